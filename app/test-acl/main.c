@@ -88,6 +88,8 @@
 #define	OPT_ITER_NUM		"iter"
 #define	OPT_VERBOSE		"verbose"
 #define	OPT_IPV6		"ipv6"
+#define	OPT_MAX_TRIES		"maxtries"
+#define	OPT_MAX_SIZE		"maxsize"
 
 #define	TRACE_DEFAULT_NUM	0x10000
 #define	TRACE_STEP_MAX		0x1000
@@ -119,6 +121,8 @@ static struct {
 	void               *traces;
 	struct rte_acl_ctx *acx;
 	uint32_t			ipv6;
+	uint32_t            max_tries;
+	uint32_t            max_size;
 } config = {
 	.bld_categories = 3,
 	.run_categories = 1,
@@ -755,8 +759,10 @@ acx_init(void)
 	int ret;
 	FILE *f;
 	struct rte_acl_config cfg;
+	struct rte_acl_build_stats stats;
 
 	/* setup ACL build config. */
+	memset(&cfg, 0, sizeof(cfg));
 	if (config.ipv6) {
 		cfg.num_fields = RTE_DIM(ipv6_defs);
 		memcpy(&cfg.defs, ipv6_defs, sizeof(ipv6_defs));
@@ -765,6 +771,8 @@ acx_init(void)
 		memcpy(&cfg.defs, ipv4_defs, sizeof(ipv4_defs));
 	}
 	cfg.num_categories = config.bld_categories;
+	cfg.max_tries = config.max_tries;
+	cfg.max_size = config.max_size;
 
 	/* setup ACL creation parameters. */
 	prm.rule_size = RTE_ACL_RULE_SZ(cfg.num_fields);
@@ -806,6 +814,12 @@ acx_init(void)
 
 	if (ret != 0)
 		rte_exit(ret, "failed to build search context\n");
+
+	rte_acl_get_build_stats(config.acx, &stats);
+	dump_verbose(DUMP_NONE, stdout,
+		"%u tries, %zu bytes of run-time structures, "
+		"%zu bytes used by build\n",
+		stats.num_tries, stats.size, stats.build_size);
 }
 
 static uint32_t
@@ -912,9 +926,13 @@ print_usage(const char *prgname)
 		"[--" OPT_ITER_NUM "=<number of iterations to perform>]\n"
 		"[--" OPT_VERBOSE "=<verbose level>]\n"
 		"[--" OPT_SEARCH_SCALAR "=<use scalar version>]\n"
-		"[--" OPT_IPV6 "=<IPv6 rules and trace files>]\n",
+		"[--" OPT_IPV6 "=<IPv6 rules and trace files>]\n"
+		"[--" OPT_MAX_TRIES
+			"=<max number of tries to build, up to %u>]\n"
+		"[--" OPT_MAX_SIZE
+			"=<max size of run-time structures in bytes>]\n",
 		prgname, RTE_ACL_RESULTS_MULTIPLIER,
-		(uint32_t)RTE_ACL_MAX_CATEGORIES);
+		(uint32_t)RTE_ACL_MAX_CATEGORIES, RTE_ACL_MAX_TRIES);
 }
 
 static void
@@ -932,6 +950,8 @@ dump_config(FILE *f)
 	fprintf(f, "%s:%u\n", OPT_VERBOSE, config.verbose);
 	fprintf(f, "%s:%u\n", OPT_SEARCH_SCALAR, config.scalar);
 	fprintf(f, "%s:%u\n", OPT_IPV6, config.ipv6);
+	fprintf(f, "%s:%u\n", OPT_MAX_TRIES, config.max_tries);
+	fprintf(f, "%s:%u\n", OPT_MAX_SIZE, config.max_size);
 }
 
 static void
@@ -960,6 +980,8 @@ get_input_opts(int argc, char **argv)
 		{OPT_VERBOSE, 1, 0, 0},
 		{OPT_SEARCH_SCALAR, 0, 0, 0},
 		{OPT_IPV6, 0, 0, 0},
+		{OPT_MAX_TRIES, 1, 0, 0},
+		{OPT_MAX_SIZE, 1, 0, 0},
 		{NULL, 0, 0, 0}
 	};
 
@@ -1006,6 +1028,12 @@ get_input_opts(int argc, char **argv)
 			config.scalar = 1;
 		} else if (strcmp(lgopts[opt_idx].name, OPT_IPV6) == 0) {
 			config.ipv6 = 1;
+		} else if (strcmp(lgopts[opt_idx].name, OPT_MAX_TRIES) == 0) {
+			config.max_tries = get_uint32_opt(optarg,
+				lgopts[opt_idx].name, 1, RTE_ACL_MAX_TRIES);
+		} else if (strcmp(lgopts[opt_idx].name, OPT_MAX_SIZE) == 0) {
+			config.max_size = get_uint32_opt(optarg,
+				lgopts[opt_idx].name, 1, UINT32_MAX);
 		}
 	}
 	config.trace_sz = config.ipv6 ? sizeof(struct ipv6_5tuple) :
@@ -346,6 +346,12 @@ parallel_test_group_list = [
 		 "Func" :default_autotest,
 		 "Report" :None,
 		 },
+		{
+		 "Name" :	"IP fragmentation autotest",
+		 "Command" : 	"ip_frag_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 	]
 },
 ]
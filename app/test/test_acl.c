@@ -42,6 +42,7 @@
 #include <rte_ip.h>
 #include <rte_acl.h>
 #include <rte_common.h>
+#include <rte_errno.h>
 
 #include "test_acl.h"
 
@@ -90,13 +91,54 @@ bswap_test_data(struct ipv4_7tuple *data, int len, int to_be)
 }
 
 /*
- * Test scalar and SSE ACL lookup.
+ * Check the results of a lookup of the first *count* test data entries.
+ */
+static int
+test_classify_check(const uint32_t *results, uint32_t count)
+{
+	uint32_t i, result;
+
+	/* check if we allow everything we should allow */
+	for (i = 0; i < count; i++) {
+		result = results[i * RTE_ACL_MAX_CATEGORIES + ACL_ALLOW];
+		if (result != acl_test_data[i].allow) {
+			printf("Line %i: Error in allow results at %u "
+					"(expected %"PRIu32" got %"PRIu32")!\n",
+					__LINE__, i, acl_test_data[i].allow,
+					result);
+			return -1;
+		}
+	}
+
+	/* check if we deny everything we should deny */
+	for (i = 0; i < count; i++) {
+		result = results[i * RTE_ACL_MAX_CATEGORIES + ACL_DENY];
+		if (result != acl_test_data[i].deny) {
+			printf("Line %i: Error in deny results at %u "
+					"(expected %"PRIu32" got %"PRIu32")!\n",
+					__LINE__, i, acl_test_data[i].deny,
+					result);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Test scalar, SSE and AVX2 ACL lookup.
+ * The last method supported by the CPU stays set for the context.
  */
 static int
 test_classify_run(struct rte_acl_ctx *acx)
 {
+	static const enum rte_acl_classify_alg alg[] = {
+		RTE_ACL_CLASSIFY_SCALAR,
+		RTE_ACL_CLASSIFY_SSE,
+		RTE_ACL_CLASSIFY_AVX2,
+	};
 	int ret, i;
-	uint32_t result, count;
+	uint32_t count, j;
 	uint32_t results[RTE_DIM(acl_test_data) * RTE_ACL_MAX_CATEGORIES];
 	const uint8_t *data[RTE_DIM(acl_test_data)];
 
@@ -107,79 +149,43 @@ test_classify_run(struct rte_acl_ctx *acx)
 	for (i = 0; i < (int) RTE_DIM(acl_test_data); i++)
 		data[i] = (uint8_t *)&acl_test_data[i];
 
-	/**
-	 * these will run quite a few times, it's necessary to test code paths
-	 * from num=0 to num>8
-	 */
-	for (count = 0; count < RTE_DIM(acl_test_data); count++) {
-		ret = rte_acl_classify(acx, data, results,
-				count, RTE_ACL_MAX_CATEGORIES);
-		if (ret != 0) {
-			printf("Line %i: SSE classify failed!\n", __LINE__);
+	ret = 0;
+	for (j = 0; j != RTE_DIM(alg); j++) {
+
+		/* skip methods that this CPU can't run */
+		ret = rte_acl_set_ctx_classify(acx, alg[j]);
+		if (ret == -ENOTSUP) {
+			ret = 0;
+			continue;
+		} else if (ret != 0) {
+			printf("Line %i: setting classify method %d failed!\n",
+				__LINE__, alg[j]);
 			goto err;
 		}
 
-		/* check if we allow everything we should allow */
-		for (i = 0; i < (int) count; i++) {
-			result =
-				results[i * RTE_ACL_MAX_CATEGORIES + ACL_ALLOW];
-			if (result != acl_test_data[i].allow) {
-				printf("Line %i: Error in allow results at %i "
-					"(expected %"PRIu32" got %"PRIu32")!\n",
-					__LINE__, i, acl_test_data[i].allow,
-					result);
+		/**
+		 * these will run quite a few times, it's necessary to test
+		 * code paths from num=0 to num>16
+		 */
+		for (count = 0; count < RTE_DIM(acl_test_data); count++) {
+			ret = rte_acl_classify(acx, data, results,
+					count, RTE_ACL_MAX_CATEGORIES);
+			if (ret != 0) {
+				printf("Line %i: classify method %d failed!\n",
+					__LINE__, alg[j]);
 				goto err;
 			}
-		}
 
-		/* check if we deny everything we should deny */
-		for (i = 0; i < (int) count; i++) {
-			result = results[i * RTE_ACL_MAX_CATEGORIES + ACL_DENY];
-			if (result != acl_test_data[i].deny) {
-				printf("Line %i: Error in deny results at %i "
-					"(expected %"PRIu32" got %"PRIu32")!\n",
-					__LINE__, i, acl_test_data[i].deny,
-					result);
+			ret = test_classify_check(results, count);
+			if (ret != 0) {
+				printf("Line %i: classify method %d, "
+					"%u packets failed!\n",
+					__LINE__, alg[j], count);
 				goto err;
 			}
 		}
 	}
 
-	/* make a quick check for scalar */
-	ret = rte_acl_classify_alg(acx, data, results,
-			RTE_DIM(acl_test_data), RTE_ACL_MAX_CATEGORIES,
-			RTE_ACL_CLASSIFY_SCALAR);
-	if (ret != 0) {
-		printf("Line %i: SSE classify failed!\n", __LINE__);
-		goto err;
-	}
-
-	/* check if we allow everything we should allow */
-	for (i = 0; i < (int) RTE_DIM(acl_test_data); i++) {
-		result = results[i * RTE_ACL_MAX_CATEGORIES + ACL_ALLOW];
-		if (result != acl_test_data[i].allow) {
-			printf("Line %i: Error in allow results at %i "
-					"(expected %"PRIu32" got %"PRIu32")!\n",
-					__LINE__, i, acl_test_data[i].allow,
-					result);
-			goto err;
-		}
-	}
-
-	/* check if we deny everything we should deny */
-	for (i = 0; i < (int) RTE_DIM(acl_test_data); i++) {
-		result = results[i * RTE_ACL_MAX_CATEGORIES + ACL_DENY];
-		if (result != acl_test_data[i].deny) {
-			printf("Line %i: Error in deny results at %i "
-					"(expected %"PRIu32" got %"PRIu32")!\n",
-					__LINE__, i, acl_test_data[i].deny,
-					result);
-			goto err;
-		}
-	}
-
-	ret = 0;
-
 err:
 	/* swap data back to cpu order so that next time tests don't fail */
 	bswap_test_data(acl_test_data, RTE_DIM(acl_test_data), 0);
@@ -883,6 +889,394 @@ test_invalid_parameters(void)
 	return 0;
 }
 
+/*
+ * Test updating rules at run time: clone a built context, change the rules
+ * of the clone, build it and swap it in place of the original one.
+ */
+enum {
+	CLONE_PROTO,
+	CLONE_SRC,
+	CLONE_DST,
+	CLONE_SRCP,
+	CLONE_DSTP,
+	CLONE_NUM_FIELDS,
+};
+
+RTE_ACL_RULE_DEF(acl_clone_rule, CLONE_NUM_FIELDS);
+
+#define	CLONE_RULE(src, usr) { \
+	.data = { \
+		.userdata = (usr), \
+		.category_mask = 1, \
+		.priority = 1, \
+	}, \
+	.field[CLONE_SRC] = { \
+		.value.u32 = (src), \
+		.mask_range.u32 = 32, \
+	}, \
+	.field[CLONE_SRCP] = { \
+		.value.u16 = 0, \
+		.mask_range.u16 = UINT16_MAX, \
+	}, \
+	.field[CLONE_DSTP] = { \
+		.value.u16 = 0, \
+		.mask_range.u16 = UINT16_MAX, \
+	}, \
+}
+
+static void
+test_clone_config(struct rte_acl_config *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->num_categories = 1;
+	cfg->num_fields = CLONE_NUM_FIELDS;
+	cfg->defs[CLONE_PROTO] = (struct rte_acl_field_def) {
+		.type = RTE_ACL_FIELD_TYPE_BITMASK,
+		.size = sizeof(uint8_t),
+		.field_index = CLONE_PROTO,
+		.input_index = 0,
+		.offset = offsetof(struct ipv4_7tuple, proto),
+	};
+	cfg->defs[CLONE_SRC] = (struct rte_acl_field_def) {
+		.type = RTE_ACL_FIELD_TYPE_MASK,
+		.size = sizeof(uint32_t),
+		.field_index = CLONE_SRC,
+		.input_index = 1,
+		.offset = offsetof(struct ipv4_7tuple, ip_src),
+	};
+	cfg->defs[CLONE_DST] = (struct rte_acl_field_def) {
+		.type = RTE_ACL_FIELD_TYPE_MASK,
+		.size = sizeof(uint32_t),
+		.field_index = CLONE_DST,
+		.input_index = 2,
+		.offset = offsetof(struct ipv4_7tuple, ip_dst),
+	};
+	cfg->defs[CLONE_SRCP] = (struct rte_acl_field_def) {
+		.type = RTE_ACL_FIELD_TYPE_RANGE,
+		.size = sizeof(uint16_t),
+		.field_index = CLONE_SRCP,
+		.input_index = 3,
+		.offset = offsetof(struct ipv4_7tuple, port_src),
+	};
+	cfg->defs[CLONE_DSTP] = (struct rte_acl_field_def) {
+		.type = RTE_ACL_FIELD_TYPE_RANGE,
+		.size = sizeof(uint16_t),
+		.field_index = CLONE_DSTP,
+		.input_index = 3,
+		.offset = offsetof(struct ipv4_7tuple, port_dst),
+	};
+}
+
+static int
+test_clone_classify(struct rte_acl_ctx *acx, const uint32_t expected[])
+{
+	struct ipv4_7tuple tuples[3];
+	const uint8_t *data[RTE_DIM(tuples)];
+	uint32_t results[RTE_DIM(tuples)];
+	uint32_t i;
+	int ret;
+
+	memset(tuples, 0, sizeof(tuples));
+	for (i = 0; i != RTE_DIM(tuples); i++) {
+		tuples[i].ip_src = rte_cpu_to_be_32(IPv4(10, 0, 0, i + 1));
+		data[i] = (const uint8_t *)&tuples[i];
+	}
+
+	ret = rte_acl_classify(acx, data, results, RTE_DIM(results), 1);
+	if (ret != 0) {
+		printf("Line %i: classify failed!\n", __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i != RTE_DIM(results); i++) {
+		if (results[i] != expected[i]) {
+			printf("Line %i: Wrong results at %u "
+				"(result=%u, should be %u)!\n",
+				__LINE__, i, results[i], expected[i]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_clone_swap(void)
+{
+	struct rte_acl_param param;
+	struct rte_acl_config cfg;
+	struct rte_acl_ctx *acx, *clone, *pub, *old;
+	int ret;
+
+	static const struct acl_clone_rule rules[] = {
+		CLONE_RULE(IPv4(10, 0, 0, 1), 1),
+		CLONE_RULE(IPv4(10, 0, 0, 2), 2),
+		CLONE_RULE(IPv4(10, 0, 0, 3), 3),
+	};
+	static const uint32_t old_results[] = {1, 2, 0};
+	static const uint32_t new_results[] = {1, 0, 3};
+
+	test_clone_config(&cfg);
+
+	memset(&param, 0, sizeof(param));
+	param.name = "acl_clone_old";
+	param.socket_id = SOCKET_ID_ANY;
+	param.rule_size = RTE_ACL_RULE_SZ(CLONE_NUM_FIELDS);
+	param.max_rule_num = RTE_DIM(rules);
+
+	acx = rte_acl_create(&param);
+	if (acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return -1;
+	}
+
+	clone = NULL;
+
+	ret = rte_acl_add_rules(acx, (const struct rte_acl_rule *)rules, 2);
+	if (ret != 0) {
+		printf("Line %i: Adding rules to ACL context failed!\n",
+			__LINE__);
+		goto err;
+	}
+
+	ret = rte_acl_build(acx, &cfg);
+	if (ret != 0) {
+		printf("Line %i: Building ACL context failed!\n", __LINE__);
+		goto err;
+	}
+
+	/* clone with wrong rule size */
+	param.name = "acl_clone_new";
+	param.rule_size = RTE_ACL_IPV4VLAN_RULE_SZ;
+	clone = rte_acl_clone(acx, &param);
+	if (clone != NULL || rte_errno != EINVAL) {
+		printf("Line %i: Clone with wrong rule size succeeded!\n",
+			__LINE__);
+		goto err;
+	}
+
+	/* clone with too few rules */
+	param.rule_size = RTE_ACL_RULE_SZ(CLONE_NUM_FIELDS);
+	param.max_rule_num = 1;
+	clone = rte_acl_clone(acx, &param);
+	if (clone != NULL || rte_errno != EINVAL) {
+		printf("Line %i: Clone with too few rules succeeded!\n",
+			__LINE__);
+		goto err;
+	}
+
+	/* clone with the name of an existing context */
+	param.name = "acl_clone_old";
+	param.max_rule_num = RTE_DIM(rules);
+	clone = rte_acl_clone(acx, &param);
+	if (clone != NULL || rte_errno != EEXIST) {
+		printf("Line %i: Clone with existing name succeeded!\n",
+			__LINE__);
+		goto err;
+	}
+
+	param.name = "acl_clone_new";
+	clone = rte_acl_clone(acx, &param);
+	if (clone == NULL) {
+		printf("Line %i: Error cloning ACL context!\n", __LINE__);
+		goto err;
+	}
+
+	/* replace rule 2 with rule 3 in the clone */
+	ret = rte_acl_del_rules(clone,
+		(const struct rte_acl_rule *)&rules[1], 1);
+	if (ret != 1) {
+		printf("Line %i: Deleting rule returned %d!\n",
+			__LINE__, ret);
+		goto err;
+	}
+
+	ret = rte_acl_del_rules(clone,
+		(const struct rte_acl_rule *)&rules[1], 1);
+	if (ret != 0) {
+		printf("Line %i: Deleting missing rule returned %d!\n",
+			__LINE__, ret);
+		goto err;
+	}
+
+	ret = rte_acl_add_rules(clone,
+		(const struct rte_acl_rule *)&rules[2], 1);
+	if (ret != 0) {
+		printf("Line %i: Adding rules to ACL context failed!\n",
+			__LINE__);
+		goto err;
+	}
+
+	ret = rte_acl_build(clone, &cfg);
+	if (ret != 0) {
+		printf("Line %i: Building ACL context failed!\n", __LINE__);
+		goto err;
+	}
+
+	/* publish the new context */
+	pub = acx;
+	old = rte_acl_swap(&pub, clone);
+	if (old != acx || pub != clone) {
+		printf("Line %i: Swapping ACL contexts failed!\n", __LINE__);
+		goto err;
+	}
+
+	/* the old context keeps working until it is freed */
+	if (test_clone_classify(old, old_results) != 0 ||
+			test_clone_classify(pub, new_results) != 0)
+		goto err;
+
+	rte_acl_free(clone);
+	rte_acl_free(acx);
+
+	return 0;
+err:
+	rte_acl_free(clone);
+	rte_acl_free(acx);
+
+	return -1;
+}
+
+/*
+ * Test build limits and statistics.
+ */
+static int
+test_build_limits(void)
+{
+	struct rte_acl_param param;
+	struct rte_acl_config cfg;
+	struct rte_acl_build_stats stats;
+	struct rte_acl_ctx *acx;
+	struct acl_clone_rule rules[64];
+	size_t size;
+	uint32_t i, n;
+	int ret;
+
+	static const uint32_t results[] = {1, 2, 3};
+
+	/* rules with different source port ranges, to get some nodes. */
+	for (i = 0; i != RTE_DIM(rules); i++) {
+		struct acl_clone_rule r = CLONE_RULE(IPv4(10, 0, 0, i + 1),
+			i + 1);
+
+		r.field[CLONE_SRCP].mask_range.u16 = i * 1000 + 1;
+		rules[i] = r;
+	}
+
+	test_clone_config(&cfg);
+
+	memset(&param, 0, sizeof(param));
+	param.name = "acl_build_limits";
+	param.socket_id = SOCKET_ID_ANY;
+	param.rule_size = RTE_ACL_RULE_SZ(CLONE_NUM_FIELDS);
+	param.max_rule_num = RTE_DIM(rules);
+
+	acx = rte_acl_create(&param);
+	if (acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return -1;
+	}
+
+	ret = rte_acl_add_rules(acx, (const struct rte_acl_rule *)rules,
+		RTE_DIM(rules));
+	if (ret != 0) {
+		printf("Line %i: Adding rules to ACL context failed!\n",
+			__LINE__);
+		goto err;
+	}
+
+	/* too many tries */
+	cfg.max_tries = RTE_ACL_MAX_TRIES + 1;
+	ret = rte_acl_build(acx, &cfg);
+	if (ret != -EINVAL) {
+		printf("Line %i: Build with %u tries returned %d!\n",
+			__LINE__, cfg.max_tries, ret);
+		goto err;
+	}
+
+	/* no limits */
+	cfg.max_tries = 0;
+	ret = rte_acl_build(acx, &cfg);
+	if (ret != 0) {
+		printf("Line %i: Building ACL context failed!\n", __LINE__);
+		goto err;
+	}
+
+	ret = rte_acl_get_build_stats(acx, &stats);
+	if (ret != 0 || stats.num_tries == 0 ||
+			stats.num_tries > RTE_ACL_MAX_TRIES ||
+			stats.size == 0 || stats.build_size == 0) {
+		printf("Line %i: Wrong build stats!\n", __LINE__);
+		goto err;
+	}
+
+	n = 0;
+	for (i = 0; i != stats.num_tries; i++) {
+		if (stats.trie[i].num_nodes == 0 ||
+				stats.trie[i].size == 0) {
+			printf("Line %i: Wrong stats for trie %u!\n",
+				__LINE__, i);
+			goto err;
+		}
+		n += stats.trie[i].num_rules;
+	}
+	if (n != RTE_DIM(rules)) {
+		printf("Line %i: %u rules in tries, should be %zu!\n",
+			__LINE__, n, RTE_DIM(rules));
+		goto err;
+	}
+
+	/* single trie */
+	size = stats.size;
+	cfg.max_tries = 1;
+	ret = rte_acl_build(acx, &cfg);
+	if (ret != 0) {
+		printf("Line %i: Building ACL context failed!\n", __LINE__);
+		goto err;
+	}
+
+	rte_acl_get_build_stats(acx, &stats);
+	if (stats.num_tries != 1 || stats.trie[0].num_rules != RTE_DIM(rules)) {
+		printf("Line %i: Build with one trie returned %u tries!\n",
+			__LINE__, stats.num_tries);
+		goto err;
+	}
+
+	if (test_clone_classify(acx, results) != 0)
+		goto err;
+
+	/* the size of the unlimited build is enough */
+	cfg.max_tries = 0;
+	cfg.max_size = size;
+	ret = rte_acl_build(acx, &cfg);
+	if (ret != 0) {
+		printf("Line %i: Build within %zu bytes failed!\n",
+			__LINE__, size);
+		goto err;
+	}
+
+	/* nothing fits into one byte */
+	cfg.max_size = 1;
+	ret = rte_acl_build(acx, &cfg);
+	if (ret != -ERANGE) {
+		printf("Line %i: Build within one byte returned %d!\n",
+			__LINE__, ret);
+		goto err;
+	}
+
+	rte_acl_get_build_stats(acx, &stats);
+	if (stats.num_tries != 0) {
+		printf("Line %i: Stats left after failed build!\n", __LINE__);
+		goto err;
+	}
+
+	rte_acl_free(acx);
+	return 0;
+err:
+	rte_acl_free(acx);
+	return -1;
+}
+
 /**
  * Various tests that don't test much but improve coverage
  */
@@ -926,6 +1320,10 @@ test_acl(void)
 		return -1;
 	if (test_classify() < 0)
 		return -1;
+	if (test_clone_swap() < 0)
+		return -1;
+	if (test_build_limits() < 0)
+		return -1;
 
 	return 0;
 }
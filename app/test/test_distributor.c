@@ -93,6 +93,28 @@ handle_work(void *arg)
 	return 0;
 }
 
+/* worker function for the sanity test of a distributor in burst mode, it
+ * returns packets and counts them.
+ */
+static int
+handle_work_burst(void *arg)
+{
+	struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE];
+	struct rte_distributor *d = arg;
+	unsigned count = 0;
+	unsigned id = __sync_fetch_and_add(&worker_idx, 1);
+	int num;
+
+	num = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+	while (!quit) {
+		worker_stats[id].handled_packets += num, count += num;
+		num = rte_distributor_get_pkt_burst(d, id, pkts, pkts, num);
+	}
+	worker_stats[id].handled_packets += num, count += num;
+	rte_distributor_return_pkt_burst(d, id, pkts, num);
+	return 0;
+}
+
 /* do basic sanity testing of the distributor. This test tests the following:
  * - send 32 packets through distributor with the same tag and ensure they
  *   all go to the one worker
@@ -445,6 +467,197 @@ test_flush_with_worker_shutdown(struct rte_distributor *d,
 	return 0;
 }
 
+/* Test the exchange of packets with the workers in burst mode. The workers
+ * are emulated on the calling lcore using the non-blocking worker APIs.
+ */
+static int
+test_burst_exchange(void)
+{
+	static struct rte_distributor *d;
+	static struct rte_mbuf mbufs[RTE_DISTRIB_BURST_SIZE + 2];
+	struct rte_mbuf *bufs[RTE_DISTRIB_BURST_SIZE + 2];
+	struct rte_mbuf *pkts0[RTE_DISTRIB_BURST_SIZE];
+	struct rte_mbuf *pkts1[RTE_DISTRIB_BURST_SIZE];
+	struct rte_mbuf *returns[RTE_DISTRIB_BURST_SIZE + 2];
+	unsigned i;
+
+	printf("=== Test burst mode exchange ===\n");
+
+	if (d == NULL) {
+		d = rte_distributor_create_burst("Test_dist_burst_xchg",
+				rte_socket_id(), 2);
+		if (d == NULL) {
+			printf("Error creating burst distributor\n");
+			return -1;
+		}
+	}
+	rte_distributor_clear_returns(d);
+
+	for (i = 0; i < RTE_DIM(bufs); i++) {
+		bufs[i] = &mbufs[i];
+		bufs[i]->hash.usr = i;
+	}
+	/* same flow as a packet of the first burst */
+	bufs[RTE_DISTRIB_BURST_SIZE]->hash.usr = 3;
+
+	/* a full burst is given to the only worker waiting for packets */
+	rte_distributor_request_pkt_burst(d, 0, NULL, 0);
+	if (rte_distributor_poll_pkt_burst(d, 0, pkts0) != -1) {
+		printf("line %d: Packets given before processing\n", __LINE__);
+		return -1;
+	}
+	rte_distributor_process(d, bufs, RTE_DISTRIB_BURST_SIZE);
+	if (rte_distributor_poll_pkt_burst(d, 0, pkts0) !=
+			RTE_DISTRIB_BURST_SIZE ||
+			memcmp(pkts0, bufs, sizeof(pkts0)) != 0) {
+		printf("line %d: Wrong burst given to worker\n", __LINE__);
+		return -1;
+	}
+
+	/* a packet of a flow in flight waits for its worker, a new flow goes
+	 * to the idle worker */
+	rte_distributor_request_pkt_burst(d, 1, NULL, 0);
+	rte_distributor_process(d, &bufs[RTE_DISTRIB_BURST_SIZE], 2);
+	if (rte_distributor_poll_pkt_burst(d, 1, pkts1) != 1 ||
+			pkts1[0] != bufs[RTE_DISTRIB_BURST_SIZE + 1]) {
+		printf("line %d: Wrong burst given to worker\n", __LINE__);
+		return -1;
+	}
+
+	/* the first worker returns its burst and gets the queued packet */
+	rte_distributor_request_pkt_burst(d, 0, pkts0, RTE_DISTRIB_BURST_SIZE);
+	rte_distributor_process(d, NULL, 0);
+	if (rte_distributor_poll_pkt_burst(d, 0, pkts0) != 1 ||
+			pkts0[0] != bufs[RTE_DISTRIB_BURST_SIZE]) {
+		printf("line %d: Wrong burst given to worker\n", __LINE__);
+		return -1;
+	}
+	if (rte_distributor_returned_pkts(d, returns, RTE_DIM(returns)) !=
+			RTE_DISTRIB_BURST_SIZE ||
+			memcmp(returns, bufs, sizeof(pkts0)) != 0) {
+		printf("line %d: Wrong packets returned\n", __LINE__);
+		return -1;
+	}
+
+	/* both workers shut down, returning their last packet */
+	rte_distributor_return_pkt_burst(d, 0, pkts0, 1);
+	rte_distributor_return_pkt_burst(d, 1, pkts1, 1);
+	if (rte_distributor_flush(d) != 2 ||
+			rte_distributor_returned_pkts(d, returns,
+				RTE_DIM(returns)) != 2) {
+		printf("line %d: Wrong packets returned\n", __LINE__);
+		return -1;
+	}
+
+	printf("Burst mode exchange test passed\n\n");
+	return 0;
+}
+
+/* Test a flow with more packets than fit in the backlog of a worker in burst
+ * mode: all of them must go to the worker processing the flow, in order,
+ * while the other worker is idle. When the backlog is deeper than a burst,
+ * the packets left after giving a burst are moved to the head of the
+ * backlog. The workers are emulated on the calling lcore.
+ */
+static int
+test_burst_backlog(void)
+{
+#define FLOW_PKTS (RTE_DISTRIB_BURST_SIZE + RTE_DISTRIB_BACKLOG_SIZE)
+	static struct rte_distributor *d;
+	static struct rte_mbuf mbufs[FLOW_PKTS + 1];
+	struct rte_mbuf *bufs[FLOW_PKTS + 1];
+	struct rte_mbuf *pkts0[RTE_DISTRIB_BURST_SIZE];
+	struct rte_mbuf *pkts1[RTE_DISTRIB_BURST_SIZE];
+	struct rte_mbuf *returns[FLOW_PKTS + 1];
+	unsigned i, n, next, flow_next;
+
+	printf("=== Test burst mode backlog ===\n");
+
+	if (d == NULL) {
+		d = rte_distributor_create_burst("Test_dist_burst_bl",
+				rte_socket_id(), 2);
+		if (d == NULL) {
+			printf("Error creating burst distributor\n");
+			return -1;
+		}
+	}
+	rte_distributor_clear_returns(d);
+
+	/* one flow, and a last packet of another flow */
+	for (i = 0; i < RTE_DIM(bufs); i++) {
+		bufs[i] = &mbufs[i];
+		bufs[i]->hash.usr = 7;
+	}
+	bufs[FLOW_PKTS]->hash.usr = 9;
+
+	/* the first worker gets a full burst of the flow */
+	rte_distributor_request_pkt_burst(d, 0, NULL, 0);
+	rte_distributor_process(d, bufs, RTE_DISTRIB_BURST_SIZE);
+	if (rte_distributor_poll_pkt_burst(d, 0, pkts0) !=
+			RTE_DISTRIB_BURST_SIZE ||
+			memcmp(pkts0, bufs, sizeof(pkts0)) != 0) {
+		printf("line %d: Wrong burst given to worker\n", __LINE__);
+		return -1;
+	}
+
+	/* the rest of the flow fills the backlog of the first worker, although
+	 * the second one is idle; the other flow goes to the second worker */
+	rte_distributor_request_pkt_burst(d, 1, NULL, 0);
+	rte_distributor_process(d, &bufs[RTE_DISTRIB_BURST_SIZE],
+			RTE_DISTRIB_BACKLOG_SIZE + 1);
+	if (rte_distributor_poll_pkt_burst(d, 1, pkts1) != 1 ||
+			pkts1[0] != bufs[FLOW_PKTS]) {
+		printf("line %d: Wrong burst given to worker\n", __LINE__);
+		return -1;
+	}
+	rte_distributor_request_pkt_burst(d, 1, pkts1, 1);
+
+	/* the first worker drains the backlog, one burst at a time */
+	n = RTE_DISTRIB_BURST_SIZE;
+	for (next = RTE_DISTRIB_BURST_SIZE; next < FLOW_PKTS; next += n) {
+		rte_distributor_request_pkt_burst(d, 0, pkts0, n);
+		rte_distributor_process(d, NULL, 0);
+		n = rte_distributor_poll_pkt_burst(d, 0, pkts0);
+		if (n != RTE_MIN((unsigned)RTE_DISTRIB_BURST_SIZE,
+					FLOW_PKTS - next) ||
+				memcmp(pkts0, &bufs[next],
+					n * sizeof(pkts0[0])) != 0) {
+			printf("line %d: Wrong burst given to worker\n",
+				__LINE__);
+			return -1;
+		}
+		if (rte_distributor_poll_pkt_burst(d, 1, pkts1) != -1) {
+			printf("line %d: Packets of a busy flow given to "
+				"another worker\n", __LINE__);
+			return -1;
+		}
+	}
+
+	/* both workers shut down; the flow is returned in order */
+	rte_distributor_return_pkt_burst(d, 0, pkts0, n);
+	rte_distributor_return_pkt_burst(d, 1, NULL, 0);
+	rte_distributor_flush(d);
+	if (rte_distributor_returned_pkts(d, returns, RTE_DIM(returns)) !=
+			RTE_DIM(returns)) {
+		printf("line %d: Wrong packets returned\n", __LINE__);
+		return -1;
+	}
+	flow_next = 0;
+	for (i = 0; i < RTE_DIM(returns); i++) {
+		if (returns[i] == bufs[FLOW_PKTS])
+			continue;
+		if (returns[i] != bufs[flow_next++]) {
+			printf("line %d: Flow returned out of order\n",
+				__LINE__);
+			return -1;
+		}
+	}
+
+	printf("Burst mode backlog test passed\n\n");
+	return 0;
+#undef FLOW_PKTS
+}
+
 static
 int test_error_distributor_create_name(void)
 {
@@ -506,8 +719,14 @@ static int
 test_distributor(void)
 {
 	static struct rte_distributor *d;
+	static struct rte_distributor *db;
 	static struct rte_mempool *p;
 
+	if (test_burst_exchange() < 0)
+		return -1;
+	if (test_burst_backlog() < 0)
+		return -1;
+
 	if (rte_lcore_count() < 2) {
 		printf("ERROR: not enough cores to test distributor\n");
 		return -1;
@@ -525,6 +744,18 @@ test_distributor(void)
 		rte_distributor_clear_returns(d);
 	}
 
+	if (db == NULL) {
+		db = rte_distributor_create_burst("Test_dist_burst",
+				rte_socket_id(), rte_lcore_count() - 1);
+		if (db == NULL) {
+			printf("Error creating burst distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_flush(db);
+		rte_distributor_clear_returns(db);
+	}
+
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -567,6 +798,13 @@ test_distributor(void)
 		printf("Not enough cores to run tests for worker shutdown\n");
 	}
 
+	rte_eal_mp_remote_launch(handle_work_burst, db, SKIP_MASTER);
+	if (sanity_test(db, p) < 0) {
+		quit_workers(db, p);
+		return -1;
+	}
+	quit_workers(db, p);
+
 	if (test_error_distributor_create_numworkers() == -1 ||
 			test_error_distributor_create_name() == -1) {
 		printf("rte_distributor_create parameter check tests failed");
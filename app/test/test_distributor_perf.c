@@ -141,6 +141,26 @@ handle_work(void *arg)
 	return 0;
 }
 
+/* worker function for performance tests in burst mode */
+static int
+handle_work_burst(void *arg)
+{
+	struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE];
+	struct rte_distributor *d = arg;
+	unsigned count = 0;
+	unsigned id = __sync_fetch_and_add(&worker_idx, 1);
+	int num;
+
+	num = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+	while (!quit) {
+		worker_stats[id].handled_packets += num, count += num;
+		num = rte_distributor_get_pkt_burst(d, id, pkts, pkts, num);
+	}
+	worker_stats[id].handled_packets += num, count += num;
+	rte_distributor_return_pkt_burst(d, id, pkts, num);
+	return 0;
+}
+
 /* this basic performance test just repeatedly sends in 32 packets at a time
  * to the distributor and verifies at the end that we got them all in the worker
  * threads and finally how long per packet the processing took.
@@ -215,6 +235,7 @@ static int
 test_distributor_perf(void)
 {
 	static struct rte_distributor *d;
+	static struct rte_distributor *db;
 	static struct rte_mempool *p;
 
 	if (rte_lcore_count() < 2) {
@@ -237,6 +258,18 @@ test_distributor_perf(void)
 		rte_distributor_clear_returns(d);
 	}
 
+	if (db == NULL) {
+		db = rte_distributor_create_burst("Test_perf_burst",
+				rte_socket_id(), rte_lcore_count() - 1);
+		if (db == NULL) {
+			printf("Error creating burst distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_flush(db);
+		rte_distributor_clear_returns(db);
+	}
+
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -257,6 +290,12 @@ test_distributor_perf(void)
 		return -1;
 	quit_workers(d, p);
 
+	printf("=== Burst mode ===\n");
+	rte_eal_mp_remote_launch(handle_work_burst, db, SKIP_MASTER);
+	if (perf_test(db, p) < 0)
+		return -1;
+	quit_workers(db, p);
+
 	return 0;
 }
 
@@ -47,6 +47,9 @@
 #include <rte_memzone.h>
 #include <rte_tailq.h>
 #include <rte_eal.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
 #include <rte_ip.h>
 #include <rte_string_fns.h>
 
@@ -610,6 +613,338 @@ static int test_full_bucket(void)
 	return 0;
 }
 
+/*
+ * Fill a single bucket for every supported bucket size, so that signature
+ * compares are checked on the whole bucket and never match in its padding:
+ *	- add bucket_entries keys: all successful, at distinct positions
+ *	- add one more key: -ENOSPC
+ *	- lookup all keys, one by one and in bulk: hits, one miss
+ */
+static int test_full_bucket_sizes(void)
+{
+	struct rte_hash_parameters params_pseudo_hash = {
+		.name = "test_bucket_sizes",
+		.entries = 64,
+		.key_len = sizeof(uint32_t),
+		.hash_func = pseudo_hash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+	};
+	uint32_t bucket_keys[RTE_HASH_BUCKET_ENTRIES_MAX + 1];
+	const void *key_array[RTE_HASH_BUCKET_ENTRIES_MAX + 1];
+	int32_t pos[RTE_HASH_BUCKET_ENTRIES_MAX + 1];
+	int32_t expected_pos[RTE_HASH_BUCKET_ENTRIES_MAX + 1];
+	struct rte_hash *handle;
+	uint32_t n, n_bulk, i;
+
+	for (n = 1; n <= RTE_HASH_BUCKET_ENTRIES_MAX; n <<= 1) {
+		params_pseudo_hash.bucket_entries = n;
+		handle = rte_hash_create(&params_pseudo_hash);
+		RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+		for (i = 0; i <= n; i++) {
+			bucket_keys[i] = i + 1;
+			key_array[i] = &bucket_keys[i];
+		}
+
+		for (i = 0; i < n; i++) {
+			expected_pos[i] = rte_hash_add_key(handle,
+							   &bucket_keys[i]);
+			RETURN_IF_ERROR(expected_pos[i] < 0 ||
+				(i > 0 && expected_pos[i] == expected_pos[0]),
+				"failed to add key %u of %u (pos=%d)",
+				i, n, expected_pos[i]);
+		}
+		pos[n] = rte_hash_add_key(handle, &bucket_keys[n]);
+		RETURN_IF_ERROR(pos[n] != -ENOSPC,
+			"fail: added key to full bucket of %u (pos=%d)",
+			n, pos[n]);
+		expected_pos[n] = -ENOENT;
+
+		for (i = 0; i <= n; i++) {
+			pos[i] = rte_hash_lookup(handle, &bucket_keys[i]);
+			RETURN_IF_ERROR(pos[i] != expected_pos[i],
+				"failed lookup of key %u of %u (pos=%d)",
+				i, n, pos[i]);
+		}
+		n_bulk = RTE_MIN(n + 1, (uint32_t)RTE_HASH_LOOKUP_BULK_MAX);
+		RETURN_IF_ERROR(rte_hash_lookup_bulk(handle, key_array, n_bulk,
+				pos) != 0, "bulk lookup failed");
+		for (i = 0; i < n_bulk; i++)
+			RETURN_IF_ERROR(pos[i] != expected_pos[i],
+				"failed bulk lookup of key %u of %u (pos=%d)",
+				i, n, pos[i]);
+
+		rte_hash_free(handle);
+	}
+
+	return 0;
+}
+
+/*
+ * Same keys as test_full_bucket, on a cuckoo table:
+ *	- add 5 keys that share both candidate buckets (4 keys per bucket):
+ *	  all successful, the 5th going to the alternative bucket
+ *	- lookup the 5 keys, one by one and in bulk: 5 hits
+ *	- delete the 5 keys: 5 OK, with the positions returned by add
+ *	- lookup the 5 keys: 5 misses
+ */
+static int test_cuckoo_full_bucket(void)
+{
+	struct rte_hash_parameters params_pseudo_hash = {
+		.name = "test_cuckoo_full",
+		.entries = 64,
+		.bucket_entries = 4,
+		.key_len = sizeof(struct flow_key), /* 13 */
+		.hash_func = pseudo_hash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_CUCKOO,
+	};
+	struct rte_hash *handle;
+	const void *key_array[5];
+	int pos[5];
+	int expected_pos[5];
+	unsigned i;
+
+	handle = rte_hash_create(&params_pseudo_hash);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	/* Fill primary bucket, overflow into the alternative one */
+	for (i = 0; i < 5; i++) {
+		pos[i] = rte_hash_add_key(handle, &keys[i]);
+		print_key_info("Add", &keys[i], pos[i]);
+		RETURN_IF_ERROR(pos[i] < 0,
+			"failed to add key (pos[%u]=%d)", i, pos[i]);
+		expected_pos[i] = pos[i];
+		key_array[i] = &keys[i];
+	}
+
+	/* Lookup */
+	for (i = 0; i < 5; i++) {
+		pos[i] = rte_hash_lookup(handle, &keys[i]);
+		print_key_info("Lkp", &keys[i], pos[i]);
+		RETURN_IF_ERROR(pos[i] != expected_pos[i],
+			"failed to find key (pos[%u]=%d)", i, pos[i]);
+	}
+	RETURN_IF_ERROR(rte_hash_lookup_bulk(handle, key_array, 5,
+			(int32_t *)pos) != 0, "bulk lookup failed");
+	for (i = 0; i < 5; i++)
+		RETURN_IF_ERROR(pos[i] != expected_pos[i],
+			"failed to bulk find key (pos[%u]=%d)", i, pos[i]);
+
+	/* Delete */
+	for (i = 0; i < 5; i++) {
+		pos[i] = rte_hash_del_key(handle, &keys[i]);
+		print_key_info("Del", &keys[i], pos[i]);
+		RETURN_IF_ERROR(pos[i] != expected_pos[i],
+			"failed to delete key (pos[%u]=%d)", i, pos[i]);
+	}
+
+	/* Lookup */
+	for (i = 0; i < 5; i++) {
+		pos[i] = rte_hash_lookup(handle, &keys[i]);
+		print_key_info("Lkp", &keys[i], pos[i]);
+		RETURN_IF_ERROR(pos[i] != -ENOENT,
+			"fail: found non-existent key (pos[%u]=%d)", i, pos[i]);
+	}
+
+	rte_hash_free(handle);
+	return 0;
+}
+
+#define CUCKOO_TEST_ENTRIES		1024
+#define CUCKOO_TEST_MIN_LOAD_PCT	90
+
+/*
+ * Fill a cuckoo table with distinct keys until an add fails, then check:
+ *	- at least CUCKOO_TEST_MIN_LOAD_PCT percent of the entries were used
+ *	- every key is still found at the position returned by add, with both
+ *	  single and bulk lookups, although keys were displaced meanwhile
+ *	- every key can be deleted, leaving the table empty
+ */
+static int test_cuckoo_load_factor(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_cuckoo_load",
+		.entries = CUCKOO_TEST_ENTRIES,
+		.bucket_entries = 4,
+		.key_len = sizeof(struct flow_key), /* 13 */
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_CUCKOO,
+	};
+	static struct flow_key flows[CUCKOO_TEST_ENTRIES];
+	static int32_t expected_pos[CUCKOO_TEST_ENTRIES];
+	struct rte_hash *handle;
+	const void *key_array[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t pos[RTE_HASH_LOOKUP_BULK_MAX];
+	unsigned i, j, n, n_keys;
+	int32_t ret;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	memset(flows, 0, sizeof(flows));
+	for (n_keys = 0; n_keys < CUCKOO_TEST_ENTRIES; n_keys++) {
+		flows[n_keys].ip_src = rte_rand();
+		flows[n_keys].ip_dst = n_keys;
+		flows[n_keys].proto = 17;
+		ret = rte_hash_add_key(handle, &flows[n_keys]);
+		if (ret == -ENOSPC)
+			break;
+		RETURN_IF_ERROR(ret < 0 || ret >= CUCKOO_TEST_ENTRIES,
+			"failed to add key %u (ret=%d)", n_keys, ret);
+		expected_pos[n_keys] = ret;
+	}
+	RETURN_IF_ERROR(n_keys * 100 < CUCKOO_TEST_ENTRIES *
+			CUCKOO_TEST_MIN_LOAD_PCT,
+			"cuckoo table only took %u of %u keys",
+			n_keys, CUCKOO_TEST_ENTRIES);
+
+	for (i = 0; i < n_keys; i++) {
+		ret = rte_hash_lookup(handle, &flows[i]);
+		RETURN_IF_ERROR(ret != expected_pos[i],
+			"failed to find key %u (ret=%d)", i, ret);
+	}
+
+	for (i = 0; i < n_keys; i += n) {
+		n = RTE_MIN(n_keys - i, (unsigned)RTE_HASH_LOOKUP_BULK_MAX);
+		for (j = 0; j < n; j++)
+			key_array[j] = &flows[i + j];
+		RETURN_IF_ERROR(rte_hash_lookup_bulk(handle, key_array, n,
+				pos) != 0, "bulk lookup failed");
+		for (j = 0; j < n; j++)
+			RETURN_IF_ERROR(pos[j] != expected_pos[i + j],
+				"failed to bulk find key %u (ret=%d)",
+				i + j, pos[j]);
+	}
+
+	for (i = 0; i < n_keys; i++) {
+		ret = rte_hash_del_key(handle, &flows[i]);
+		RETURN_IF_ERROR(ret != expected_pos[i],
+			"failed to delete key %u (ret=%d)", i, ret);
+	}
+	for (i = 0; i < n_keys; i++) {
+		ret = rte_hash_lookup(handle, &flows[i]);
+		RETURN_IF_ERROR(ret != -ENOENT,
+			"fail: found deleted key %u (ret=%d)", i, ret);
+	}
+
+	rte_hash_free(handle);
+	return 0;
+}
+
+#define MR_TEST_ENTRIES		1024
+#define MR_TEST_STABLE_KEYS	256
+#define MR_TEST_ROUNDS		64
+
+static struct rte_hash *mr_handle;
+static uint32_t mr_stable_keys[MR_TEST_STABLE_KEYS];
+static int32_t mr_stable_pos[MR_TEST_STABLE_KEYS];
+static volatile int mr_stop;
+static rte_atomic32_t mr_errors;
+
+/* Reader: the stable keys must always be found at their position. */
+static int
+test_multi_reader_lookup(__attribute__((unused)) void *arg)
+{
+	const void *key_array[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t pos[RTE_HASH_LOOKUP_BULK_MAX];
+	unsigned i, j;
+
+	while (!mr_stop) {
+		for (i = 0; i < MR_TEST_STABLE_KEYS; i++) {
+			if (rte_hash_lookup(mr_handle, &mr_stable_keys[i]) !=
+					mr_stable_pos[i])
+				rte_atomic32_inc(&mr_errors);
+		}
+		for (i = 0; i < MR_TEST_STABLE_KEYS;
+				i += RTE_HASH_LOOKUP_BULK_MAX) {
+			for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+				key_array[j] = &mr_stable_keys[i + j];
+			rte_hash_lookup_bulk(mr_handle, key_array,
+					     RTE_HASH_LOOKUP_BULK_MAX, pos);
+			for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+				if (pos[j] != mr_stable_pos[i + j])
+					rte_atomic32_inc(&mr_errors);
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Multi-reader cuckoo table: while the slave lcores look up a set of stable
+ * keys, the master fills the table with other keys up to the first -ENOSPC
+ * (so that stable keys get displaced) and deletes them again. Readers must
+ * never miss a stable key. With a single lcore, the master checks the
+ * stable keys between rounds only.
+ */
+static int test_hash_multi_reader(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_multi_reader",
+		.entries = MR_TEST_ENTRIES,
+		.bucket_entries = 4,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_CUCKOO |
+			RTE_HASH_EXTRA_FLAGS_MULTI_READER,
+	};
+	static uint32_t churn_keys[MR_TEST_ENTRIES];
+	struct rte_hash *handle;
+	unsigned i, round, n_churn;
+	int32_t ret;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+	mr_handle = handle;
+
+	for (i = 0; i < MR_TEST_STABLE_KEYS; i++) {
+		mr_stable_keys[i] = i;
+		mr_stable_pos[i] = rte_hash_add_key(handle, &mr_stable_keys[i]);
+		RETURN_IF_ERROR(mr_stable_pos[i] < 0,
+			"failed to add stable key %u", i);
+	}
+
+	mr_stop = 0;
+	rte_atomic32_init(&mr_errors);
+	rte_eal_mp_remote_launch(test_multi_reader_lookup, NULL, SKIP_MASTER);
+
+	for (round = 0; round < MR_TEST_ROUNDS; round++) {
+		for (n_churn = 0; n_churn < MR_TEST_ENTRIES; n_churn++) {
+			churn_keys[n_churn] = MR_TEST_STABLE_KEYS +
+				round * MR_TEST_ENTRIES + n_churn;
+			ret = rte_hash_add_key(handle, &churn_keys[n_churn]);
+			if (ret == -ENOSPC)
+				break;
+			if (ret < 0)
+				rte_atomic32_inc(&mr_errors);
+		}
+		for (i = 0; i < n_churn; i++)
+			if (rte_hash_del_key(handle, &churn_keys[i]) < 0)
+				rte_atomic32_inc(&mr_errors);
+		for (i = 0; i < MR_TEST_STABLE_KEYS; i++)
+			if (rte_hash_lookup(handle, &mr_stable_keys[i]) !=
+					mr_stable_pos[i])
+				rte_atomic32_inc(&mr_errors);
+	}
+
+	mr_stop = 1;
+	rte_eal_mp_wait_lcore();
+
+	RETURN_IF_ERROR(rte_atomic32_read(&mr_errors) != 0,
+		"%d lookup errors with a concurrent writer on %u lcores",
+		rte_atomic32_read(&mr_errors), rte_lcore_count());
+
+	rte_hash_free(handle);
+	return 0;
+}
+
 /******************************************************************************/
 static int
 fbk_hash_unit_test(void)
@@ -1037,6 +1372,16 @@ static int test_hash_creation_with_bad_parameters(void)
 		return -1;
 	}
 
+	memcpy(&params, &ut_params, sizeof(params));
+	params.name = "creation_with_bad_parameters_8";
+	params.extra_flag = 0x80;
+	handle = rte_hash_create(&params);
+	if (handle != NULL) {
+		rte_hash_free(handle);
+		printf("Impossible creating hash sucessfully with unknown extra flag\n");
+		return -1;
+	}
+
 	rte_hash_free(handle);
 
 	return 0;
@@ -1351,6 +1696,14 @@ test_hash(void)
 		return -1;
 	if (test_full_bucket() < 0)
 		return -1;
+	if (test_full_bucket_sizes() < 0)
+		return -1;
+	if (test_cuckoo_full_bucket() < 0)
+		return -1;
+	if (test_cuckoo_load_factor() < 0)
+		return -1;
+	if (test_hash_multi_reader() < 0)
+		return -1;
 
 	if (test_fbk_hash_find_existing() < 0)
 		return -1;
@@ -0,0 +1,396 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_mbuf.h>
+#include <rte_ip.h>
+#include <rte_ip_frag.h>
+
+#define NB_MBUF          1023
+#define MBUF_SIZE        (2048 + sizeof(struct rte_mbuf) + RTE_PKTMBUF_HEADROOM)
+#define MEMPOOL_CACHE_SZ 32
+
+#define FRAG_LEN         64 /* multiple of 8 */
+#define MAX_FRAGS        7
+
+#define BUCKET_NUM       64
+#define BUCKET_ENTRIES   4
+#define MAX_ENTRIES      (BUCKET_NUM * BUCKET_ENTRIES)
+
+#define NB_STRIPES       4
+#define NB_DGRAMS        64
+
+static struct rte_mempool *pkt_pool;
+static struct rte_ip_frag_tbl *shared_tbl;
+static rte_atomic32_t nb_reassembled;
+static rte_atomic32_t nb_errors;
+
+/* build fragment idx of nb_frags of an IPv4 datagram */
+static struct rte_mbuf *
+ipv4_frag(uint16_t id, uint32_t idx, uint32_t nb_frags)
+{
+	struct rte_mbuf *m;
+	struct ipv4_hdr *hdr;
+	uint16_t frag_ofs;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+	hdr = (struct ipv4_hdr *)rte_pktmbuf_append(m,
+		sizeof(*hdr) + FRAG_LEN);
+	if (hdr == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->version_ihl = 0x45;
+	hdr->time_to_live = 64;
+	hdr->next_proto_id = IPPROTO_UDP;
+	hdr->total_length = rte_cpu_to_be_16(sizeof(*hdr) + FRAG_LEN);
+	hdr->packet_id = rte_cpu_to_be_16(id);
+	hdr->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+	hdr->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+	frag_ofs = (uint16_t)(idx * FRAG_LEN / IPV4_HDR_OFFSET_UNITS);
+	if (idx != nb_frags - 1)
+		frag_ofs |= IPV4_HDR_MF_FLAG;
+	hdr->fragment_offset = rte_cpu_to_be_16(frag_ofs);
+
+	m->l2_len = 0;
+	m->l3_len = sizeof(*hdr);
+	return m;
+}
+
+/* build fragment idx of nb_frags of an IPv6 datagram */
+static struct rte_mbuf *
+ipv6_frag(uint32_t id, uint32_t idx, uint32_t nb_frags)
+{
+	struct rte_mbuf *m;
+	struct ipv6_hdr *hdr;
+	struct ipv6_extension_fragment *frag_hdr;
+	uint16_t frag_data;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+	hdr = (struct ipv6_hdr *)rte_pktmbuf_append(m,
+		sizeof(*hdr) + sizeof(*frag_hdr) + FRAG_LEN);
+	if (hdr == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(hdr, 0, sizeof(*hdr) + sizeof(*frag_hdr));
+	hdr->vtc_flow = rte_cpu_to_be_32(6 << 28);
+	hdr->payload_len = rte_cpu_to_be_16(sizeof(*frag_hdr) + FRAG_LEN);
+	hdr->proto = IPPROTO_FRAGMENT;
+	hdr->hop_limits = 64;
+	hdr->src_addr[0] = 0xfd;
+	hdr->src_addr[15] = 1;
+	hdr->dst_addr[0] = 0xfd;
+	hdr->dst_addr[15] = 2;
+
+	frag_hdr = rte_ipv6_frag_get_ipv6_fragment_header(hdr);
+	frag_hdr->next_header = IPPROTO_UDP;
+	frag_hdr->id = rte_cpu_to_be_32(id);
+	/* offset in 8 bytes units, followed by the more fragments bit */
+	frag_data = (uint16_t)(idx * FRAG_LEN);
+	if (idx != nb_frags - 1)
+		frag_data |= 1;
+	frag_hdr->frag_data = rte_cpu_to_be_16(frag_data);
+
+	m->l2_len = 0;
+	m->l3_len = sizeof(*hdr) + sizeof(*frag_hdr);
+	return m;
+}
+
+/* give one fragment to the table, return the reassembled datagram if any */
+static struct rte_mbuf *
+reassemble(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
+	int ipv6, uint32_t id, uint32_t idx, uint32_t nb_frags)
+{
+	struct rte_mbuf *m;
+
+	if (ipv6 == 0) {
+		m = ipv4_frag((uint16_t)id, idx, nb_frags);
+		if (m == NULL)
+			return NULL;
+		return rte_ipv4_frag_reassemble_packet(tbl, dr, m, rte_rdtsc(),
+			rte_pktmbuf_mtod(m, struct ipv4_hdr *));
+	}
+
+	m = ipv6_frag(id, idx, nb_frags);
+	if (m == NULL)
+		return NULL;
+	return rte_ipv6_frag_reassemble_packet(tbl, dr, m, rte_rdtsc(),
+		rte_pktmbuf_mtod(m, struct ipv6_hdr *),
+		rte_ipv6_frag_get_ipv6_fragment_header(
+			rte_pktmbuf_mtod(m, struct ipv6_hdr *)));
+}
+
+/*
+ * A table created for MAX_FRAGS fragments reassembles a datagram of
+ * MAX_FRAGS fragments given out of order, and drops a datagram with one
+ * more fragment.
+ */
+static int
+test_ip_frag_max_frags(int ipv6)
+{
+	static const uint32_t order[MAX_FRAGS] = {3, 0, 6, 2, 5, 1, 4};
+	const uint32_t hdr_len = ipv6 ? sizeof(struct ipv6_hdr) :
+		sizeof(struct ipv4_hdr);
+	struct rte_ip_frag_death_row dr;
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_mbuf *m;
+	uint32_t i;
+
+	printf("=== Test IPv%d reassembly of %u fragments ===\n",
+		ipv6 ? 6 : 4, MAX_FRAGS);
+
+	tbl = rte_ip_frag_table_create_ext(BUCKET_NUM, BUCKET_ENTRIES,
+		MAX_ENTRIES, rte_get_tsc_hz(), MAX_FRAGS, 0, SOCKET_ID_ANY);
+	if (tbl == NULL) {
+		printf("Cannot create fragment table\n");
+		return -1;
+	}
+	dr.cnt = 0;
+
+	for (i = 0; i != MAX_FRAGS; i++) {
+		m = reassemble(tbl, &dr, ipv6, 1, order[i], MAX_FRAGS);
+		if (m != NULL)
+			break;
+	}
+	if (i != MAX_FRAGS - 1 || m == NULL) {
+		printf("line %d: Datagram not reassembled\n", __LINE__);
+		goto fail;
+	}
+	if (m->pkt_len != hdr_len + MAX_FRAGS * FRAG_LEN ||
+			m->nb_segs != MAX_FRAGS || dr.cnt != 0) {
+		printf("line %d: Wrong datagram, length %u, %u segments\n",
+			__LINE__, m->pkt_len, m->nb_segs);
+		rte_pktmbuf_free(m);
+		goto fail;
+	}
+	rte_pktmbuf_free(m);
+
+	/* first and last fragments, then the middle ones: the last middle
+	 * fragment does not fit and the whole datagram is dropped */
+	if (reassemble(tbl, &dr, ipv6, 2, 0, MAX_FRAGS + 1) != NULL ||
+			reassemble(tbl, &dr, ipv6, 2, MAX_FRAGS,
+				MAX_FRAGS + 1) != NULL) {
+		printf("line %d: Incomplete datagram reassembled\n", __LINE__);
+		goto fail;
+	}
+	for (i = 1; i != MAX_FRAGS; i++) {
+		if (reassemble(tbl, &dr, ipv6, 2, i, MAX_FRAGS + 1) != NULL) {
+			printf("line %d: Datagram of %u fragments "
+				"reassembled\n", __LINE__, MAX_FRAGS + 1);
+			goto fail;
+		}
+	}
+	if (dr.cnt != MAX_FRAGS + 1 || tbl->use_entries != 0) {
+		printf("line %d: Datagram of %u fragments not dropped, "
+			"%u fragments to free, %u entries in use\n", __LINE__,
+			MAX_FRAGS + 1, dr.cnt, tbl->use_entries);
+		goto fail;
+	}
+
+	rte_ip_frag_free_death_row(&dr, 0);
+	rte_ip_frag_table_destroy(tbl);
+	printf("IPv%d reassembly test passed\n\n", ipv6 ? 6 : 4);
+	return 0;
+
+fail:
+	rte_ip_frag_free_death_row(&dr, 0);
+	rte_ip_frag_table_destroy(tbl);
+	return -1;
+}
+
+/* each lcore gives its share of the fragments of every datagram */
+static int
+shared_tbl_worker(__attribute__((unused)) void *arg)
+{
+	const uint32_t nb_lcores = rte_lcore_count();
+	const uint32_t idx = rte_lcore_index(rte_lcore_id());
+	struct rte_ip_frag_death_row dr;
+	struct rte_mbuf *m;
+	uint32_t id, k;
+
+	dr.cnt = 0;
+	for (id = 1; id <= NB_DGRAMS; id++) {
+		for (k = idx; k < MAX_FRAGS; k += nb_lcores) {
+			m = reassemble(shared_tbl, &dr, id & 1, id,
+				MAX_FRAGS - 1 - k, MAX_FRAGS);
+			if (m != NULL) {
+				rte_atomic32_inc(&nb_reassembled);
+				if (m->nb_segs != MAX_FRAGS)
+					rte_atomic32_inc(&nb_errors);
+				rte_pktmbuf_free(m);
+			}
+		}
+		if (dr.cnt != 0) {
+			rte_atomic32_add(&nb_errors, dr.cnt);
+			rte_ip_frag_free_death_row(&dr, 0);
+		}
+	}
+	return 0;
+}
+
+/* read a counter of the statistics dump */
+static int
+read_stat(FILE *f, const char *name, uint64_t *val)
+{
+	char line[128];
+	size_t len = strlen(name);
+
+	rewind(f);
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (strncmp(line, name, len) == 0 && line[len] == ':')
+			return (sscanf(line + len + 1, "%" SCNu64, val) == 1) ?
+				0 : -1;
+	}
+	return -1;
+}
+
+/*
+ * All lcores reassemble datagrams through one shared table, the fragments
+ * of each datagram being spread over the lcores. The statistics dump sums
+ * the counters of all sub-tables.
+ */
+static int
+test_ip_frag_shared(void)
+{
+	uint64_t max_entries, use_entries;
+	FILE *f;
+
+	printf("=== Test shared table on %u lcores ===\n", rte_lcore_count());
+
+	shared_tbl = rte_ip_frag_table_create_ext(BUCKET_NUM, BUCKET_ENTRIES,
+		MAX_ENTRIES, rte_get_tsc_hz() * 10, MAX_FRAGS, NB_STRIPES,
+		SOCKET_ID_ANY);
+	if (shared_tbl == NULL) {
+		printf("Cannot create shared fragment table\n");
+		return -1;
+	}
+	rte_atomic32_init(&nb_reassembled);
+	rte_atomic32_init(&nb_errors);
+
+	rte_eal_mp_remote_launch(shared_tbl_worker, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+
+	if (rte_atomic32_read(&nb_reassembled) != NB_DGRAMS ||
+			rte_atomic32_read(&nb_errors) != 0) {
+		printf("line %d: %d datagrams reassembled, %d errors\n",
+			__LINE__, rte_atomic32_read(&nb_reassembled),
+			rte_atomic32_read(&nb_errors));
+		goto fail;
+	}
+
+	f = tmpfile();
+	if (f == NULL) {
+		printf("Cannot create statistics file\n");
+		goto fail;
+	}
+	rte_ip_frag_table_statistics_dump(f, shared_tbl);
+	rte_ip_frag_table_statistics_dump(stdout, shared_tbl);
+	if (read_stat(f, "max entries", &max_entries) != 0 ||
+			read_stat(f, "entries in use", &use_entries) != 0 ||
+			max_entries != MAX_ENTRIES || use_entries != 0) {
+		printf("line %d: Wrong statistics totals\n", __LINE__);
+		fclose(f);
+		goto fail;
+	}
+#ifdef RTE_LIBRTE_IP_FRAG_TBL_STAT
+	{
+		uint64_t finds, adds, fails;
+
+		if (read_stat(f, "finds/inserts", &finds) != 0 ||
+				read_stat(f, "entries added", &adds) != 0 ||
+				read_stat(f, "total add failures", &fails) != 0 ||
+				finds != NB_DGRAMS * MAX_FRAGS ||
+				adds != NB_DGRAMS || fails != 0) {
+			printf("line %d: Wrong statistics totals\n", __LINE__);
+			fclose(f);
+			goto fail;
+		}
+	}
+#endif
+	fclose(f);
+
+	rte_ip_frag_table_destroy(shared_tbl);
+	printf("Shared table test passed\n\n");
+	return 0;
+
+fail:
+	rte_ip_frag_table_destroy(shared_tbl);
+	return -1;
+}
+
+static int
+test_ip_frag(void)
+{
+	if (pkt_pool == NULL) {
+		pkt_pool = rte_mempool_create("test_ip_frag", NB_MBUF,
+			MBUF_SIZE, MEMPOOL_CACHE_SZ,
+			sizeof(struct rte_pktmbuf_pool_private),
+			rte_pktmbuf_pool_init, NULL,
+			rte_pktmbuf_init, NULL,
+			SOCKET_ID_ANY, 0);
+		if (pkt_pool == NULL) {
+			printf("Cannot create mbuf pool\n");
+			return -1;
+		}
+	}
+
+	if (test_ip_frag_max_frags(0) < 0)
+		return -1;
+	if (test_ip_frag_max_frags(1) < 0)
+		return -1;
+	if (test_ip_frag_shared() < 0)
+		return -1;
+
+	return 0;
+}
+
+static struct test_command ip_frag_cmd = {
+	.command = "ip_frag_autotest",
+	.callback = test_ip_frag,
+};
+REGISTER_TEST_COMMAND(ip_frag_cmd);
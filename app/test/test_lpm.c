@@ -43,6 +43,9 @@
 #include <rte_random.h>
 #include <rte_branch_prediction.h>
 #include <rte_ip.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
 #include <time.h>
 
 #include "test.h"
@@ -77,6 +80,11 @@ static int32_t test14(void);
 static int32_t test15(void);
 static int32_t test16(void);
 static int32_t test17(void);
+static int32_t test18(void);
+static int32_t test19(void);
+static int32_t test20(void);
+static int32_t test21(void);
+static int32_t test22(void);
 static int32_t perf_test(void);
 
 rte_lpm_test tests[] = {
@@ -99,6 +107,11 @@ rte_lpm_test tests[] = {
 	test15,
 	test16,
 	test17,
+	test18,
+	test19,
+	test20,
+	test21,
+	test22,
 	perf_test,
 };
 
@@ -181,7 +194,8 @@ test3(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 24, next_hop = 100;
+	uint32_t next_hop = 100;
+	uint8_t depth = 24;
 	int32_t status = 0;
 
 	/* rte_lpm_add: lpm == NULL */
@@ -248,7 +262,7 @@ test5(void)
 #if defined(RTE_LIBRTE_LPM_DEBUG)
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t next_hop_return = 0;
+	uint32_t next_hop_return = 0;
 	int32_t status = 0;
 
 	/* rte_lpm_lookup: lpm == NULL */
@@ -278,7 +292,8 @@ test6(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 24, next_hop_add = 100, next_hop_return = 0;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 24;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -309,10 +324,11 @@ int32_t
 test7(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 32, next_hop_add = 100, next_hop_return = 0;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 32;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -325,10 +341,10 @@ test7(void)
 	TEST_LPM_ASSERT((status == 0) && (next_hop_return == next_hop_add));
 
 	ipx4 = _mm_set_epi32(ip, ip + 0x100, ip - 0x100, ip);
-	rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
+	rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
 	TEST_LPM_ASSERT(hop[0] == next_hop_add);
-	TEST_LPM_ASSERT(hop[1] == UINT16_MAX);
-	TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
+	TEST_LPM_ASSERT(hop[1] == UINT32_MAX);
+	TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
 	TEST_LPM_ASSERT(hop[3] == next_hop_add);
 
 	status = rte_lpm_delete(lpm, ip, depth);
@@ -355,10 +371,11 @@ int32_t
 test8(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip1 = IPv4(127, 255, 255, 255), ip2 = IPv4(128, 0, 0, 0);
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -381,10 +398,10 @@ test8(void)
 			(next_hop_return == next_hop_add));
 
 		ipx4 = _mm_set_epi32(ip2, ip1, ip2, ip1);
-		rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
-		TEST_LPM_ASSERT(hop[0] == UINT16_MAX);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+		TEST_LPM_ASSERT(hop[0] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[1] == next_hop_add);
-		TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
+		TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[3] == next_hop_add);
 	}
 
@@ -409,16 +426,16 @@ test8(void)
 		TEST_LPM_ASSERT(status == -ENOENT);
 
 		ipx4 = _mm_set_epi32(ip1, ip1, ip2, ip2);
-		rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
 		if (depth != 1) {
 			TEST_LPM_ASSERT(hop[0] == next_hop_add);
 			TEST_LPM_ASSERT(hop[1] == next_hop_add);
 		} else {
-			TEST_LPM_ASSERT(hop[0] == UINT16_MAX);
-			TEST_LPM_ASSERT(hop[1] == UINT16_MAX);
+			TEST_LPM_ASSERT(hop[0] == UINT32_MAX);
+			TEST_LPM_ASSERT(hop[1] == UINT32_MAX);
 		}
-		TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
-		TEST_LPM_ASSERT(hop[3] == UINT16_MAX);
+		TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
+		TEST_LPM_ASSERT(hop[3] == UINT32_MAX);
 	}
 
 	rte_lpm_free(lpm);
@@ -438,8 +455,8 @@ test9(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip, ip_1, ip_2;
-	uint8_t depth, depth_1, depth_2, next_hop_add, next_hop_add_1,
-		next_hop_add_2, next_hop_return;
+	uint32_t next_hop_add, next_hop_add_1, next_hop_add_2, next_hop_return;
+	uint8_t depth, depth_1, depth_2;
 	int32_t status = 0;
 
 	/* Add & lookup to hit invalid TBL24 entry */
@@ -602,7 +619,8 @@ test10(void)
 
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
 	/* Add rule that covers a TBL24 range previously invalid & lookup
@@ -788,7 +806,8 @@ test11(void)
 
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -851,10 +870,11 @@ int32_t
 test12(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip, i;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -873,10 +893,10 @@ test12(void)
 				(next_hop_return == next_hop_add));
 
 		ipx4 = _mm_set_epi32(ip, ip + 1, ip, ip - 1);
-		rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
-		TEST_LPM_ASSERT(hop[0] == UINT16_MAX);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+		TEST_LPM_ASSERT(hop[0] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[1] == next_hop_add);
-		TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
+		TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[3] == next_hop_add);
 
 		status = rte_lpm_delete(lpm, ip, depth);
@@ -904,7 +924,8 @@ test13(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip, i;
-	uint8_t depth, next_hop_add_1, next_hop_add_2, next_hop_return;
+	uint32_t next_hop_add_1, next_hop_add_2, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -966,7 +987,8 @@ test14(void)
 
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
 	/* Add enough space for 256 rules for every depth */
@@ -1078,10 +1100,10 @@ test17(void)
 	const uint8_t d_ip_10_32 = 32,
 			d_ip_10_24 = 24,
 			d_ip_20_25 = 25;
-	const uint8_t next_hop_ip_10_32 = 100,
+	const uint32_t next_hop_ip_10_32 = 100,
 			next_hop_ip_10_24 = 105,
 			next_hop_ip_20_25 = 111;
-	uint8_t next_hop_return = 0;
+	uint32_t next_hop_return = 0;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -1092,7 +1114,7 @@ test17(void)
 		return -1;
 
 	status = rte_lpm_lookup(lpm, ip_10_32, &next_hop_return);
-	uint8_t test_hop_10_32 = next_hop_return;
+	uint32_t test_hop_10_32 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_10_32);
 
@@ -1101,7 +1123,7 @@ test17(void)
 			return -1;
 
 	status = rte_lpm_lookup(lpm, ip_10_24, &next_hop_return);
-	uint8_t test_hop_10_24 = next_hop_return;
+	uint32_t test_hop_10_24 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_10_24);
 
@@ -1110,7 +1132,7 @@ test17(void)
 		return -1;
 
 	status = rte_lpm_lookup(lpm, ip_20_25, &next_hop_return);
-	uint8_t test_hop_20_25 = next_hop_return;
+	uint32_t test_hop_20_25 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_20_25);
 
@@ -1137,6 +1159,515 @@ test17(void)
 	return PASS;
 }
 
+#define TEST18_NUM_TBL8S (RTE_LPM_TBL8_NUM_GROUPS * 4)
+
+/*
+ * Test a table created with a configured tbl8 size and 24-bit next hops:
+ *  - invalid configurations are rejected
+ *  - more than RTE_LPM_TBL8_NUM_GROUPS /32 rules with distinct /24 prefixes
+ *    and next hops above 255 can be added, then looked up with all the
+ *    lookup functions
+ *  - adding fails once the configured number of tbl8 groups is used up
+ */
+int32_t
+test18(void)
+{
+	struct rte_lpm_config config = {
+		.max_rules = TEST18_NUM_TBL8S * 2,
+		.number_tbl8s = 0,
+		.flags = 0,
+	};
+	struct rte_lpm *lpm = NULL;
+	uint32_t ip, next_hop_add, next_hop_return, i;
+	uint32_t ips[4], next_hops[4], hop[4];
+	__m128i ipx4;
+	int32_t status;
+
+	/* number_tbl8s == 0 and too large are invalid */
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm == NULL);
+	config.number_tbl8s = RTE_LPM_MAX_TBL8_NUM_GROUPS + 1;
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm == NULL);
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, NULL);
+	TEST_LPM_ASSERT(lpm == NULL);
+
+	config.number_tbl8s = TEST18_NUM_TBL8S;
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	/* next hop wider than 24 bits */
+	status = rte_lpm_add(lpm, IPv4(10, 0, 0, 0), 8,
+			RTE_LPM_MAX_NEXT_HOP + 1);
+	TEST_LPM_ASSERT(status < 0);
+
+	/* every rule needs its own tbl8 group */
+	for (i = 0; i < TEST18_NUM_TBL8S; i++) {
+		ip = IPv4(10, 0, 0, 1) + (i << 8);
+		next_hop_add = RTE_LPM_MAX_NEXT_HOP - i;
+		status = rte_lpm_add(lpm, ip, 32, next_hop_add);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	/* all tbl8 groups are in use */
+	ip = IPv4(10, 0, 0, 1) + (TEST18_NUM_TBL8S << 8);
+	status = rte_lpm_add(lpm, ip, 32, 1);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+
+	for (i = 0; i < TEST18_NUM_TBL8S; i++) {
+		ip = IPv4(10, 0, 0, 1) + (i << 8);
+		next_hop_add = RTE_LPM_MAX_NEXT_HOP - i;
+
+		status = rte_lpm_lookup(lpm, ip, &next_hop_return);
+		TEST_LPM_ASSERT((status == 0) &&
+				(next_hop_return == next_hop_add));
+
+		status = rte_lpm_lookup(lpm, ip + 1, &next_hop_return);
+		TEST_LPM_ASSERT(status == -ENOENT);
+
+		status = rte_lpm_is_rule_present(lpm, ip, 32,
+				&next_hop_return);
+		TEST_LPM_ASSERT((status == 1) &&
+				(next_hop_return == next_hop_add));
+
+		ips[0] = ip;
+		ips[1] = ip + 1;
+		ips[2] = IPv4(192, 168, 0, 1);
+		ips[3] = ip;
+		rte_lpm_lookup_bulk(lpm, ips, next_hops, 4);
+		TEST_LPM_ASSERT((next_hops[0] & RTE_LPM_LOOKUP_SUCCESS) &&
+				(next_hops[0] & RTE_LPM_NEXT_HOP_MASK) ==
+				next_hop_add);
+		TEST_LPM_ASSERT(!(next_hops[1] & RTE_LPM_LOOKUP_SUCCESS));
+		TEST_LPM_ASSERT(!(next_hops[2] & RTE_LPM_LOOKUP_SUCCESS));
+		TEST_LPM_ASSERT((next_hops[3] & RTE_LPM_LOOKUP_SUCCESS) &&
+				(next_hops[3] & RTE_LPM_NEXT_HOP_MASK) ==
+				next_hop_add);
+
+		ipx4 = _mm_set_epi32(ips[3], ips[2], ips[1], ips[0]);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+		TEST_LPM_ASSERT(hop[0] == next_hop_add);
+		TEST_LPM_ASSERT(hop[1] == UINT32_MAX);
+		TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
+		TEST_LPM_ASSERT(hop[3] == next_hop_add);
+	}
+
+	/* a tbl24 only rule with a wide next hop uses the lookupx4 fast path */
+	status = rte_lpm_add(lpm, IPv4(192, 168, 0, 0), 16,
+			RTE_LPM_MAX_NEXT_HOP);
+	TEST_LPM_ASSERT(status == 0);
+	ipx4 = _mm_set_epi32(IPv4(192, 168, 1, 1), IPv4(192, 168, 2, 1),
+			IPv4(192, 168, 3, 1), IPv4(192, 168, 4, 1));
+	rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+	for (i = 0; i < RTE_DIM(hop); i++)
+		TEST_LPM_ASSERT(hop[i] == RTE_LPM_MAX_NEXT_HOP);
+
+	/* freeing a group makes room for one more rule */
+	status = rte_lpm_delete(lpm, IPv4(10, 0, 0, 1), 32);
+	TEST_LPM_ASSERT(status == 0);
+	ip = IPv4(10, 0, 0, 1) + (TEST18_NUM_TBL8S << 8);
+	status = rte_lpm_add(lpm, ip, 32, 1);
+	TEST_LPM_ASSERT(status == 0);
+
+	rte_lpm_delete_all(lpm);
+	status = rte_lpm_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	rte_lpm_free(lpm);
+
+	return PASS;
+}
+
+/*
+ * Test deferred tbl8 reclaim:
+ *  - with RTE_LPM_F_TBL8_DEFER_FREE, a freed tbl8 group stays allocated
+ *    and keeps its last content until rte_lpm_tbl8_reclaim() is called
+ *  - only groups freed before rte_lpm_tbl8_gp_start() are reclaimed
+ *  - rte_lpm_delete_all() defers the groups in use as well
+ */
+int32_t
+test19(void)
+{
+	struct rte_lpm_config config = {
+		.max_rules = MAX_RULES,
+		.number_tbl8s = 2,
+		.flags = RTE_LPM_F_TBL8_DEFER_FREE,
+	};
+	struct rte_lpm *lpm = NULL;
+	const uint32_t ip_a = IPv4(10, 0, 1, 1);
+	const uint32_t ip_b = IPv4(10, 0, 2, 1);
+	const uint32_t ip_c = IPv4(10, 0, 3, 1);
+	uint32_t group_a, next_hop_return, token;
+	int32_t status;
+
+	/* reclaim on a table freeing groups immediately */
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	TEST_LPM_ASSERT(lpm != NULL);
+	TEST_LPM_ASSERT(rte_lpm_tbl8_reclaim(lpm, 0) == -EINVAL);
+	rte_lpm_free(lpm);
+
+	/* unknown flag */
+	config.flags = 0x80;
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm == NULL);
+
+	config.flags = RTE_LPM_F_TBL8_DEFER_FREE;
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	status = rte_lpm_add(lpm, ip_a, 24, 50);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_add(lpm, ip_a, 32, 100);
+	TEST_LPM_ASSERT(status == 0);
+	group_a = lpm->tbl24[ip_a >> 8].next_hop;
+
+	/* the group is now uniformly /24 and collapses into tbl24 */
+	status = rte_lpm_delete(lpm, ip_a, 32);
+	TEST_LPM_ASSERT(status == 0);
+	TEST_LPM_ASSERT(lpm->tbl24[ip_a >> 8].ext_entry == 0);
+	status = rte_lpm_lookup(lpm, ip_a, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 50));
+
+	/* a reader holding the old tbl24 entry still finds the /24 rule */
+	TEST_LPM_ASSERT(lpm->tbl8[group_a * RTE_LPM_TBL8_GROUP_NUM_ENTRIES +
+			(ip_a & 0xFF)].valid);
+	TEST_LPM_ASSERT(lpm->tbl8[group_a * RTE_LPM_TBL8_GROUP_NUM_ENTRIES +
+			(ip_a & 0xFF)].next_hop == 50);
+
+	/* the group of ip_a is not reused */
+	status = rte_lpm_add(lpm, ip_b, 32, 101);
+	TEST_LPM_ASSERT(status == 0);
+	TEST_LPM_ASSERT(lpm->tbl24[ip_b >> 8].next_hop != group_a);
+	status = rte_lpm_add(lpm, ip_c, 32, 102);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+
+	token = rte_lpm_tbl8_gp_start(lpm);
+
+	/* freed after the grace period started, not reclaimed */
+	status = rte_lpm_delete(lpm, ip_b, 32);
+	TEST_LPM_ASSERT(status == 0);
+
+	TEST_LPM_ASSERT(rte_lpm_tbl8_reclaim(lpm, token) == 1);
+	TEST_LPM_ASSERT(rte_lpm_tbl8_reclaim(lpm, token) == 0);
+
+	status = rte_lpm_add(lpm, ip_c, 32, 102);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_lookup(lpm, ip_c, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 102));
+	status = rte_lpm_add(lpm, ip_a, 32, 100);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+
+	/* both groups are freed, ip_b first */
+	rte_lpm_delete_all(lpm);
+	status = rte_lpm_lookup(lpm, ip_c, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+	status = rte_lpm_add(lpm, ip_a, 32, 100);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+
+	token = rte_lpm_tbl8_gp_start(lpm);
+	TEST_LPM_ASSERT(rte_lpm_tbl8_reclaim(lpm, token) == 2);
+
+	status = rte_lpm_add(lpm, ip_a, 32, 100);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_add(lpm, ip_b, 32, 101);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_lookup(lpm, ip_a, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 100));
+	status = rte_lpm_lookup(lpm, ip_b, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 101));
+
+	rte_lpm_free(lpm);
+
+	return PASS;
+}
+
+#define TEST20_NUM_RULES 1024
+
+/*
+ * Test rte_lpm_add_bulk() against rte_lpm_add():
+ *  - rules of all depths, in random order, with duplicated prefixes and a
+ *    few invalid rules, give the same table as adding them one by one
+ *  - rules that do not fit are skipped
+ */
+int32_t
+test20(void)
+{
+	static uint32_t ips[TEST20_NUM_RULES], next_hops[TEST20_NUM_RULES];
+	static uint8_t depths[TEST20_NUM_RULES];
+	struct rte_lpm *lpm_bulk = NULL, *lpm_single = NULL;
+	uint32_t i, n_valid, ip, next_hop_bulk, next_hop_single;
+	int status, status_single;
+
+	lpm_bulk = rte_lpm_create("lpm_bulk", SOCKET_ID_ANY,
+			TEST20_NUM_RULES, 0);
+	TEST_LPM_ASSERT(lpm_bulk != NULL);
+	lpm_single = rte_lpm_create("lpm_single", SOCKET_ID_ANY,
+			TEST20_NUM_RULES, 0);
+	TEST_LPM_ASSERT(lpm_single != NULL);
+
+	TEST_LPM_ASSERT(rte_lpm_add_bulk(NULL, ips, depths, next_hops, 1) ==
+			-EINVAL);
+	TEST_LPM_ASSERT(rte_lpm_add_bulk(lpm_bulk, ips, depths, next_hops, 0) ==
+			0);
+
+	/* Keep rules under 10.0.0.0/16 so that they overlap. */
+	n_valid = 0;
+	for (i = 0; i < TEST20_NUM_RULES; i++) {
+		if (i % 8 == 7) {
+			/* duplicate of an earlier prefix */
+			ips[i] = ips[i / 2];
+			depths[i] = depths[i / 2];
+		} else {
+			ips[i] = IPv4(10, 0, 0, 0) | (rte_rand() & 0xFFFF);
+			depths[i] = 16 + rte_rand() % 17;
+		}
+		next_hops[i] = rte_rand() & RTE_LPM_MAX_NEXT_HOP;
+		if (i % 100 == 99)
+			depths[i] = 0;
+		if (i % 100 == 98)
+			next_hops[i] = RTE_LPM_MAX_NEXT_HOP + 1;
+		if (depths[i] != 0 && next_hops[i] <= RTE_LPM_MAX_NEXT_HOP)
+			n_valid++;
+	}
+
+	/* rte_lpm_add() applies rules of one depth in array order too */
+	status = 0;
+	for (i = 0; i < TEST20_NUM_RULES; i++)
+		if (rte_lpm_add(lpm_single, ips[i], depths[i],
+				next_hops[i]) == 0)
+			status++;
+	TEST_LPM_ASSERT(status == (int)n_valid);
+
+	status = rte_lpm_add_bulk(lpm_bulk, ips, depths, next_hops,
+			TEST20_NUM_RULES);
+	TEST_LPM_ASSERT(status == (int)n_valid);
+
+	for (ip = IPv4(10, 0, 0, 0); ip <= IPv4(10, 0, 255, 255); ip++) {
+		status = rte_lpm_lookup(lpm_bulk, ip, &next_hop_bulk);
+		status_single = rte_lpm_lookup(lpm_single, ip,
+				&next_hop_single);
+		TEST_LPM_ASSERT(status == status_single);
+		TEST_LPM_ASSERT(status != 0 ||
+				next_hop_bulk == next_hop_single);
+	}
+	for (i = 0; i < TEST20_NUM_RULES; i++) {
+		if (depths[i] == 0)
+			continue;
+		status = rte_lpm_is_rule_present(lpm_bulk, ips[i], depths[i],
+				&next_hop_bulk);
+		status_single = rte_lpm_is_rule_present(lpm_single, ips[i],
+				depths[i], &next_hop_single);
+		TEST_LPM_ASSERT(status == status_single);
+		TEST_LPM_ASSERT(status != 1 ||
+				next_hop_bulk == next_hop_single);
+	}
+
+	rte_lpm_free(lpm_bulk);
+
+	/* only 4 rules fit, the duplicate updates the first one */
+	lpm_bulk = rte_lpm_create("lpm_bulk", SOCKET_ID_ANY, 4, 0);
+	TEST_LPM_ASSERT(lpm_bulk != NULL);
+	for (i = 0; i < 8; i++) {
+		ips[i] = IPv4(10, 0, i, 0);
+		depths[i] = 24;
+		next_hops[i] = i;
+	}
+	ips[4] = ips[0];
+	status = rte_lpm_add_bulk(lpm_bulk, ips, depths, next_hops, 8);
+	TEST_LPM_ASSERT(status == 5);
+	status = rte_lpm_lookup(lpm_bulk, IPv4(10, 0, 0, 1), &next_hop_bulk);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_bulk == 4));
+	status = rte_lpm_lookup(lpm_bulk, IPv4(10, 0, 5, 1), &next_hop_bulk);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	rte_lpm_free(lpm_bulk);
+	rte_lpm_free(lpm_single);
+
+	return PASS;
+}
+
+/*
+ * Route churn with concurrent lookups: the slave lcores look up addresses
+ * under a stable 10.0.0.0/8 route, while the master repeatedly adds and
+ * deletes more specific /24 and /32 routes for them, with few enough tbl8
+ * groups that they are recycled every round. Every lookup must hit, with the
+ * next hop of one of the routes covering the address. With a single lcore,
+ * the master checks the addresses between rounds only.
+ */
+#define CHURN_NUM_IPS		96
+#define CHURN_ROUNDS		256
+#define CHURN_HOP_8		1
+#define CHURN_HOP_24(ip)	(0x200000 | (((ip) >> 8) & 0xFF))
+#define CHURN_HOP_32(ip)	(0x100000 | ((ip) & 0xFFFF))
+
+static struct rte_lpm *churn_lpm;
+static uint32_t churn_ips[CHURN_NUM_IPS];
+static volatile int churn_stop;
+static volatile uint32_t churn_passes[RTE_MAX_LCORE];
+static rte_atomic32_t churn_errors;
+
+static inline int
+churn_hop_ok(uint32_t ip, uint32_t hop)
+{
+	return hop == CHURN_HOP_8 || hop == CHURN_HOP_24(ip) ||
+		hop == CHURN_HOP_32(ip);
+}
+
+static int
+test_churn_lookup(__attribute__((unused)) void *arg)
+{
+	uint32_t next_hops[4], next_hop;
+	unsigned i, j;
+
+	while (!churn_stop) {
+		for (i = 0; i < CHURN_NUM_IPS; i++) {
+			if (rte_lpm_lookup(churn_lpm, churn_ips[i],
+					&next_hop) != 0 ||
+					!churn_hop_ok(churn_ips[i], next_hop))
+				rte_atomic32_inc(&churn_errors);
+		}
+		for (i = 0; i < CHURN_NUM_IPS; i += RTE_DIM(next_hops)) {
+			rte_lpm_lookup_bulk(churn_lpm, &churn_ips[i], next_hops,
+					RTE_DIM(next_hops));
+			for (j = 0; j < RTE_DIM(next_hops); j++)
+				if (!(next_hops[j] & RTE_LPM_LOOKUP_SUCCESS) ||
+						!churn_hop_ok(churn_ips[i + j],
+						next_hops[j] &
+						RTE_LPM_NEXT_HOP_MASK))
+					rte_atomic32_inc(&churn_errors);
+		}
+		/* Quiescent state: no lookup in progress. */
+		churn_passes[rte_lcore_id()]++;
+	}
+
+	return 0;
+}
+
+/* Wait until every slave lcore went through a quiescent state. */
+static void
+churn_wait_grace_period(void)
+{
+	static uint32_t passes[RTE_MAX_LCORE];
+	unsigned lcore_id;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		passes[lcore_id] = churn_passes[lcore_id];
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		while (churn_passes[lcore_id] == passes[lcore_id])
+			rte_pause();
+}
+
+int32_t
+test21(void)
+{
+	struct rte_lpm_config config = {
+		.max_rules = CHURN_NUM_IPS * 2 + 1,
+		.number_tbl8s = CHURN_NUM_IPS / 3,
+		.flags = RTE_LPM_F_TBL8_DEFER_FREE,
+	};
+	static uint32_t ips[CHURN_NUM_IPS], next_hops[CHURN_NUM_IPS];
+	static uint8_t depths[CHURN_NUM_IPS];
+	uint32_t next_hop, token;
+	unsigned i, round;
+	int32_t status;
+
+	churn_lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(churn_lpm != NULL);
+
+	/* 3 addresses in each of 32 /24 prefixes. */
+	for (i = 0; i < CHURN_NUM_IPS; i++)
+		churn_ips[i] = IPv4(10, 1, i / 3, 1 + (i % 3) * 100);
+
+	status = rte_lpm_add(churn_lpm, IPv4(10, 0, 0, 0), 8, CHURN_HOP_8);
+	TEST_LPM_ASSERT(status == 0);
+
+	churn_stop = 0;
+	rte_atomic32_init(&churn_errors);
+	rte_eal_mp_remote_launch(test_churn_lookup, NULL, SKIP_MASTER);
+
+	for (round = 0; round < CHURN_ROUNDS; round++) {
+		/* /32 routes, each /24 prefix takes a tbl8 group. */
+		for (i = 0; i < CHURN_NUM_IPS; i++) {
+			ips[i] = churn_ips[i];
+			depths[i] = 32;
+			next_hops[i] = CHURN_HOP_32(churn_ips[i]);
+		}
+		status = rte_lpm_add_bulk(churn_lpm, ips, depths, next_hops,
+				CHURN_NUM_IPS);
+		if (status != CHURN_NUM_IPS)
+			rte_atomic32_inc(&churn_errors);
+
+		/* /24 routes under them, then the /32 routes go away. */
+		for (i = 0; i < CHURN_NUM_IPS; i += 3)
+			if (rte_lpm_add(churn_lpm, churn_ips[i], 24,
+					CHURN_HOP_24(churn_ips[i])) != 0)
+				rte_atomic32_inc(&churn_errors);
+		for (i = 0; i < CHURN_NUM_IPS; i++)
+			if (rte_lpm_delete(churn_lpm, churn_ips[i], 32) != 0)
+				rte_atomic32_inc(&churn_errors);
+		for (i = 0; i < CHURN_NUM_IPS; i += 3)
+			if (rte_lpm_delete(churn_lpm, churn_ips[i], 24) != 0)
+				rte_atomic32_inc(&churn_errors);
+
+		for (i = 0; i < CHURN_NUM_IPS; i++) {
+			if (rte_lpm_lookup(churn_lpm, churn_ips[i],
+					&next_hop) != 0 ||
+					next_hop != CHURN_HOP_8)
+				rte_atomic32_inc(&churn_errors);
+		}
+
+		/* All groups were freed, reclaim them for the next round. */
+		token = rte_lpm_tbl8_gp_start(churn_lpm);
+		churn_wait_grace_period();
+		if (rte_lpm_tbl8_reclaim(churn_lpm, token) !=
+				(int)config.number_tbl8s)
+			rte_atomic32_inc(&churn_errors);
+	}
+
+	churn_stop = 1;
+	rte_eal_mp_wait_lcore();
+
+	if (rte_atomic32_read(&churn_errors) != 0) {
+		printf("%d lookup errors with a concurrent writer on %u lcores\n",
+				rte_atomic32_read(&churn_errors),
+				rte_lcore_count());
+		return -1;
+	}
+
+	rte_lpm_free(churn_lpm);
+
+	return PASS;
+}
+
+/*
+ * Test that the deprecated RTE_LPM_MEMZONE value passed to rte_lpm_create()
+ * does not turn on deferred tbl8 freeing: adding and deleting a /32 more
+ * times than there are tbl8 groups never runs out of groups.
+ */
+int32_t
+test22(void)
+{
+	struct rte_lpm *lpm = NULL;
+	uint32_t ip, i;
+	int32_t status;
+
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES,
+			RTE_LPM_MEMZONE);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	for (i = 0; i < 2 * RTE_LPM_TBL8_NUM_GROUPS; i++) {
+		ip = IPv4(10, (i >> 8) & 0xFF, i & 0xFF, 1);
+		status = rte_lpm_add(lpm, ip, 32, 100);
+		TEST_LPM_ASSERT(status == 0);
+		status = rte_lpm_delete(lpm, ip, 32);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	rte_lpm_free(lpm);
+
+	return PASS;
+}
+
 /*
  * Lookup performance test
  */
@@ -1175,7 +1706,7 @@ perf_test(void)
 	struct rte_lpm *lpm = NULL;
 	uint64_t begin, total_time, lpm_used_entries = 0;
 	unsigned i, j;
-	uint8_t next_hop_add = 0xAA, next_hop_return = 0;
+	uint32_t next_hop_add = 0xAA, next_hop_return = 0;
 	int status = 0;
 	uint64_t cache_line_counter = 0;
 	int64_t count = 0;
@@ -1252,7 +1783,7 @@ perf_test(void)
 	count = 0;
 	for (i = 0; i < ITERATIONS; i ++) {
 		static uint32_t ip_batch[BATCH_SIZE];
-		uint16_t next_hops[BULK_SIZE];
+		uint32_t next_hops[BULK_SIZE];
 
 		/* Create array of random IP addresses */
 		for (j = 0; j < BATCH_SIZE; j ++)
@@ -1279,7 +1810,7 @@ perf_test(void)
 	count = 0;
 	for (i = 0; i < ITERATIONS; i++) {
 		static uint32_t ip_batch[BATCH_SIZE];
-		uint16_t next_hops[4];
+		uint32_t next_hops[4];
 
 		/* Create array of random IP addresses */
 		for (j = 0; j < BATCH_SIZE; j++)
@@ -1293,9 +1824,9 @@ perf_test(void)
 
 			ipx4 = _mm_loadu_si128((__m128i *)(ip_batch + j));
 			ipx4 = *(__m128i *)(ip_batch + j);
-			rte_lpm_lookupx4(lpm, ipx4, next_hops, UINT16_MAX);
+			rte_lpm_lookupx4(lpm, ipx4, next_hops, UINT32_MAX);
 			for (k = 0; k < RTE_DIM(next_hops); k++)
-				if (unlikely(next_hops[k] == UINT16_MAX))
+				if (unlikely(next_hops[k] == UINT32_MAX))
 					count++;
 		}
 
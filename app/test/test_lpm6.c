@@ -88,6 +88,7 @@ static int32_t test24(void);
 static int32_t test25(void);
 static int32_t test26(void);
 static int32_t test27(void);
+static int32_t test28(void);
 static int32_t perf_test(void);
 
 rte_lpm6_test tests6[] = {
@@ -120,6 +121,7 @@ rte_lpm6_test tests6[] = {
 	test25,
 	test26,
 	test27,
+	test28,
 	perf_test,
 };
 
@@ -1761,6 +1763,71 @@ test27(void)
 		return PASS;
 }
 
+#define TEST28_NUM_RULES 1000
+#define TEST28_NUM_IPS 1001
+
+/*
+ * Add random rules of all depths sharing their first bytes, so that lookups
+ * go down many levels, and check that rte_lpm6_lookup_bulk_func() agrees
+ * with rte_lpm6_lookup() for addresses hitting the rules, their neighbours
+ * and misses. The number of addresses is not a multiple of the lookup burst.
+ */
+int32_t
+test28(void)
+{
+	static uint8_t ip_batch[TEST28_NUM_IPS][RTE_LPM6_IPV6_ADDR_SIZE];
+	static int16_t next_hops[TEST28_NUM_IPS];
+	struct rte_lpm6 *lpm = NULL;
+	struct rte_lpm6_config config;
+	uint8_t ip[RTE_LPM6_IPV6_ADDR_SIZE];
+	uint8_t depth, next_hop_return;
+	int32_t status = 0;
+	unsigned i, j;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	rte_srand(rte_rdtsc());
+
+	for (i = 0; i < TEST28_NUM_RULES; i++) {
+		ip[0] = 0x20;
+		ip[1] = 0x01;
+		for (j = 2; j < RTE_LPM6_IPV6_ADDR_SIZE; j++)
+			ip[j] = (uint8_t)(rte_rand() & 0x3);
+		depth = (uint8_t)(1 + rte_rand() % MAX_DEPTH);
+		status = rte_lpm6_add(lpm, ip, depth, (uint8_t)i);
+		TEST_LPM_ASSERT(status == 0);
+
+		/* the rule itself, or a random neighbour, or a miss */
+		memcpy(ip_batch[i], ip, sizeof(ip));
+		if (i % 3 == 1)
+			ip_batch[i][rte_rand() % RTE_LPM6_IPV6_ADDR_SIZE] ^= 0x1;
+		else if (i % 3 == 2)
+			ip_batch[i][0] = 0x30;
+	}
+	memset(ip_batch[TEST28_NUM_RULES], 0, RTE_LPM6_IPV6_ADDR_SIZE);
+
+	status = rte_lpm6_lookup_bulk_func(lpm, ip_batch, next_hops,
+			TEST28_NUM_IPS);
+	TEST_LPM_ASSERT(status == 0);
+
+	for (i = 0; i < TEST28_NUM_IPS; i++) {
+		status = rte_lpm6_lookup(lpm, ip_batch[i], &next_hop_return);
+		if (status == 0)
+			TEST_LPM_ASSERT(next_hops[i] == next_hop_return);
+		else
+			TEST_LPM_ASSERT(next_hops[i] == -1);
+	}
+
+	rte_lpm6_free(lpm);
+
+	return PASS;
+}
+
 /*
  * Lookup performance test
  */
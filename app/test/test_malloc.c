@@ -447,6 +447,102 @@ test_multi_alloc_statistics(void)
 	return 0;
 }
 
+static int
+test_malloc_cache(void)
+{
+#if RTE_MALLOC_CACHE_SIZE > 0
+	int socket = rte_socket_id();
+	struct rte_malloc_socket_stats stats;
+	size_t size;
+	unsigned idx;
+	void *p1, *p2;
+
+	rte_malloc_cache_flush();
+
+	/* small blocks are rounded up to the size of their class */
+	p1 = rte_malloc_socket("cache", RTE_CACHE_LINE_SIZE + 1, 0, socket);
+	if (p1 == NULL)
+		return -1;
+	if (rte_malloc_validate(p1, &size) < 0 ||
+			size != 2 * RTE_CACHE_LINE_SIZE) {
+		printf("Unexpected size of small block: %zu\n", size);
+		rte_free(p1);
+		return -1;
+	}
+
+	/* a freed block is held in the lcore cache and allocated again */
+	rte_free(p1);
+	rte_malloc_get_socket_stats(socket, &stats);
+	if (stats.cache_count[1] != 1 ||
+			stats.cache_sz_bytes != 2 * RTE_CACHE_LINE_SIZE) {
+		printf("Incorrect cache statistics after free\n");
+		return -1;
+	}
+	p2 = rte_malloc_socket("cache", 2 * RTE_CACHE_LINE_SIZE, 0, socket);
+	if (p2 != p1) {
+		printf("Freed block not allocated from the cache\n");
+		rte_free(p2);
+		return -1;
+	}
+
+	/* flushing returns the cached blocks to the heap */
+	rte_free(p2);
+	rte_malloc_cache_flush();
+	rte_malloc_get_socket_stats(socket, &stats);
+	for (idx = 0; idx < RTE_MALLOC_CACHE_NUM_CLASSES; idx++) {
+		if (stats.cache_count[idx] != 0) {
+			printf("Cache not empty after flush\n");
+			return -1;
+		}
+	}
+	if (stats.cache_sz_bytes != 0 || stats.fragmentation > 100) {
+		printf("Incorrect heap statistics after flush\n");
+		return -1;
+	}
+#endif
+	return 0;
+}
+
+static int
+test_malloc_trim(void)
+{
+	int socket = rte_socket_id();
+	struct rte_malloc_socket_stats pre_stats, post_stats;
+	size_t size = rte_str_to_size(MALLOC_MEMZONE_SIZE) * 2;
+	size_t released;
+	void *p1;
+
+	/* start from a heap without unused memzones */
+	rte_malloc_cache_flush();
+	rte_malloc_heap_trim(socket);
+	rte_malloc_get_socket_stats(socket, &pre_stats);
+
+	/* the heap grows for a big block and is trimmed back once it is freed */
+	p1 = rte_malloc_socket("trim", size, 0, socket);
+	if (p1 == NULL)
+		return -1;
+	rte_free(p1);
+	released = rte_malloc_heap_trim(socket);
+	if (released < size) {
+		printf("Heap trim released %zu bytes, expected at least %zu\n",
+			released, size);
+		return -1;
+	}
+	rte_malloc_get_socket_stats(socket, &post_stats);
+	if (post_stats.heap_totalsz_bytes != pre_stats.heap_totalsz_bytes ||
+			post_stats.heap_freesz_bytes !=
+			post_stats.heap_totalsz_bytes -
+			post_stats.heap_allocsz_bytes) {
+		printf("Malloc statistics are incorrect after heap trim\n");
+		return -1;
+	}
+
+	/* nothing left to release */
+	if (rte_malloc_heap_trim(socket) != 0)
+		return -1;
+	return 0;
+}
+
 static int
 test_memzone_size_alloc(void)
 {
@@ -1043,6 +1139,22 @@ test_malloc(void)
 	else
 		printf("test_multi_alloc_statistics() passed\n");
 
+	ret = test_malloc_cache();
+	if (ret < 0) {
+		printf("test_malloc_cache() failed\n");
+		return ret;
+	}
+	else
+		printf("test_malloc_cache() passed\n");
+
+	ret = test_malloc_trim();
+	if (ret < 0) {
+		printf("test_malloc_trim() failed\n");
+		return ret;
+	}
+	else
+		printf("test_malloc_trim() passed\n");
+
 	return 0;
 }
 
@@ -57,6 +57,7 @@
 #include <rte_ring.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
+#include <rte_malloc.h>
 #include <rte_random.h>
 #include <rte_cycles.h>
 
@@ -502,6 +503,158 @@ test_pktmbuf_free_segment(void)
 	return ret;
 }
 
+/*
+ * test bulk allocation and free of mbufs
+ */
+#define NB_BULK_MBUF (NB_MBUF / 2)
+
+static int
+test_pktmbuf_bulk(void)
+{
+	unsigned i;
+	struct rte_mbuf *m[NB_MBUF + 1];
+
+	if (rte_pktmbuf_alloc_bulk(pktmbuf_pool, m, NB_MBUF + 1) == 0) {
+		printf("allocated more mbufs than the pool size\n");
+		return -1;
+	}
+	if (rte_mempool_count(pktmbuf_pool) != NB_MBUF) {
+		printf("failed bulk allocation took mbufs\n");
+		return -1;
+	}
+
+	/*
+	 * some mbufs may sit in the lcore cache, which is not used for
+	 * requests larger than the cache size: only take half of the pool
+	 */
+	if (rte_pktmbuf_alloc_bulk(pktmbuf_pool, m, NB_BULK_MBUF) != 0) {
+		printf("rte_pktmbuf_alloc_bulk() failed\n");
+		return -1;
+	}
+	if (rte_mempool_count(pktmbuf_pool) != NB_MBUF - NB_BULK_MBUF) {
+		printf("bad mbuf count after bulk allocation\n");
+		return -1;
+	}
+	for (i = 0; i < NB_BULK_MBUF; i++) {
+		if (m[i]->data_off != RTE_PKTMBUF_HEADROOM ||
+				m[i]->nb_segs != 1 || m[i]->next != NULL ||
+				rte_pktmbuf_pkt_len(m[i]) != 0) {
+			printf("mbuf %u not reset\n", i);
+			return -1;
+		}
+#ifdef RTE_MBUF_REFCNT
+		if (rte_mbuf_refcnt_read(m[i]) != 1) {
+			printf("mbuf %u has bad refcnt\n", i);
+			return -1;
+		}
+#endif
+	}
+
+	/* chain two mbufs, the second one is freed with the first */
+	m[0]->next = m[1];
+	m[0]->nb_segs = 2;
+	m[1] = NULL;
+
+	rte_pktmbuf_free_bulk(m, NB_BULK_MBUF);
+	if (rte_mempool_count(pktmbuf_pool) != NB_MBUF) {
+		printf("rte_pktmbuf_free_bulk() did not free all mbufs\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * test attachment of an external buffer
+ */
+#define EXT_BUF_LEN 2048
+
+static void
+test_ext_buf_free_cb(void *addr, void *opaque)
+{
+	unsigned *nb_free = opaque;
+
+	(*nb_free)++;
+	rte_free(addr);
+}
+
+static int
+test_pktmbuf_ext_buf(void)
+{
+#ifndef RTE_MBUF_REFCNT
+	return 0;
+#else
+	struct rte_mbuf_ext_shared_info shinfo;
+	struct rte_mbuf *m = NULL, *clone = NULL;
+	unsigned nb_free = 0;
+	char *buf;
+
+	buf = rte_malloc(NULL, EXT_BUF_LEN, 0);
+	if (buf == NULL) {
+		printf("cannot allocate external buffer\n");
+		return -1;
+	}
+	memset(buf, 0x5a, EXT_BUF_LEN);
+	rte_pktmbuf_ext_shinfo_init(&shinfo, test_ext_buf_free_cb, &nb_free);
+
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		goto fail;
+	rte_pktmbuf_attach_extbuf(m, buf, rte_malloc_virt2phy(buf),
+		EXT_BUF_LEN, &shinfo);
+	if (!RTE_MBUF_HAS_EXTBUF(m) || RTE_MBUF_INDIRECT(m) ||
+			RTE_MBUF_DIRECT(m)) {
+		printf("bad type of mbuf with external buffer\n");
+		goto fail;
+	}
+	if (rte_pktmbuf_append(m, 64) != buf) {
+		printf("bad data address in external buffer\n");
+		goto fail;
+	}
+
+	/* the clone shares the external buffer */
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+	if (clone == NULL) {
+		printf("cannot clone mbuf with external buffer\n");
+		goto fail;
+	}
+	if (rte_pktmbuf_mtod(clone, char *) != buf ||
+			rte_pktmbuf_pkt_len(clone) != 64 ||
+			rte_atomic16_read(&shinfo.refcnt_atomic) != 2) {
+		printf("bad clone of mbuf with external buffer\n");
+		goto fail;
+	}
+
+	rte_pktmbuf_free(m);
+	m = NULL;
+	if (nb_free != 0) {
+		printf("external buffer freed while still attached\n");
+		goto fail;
+	}
+	rte_pktmbuf_free(clone);
+	clone = NULL;
+	if (nb_free != 1) {
+		printf("external buffer not freed\n");
+		return -1;
+	}
+	if (rte_mempool_count(pktmbuf_pool) != NB_MBUF) {
+		printf("mbufs not returned to the pool\n");
+		return -1;
+	}
+
+	return 0;
+
+fail:
+	if (clone)
+		rte_pktmbuf_free(clone);
+	if (m)
+		rte_pktmbuf_free(m);
+	if (nb_free == 0 && rte_atomic16_read(&shinfo.refcnt_atomic) == 0)
+		rte_free(buf);
+	return -1;
+#endif /* RTE_MBUF_REFCNT */
+}
+
 /*
  * Stress test for rte_mbuf atomic refcnt.
  * Implies that:
@@ -833,6 +986,18 @@ test_mbuf(void)
 		return -1;
 	}
 
+	/* test bulk allocation and free */
+	if (test_pktmbuf_bulk() < 0) {
+		printf("test_pktmbuf_bulk() failed\n");
+		return -1;
+	}
+
+	/* test external buffer attachment */
+	if (test_pktmbuf_ext_buf() < 0) {
+		printf("test_pktmbuf_ext_buf() failed\n");
+		return -1;
+	}
+
 	if (testclone_testupdate_testdetach()<0){
 		printf("testclone_and_testupdate() failed \n");
 		return -1;
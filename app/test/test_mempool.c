@@ -194,6 +194,197 @@ test_mempool_basic(void)
 	return ret;
 }
 
+/*
+ * Get and put objects through a user-owned cache, as a thread that is not
+ * an EAL lcore would, and check that freeing the cache returns the objects
+ * it holds to the pool.
+ */
+static int
+test_mempool_user_cache(struct rte_mempool *mp_uc)
+{
+	struct rte_mempool_cache *cache;
+	void *obj, *obj2;
+	unsigned count = rte_mempool_count(mp_uc);
+
+	if (rte_mempool_cache_create(mp_uc, 0, SOCKET_ID_ANY) != NULL ||
+			rte_mempool_cache_create(mp_uc,
+				RTE_MEMPOOL_CACHE_MAX_SIZE + 1,
+				SOCKET_ID_ANY) != NULL) {
+		printf("cache with invalid size was created\n");
+		return -1;
+	}
+
+	cache = rte_mempool_cache_create(mp_uc, 32, SOCKET_ID_ANY);
+	if (cache == NULL) {
+		printf("cannot create mempool cache\n");
+		return -1;
+	}
+
+	/* the first get fills the cache from the pool */
+	if (rte_mempool_generic_get(mp_uc, &obj, 1, cache) < 0) {
+		printf("cannot get object through user cache\n");
+		goto fail;
+	}
+	if (cache->len != 32 || rte_mempool_count(mp_uc) != count - 33) {
+		printf("bad cache fill: len %u, count %u\n", cache->len,
+			rte_mempool_count(mp_uc));
+		goto fail;
+	}
+
+	/* objects are taken from and put back in the cache */
+	if (rte_mempool_generic_get(mp_uc, &obj2, 1, cache) < 0) {
+		printf("cannot get object through user cache\n");
+		goto fail;
+	}
+	rte_mempool_generic_put(mp_uc, &obj2, 1, cache);
+	rte_mempool_generic_put(mp_uc, &obj, 1, cache);
+	if (cache->len != 33 || rte_mempool_count(mp_uc) != count - 33) {
+		printf("bad cache put: len %u, count %u\n", cache->len,
+			rte_mempool_count(mp_uc));
+		goto fail;
+	}
+
+	/* without a cache, objects go straight to the pool */
+	if (rte_mempool_generic_get(mp_uc, &obj, 1, NULL) < 0) {
+		printf("cannot get object without cache\n");
+		goto fail;
+	}
+	rte_mempool_generic_put(mp_uc, &obj, 1, NULL);
+
+	rte_mempool_cache_free(cache);
+	if (rte_mempool_count(mp_uc) != count) {
+		printf("objects were not flushed from the cache\n");
+		return -1;
+	}
+
+	return 0;
+
+fail:
+	rte_mempool_cache_free(cache);
+	return -1;
+}
+
+/*
+ * Create a pool with the stack handler and check that objects are given
+ * back in LIFO order.
+ */
+static int
+test_mempool_handler(void)
+{
+	struct rte_mempool *mp_stack;
+	struct rte_mempool_handler dup;
+	void *obj, *obj2, *obj3;
+
+	if (rte_mempool_create_with_handler("test_unknown_handler",
+			MEMPOOL_SIZE, MEMPOOL_ELT_SIZE, 0, 0,
+			NULL, NULL, my_obj_init, NULL,
+			SOCKET_ID_ANY, 0, "unknown") != NULL) {
+		printf("mempool created with unknown handler\n");
+		return -1;
+	}
+
+	memset(&dup, 0, sizeof(dup));
+	snprintf(dup.name, sizeof(dup.name), "stack");
+	if (rte_mempool_handler_register(&dup) != -EINVAL) {
+		printf("incomplete handler registered\n");
+		return -1;
+	}
+	dup = rte_mempool_handler_table.handler[
+		rte_mempool_handler_lookup("stack")];
+	if (rte_mempool_handler_register(&dup) != -EEXIST) {
+		printf("handler registered twice\n");
+		return -1;
+	}
+
+	/* rte_mempool_mp_put()/mc_get() stay safe on single ring pools */
+	dup = rte_mempool_handler_table.handler[
+		rte_mempool_handler_lookup("ring_sp_sc")];
+	if (dup.mp_put == NULL || dup.mc_get == NULL) {
+		printf("ring_sp_sc handler has no multi-producer/consumer ops\n");
+		return -1;
+	}
+
+	mp_stack = rte_mempool_create_with_handler("test_stack",
+		MEMPOOL_SIZE, MEMPOOL_ELT_SIZE, 0, 0,
+		NULL, NULL, my_obj_init, NULL,
+		SOCKET_ID_ANY, 0, "stack");
+	if (mp_stack == NULL) {
+		printf("cannot create mempool with stack handler\n");
+		return -1;
+	}
+	rte_mempool_dump(stdout, mp_stack);
+
+	if (rte_mempool_count(mp_stack) != MEMPOOL_SIZE)
+		return -1;
+
+	if (rte_mempool_get(mp_stack, &obj) < 0 ||
+			rte_mempool_get(mp_stack, &obj2) < 0)
+		return -1;
+	if (rte_mempool_count(mp_stack) != MEMPOOL_SIZE - 2)
+		return -1;
+
+	/* the last object freed is the first one allocated */
+	rte_mempool_put(mp_stack, obj2);
+	rte_mempool_put(mp_stack, obj);
+	if (rte_mempool_get(mp_stack, &obj3) < 0)
+		return -1;
+	if (obj3 != obj) {
+		printf("stack handler is not LIFO\n");
+		return -1;
+	}
+	rte_mempool_put(mp_stack, obj3);
+
+	if (rte_mempool_count(mp_stack) != MEMPOOL_SIZE)
+		return -1;
+
+	rte_mempool_free(mp_stack);
+	if (rte_mempool_lookup("test_stack") != NULL) {
+		printf("freed stack mempool still found\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Free a mempool and check that its name and memory are released, so it
+ * can be created again.
+ */
+static int
+test_mempool_free(void)
+{
+	struct rte_mempool *mp_free;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		mp_free = rte_mempool_create("test_free", MEMPOOL_SIZE,
+			MEMPOOL_ELT_SIZE, RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+			NULL, NULL, my_obj_init, NULL, SOCKET_ID_ANY, 0);
+		if (mp_free == NULL) {
+			printf("cannot create mempool test_free\n");
+			return -1;
+		}
+
+		rte_mempool_free(mp_free);
+		if (rte_mempool_lookup("test_free") != NULL) {
+			printf("freed mempool still found\n");
+			return -1;
+		}
+		if (rte_memzone_lookup(RTE_MEMPOOL_MZ_PREFIX "test_free") !=
+				NULL ||
+				rte_memzone_lookup(RTE_RING_MZ_PREFIX RTE_MEMPOOL_MZ_PREFIX
+					"test_free") != NULL) {
+			printf("memzone of freed mempool still found\n");
+			return -1;
+		}
+	}
+
+	/* freeing NULL is allowed */
+	rte_mempool_free(NULL);
+
+	return 0;
+}
+
 static int test_mempool_creation_with_exceeded_cache_size(void)
 {
 	struct rte_mempool *mp_cov;
@@ -504,6 +695,21 @@ test_mempool(void)
 	if (test_mempool_basic_ex(mp_nocache) < 0)
 		return -1;
 
+	/* user-owned caches, on pools with and without default cache */
+	if (test_mempool_user_cache(mp_nocache) < 0)
+		return -1;
+
+	if (test_mempool_user_cache(mp_cache) < 0)
+		return -1;
+
+	/* mempool with the stack handler */
+	if (test_mempool_handler() < 0)
+		return -1;
+
+	/* release of a mempool */
+	if (test_mempool_free() < 0)
+		return -1;
+
 	/* mempool operation test based on single producer and single comsumer */
 	if (test_mempool_sp_sc() < 0)
 		return -1;
@@ -32,8 +32,10 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <errno.h>
 #include <sys/queue.h>
 
 #include <rte_random.h>
@@ -1042,6 +1044,91 @@ test_memzone_reserve_remainder(void)
 	return 0;
 }
 
+/* sum the length of the free memory segments and count them */
+static size_t
+get_free_memseg_len(unsigned *nb_seg)
+{
+	const struct rte_config *config = rte_eal_get_configuration();
+	const struct rte_memseg *ms;
+	size_t len = 0;
+	int i;
+
+	*nb_seg = 0;
+	for (i = 0; i < RTE_MAX_MEMSEG; i++) {
+		ms = &config->mem_config->free_memseg[i];
+		if (ms->addr == NULL)
+			break;
+		if (ms->len == 0)
+			continue;
+		len += ms->len;
+		(*nb_seg)++;
+	}
+	return len;
+}
+
+static int
+test_memzone_free(void)
+{
+	const struct rte_memzone *mz1, *mz2, *mz;
+	unsigned nb_seg_before, nb_seg_after;
+	size_t len_before, len_after, i;
+	void *addr1;
+
+	len_before = get_free_memseg_len(&nb_seg_before);
+
+	mz1 = rte_memzone_reserve("tempzone0", 2000, SOCKET_ID_ANY, 0);
+	mz2 = rte_memzone_reserve("tempzone1", 4000, SOCKET_ID_ANY, 0);
+	if (mz1 == NULL || mz2 == NULL) {
+		printf("Fail memzone reserve\n");
+		return -1;
+	}
+	addr1 = mz1->addr;
+	memset(addr1, 0xff, mz1->len);
+
+	/* free the first zone, its name and descriptor can be reused */
+	if (rte_memzone_free(mz1) != 0) {
+		printf("Fail memzone free\n");
+		return -1;
+	}
+	if (rte_memzone_lookup("tempzone0") != NULL) {
+		printf("Freed memzone still found\n");
+		return -1;
+	}
+	if (rte_memzone_free(mz1) != -EINVAL || rte_memzone_free(NULL) !=
+			-EINVAL) {
+		printf("Invalid memzone free did not fail\n");
+		return -1;
+	}
+
+	/* the freed memory fits best, it is reserved again */
+	mz = rte_memzone_reserve("tempzone0", 2000, SOCKET_ID_ANY, 0);
+	if (mz != mz1 || mz->addr != addr1) {
+		printf("Freed memzone memory or descriptor not reused\n");
+		return -1;
+	}
+	for (i = 0; i < mz->len; i++) {
+		if (((const uint8_t *)mz->addr)[i] != 0) {
+			printf("Freed memzone memory not zeroed\n");
+			return -1;
+		}
+	}
+
+	/* once both zones are freed, the free memory is merged back */
+	if (rte_memzone_free(mz) != 0 || rte_memzone_free(mz2) != 0) {
+		printf("Fail memzone free\n");
+		return -1;
+	}
+	len_after = get_free_memseg_len(&nb_seg_after);
+	if (len_after != len_before || nb_seg_after != nb_seg_before) {
+		printf("Free memory not merged: %zu bytes in %u segments, "
+			"expected %zu bytes in %u segments\n", len_after,
+			nb_seg_after, len_before, nb_seg_before);
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 test_memzone(void)
 {
@@ -1122,6 +1209,10 @@ test_memzone(void)
 	if (mz != NULL)
 		return -1;
 
+	printf("test freeing memzones\n");
+	if (test_memzone_free() < 0)
+		return -1;
+
 	printf("test reserving memzone with bigger size than the maximum\n");
 	if (test_memzone_reserving_zone_size_bigger_than_the_maximum() < 0)
 		return -1;
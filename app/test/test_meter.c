@@ -466,6 +466,114 @@ tm_test_trtcm_color_aware_check(void)
 	return 0;
 }
 
+#define TM_TEST_BULK_METERS 8
+#define TM_TEST_BULK_BURST  32
+#define TM_TEST_BULK_ROUNDS 64
+
+/**
+ * functional test for the bulk metering functions: the colors of random bursts
+ * must match the ones of the per packet functions, for both meter layouts
+ */
+static inline int
+tm_test_color_check_bulk(void)
+{
+#define BULK_CHECK_MSG "color_check_bulk"
+	struct rte_meter_srtcm sm[TM_TEST_BULK_METERS], sm_ref[TM_TEST_BULK_METERS];
+	struct rte_meter_trtcm tm[TM_TEST_BULK_METERS], tm_ref[TM_TEST_BULK_METERS];
+	struct rte_meter_srtcm_compact smc[TM_TEST_BULK_METERS];
+	struct rte_meter_trtcm_compact tmc[TM_TEST_BULK_METERS];
+	struct rte_meter_srtcm_profile sp;
+	struct rte_meter_trtcm_profile tp;
+	struct rte_meter_srtcm *sm_burst[TM_TEST_BULK_BURST];
+	struct rte_meter_trtcm *tm_burst[TM_TEST_BULK_BURST];
+	struct rte_meter_srtcm_compact *smc_burst[TM_TEST_BULK_BURST];
+	struct rte_meter_trtcm_compact *tmc_burst[TM_TEST_BULK_BURST];
+	enum rte_meter_color in[TM_TEST_BULK_BURST], ref[TM_TEST_BULK_BURST];
+	enum rte_meter_color out[TM_TEST_BULK_BURST], out_c[TM_TEST_BULK_BURST];
+	uint32_t len[TM_TEST_BULK_BURST];
+	uint64_t time, hz = rte_get_tsc_hz();
+	uint32_t i, j, round;
+
+	if (rte_meter_srtcm_profile_config(&sp, &sparams) != 0)
+		melog(BULK_CHECK_MSG" srtcm profile");
+	if (rte_meter_trtcm_profile_config(&tp, &tparams) != 0)
+		melog(BULK_CHECK_MSG" trtcm profile");
+
+	time = rte_get_tsc_cycles();
+	for (i = 0; i < TM_TEST_BULK_METERS; i++) {
+		if ((rte_meter_srtcm_config(&sm[i], &sparams) != 0) ||
+			(rte_meter_srtcm_config(&sm_ref[i], &sparams) != 0) ||
+			(rte_meter_srtcm_compact_config(&smc[i], &sp) != 0))
+			melog(BULK_CHECK_MSG" srtcm config");
+		if ((rte_meter_trtcm_config(&tm[i], &tparams) != 0) ||
+			(rte_meter_trtcm_config(&tm_ref[i], &tparams) != 0) ||
+			(rte_meter_trtcm_compact_config(&tmc[i], &tp) != 0))
+			melog(BULK_CHECK_MSG" trtcm config");
+
+		/* same starting point for all the layouts */
+		sm[i].time = sm_ref[i].time = smc[i].time = time;
+		tm[i].time_tc = tm_ref[i].time_tc = tmc[i].time_tc = time;
+		tm[i].time_tp = tm_ref[i].time_tp = tmc[i].time_tp = time;
+	}
+
+	for (round = 0; round < TM_TEST_BULK_ROUNDS; round++) {
+		uint32_t aware = round & 1;
+
+		/* a few microseconds per burst, so that some packets run out of credits */
+		time += hz / 200000;
+
+		for (j = 0; j < TM_TEST_BULK_BURST; j++) {
+			i = rand() % TM_TEST_BULK_METERS;
+			sm_burst[j] = &sm[i];
+			tm_burst[j] = &tm[i];
+			smc_burst[j] = &smc[i];
+			tmc_burst[j] = &tmc[i];
+			len[j] = 64 + rand() % 1455;
+			in[j] = (enum rte_meter_color) (rand() % e_RTE_METER_COLORS);
+		}
+
+		/* srTCM */
+		for (j = 0; j < TM_TEST_BULK_BURST; j++) {
+			struct rte_meter_srtcm *m = &sm_ref[sm_burst[j] - sm];
+
+			ref[j] = aware ?
+				rte_meter_srtcm_color_aware_check(m, time, len[j], in[j]) :
+				rte_meter_srtcm_color_blind_check(m, time, len[j]);
+		}
+		if (aware) {
+			rte_meter_srtcm_color_aware_check_bulk(sm_burst, time, len, in, out, TM_TEST_BULK_BURST);
+			rte_meter_srtcm_compact_color_aware_check_bulk(smc_burst, time, len, in, out_c, TM_TEST_BULK_BURST);
+		} else {
+			rte_meter_srtcm_color_blind_check_bulk(sm_burst, time, len, out, TM_TEST_BULK_BURST);
+			rte_meter_srtcm_compact_color_blind_check_bulk(smc_burst, time, len, out_c, TM_TEST_BULK_BURST);
+		}
+		for (j = 0; j < TM_TEST_BULK_BURST; j++)
+			if ((out[j] != ref[j]) || (out_c[j] != ref[j]))
+				melog(BULK_CHECK_MSG" srtcm color");
+
+		/* trTCM */
+		for (j = 0; j < TM_TEST_BULK_BURST; j++) {
+			struct rte_meter_trtcm *m = &tm_ref[tm_burst[j] - tm];
+
+			ref[j] = aware ?
+				rte_meter_trtcm_color_aware_check(m, time, len[j], in[j]) :
+				rte_meter_trtcm_color_blind_check(m, time, len[j]);
+		}
+		if (aware) {
+			rte_meter_trtcm_color_aware_check_bulk(tm_burst, time, len, in, out, TM_TEST_BULK_BURST);
+			rte_meter_trtcm_compact_color_aware_check_bulk(tmc_burst, time, len, in, out_c, TM_TEST_BULK_BURST);
+		} else {
+			rte_meter_trtcm_color_blind_check_bulk(tm_burst, time, len, out, TM_TEST_BULK_BURST);
+			rte_meter_trtcm_compact_color_blind_check_bulk(tmc_burst, time, len, out_c, TM_TEST_BULK_BURST);
+		}
+		for (j = 0; j < TM_TEST_BULK_BURST; j++)
+			if ((out[j] != ref[j]) || (out_c[j] != ref[j]))
+				melog(BULK_CHECK_MSG" trtcm color");
+	}
+
+	return 0;
+}
+
 /**
  * test main entrance for library meter
  */
@@ -490,6 +598,9 @@ test_meter(void)
 	if(tm_test_trtcm_color_aware_check()!= 0)
 		return -1;
 
+	if(tm_test_color_check_bulk() != 0)
+		return -1;
+
 	return 0;
 
 }
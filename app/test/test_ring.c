@@ -1248,6 +1248,319 @@ test_lookup_null(void)
 	return 0;
 }
 
+/*
+ * Check the free space and available counts returned by burst operations.
+ */
+static int
+test_ring_burst_free_avail(void)
+{
+	struct rte_ring *rp;
+	void *obj[16];
+	unsigned ret, free_space, available;
+
+	memset(obj, 0, sizeof(obj));
+
+	rp = rte_ring_create("test_ring_free_avail", RTE_DIM(obj),
+		SOCKET_ID_ANY, 0);
+	if (rp == NULL) {
+		printf("%s: fail to create ring\n", __func__);
+		return -1;
+	}
+
+	/* ring can hold size - 1 objects */
+	ret = rte_ring_mp_enqueue_burst_free(rp, obj, 10, &free_space);
+	if (ret != 10 || free_space != 5) {
+		printf("%s: mp enqueue %u, free %u\n", __func__,
+			ret, free_space);
+		return -1;
+	}
+
+	ret = rte_ring_sp_enqueue_burst_free(rp, obj, 10, &free_space);
+	if (ret != 5 || free_space != 0) {
+		printf("%s: sp enqueue %u, free %u\n", __func__,
+			ret, free_space);
+		return -1;
+	}
+
+	ret = rte_ring_enqueue_burst_free(rp, obj, 1, &free_space);
+	if (ret != 0 || free_space != 0) {
+		printf("%s: enqueue in full ring %u, free %u\n", __func__,
+			ret, free_space);
+		return -1;
+	}
+
+	ret = rte_ring_mc_dequeue_burst_avail(rp, obj, 4, &available);
+	if (ret != 4 || available != 11) {
+		printf("%s: mc dequeue %u, available %u\n", __func__,
+			ret, available);
+		return -1;
+	}
+
+	ret = rte_ring_sc_dequeue_burst_avail(rp, obj, 16, &available);
+	if (ret != 11 || available != 0) {
+		printf("%s: sc dequeue %u, available %u\n", __func__,
+			ret, available);
+		return -1;
+	}
+
+	ret = rte_ring_dequeue_burst_avail(rp, obj, 1, &available);
+	if (ret != 0 || available != 0) {
+		printf("%s: dequeue from empty ring %u, available %u\n",
+			__func__, ret, available);
+		return -1;
+	}
+
+	/* NULL counters are allowed */
+	if (rte_ring_enqueue_burst_free(rp, obj, 3, NULL) != 3 ||
+			rte_ring_dequeue_burst_avail(rp, obj, 3, NULL) != 3) {
+		printf("%s: burst without counters failed\n", __func__);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Check that a ring with relaxed tail sync behaves as a normal ring when
+ * used through the generic API.
+ */
+static int
+test_ring_rts(void)
+{
+	struct rte_ring *rp;
+	void *src[16], *dst[16];
+	unsigned i, ret;
+
+	for (i = 0; i < RTE_DIM(src); i++)
+		src[i] = (void *)(uintptr_t)(i + 1);
+
+	rp = rte_ring_create("test_ring_rts", RTE_DIM(src), SOCKET_ID_ANY,
+		RING_F_RTS);
+	if (rp == NULL) {
+		printf("%s: fail to create ring\n", __func__);
+		return -1;
+	}
+
+	if (rte_ring_mp_enqueue_bulk(rp, src, 8) != 0 ||
+			rte_ring_enqueue_burst(rp, &src[8], 8) != 7) {
+		printf("%s: enqueue failed\n", __func__);
+		return -1;
+	}
+	if (!rte_ring_full(rp) || rte_ring_count(rp) != 15 ||
+			rte_ring_mp_enqueue(rp, src[0]) != -ENOBUFS) {
+		printf("%s: ring should be full\n", __func__);
+		return -1;
+	}
+
+	if (rte_ring_mc_dequeue_bulk(rp, dst, 3) != 0 ||
+			rte_ring_dequeue_burst(rp, &dst[3], 16) != 12) {
+		printf("%s: dequeue failed\n", __func__);
+		return -1;
+	}
+	if (memcmp(src, dst, 15 * sizeof(void *)) != 0) {
+		printf("%s: objects differ\n", __func__);
+		return -1;
+	}
+	if (!rte_ring_empty(rp) ||
+			rte_ring_mc_dequeue(rp, &dst[0]) != -ENOENT) {
+		printf("%s: ring should be empty\n", __func__);
+		return -1;
+	}
+
+	/* every operation completed, so the tails have caught up */
+	if (rp->prod.head_cnt != rp->prod.tail_cnt ||
+			rp->cons.head_cnt != rp->cons.tail_cnt ||
+			rp->prod.tail != 15 || rp->cons.tail != 15) {
+		printf("%s: tails did not catch up with heads\n", __func__);
+		rte_ring_dump(stdout, rp);
+		return -1;
+	}
+
+	/* wrap around the end of the ring */
+	for (i = 0; i < 4; i++) {
+		ret = rte_ring_enqueue_burst(rp, src, 10);
+		if (ret != 10 ||
+				rte_ring_dequeue_bulk(rp, dst, 10) != 0 ||
+				memcmp(src, dst, 10 * sizeof(void *)) != 0) {
+			printf("%s: wrap iteration %u failed\n", __func__, i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+#define RTS_STRESS_RING_SIZE	64
+#define RTS_STRESS_ITERATIONS	(1 << 16)
+#define RTS_STRESS_BURST	8
+
+static struct rte_ring *rts_ring;
+static rte_atomic64_t rts_enq_cnt, rts_enq_sum;
+static rte_atomic64_t rts_deq_cnt, rts_deq_sum;
+static rte_atomic32_t rts_errors;
+
+/*
+ * Objects carry the lcore that enqueued them in the top 8 bits and a
+ * sequence number below. Whoever dequeues must see the objects of each
+ * producer in the order they were enqueued.
+ */
+static int
+rts_check_order(uint32_t next_seq[], void * const obj[], unsigned n,
+	uint64_t *sum)
+{
+	unsigned i;
+	uint32_t v;
+
+	for (i = 0; i < n; i++) {
+		v = (uint32_t)(uintptr_t)obj[i];
+		if ((v & 0xFFFFFF) < next_seq[v >> 24])
+			return -1;
+		next_seq[v >> 24] = (v & 0xFFFFFF) + 1;
+		*sum += v;
+	}
+	return 0;
+}
+
+static int
+rts_stress_worker(__attribute__((unused)) void *arg)
+{
+	void *obj[RTS_STRESS_BURST];
+	uint32_t next_seq[RTE_MAX_LCORE];
+	uint32_t lcore_id = rte_lcore_id();
+	uint32_t seq = 0;
+	uint64_t enq_sum = 0, deq_sum = 0, deq_cnt = 0;
+	unsigned i, j, n;
+
+	memset(next_seq, 0, sizeof(next_seq));
+
+	for (i = 0; i < RTS_STRESS_ITERATIONS; i++) {
+		n = i % RTS_STRESS_BURST + 1;
+		for (j = 0; j < n; j++)
+			obj[j] = (void *)(uintptr_t)(lcore_id << 24 | (seq + j));
+		n = rte_ring_mp_enqueue_burst(rts_ring, obj, n);
+		for (j = 0; j < n; j++)
+			enq_sum += (uintptr_t)obj[j];
+		seq += n;
+
+		n = rte_ring_mc_dequeue_burst(rts_ring, obj, RTS_STRESS_BURST);
+		if (rts_check_order(next_seq, obj, n, &deq_sum) != 0)
+			rte_atomic32_inc(&rts_errors);
+		deq_cnt += n;
+	}
+
+	rte_atomic64_add(&rts_enq_cnt, seq);
+	rte_atomic64_add(&rts_enq_sum, enq_sum);
+	rte_atomic64_add(&rts_deq_cnt, deq_cnt);
+	rte_atomic64_add(&rts_deq_sum, deq_sum);
+	return 0;
+}
+
+/*
+ * Enqueue and dequeue bursts on a small relaxed tail sync ring from all
+ * lcores at once, so that tails complete out of order and operations have
+ * to wait for the head to tail distance to shrink. Check that every object
+ * comes out once, in enqueue order for each producer, and that the tails
+ * catch up with the heads at the end.
+ */
+static int
+test_ring_rts_stress(void)
+{
+	void *obj[RTS_STRESS_BURST];
+	uint32_t next_seq[RTE_MAX_LCORE];
+	uint64_t deq_sum = 0;
+	unsigned n;
+
+	printf("Test RTS ring on %u lcores\n", rte_lcore_count());
+
+	rts_ring = rte_ring_create("test_ring_rts_st", RTS_STRESS_RING_SIZE,
+		SOCKET_ID_ANY, RING_F_RTS);
+	if (rts_ring == NULL) {
+		printf("%s: fail to create ring\n", __func__);
+		return -1;
+	}
+
+	rte_atomic64_init(&rts_enq_cnt);
+	rte_atomic64_init(&rts_enq_sum);
+	rte_atomic64_init(&rts_deq_cnt);
+	rte_atomic64_init(&rts_deq_sum);
+	rte_atomic32_init(&rts_errors);
+
+	rte_eal_mp_remote_launch(rts_stress_worker, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+
+	/* drain what is left */
+	memset(next_seq, 0, sizeof(next_seq));
+	while ((n = rte_ring_mc_dequeue_burst(rts_ring, obj,
+			RTS_STRESS_BURST)) != 0) {
+		if (rts_check_order(next_seq, obj, n, &deq_sum) != 0)
+			rte_atomic32_inc(&rts_errors);
+		rte_atomic64_add(&rts_deq_cnt, n);
+	}
+	rte_atomic64_add(&rts_deq_sum, deq_sum);
+
+	if (rte_atomic32_read(&rts_errors) != 0) {
+		printf("%s: %d bursts out of order\n", __func__,
+			rte_atomic32_read(&rts_errors));
+		return -1;
+	}
+	if (rte_atomic64_read(&rts_enq_cnt) != rte_atomic64_read(&rts_deq_cnt) ||
+			rte_atomic64_read(&rts_enq_sum) !=
+			rte_atomic64_read(&rts_deq_sum)) {
+		printf("%s: enqueued %" PRId64 " objects, dequeued %" PRId64 "\n",
+			__func__, rte_atomic64_read(&rts_enq_cnt),
+			rte_atomic64_read(&rts_deq_cnt));
+		return -1;
+	}
+	if (rts_ring->prod.head_cnt != rts_ring->prod.tail_cnt ||
+			rts_ring->cons.head_cnt != rts_ring->cons.tail_cnt ||
+			rts_ring->prod.tail != rts_ring->cons.tail) {
+		printf("%s: tails did not catch up with heads\n", __func__);
+		rte_ring_dump(stdout, rts_ring);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Free a ring and check that its name and memory are released, so it can
+ * be created again.
+ */
+static int
+test_ring_free(void)
+{
+	struct rte_ring *rp;
+	void *obj = NULL;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		rp = rte_ring_create("test_ring_free", RING_SIZE,
+			SOCKET_ID_ANY, 0);
+		if (rp == NULL) {
+			printf("cannot create ring test_ring_free\n");
+			return -1;
+		}
+		if (rte_ring_enqueue(rp, obj) != 0)
+			return -1;
+
+		rte_ring_free(rp);
+		if (rte_ring_lookup("test_ring_free") != NULL) {
+			printf("freed ring still found\n");
+			return -1;
+		}
+		if (rte_memzone_lookup(RTE_RING_MZ_PREFIX "test_ring_free") !=
+				NULL) {
+			printf("memzone of freed ring still found\n");
+			return -1;
+		}
+	}
+
+	/* freeing NULL is allowed */
+	rte_ring_free(NULL);
+
+	return 0;
+}
+
 /*
  * it tests some more basic ring operations
  */
@@ -1342,10 +1655,25 @@ test_ring(void)
 		return -1;
 	}
 
+	/* release of a ring */
+	if (test_ring_free() < 0)
+		return -1;
+
 	/* burst operations */
 	if (test_ring_burst_basic() < 0)
 		return -1;
 
+	/* burst operations returning free space and available entries */
+	if (test_ring_burst_free_avail() < 0)
+		return -1;
+
+	/* relaxed tail sync ring */
+	if (test_ring_rts() < 0)
+		return -1;
+
+	if (test_ring_rts_stress() < 0)
+		return -1;
+
 	/* basic operations */
 	if (test_ring_basic() < 0)
 		return -1;
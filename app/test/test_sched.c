@@ -36,6 +36,7 @@
 #include <string.h>
 #include <stdint.h>
 #include <unistd.h>
+#include <errno.h>
 
 #include "test.h"
 
@@ -149,6 +150,340 @@ prepare_pkt(struct rte_mbuf *mbuf)
 	mbuf->data_len = 60;
 }
 
+/* port parameters of the small ports used by the feature tests */
+static void
+init_port_params(struct rte_sched_port_params *params, const char *name)
+{
+	*params = port_param;
+	params->name = name;
+	params->n_pipes_per_subport = 64;
+}
+
+/* configure a subport and all its pipes with the first profile */
+static int
+config_subport_pipes(struct rte_sched_port *port, uint32_t subport, uint32_t n_pipes)
+{
+	uint32_t pipe;
+	int err;
+
+	err = rte_sched_subport_config(port, subport, subport_param);
+	VERIFY(err == 0, "Error config sched, err=%d\n", err);
+
+	for (pipe = 0; pipe < n_pipes; pipe ++) {
+		err = rte_sched_pipe_config(port, subport, pipe, 0);
+		VERIFY(err == 0, "Error config sched pipe %u, err=%d\n", pipe, err);
+	}
+
+	return 0;
+}
+
+/* enqueue n_pkts packets of a subport, spread over n_pipes pipes from PIPE
+ * first, then over n_queues queues of a traffic class from queue */
+static int
+enqueue_pkts(struct rte_mempool *mp, struct rte_sched_port *port,
+	struct rte_mbuf **mbufs, int n_pkts, uint32_t subport, uint32_t n_pipes,
+	uint32_t traffic_class, uint32_t queue, uint32_t n_queues)
+{
+	int i, err;
+
+	for (i = 0; i < n_pkts; i++) {
+		mbufs[i] = rte_pktmbuf_alloc(mp);
+		VERIFY(mbufs[i] != NULL, "Error allocating mbuf\n");
+		prepare_pkt(mbufs[i]);
+		rte_sched_port_pkt_write(mbufs[i], subport, PIPE + i % n_pipes,
+			traffic_class, queue + (i / n_pipes) % n_queues, e_RTE_METER_GREEN);
+	}
+
+	err = rte_sched_port_enqueue(port, mbufs, n_pkts);
+	VERIFY(err == n_pkts, "Wrong enqueue, err=%d\n", err);
+
+	return 0;
+}
+
+
+#define LAYOUT_TCS       2
+#define LAYOUT_QUEUES    2
+#define LAYOUT_PKTS      8
+
+/**
+ * runtime pipe layout: fewer traffic classes and queues than the maximum
+ */
+static int
+test_sched_layout(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params;
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[LAYOUT_PKTS];
+	struct rte_mbuf *out_mbufs[LAYOUT_PKTS];
+	uint32_t footprint, pipe;
+	int i, err;
+
+	init_port_params(&params, "test_layout");
+	footprint = rte_sched_port_get_memory_footprint(&params);
+
+	params.n_traffic_classes = 3;
+	VERIFY(rte_sched_port_config(&params) == NULL,
+		"Port accepted a non power of 2 traffic class count\n");
+	params.n_traffic_classes = 2 * RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE;
+	VERIFY(rte_sched_port_config(&params) == NULL,
+		"Port accepted too many traffic classes\n");
+
+	params.n_traffic_classes = LAYOUT_TCS;
+	params.n_queues_per_traffic_class = LAYOUT_QUEUES;
+	params.n_grinders = 4;
+	VERIFY(rte_sched_port_get_memory_footprint(&params) < footprint,
+		"Smaller pipe layout did not reduce the memory footprint\n");
+
+	port = rte_sched_port_config(&params);
+	VERIFY(port != NULL, "Error config sched port\n");
+
+	if (config_subport_pipes(port, SUBPORT, params.n_pipes_per_subport) != 0)
+		return -1;
+
+	if (enqueue_pkts(mp, port, in_mbufs, LAYOUT_PKTS, SUBPORT, 2,
+			LAYOUT_TCS - 1, 0, LAYOUT_QUEUES) != 0)
+		return -1;
+
+	err = rte_sched_port_dequeue(port, out_mbufs, LAYOUT_PKTS);
+	VERIFY(err == LAYOUT_PKTS, "Wrong dequeue, err=%d\n", err);
+
+	for (i = 0; i < LAYOUT_PKTS; i++) {
+		uint32_t subport, traffic_class, queue;
+
+		rte_sched_port_pkt_read_tree_path(out_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+		VERIFY(subport == SUBPORT, "Wrong subport\n");
+		VERIFY((pipe == PIPE) || (pipe == PIPE + 1), "Wrong pipe\n");
+		VERIFY(traffic_class == LAYOUT_TCS - 1, "Wrong traffic_class\n");
+		VERIFY(queue < LAYOUT_QUEUES, "Wrong queue\n");
+		rte_pktmbuf_free(out_mbufs[i]);
+	}
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
+#define PROFILE_PKTS     8
+#define PROFILE_WRR_PKTS 16
+#define PROFILE_FRAME    (60 + RTE_SCHED_FRAME_OVERHEAD_DEFAULT)
+
+/* dequeue n_pkts packets, free them and count those of a pipe and of a queue */
+static int
+dequeue_pkts(struct rte_sched_port *port, int n_pkts, uint32_t pipe_id,
+	uint32_t queue_id, uint32_t *n_pipe_pkts, uint32_t *n_queue_pkts)
+{
+	struct rte_mbuf *out_mbufs[PROFILE_WRR_PKTS];
+	int i, n;
+
+	*n_pipe_pkts = 0;
+	*n_queue_pkts = 0;
+
+	n = rte_sched_port_dequeue(port, out_mbufs, n_pkts);
+
+	for (i = 0; i < n; i++) {
+		uint32_t subport, pipe, traffic_class, queue;
+
+		rte_sched_port_pkt_read_tree_path(out_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+		*n_pipe_pkts += (pipe == pipe_id);
+		*n_queue_pkts += (queue == queue_id);
+		rte_pktmbuf_free(out_mbufs[i]);
+	}
+
+	return n;
+}
+
+/**
+ * pipe profile add and modify on a live port, bulk pipe statistics
+ */
+static int
+test_sched_profile(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params;
+	struct rte_sched_pipe_params profile = pipe_profile[0];
+	struct rte_sched_pipe_stats pipe_stats[2];
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[PROFILE_WRR_PKTS];
+	uint32_t profile_id, n_pipe_pkts, n_queue_pkts, n_queue_pkts_old;
+	int i, err;
+
+	init_port_params(&params, "test_profile");
+
+	port = rte_sched_port_config(&params);
+	VERIFY(port != NULL, "Error config sched port\n");
+
+	if (config_subport_pipes(port, SUBPORT, params.n_pipes_per_subport) != 0)
+		return -1;
+
+	/* New slow profile, assigned to a pipe of the running port: its token bucket
+	 * starts half full with credits for 2 frames and gains 1 frame per 250 ms */
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+		profile.tc_rate[i] = 4 * PROFILE_FRAME;
+	profile.tb_rate = 4 * PROFILE_FRAME;
+	profile.tb_size = 4 * PROFILE_FRAME;
+	profile.tc_period = 1000;
+	err = rte_sched_port_pipe_profile_add(port, &profile, &profile_id);
+	VERIFY(err == 0, "Error adding pipe profile, err=%d\n", err);
+	VERIFY(profile_id == 1, "Wrong pipe profile ID %u\n", profile_id);
+
+	err = rte_sched_pipe_config(port, SUBPORT, PIPE + 1, (int32_t) profile_id);
+	VERIFY(err == 0, "Error config sched pipe with new profile, err=%d\n", err);
+
+	err = rte_sched_port_pipe_profile_modify(port, profile_id + 1, &profile);
+	VERIFY(err != 0, "Modified a pipe profile that does not exist\n");
+
+	profile.tb_rate = 0;
+	err = rte_sched_port_pipe_profile_add(port, &profile, &profile_id);
+	VERIFY(err != 0, "Added an invalid pipe profile\n");
+
+	if (enqueue_pkts(mp, port, in_mbufs, PROFILE_PKTS, SUBPORT, 2,
+			TC, QUEUE, 1) != 0)
+		return -1;
+
+	err = rte_sched_pipe_read_stats_bulk(port, SUBPORT, PIPE, 2, pipe_stats);
+#ifdef RTE_SCHED_COLLECT_STATS
+	VERIFY(err == 0, "Error reading pipe stats, err=%d\n", err);
+	VERIFY(pipe_stats[0].n_pkts_tc[TC] == PROFILE_PKTS / 2, "Wrong pipe stats\n");
+	VERIFY(pipe_stats[1].n_pkts_tc[TC] == PROFILE_PKTS / 2, "Wrong pipe stats\n");
+#else
+	VERIFY(err == -ENOTSUP, "Pipe stats read without stats collection, err=%d\n", err);
+#endif
+	err = rte_sched_pipe_read_stats_bulk(port, SUBPORT, params.n_pipes_per_subport - 1, 2, pipe_stats);
+	VERIFY(err != 0, "Pipe stats read past the last pipe\n");
+
+	/* The pipe with the new profile runs out of credits after 2 frames */
+	err = dequeue_pkts(port, PROFILE_PKTS, PIPE + 1, QUEUE, &n_pipe_pkts, &n_queue_pkts);
+	VERIFY(err == PROFILE_PKTS - 2, "Wrong dequeue, err=%d\n", err);
+	VERIFY(n_pipe_pkts == 2, "Wrong dequeue from the new profile pipe, %u pkts\n", n_pipe_pkts);
+
+	/* Modified profile, the pipe using it is released at its next refill */
+	profile = pipe_profile[0];
+	profile.tb_rate = params.rate;
+	err = rte_sched_port_pipe_profile_modify(port, profile_id, &profile);
+	VERIFY(err == 0, "Error modifying pipe profile, err=%d\n", err);
+
+	err = dequeue_pkts(port, PROFILE_PKTS, PIPE + 1, QUEUE, &n_pipe_pkts, &n_queue_pkts);
+	VERIFY(err == 2, "Wrong dequeue after profile modify, err=%d\n", err);
+	VERIFY(n_pipe_pkts == 2, "Wrong dequeue from the modified profile pipe, %u pkts\n", n_pipe_pkts);
+
+	/* Equal WRR weights: the queues of the traffic class take turns */
+	if (enqueue_pkts(mp, port, in_mbufs, PROFILE_WRR_PKTS, SUBPORT, 1,
+			TC, 0, RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS) != 0)
+		return -1;
+
+	err = dequeue_pkts(port, PROFILE_PKTS, PIPE, QUEUE, &n_pipe_pkts, &n_queue_pkts_old);
+	VERIFY(err == PROFILE_PKTS, "Wrong dequeue, err=%d\n", err);
+	err = dequeue_pkts(port, PROFILE_WRR_PKTS, PIPE, QUEUE, &n_pipe_pkts, &n_queue_pkts);
+	VERIFY(err == PROFILE_WRR_PKTS - PROFILE_PKTS, "Wrong dequeue, err=%d\n", err);
+
+	/* Modified WRR weight: the heavier queue gets a larger share */
+	profile = pipe_profile[0];
+	profile.tc_period = 2 * pipe_profile[0].tc_period;
+	profile.wrr_weights[TC * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + QUEUE] = 4;
+	err = rte_sched_port_pipe_profile_modify(port, 0, &profile);
+	VERIFY(err == 0, "Error modifying pipe profile, err=%d\n", err);
+
+	if (enqueue_pkts(mp, port, in_mbufs, PROFILE_WRR_PKTS, SUBPORT, 1,
+			TC, 0, RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS) != 0)
+		return -1;
+
+	err = dequeue_pkts(port, PROFILE_PKTS, PIPE, QUEUE, &n_pipe_pkts, &n_queue_pkts);
+	VERIFY(err == PROFILE_PKTS, "Wrong dequeue, err=%d\n", err);
+	VERIFY(n_queue_pkts > n_queue_pkts_old,
+		"WRR weight change ignored, %u pkts of queue %u before, %u after\n",
+		n_queue_pkts_old, QUEUE, n_queue_pkts);
+	err = dequeue_pkts(port, PROFILE_WRR_PKTS, PIPE, QUEUE, &n_pipe_pkts, &n_queue_pkts);
+	VERIFY(err == PROFILE_WRR_PKTS - PROFILE_PKTS, "Wrong dequeue, err=%d\n", err);
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
+#define GROUP_SHARDS     2
+#define GROUP_PKTS       8
+
+/**
+ * port group: subports sharded across two schedulers merged into one port
+ */
+static int
+test_sched_group(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params;
+	struct rte_sched_port_group *group;
+	struct rte_mbuf *in_mbufs[GROUP_PKTS];
+	struct rte_mbuf *out_mbufs[GROUP_SHARDS * GROUP_PKTS];
+	uint32_t n_subport_pkts[GROUP_SHARDS] = {0};
+	uint32_t subport, pipe, shard;
+	int i, err;
+
+	init_port_params(&params, "test_group");
+	params.n_subports_per_port = GROUP_SHARDS;
+
+	VERIFY(rte_sched_port_group_config(&params, 3) == NULL,
+		"Port group accepted a non power of 2 shard count\n");
+	VERIFY(rte_sched_port_group_config(&params, 2 * GROUP_SHARDS) == NULL,
+		"Port group accepted more shards than subports\n");
+
+	group = rte_sched_port_group_config(&params, GROUP_SHARDS);
+	VERIFY(group != NULL, "Error config sched port group\n");
+
+	for (subport = 0; subport < GROUP_SHARDS; subport ++) {
+		struct rte_sched_port *port;
+
+		err = rte_sched_port_group_shard_id(group, subport);
+		VERIFY(err == (int) subport, "Wrong shard %d for subport %u\n", err, subport);
+		port = rte_sched_port_group_shard(group, (uint32_t) err);
+
+		/* Subports owned by another shard are rejected */
+		err = rte_sched_subport_config(port, subport ^ 1, subport_param);
+		VERIFY(err != 0, "Shard %u configured a foreign subport\n", subport);
+
+		if (config_subport_pipes(port, subport, params.n_pipes_per_subport) != 0)
+			return -1;
+
+		if (enqueue_pkts(mp, port, in_mbufs, GROUP_PKTS, subport, 1,
+				TC, QUEUE, 1) != 0)
+			return -1;
+	}
+
+	VERIFY(rte_sched_port_group_shard_dequeue(NULL, 0, GROUP_PKTS) == -1,
+		"Shard dequeue accepted a NULL group\n");
+	VERIFY(rte_sched_port_group_shard_dequeue(group, GROUP_SHARDS, GROUP_PKTS) == -1,
+		"Shard dequeue accepted an invalid shard\n");
+
+	for (shard = 0; shard < GROUP_SHARDS; shard ++) {
+		err = rte_sched_port_group_shard_dequeue(group, shard, GROUP_PKTS);
+		VERIFY(err == GROUP_PKTS, "Wrong shard dequeue, err=%d\n", err);
+	}
+
+	err = rte_sched_port_group_dequeue(group, out_mbufs, GROUP_SHARDS * GROUP_PKTS);
+	VERIFY(err == GROUP_SHARDS * GROUP_PKTS, "Wrong merge dequeue, err=%d\n", err);
+
+	for (i = 0; i < GROUP_SHARDS * GROUP_PKTS; i++) {
+		uint32_t traffic_class, queue;
+
+		rte_sched_port_pkt_read_tree_path(out_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+		VERIFY(subport < GROUP_SHARDS, "Wrong subport\n");
+		VERIFY(pipe == PIPE, "Wrong pipe\n");
+		n_subport_pkts[subport] ++;
+		rte_pktmbuf_free(out_mbufs[i]);
+	}
+
+	for (subport = 0; subport < GROUP_SHARDS; subport ++) {
+		VERIFY(n_subport_pkts[subport] == GROUP_PKTS,
+			"Wrong packet count for subport %u\n", subport);
+	}
+
+	err = rte_sched_port_group_dequeue(group, out_mbufs, 1);
+	VERIFY(err == 0, "Merge stage not empty, err=%d\n", err);
+
+	rte_sched_port_group_free(group);
+
+	return 0;
+}
 
 /**
  * test main entrance for library sched
@@ -224,7 +559,15 @@ test_sched(void)
 
 	rte_sched_port_free(port);
 
-	return 0;
+	err = test_sched_layout(mp);
+	if (err != 0)
+		return err;
+
+	err = test_sched_profile(mp);
+	if (err != 0)
+		return err;
+
+	return test_sched_group(mp);
 }
 
 static struct test_command sched_cmd = {
@@ -112,6 +112,18 @@
  *      - At initialization, timer3 is loaded by the master core, on
  *        another core in "periodical" mode (time = 1 second).
  *      - It is stopped at t=25s by timer2.
+ *
+ * #. Wheel test.
+ *
+ *    This test checks the timer wheel backend on the master core.
+ *
+ *    - Timers are loaded with delays around the boundaries of the wheel
+ *      levels, so that they get cascaded between levels.
+ *    - One timer is stopped and one is reloaded before they expire, one
+ *      periodical timer stops itself after three callbacks.
+ *    - rte_timer_manage() is called until all timers are expected to have
+ *      expired, and each callback must have run the expected number of
+ *      times, not before the timer expiry and at most a few ticks after.
  */
 
 #include <stdio.h>
@@ -419,6 +431,111 @@ timer_basic_main_loop(__attribute__((unused)) void *arg)
 	return 0;
 }
 
+#define WHEEL_TIMER_LATE	20 /* max ticks a wheel timer can be late */
+
+struct wheel_timer_info {
+	struct rte_timer tim;
+	uint64_t expire;
+	uint64_t period;
+	unsigned count;
+	unsigned max_count;
+	int error;
+};
+
+static void
+timer_wheel_cb(struct rte_timer *tim, void *arg)
+{
+	struct wheel_timer_info *info = arg;
+	uint64_t cur_time = rte_get_timer_cycles();
+	uint64_t tick = rte_get_timer_hz() / 1000;
+
+	if (cur_time < info->expire ||
+			cur_time > info->expire + WHEEL_TIMER_LATE * tick) {
+		printf("Wheel timer expired at %"PRIu64", expected %"PRIu64"\n",
+			cur_time, info->expire);
+		info->error = 1;
+	}
+
+	info->expire += info->period;
+	if (++info->count == info->max_count)
+		rte_timer_stop(tim);
+}
+
+/* check timer wheel expiry, with a one millisecond tick */
+static int
+timer_wheel_check(void)
+{
+	static const uint64_t delays[] = {
+		0, 1, 5, 63, 64, 65, 100, 1000, 4095, 4096, 4097,
+	};
+	struct wheel_timer_info info[RTE_DIM(delays) + 3];
+	struct wheel_timer_info *stopped, *reloaded, *periodic;
+	uint64_t tick, cur_time, end;
+	unsigned i, lcore_id;
+	int ret;
+
+	lcore_id = rte_lcore_id();
+	tick = rte_get_timer_hz() / 1000;
+	if (rte_timer_subsystem_init_backend(RTE_TIMER_BACKEND_WHEEL,
+			tick) != 0) {
+		printf("Cannot init timer wheel\n");
+		return -1;
+	}
+
+	memset(info, 0, sizeof(info));
+	cur_time = rte_get_timer_cycles();
+
+	for (i = 0; i != RTE_DIM(info); i++) {
+		rte_timer_init(&info[i].tim);
+		info[i].max_count = 1;
+	}
+
+	for (i = 0; i != RTE_DIM(delays); i++) {
+		info[i].expire = cur_time + delays[i] * tick;
+		rte_timer_reset(&info[i].tim, delays[i] * tick, SINGLE,
+			lcore_id, timer_wheel_cb, &info[i]);
+	}
+
+	stopped = &info[i++];
+	rte_timer_reset(&stopped->tim, 10 * tick, SINGLE, lcore_id,
+		timer_wheel_cb, stopped);
+	stopped->max_count = 0;
+
+	reloaded = &info[i++];
+	rte_timer_reset(&reloaded->tim, 3000 * tick, SINGLE, lcore_id,
+		timer_wheel_cb, reloaded);
+	reloaded->expire = rte_get_timer_cycles() + 200 * tick;
+	rte_timer_reset(&reloaded->tim, 200 * tick, SINGLE, lcore_id,
+		timer_wheel_cb, reloaded);
+
+	periodic = &info[i++];
+	periodic->period = 70 * tick;
+	periodic->max_count = 3;
+	periodic->expire = rte_get_timer_cycles() + periodic->period;
+	rte_timer_reset(&periodic->tim, periodic->period, PERIODICAL,
+		lcore_id, timer_wheel_cb, periodic);
+
+	rte_timer_stop(&stopped->tim);
+
+	end = cur_time + (4097 + 2 * WHEEL_TIMER_LATE) * tick;
+	while (rte_get_timer_cycles() < end)
+		rte_timer_manage();
+
+	ret = 0;
+	for (i = 0; i != RTE_DIM(info); i++) {
+		if (info[i].error != 0 || info[i].count != info[i].max_count ||
+				rte_timer_pending(&info[i].tim)) {
+			printf("Wheel timer %u: %u callbacks, expected %u\n",
+				i, info[i].count, info[i].max_count);
+			ret = -1;
+		}
+		rte_timer_stop_sync(&info[i].tim);
+	}
+
+	rte_timer_subsystem_init();
+	return ret;
+}
+
 static int
 timer_sanity_check(void)
 {
@@ -469,6 +586,11 @@ test_timer(void)
 		return -1;
 	}
 
+	if (timer_wheel_check() < 0) {
+		printf("Timer wheel checks failed\n");
+		return -1;
+	}
+
 	if (rte_lcore_count() < 2) {
 		printf("not enough lcores for this test\n");
 		return -1;
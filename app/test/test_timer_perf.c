@@ -61,8 +61,12 @@ timer_cb(struct rte_timer *t __rte_unused, void *param __rte_unused)
 #define do_delay() rte_pause()
 #endif
 
+/*
+ * tick is the resolution of the timer wheel, timers may expire up to
+ * one tick late.
+ */
 static int
-test_timer_perf(void)
+timer_perf(uint64_t tick)
 {
 	unsigned iterations = 100;
 	unsigned i;
@@ -71,6 +75,10 @@ test_timer_perf(void)
 	unsigned lcore_id = rte_lcore_id();
 
 	tms = rte_malloc(NULL, sizeof(*tms) * MAX_ITERATIONS, 0);
+	if (tms == NULL) {
+		printf("Cannot allocate timers\n");
+		return -1;
+	}
 
 	for (i = 0; i < MAX_ITERATIONS; i++)
 		rte_timer_init(&tms[i]);
@@ -94,7 +102,7 @@ test_timer_perf(void)
 				((end_tsc-start_tsc)/iterations+ticks_per_us/2)/(ticks_per_us));
 		outstanding_count = iterations;
 		delay_start = rte_get_timer_cycles();
-		while (rte_get_timer_cycles() < delay_start + ticks)
+		while (rte_get_timer_cycles() < delay_start + ticks + tick)
 			do_delay();
 
 		start_tsc = rte_rdtsc();
@@ -121,12 +129,13 @@ test_timer_perf(void)
 		outstanding_count = iterations;
 
 		delay_start = rte_get_timer_cycles();
-		while (rte_get_timer_cycles() < delay_start + ticks)
+		while (rte_get_timer_cycles() < delay_start + ticks + tick)
 			do_delay();
 
 		rte_timer_manage();
 		if (outstanding_count != 0) {
 			printf("Error: outstanding callback count = %d\n", outstanding_count);
+			rte_free(tms);
 			return -1;
 		}
 
@@ -155,9 +164,32 @@ test_timer_perf(void)
 	printf("Time per rte_timer_manage with zero callbacks: %"PRIu64" cycles\n",
 			(end_tsc - start_tsc + iterations/2) / iterations);
 
+	rte_timer_stop_sync(&tms[0]);
+	rte_free(tms);
 	return 0;
 }
 
+static int
+test_timer_perf(void)
+{
+	uint64_t tick;
+	int ret;
+
+	printf("Skiplist timers\n");
+	if (timer_perf(0) != 0)
+		return -1;
+
+	/* one millisecond wheel */
+	tick = rte_get_timer_hz() / 1000;
+	rte_timer_subsystem_init_backend(RTE_TIMER_BACKEND_WHEEL, tick);
+
+	printf("\nTimer wheel\n");
+	ret = timer_perf(tick);
+
+	rte_timer_subsystem_init();
+	return ret;
+}
+
 static struct test_command timer_perf_cmd = {
 	.command = "timer_perf_autotest",
 	.callback = test_timer_perf,
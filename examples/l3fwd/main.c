@@ -707,7 +707,7 @@ get_ipv6_dst_port(void *ipv6_hdr,  uint8_t portid, lookup_struct_t * ipv6_l3fwd_
 static inline uint8_t
 get_ipv4_dst_port(void *ipv4_hdr,  uint8_t portid, lookup_struct_t * ipv4_l3fwd_lookup_struct)
 {
-	uint8_t next_hop;
+	uint32_t next_hop;
 
 	return (uint8_t) ((rte_lpm_lookup(ipv4_l3fwd_lookup_struct,
 		rte_be_to_cpu_32(((struct ipv4_hdr *)ipv4_hdr)->dst_addr),
@@ -1070,25 +1070,26 @@ static inline __attribute__((always_inline)) uint16_t
 get_dst_port(const struct lcore_conf *qconf, struct rte_mbuf *pkt,
 	uint32_t dst_ipv4, uint8_t portid)
 {
-	uint8_t next_hop;
+	uint32_t next_hop_ipv4;
+	uint8_t next_hop_ipv6;
 	struct ipv6_hdr *ipv6_hdr;
 	struct ether_hdr *eth_hdr;
 
 	if (pkt->ol_flags & PKT_RX_IPV4_HDR) {
 		if (rte_lpm_lookup(qconf->ipv4_lookup_struct, dst_ipv4,
-				&next_hop) != 0)
-			next_hop = portid;
+				&next_hop_ipv4) != 0)
+			next_hop_ipv4 = portid;
+		return next_hop_ipv4;
 	} else if (pkt->ol_flags & PKT_RX_IPV6_HDR) {
 		eth_hdr = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
 		ipv6_hdr = (struct ipv6_hdr *)(eth_hdr + 1);
 		if (rte_lpm6_lookup(qconf->ipv6_lookup_struct,
-				ipv6_hdr->dst_addr, &next_hop) != 0)
-			next_hop = portid;
-	} else {
-		next_hop = portid;
+				ipv6_hdr->dst_addr, &next_hop_ipv6) != 0)
+			next_hop_ipv6 = portid;
+		return next_hop_ipv6;
 	}
 
-	return next_hop;
+	return portid;
 }
 
 static inline void
@@ -1168,7 +1169,11 @@ processx4_step2(const struct lcore_conf *qconf, __m128i dip, uint32_t flag,
 
 	/* if all 4 packets are IPV4. */
 	if (likely(flag != 0)) {
-		rte_lpm_lookupx4(qconf->ipv4_lookup_struct, dip, dprt, portid);
+		rte_lpm_lookupx4(qconf->ipv4_lookup_struct, dip, dst.u32,
+			portid);
+		/* get rid of unused upper 16 bit for each dport. */
+		dst.m = _mm_packs_epi32(dst.m, dst.m);
+		*(uint64_t *)dprt = dst.u64[0];
 	} else {
 		dst.m = dip;
 		dprt[0] = get_dst_port(qconf, pkt[0], dst.u32[0], portid);
@@ -43,6 +43,7 @@
 
 /* variable for dividing rule sets */
 #define NODE_MAX	2500
+#define NODE_MIN	64
 #define NODE_PERCENTAGE	(0.40)
 #define RULE_PERCENTAGE	(0.40)
 
@@ -105,6 +106,8 @@ struct acl_build_context {
 	uint32_t                  src_mask;
 	uint32_t                  num_build_rules;
 	uint32_t                  num_tries;
+	uint32_t                  max_tries;
+	uint32_t                  node_max;
 	struct tb_mem_pool        pool;
 	struct rte_acl_trie       tries[RTE_ACL_MAX_TRIES];
 	struct rte_acl_bld_trie   bld_tries[RTE_ACL_MAX_TRIES];
@@ -1314,7 +1317,7 @@ acl_gen_mask_trie(struct acl_build_context *context,
 
 static struct rte_acl_node *
 build_trie(struct acl_build_context *context, struct rte_acl_build_rule *head,
-	struct rte_acl_build_rule **last, uint32_t *count)
+	struct rte_acl_build_rule **last, uint32_t *count, int node_max)
 {
 	uint32_t n, m;
 	int field_index, node_count;
@@ -1447,7 +1450,7 @@ build_trie(struct acl_build_context *context, struct rte_acl_build_rule *head,
 			return NULL;
 
 		node_count = context->num_nodes - node_count;
-		if (node_count > NODE_MAX) {
+		if (node_count > node_max) {
 			*last = prev;
 			return trie;
 		}
@@ -1752,7 +1755,7 @@ static int
 acl_build_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *head)
 {
-	int32_t rc;
+	int32_t rc, node_max;
 	uint32_t n, m, num_tries;
 	struct rte_acl_config *config;
 	struct rte_acl_build_rule *last, *rule;
@@ -1782,7 +1785,7 @@ acl_build_tries(struct acl_build_context *context,
 	n = acl_rule_stats(head, config, &wild_limit[0]);
 
 	/* put all rules that fit the wildness criteria into a seperate trie */
-	while (n > 0 && num_tries < RTE_ACL_MAX_TRIES) {
+	while (n > 0 && num_tries < context->max_tries) {
 
 		struct rte_acl_config *new_config;
 		struct rte_acl_build_rule **prev = &rule_sets[num_tries - 1];
@@ -1829,10 +1832,14 @@ acl_build_tries(struct acl_build_context *context,
 
 	if (n > 0)
 		RTE_LOG(DEBUG, ACL,
-			"Number of tries(%d) exceeded.\n", RTE_ACL_MAX_TRIES);
+			"Number of tries(%u) exceeded.\n", context->max_tries);
 
 	for (n = 0; n < num_tries; n++) {
 
+		/* the last allowed trie takes all remaining rules. */
+		node_max = (num_tries < context->max_tries) ?
+			context->node_max : INT32_MAX;
+
 		rule_sets[n] = sort_rules(rule_sets[n]);
 		context->tries[n].type = RTE_ACL_FULL_TRIE;
 		context->tries[n].count = 0;
@@ -1843,7 +1850,7 @@ acl_build_tries(struct acl_build_context *context,
 
 		context->bld_tries[n].trie =
 				build_trie(context, rule_sets[n],
-				&last, &context->tries[n].count);
+				&last, &context->tries[n].count, node_max);
 		if (context->bld_tries[n].trie == NULL) {
 			RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
 			return -ENOMEM;
@@ -1857,7 +1864,8 @@ acl_build_tries(struct acl_build_context *context,
 
 			context->bld_tries[n].trie =
 					build_trie(context, rule_sets[n],
-					&last, &context->tries[n].count);
+					&last, &context->tries[n].count,
+					node_max);
 			if (context->bld_tries[n].trie == NULL) {
 				RTE_LOG(ERR, ACL,
 					"Build of %u-th trie failed\n", n);
@@ -1953,43 +1961,44 @@ acl_set_data_indexes(struct rte_acl_ctx *ctx)
 }
 
 
-int
-rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
+static int
+acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
+	const struct rte_acl_config *cfg, uint32_t max_tries, uint32_t node_max)
 {
 	int rc;
-	struct acl_build_context bcx;
-
-	if (ctx == NULL || cfg == NULL || cfg->num_categories == 0 ||
-			cfg->num_categories > RTE_ACL_MAX_CATEGORIES)
-		return -EINVAL;
-
-	acl_build_reset(ctx);
-
-	memset(&bcx, 0, sizeof(bcx));
-	bcx.acx = ctx;
-	bcx.pool.alignment = ACL_POOL_ALIGN;
-	bcx.pool.min_alloc = ACL_POOL_ALLOC_MIN;
-	bcx.cfg = *cfg;
-	bcx.category_mask = LEN2MASK(bcx.cfg.num_categories);
+	uint32_t i, n;
 
+	memset(bcx, 0, sizeof(*bcx));
+	bcx->acx = ctx;
+	bcx->pool.alignment = ACL_POOL_ALIGN;
+	bcx->pool.min_alloc = ACL_POOL_ALLOC_MIN;
+	bcx->cfg = *cfg;
+	bcx->category_mask = LEN2MASK(bcx->cfg.num_categories);
+	bcx->max_tries = max_tries;
+	bcx->node_max = node_max;
 
 	/* Create a build rules copy. */
-	rc = acl_build_rules(&bcx);
+	rc = acl_build_rules(bcx);
 	if (rc != 0)
 		return rc;
 
 	/* No rules to build for that context+config */
-	if (bcx.build_rules == NULL) {
+	if (bcx->build_rules == NULL) {
 		rc = -EINVAL;
 
 	/* build internal trie representation. */
-	} else if ((rc = acl_build_tries(&bcx, bcx.build_rules)) == 0) {
+	} else if ((rc = acl_build_tries(bcx, bcx->build_rules)) == 0) {
+
+		/* space for data indexes of all tries. */
+		n = 0;
+		for (i = 0; i != bcx->num_tries; i++)
+			n += bcx->tries[i].num_data_indexes;
 
 		/* allocate and fill run-time  structures. */
-		rc = rte_acl_gen(ctx, bcx.tries, bcx.bld_tries,
-				bcx.num_tries, bcx.cfg.num_categories,
-				RTE_ACL_IPV4VLAN_NUM * RTE_DIM(bcx.tries),
-				bcx.num_build_rules);
+		rc = rte_acl_gen(ctx, bcx->tries, bcx->bld_tries,
+				bcx->num_tries, bcx->cfg.num_categories,
+				n * sizeof(ctx->data_indexes[0]),
+				bcx->num_build_rules, cfg->max_size);
 		if (rc == 0) {
 
 			/* set data indexes. */
@@ -1997,12 +2006,45 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 
 			/* copy in build config. */
 			ctx->config = *cfg;
+
+			ctx->stats.node_max = node_max;
+			ctx->stats.build_size = bcx->pool.alloc;
 		}
 	}
 
-	acl_build_log(&bcx);
+	acl_build_log(bcx);
+	return rc;
+}
+
+int
+rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
+{
+	int rc;
+	uint32_t max_tries, node_max;
+	struct acl_build_context bcx;
+
+	if (ctx == NULL || cfg == NULL || cfg->num_categories == 0 ||
+			cfg->num_categories > RTE_ACL_MAX_CATEGORIES ||
+			cfg->max_tries > RTE_ACL_MAX_TRIES)
+		return -EINVAL;
+
+	max_tries = (cfg->max_tries == 0) ? RTE_ACL_MAX_TRIES : cfg->max_tries;
+
+	acl_build_reset(ctx);
+
+	/*
+	 * If RT structures exceed max_size, split the rules into smaller
+	 * tries and try again, while there are tries left to split into.
+	 */
+	node_max = NODE_MAX;
+	do {
+		rc = acl_bld(&bcx, ctx, cfg, max_tries, node_max);
+
+		/* cleanup after build. */
+		tb_free_pool(&bcx.pool);
+		node_max /= 2;
+	} while (rc == -ERANGE && bcx.num_tries < max_tries &&
+		node_max >= NODE_MIN);
 
-	/* cleanup after build. */
-	tb_free_pool(&bcx.pool);
 	return rc;
 }
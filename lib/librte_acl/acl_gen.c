@@ -368,19 +368,35 @@ static int
 acl_calc_counts_indices(struct acl_node_counters *counts,
 	struct rte_acl_indices *indices, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	int match_num)
+	int match_num, struct rte_acl_trie_stats *stats)
 {
-	uint32_t n;
+	uint32_t n, trans;
+	struct acl_node_counters prev;
 
 	memset(indices, 0, sizeof(*indices));
 	memset(counts, 0, sizeof(*counts));
 
 	/* Get stats on nodes */
 	for (n = 0; n < num_tries; n++) {
+		prev = *counts;
 		counts->smallest_match = INT32_MAX;
 		match_num = acl_count_trie_types(counts, node_bld_trie[n].trie,
 			match_num, 1);
 		trie[n].smallest = counts->smallest_match;
+
+		/* nodes shared with previous tries are counted only once. */
+		trans = (counts->dfa - prev.dfa) * RTE_ACL_DFA_SIZE +
+			counts->quad_vectors - prev.quad_vectors +
+			counts->single - prev.single;
+		stats[n].num_rules = trie[n].count;
+		stats[n].num_nodes = counts->dfa - prev.dfa +
+			counts->quad - prev.quad +
+			counts->single - prev.single +
+			counts->match - prev.match;
+		stats[n].num_trans = trans;
+		stats[n].size = trans * sizeof(uint64_t) +
+			(counts->match - prev.match) *
+			sizeof(struct rte_acl_match_results);
 	}
 
 	indices->dfa_index = RTE_ACL_DFA_SIZE + 1;
@@ -400,7 +416,8 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 int
 rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint32_t num_categories, uint32_t data_index_sz, int match_num)
+	uint32_t num_categories, uint32_t data_index_sz, int match_num,
+	size_t max_size)
 {
 	void *mem;
 	size_t total_size;
@@ -409,10 +426,11 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_match_results *match;
 	struct acl_node_counters counts;
 	struct rte_acl_indices indices;
+	struct rte_acl_trie_stats stats[RTE_ACL_MAX_TRIES];
 
 	/* Fill counts and indices arrays from the nodes. */
 	match_num = acl_calc_counts_indices(&counts, &indices, trie,
-		node_bld_trie, num_tries, match_num);
+		node_bld_trie, num_tries, match_num, stats);
 
 	/* Allocate runtime memory (align to cache boundary) */
 	total_size = RTE_ALIGN(data_index_sz, RTE_CACHE_LINE_SIZE) +
@@ -420,6 +438,13 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 		(match_num + 2) * sizeof(struct rte_acl_match_results) +
 		XMM_SIZE;
 
+	if (max_size != 0 && total_size > max_size) {
+		RTE_LOG(DEBUG, ACL, "Gen phase for ACL \"%s\": "
+			"runtime memory footprint %zu bytes exceeds %zu bytes\n",
+			ctx->name, total_size, max_size);
+		return -ERANGE;
+	}
+
 	mem = rte_zmalloc_socket(ctx->name, total_size, RTE_CACHE_LINE_SIZE,
 			ctx->socket_id);
 	if (mem == NULL) {
@@ -469,6 +494,9 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	ctx->idle = node_array[RTE_ACL_DFA_SIZE];
 	ctx->trans_table = node_array;
 	memcpy(ctx->trie, trie, sizeof(ctx->trie));
+	ctx->stats.num_tries = num_tries;
+	ctx->stats.size = total_size;
+	memcpy(ctx->stats.trie, stats, num_tries * sizeof(stats[0]));
 
 	acl_gen_log_stats(ctx, &counts);
 	return 0;
@@ -0,0 +1,322 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "acl_run_sse.h"
+
+/*
+ * The AVX2 engine keeps 8 transitions in two YMM registers, slots 0-3 in the
+ * first one and slots 4-7 in the second one. Splitting them into their low
+ * (node index and type) and high (quad range boundaries) 32 bits is done by
+ * a per-lane shuffle, which leaves the slots in the order
+ * {0, 1, 4, 5, 2, 3, 6, 7}. Input bytes are loaded in that same order, and
+ * the addresses are put back in slot order before gathering the next
+ * transitions.
+ */
+
+static const rte_ymm_t ymm_type_quad_range = {
+	.u32 = {
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+	},
+};
+
+static const rte_ymm_t ymm_shuffle_input = {
+	.u32 = {
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+	},
+};
+
+static const rte_ymm_t ymm_ones_16 = {
+	.u16 = {
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+	},
+};
+
+static const rte_ymm_t ymm_bytes = {
+	.u32 = {
+		UINT8_MAX, UINT8_MAX, UINT8_MAX, UINT8_MAX,
+		UINT8_MAX, UINT8_MAX, UINT8_MAX, UINT8_MAX,
+	},
+};
+
+static const rte_ymm_t ymm_match_mask = {
+	.u32 = {
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+	},
+};
+
+static const rte_ymm_t ymm_index_mask = {
+	.u32 = {
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+	},
+};
+
+/* {0, 1, 4, 5, 2, 3, 6, 7} <-> {0, 1, 2, 3, 4, 5, 6, 7} */
+static const rte_ymm_t ymm_slot_order = {
+	.u32 = {0, 1, 4, 5, 2, 3, 6, 7},
+};
+
+/*
+ * Gather 4 bytes of input data for 8 streams, in the shuffled slot order.
+ */
+#define	GET_NEXT_4BYTES_X8(prm, idx)				\
+	_mm256_set_epi32(					\
+		GET_NEXT_4BYTES(prm, (idx) + 7),		\
+		GET_NEXT_4BYTES(prm, (idx) + 6),		\
+		GET_NEXT_4BYTES(prm, (idx) + 3),		\
+		GET_NEXT_4BYTES(prm, (idx) + 2),		\
+		GET_NEXT_4BYTES(prm, (idx) + 5),		\
+		GET_NEXT_4BYTES(prm, (idx) + 4),		\
+		GET_NEXT_4BYTES(prm, (idx) + 1),		\
+		GET_NEXT_4BYTES(prm, (idx) + 0))
+
+/*
+ * Extract transitions from 2 YMM registers and check for any matches
+ */
+static void
+acl_process_matches_avx2x8(int slot, const struct rte_acl_ctx *ctx,
+	struct parms *parms, struct acl_flow_data *flows,
+	ymm_t *indices1, ymm_t *indices2)
+{
+	uint64_t transitions[MAX_SEARCHES_SSE8];
+	uint32_t n;
+
+	_mm256_storeu_si256((ymm_t *)&transitions[0], *indices1);
+	_mm256_storeu_si256((ymm_t *)&transitions[4], *indices2);
+
+	for (n = 0; n < RTE_DIM(transitions); n++)
+		transitions[n] = acl_match_check(transitions[n], slot + n,
+			ctx, parms, flows, resolve_priority_sse);
+
+	/* update indices with new transitions. */
+	*indices1 = _mm256_loadu_si256((const ymm_t *)&transitions[0]);
+	*indices2 = _mm256_loadu_si256((const ymm_t *)&transitions[4]);
+}
+
+/*
+ * Check for any match in 8 transitions (contained in 2 YMM registers)
+ */
+static inline void
+acl_match_check_avx2x8(int slot, const struct rte_acl_ctx *ctx,
+	struct parms *parms, struct acl_flow_data *flows,
+	ymm_t *indices1, ymm_t *indices2)
+{
+	ymm_t temp;
+
+	/* put low 32 bits of each transition into one register */
+	temp = (ymm_t)_mm256_shuffle_ps((__m256)*indices1, (__m256)*indices2,
+		0x88);
+	/* test for match node */
+	temp = _mm256_and_si256(ymm_match_mask.m, temp);
+
+	while (!_mm256_testz_si256(temp, temp)) {
+		acl_process_matches_avx2x8(slot, ctx, parms, flows,
+			indices1, indices2);
+
+		temp = (ymm_t)_mm256_shuffle_ps((__m256)*indices1,
+			(__m256)*indices2, 0x88);
+		temp = _mm256_and_si256(ymm_match_mask.m, temp);
+	}
+}
+
+/*
+ * Process 8 transitions (in 2 YMM registers) in parallel.
+ * Same as transition4() for SSE, with hardware gathers of the next
+ * transitions.
+ */
+static inline ymm_t
+transition8(ymm_t next_input, const uint64_t *trans,
+	ymm_t *indices1, ymm_t *indices2)
+{
+	ymm_t addr, node_types, range, temp;
+
+	/* Split transitions into node indexes and range boundaries. */
+	temp = (ymm_t)_mm256_shuffle_ps((__m256)*indices1, (__m256)*indices2,
+		0x88);
+	range = (ymm_t)_mm256_shuffle_ps((__m256)*indices1, (__m256)*indices2,
+		0xdd);
+
+	/* Calc node type and node addr */
+	node_types = _mm256_andnot_si256(ymm_index_mask.m, temp);
+	addr = _mm256_and_si256(ymm_index_mask.m, temp);
+
+	/*
+	 * Calc addr for DFAs - addr = dfa_index + input_byte
+	 */
+
+	/* mask for DFA type (0) nodes */
+	temp = _mm256_cmpeq_epi32(node_types, _mm256_setzero_si256());
+
+	/* add input byte to DFA position */
+	temp = _mm256_and_si256(temp, ymm_bytes.m);
+	temp = _mm256_and_si256(temp, next_input);
+	addr = _mm256_add_epi32(addr, temp);
+
+	/*
+	 * Calc addr for Range nodes -> range_index + range(input)
+	 */
+	node_types = _mm256_cmpeq_epi32(node_types, ymm_type_quad_range.m);
+
+	/* shuffle input byte to all 4 positions of 32 bit value */
+	temp = _mm256_shuffle_epi8(next_input, ymm_shuffle_input.m);
+
+	/* count range boundaries that are less than the input byte */
+	temp = _mm256_cmpgt_epi8(temp, range);
+	temp = _mm256_sign_epi8(temp, temp);
+	temp = _mm256_maddubs_epi16(temp, temp);
+	temp = _mm256_madd_epi16(temp, ymm_ones_16.m);
+
+	/* mask to range type nodes and add index into node position */
+	temp = _mm256_and_si256(temp, node_types);
+	addr = _mm256_add_epi32(addr, temp);
+
+	/* Gather 64 bit transitions, back in slot order. */
+	addr = _mm256_permutevar8x32_epi32(addr, ymm_slot_order.m);
+
+	*indices1 = _mm256_i32gather_epi64((const long long *)trans,
+		_mm256_castsi256_si128(addr), sizeof(trans[0]));
+	*indices2 = _mm256_i32gather_epi64((const long long *)trans,
+		_mm256_extracti128_si256(addr, 1), sizeof(trans[0]));
+
+	return _mm256_srli_epi32(next_input, CHAR_BIT);
+}
+
+/*
+ * Execute trie traversal with 16 traversals in parallel
+ */
+static inline int
+search_avx2x16(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	int n;
+	struct acl_flow_data flows;
+	uint64_t index_array[MAX_SEARCHES_AVX16];
+	struct completion cmplt[MAX_SEARCHES_AVX16];
+	struct parms parms[MAX_SEARCHES_AVX16];
+	ymm_t input0, input1;
+	ymm_t indices1, indices2, indices3, indices4;
+
+	acl_set_flow(&flows, cmplt, RTE_DIM(cmplt), data, results,
+		total_packets, categories, ctx->trans_table);
+
+	for (n = 0; n < MAX_SEARCHES_AVX16; n++) {
+		cmplt[n].count = 0;
+		index_array[n] = acl_start_next_trie(&flows, parms, n, ctx);
+	}
+
+	/*
+	 * indices1 contains index_array[0-3]
+	 * indices2 contains index_array[4-7]
+	 * indices3 contains index_array[8-11]
+	 * indices4 contains index_array[12-15]
+	 */
+
+	indices1 = _mm256_loadu_si256((const ymm_t *)&index_array[0]);
+	indices2 = _mm256_loadu_si256((const ymm_t *)&index_array[4]);
+
+	indices3 = _mm256_loadu_si256((const ymm_t *)&index_array[8]);
+	indices4 = _mm256_loadu_si256((const ymm_t *)&index_array[12]);
+
+	 /* Check for any matches. */
+	acl_match_check_avx2x8(0, ctx, parms, &flows, &indices1, &indices2);
+	acl_match_check_avx2x8(8, ctx, parms, &flows, &indices3, &indices4);
+
+	while (flows.started > 0) {
+
+		/* Gather 4 bytes of input data for each stream. */
+		input0 = GET_NEXT_4BYTES_X8(parms, 0);
+		input1 = GET_NEXT_4BYTES_X8(parms, 8);
+
+		 /* Process the 4 bytes of input on each stream. */
+
+		input0 = transition8(input0, flows.trans, &indices1, &indices2);
+		input1 = transition8(input1, flows.trans, &indices3, &indices4);
+
+		input0 = transition8(input0, flows.trans, &indices1, &indices2);
+		input1 = transition8(input1, flows.trans, &indices3, &indices4);
+
+		input0 = transition8(input0, flows.trans, &indices1, &indices2);
+		input1 = transition8(input1, flows.trans, &indices3, &indices4);
+
+		input0 = transition8(input0, flows.trans, &indices1, &indices2);
+		input1 = transition8(input1, flows.trans, &indices3, &indices4);
+
+		 /* Check for any matches. */
+		acl_match_check_avx2x8(0, ctx, parms, &flows,
+			&indices1, &indices2);
+		acl_match_check_avx2x8(8, ctx, parms, &flows,
+			&indices3, &indices4);
+	}
+
+	return 0;
+}
+
+int
+rte_acl_classify_avx2(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories)
+{
+	if (categories != 1 &&
+		((RTE_ACL_RESULTS_MULTIPLIER - 1) & categories) != 0)
+		return -EINVAL;
+
+	if (likely(num >= MAX_SEARCHES_AVX16))
+		return search_avx2x16(ctx, data, results, num, categories);
+	else if (num >= MAX_SEARCHES_SSE8)
+		return search_sse_8(ctx, data, results, num, categories);
+	else if (num >= MAX_SEARCHES_SSE4)
+		return search_sse_4(ctx, data, results, num, categories);
+	else
+		return search_sse_2(ctx, data, results, num, categories);
+}
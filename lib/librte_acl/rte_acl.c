@@ -42,6 +42,7 @@ static const rte_acl_classify_t classify_fns[] = {
 	[RTE_ACL_CLASSIFY_DEFAULT] = rte_acl_classify_scalar,
 	[RTE_ACL_CLASSIFY_SCALAR] = rte_acl_classify_scalar,
 	[RTE_ACL_CLASSIFY_SSE] = rte_acl_classify_sse,
+	[RTE_ACL_CLASSIFY_AVX2] = rte_acl_classify_avx2,
 };
 
 /* by default, use always available scalar code path. */
@@ -54,12 +55,53 @@ rte_acl_set_default_classify(enum rte_acl_classify_alg alg)
 	rte_acl_default_classify = alg;
 }
 
+#ifndef CC_AVX2_SUPPORT
+/*
+ * If the compiler doesn't support AVX2 instructions,
+ * then the dummy one would be used instead for AVX2 classify method.
+ */
+int
+rte_acl_classify_avx2(__rte_unused const struct rte_acl_ctx *ctx,
+	__rte_unused const uint8_t **data,
+	__rte_unused uint32_t *results,
+	__rte_unused uint32_t num,
+	__rte_unused uint32_t categories)
+{
+	return -ENOTSUP;
+}
+#endif
+
+/*
+ * Check that the given classify method was built in and can run on this CPU.
+ */
+static int
+acl_check_alg(enum rte_acl_classify_alg alg)
+{
+	switch (alg) {
+	case RTE_ACL_CLASSIFY_AVX2:
+#ifdef CC_AVX2_SUPPORT
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+			return 0;
+#endif
+		return -ENOTSUP;
+	case RTE_ACL_CLASSIFY_SSE:
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1))
+			return 0;
+		return -ENOTSUP;
+	default:
+		return 0;
+	}
+}
+
 extern int
 rte_acl_set_ctx_classify(struct rte_acl_ctx *ctx, enum rte_acl_classify_alg alg)
 {
 	if (ctx == NULL || (uint32_t)alg >= RTE_DIM(classify_fns))
 		return -EINVAL;
 
+	if (acl_check_alg(alg) != 0)
+		return -ENOTSUP;
+
 	ctx->alg = alg;
 	return 0;
 }
@@ -69,7 +111,9 @@ rte_acl_init(void)
 {
 	enum rte_acl_classify_alg alg = RTE_ACL_CLASSIFY_DEFAULT;
 
-	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1))
+	if (acl_check_alg(RTE_ACL_CLASSIFY_AVX2) == 0)
+		alg = RTE_ACL_CLASSIFY_AVX2;
+	else if (acl_check_alg(RTE_ACL_CLASSIFY_SSE) == 0)
 		alg = RTE_ACL_CLASSIFY_SSE;
 
 	rte_acl_set_default_classify(alg);
@@ -282,6 +326,85 @@ rte_acl_add_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
 	return acl_add_rules(ctx, rules, num);
 }
 
+/*
+ * Create a new context with a copy of the rules of an existing one.
+ * RT structures are not copied.
+ */
+struct rte_acl_ctx *
+rte_acl_clone(const struct rte_acl_ctx *ctx, const struct rte_acl_param *param)
+{
+	struct rte_acl_ctx *clone;
+
+	if (ctx == NULL || param == NULL || param->name == NULL ||
+			param->rule_size != ctx->rule_sz ||
+			param->max_rule_num < ctx->num_rules) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	/* rte_acl_create() would return the existing context. */
+	if (rte_acl_find_existing(param->name) != NULL) {
+		rte_errno = EEXIST;
+		return NULL;
+	}
+
+	clone = rte_acl_create(param);
+	if (clone == NULL)
+		return NULL;
+
+	clone->alg = ctx->alg;
+	acl_add_rules(clone, ctx->rules, ctx->num_rules);
+
+	return clone;
+}
+
+struct rte_acl_ctx *
+rte_acl_swap(struct rte_acl_ctx **pctx, struct rte_acl_ctx *ctx)
+{
+	/* complete all stores to the new context before publishing it. */
+	__sync_synchronize();
+	return __sync_lock_test_and_set(pctx, ctx);
+}
+
+/*
+ * Delete the rules equal to any of the given ones, keeping the order of
+ * the remaining ones.
+ * Note that RT structures are not affected.
+ */
+int
+rte_acl_del_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
+	uint32_t num)
+{
+	uint8_t *dst, *src;
+	uint32_t i, j, n;
+
+	if (ctx == NULL || rules == NULL || 0 == ctx->rule_sz)
+		return -EINVAL;
+
+	dst = ctx->rules;
+	n = 0;
+	for (i = 0; i != ctx->num_rules; i++) {
+		src = (uint8_t *)ctx->rules + i * ctx->rule_sz;
+		for (j = 0; j != num; j++) {
+			if (memcmp(src, (const uint8_t *)rules +
+					j * ctx->rule_sz, ctx->rule_sz) == 0)
+				break;
+		}
+
+		/* keep the rule */
+		if (j == num) {
+			if (dst != src)
+				memcpy(dst, src, ctx->rule_sz);
+			dst += ctx->rule_sz;
+			n++;
+		}
+	}
+
+	i = ctx->num_rules - n;
+	ctx->num_rules = n;
+	return i;
+}
+
 /*
  * Reset all rules.
  * Note that RT structures are not affected.
@@ -305,6 +428,17 @@ rte_acl_reset(struct rte_acl_ctx *ctx)
 	}
 }
 
+int
+rte_acl_get_build_stats(const struct rte_acl_ctx *ctx,
+	struct rte_acl_build_stats *stats)
+{
+	if (ctx == NULL || stats == NULL)
+		return -EINVAL;
+
+	*stats = ctx->stats;
+	return 0;
+}
+
 /*
  * Dump ACL context to the stdout.
  */
@@ -478,6 +612,7 @@ acl_ipv4vlan_config(struct rte_acl_config *cfg,
 		},
 	};
 
+	memset(cfg, 0, sizeof(*cfg));
 	memcpy(&cfg->defs, ipv4_defs, sizeof(ipv4_defs));
 	cfg->num_fields = RTE_DIM(ipv4_defs);
 
@@ -53,6 +53,9 @@ extern "C" {
 #define RTE_ACL_MAX_LEVELS 64
 #define RTE_ACL_MAX_FIELDS 64
 
+/** Max number of tries per one ACL context. */
+#define RTE_ACL_MAX_TRIES	8
+
 union rte_acl_field_types {
 	uint8_t  u8;
 	uint16_t u16;
@@ -88,12 +91,41 @@ struct rte_acl_field_def {
 /**
  * ACL build configuration.
  * Defines the fields of an ACL trie and number of categories to build with.
+ * Fewer tries give a faster classification, at the expense of a bigger
+ * memory footprint of the run-time structures.
  */
 struct rte_acl_config {
 	uint32_t num_categories; /**< Number of categories to build with. */
 	uint32_t num_fields;     /**< Number of field definitions. */
 	struct rte_acl_field_def defs[RTE_ACL_MAX_FIELDS];
 	/**< array of field definitions. */
+	uint32_t max_tries;
+	/**< Max number of tries to split rules into, 0 - RTE_ACL_MAX_TRIES. */
+	size_t max_size;
+	/**< Max size of run-time structures in bytes, 0 - no limit. */
+};
+
+/**
+ * Statistics of one trie of a built ACL context.
+ */
+struct rte_acl_trie_stats {
+	uint32_t num_rules;  /**< Number of rules in the trie. */
+	uint32_t num_nodes;  /**< Number of run-time nodes. */
+	uint32_t num_trans;  /**< Number of transitions of these nodes. */
+	size_t size;         /**< Size of nodes and match results in bytes. */
+};
+
+/**
+ * Statistics of the last build of an ACL context.
+ */
+struct rte_acl_build_stats {
+	uint32_t num_tries;  /**< Number of tries built. */
+	uint32_t node_max;
+	/**< Max number of nodes one rule could add before splitting a trie. */
+	size_t build_size;   /**< Temporary memory used by the build phase. */
+	size_t size;         /**< Total size of run-time structures. */
+	struct rte_acl_trie_stats trie[RTE_ACL_MAX_TRIES];
+	/**< Statistics per trie. */
 };
 
 /**
@@ -187,6 +219,47 @@ rte_acl_create(const struct rte_acl_param *param);
 struct rte_acl_ctx *
 rte_acl_find_existing(const char *name);
 
+/**
+ * Create a new ACL context holding the rules of an existing one.
+ * The new context has the same rules and classify method as *ctx*, but no
+ * run-time structures: once the rule set is updated with rte_acl_add_rules()
+ * and rte_acl_del_rules(), it has to be built before use. *ctx* is not
+ * modified and can be used for classification meanwhile.
+ *
+ * @param ctx
+ *   ACL context to copy the rules from.
+ * @param param
+ *   Parameters of the new ACL context. The rule size must be the one of
+ *   *ctx* and the maximum number of rules at least the number of rules
+ *   in *ctx*. The name must not be used by any other ACL context.
+ * @return
+ *   Pointer to the new ACL context, or NULL on error
+ *   with rte_errno set appropriately. Possible rte_errno values include:
+ *    - EINVAL - invalid parameter passed to function
+ *    - EEXIST - an ACL context with the same name already exists
+ */
+struct rte_acl_ctx *
+rte_acl_clone(const struct rte_acl_ctx *ctx,
+	const struct rte_acl_param *param);
+
+/**
+ * Publish a new ACL context to the lcores classifying through *pctx*.
+ * All the updates of *ctx*, including its build, are visible to an lcore
+ * which reads the new pointer. The previous context may still be in use by
+ * lcores which read *pctx* before: it must only be freed once each of them
+ * went through a quiescent state, e.g. finished processing its current
+ * burst of packets.
+ *
+ * @param pctx
+ *   Location of the ACL context pointer read by classifying lcores.
+ * @param ctx
+ *   ACL context to publish.
+ * @return
+ *   Previous ACL context stored at *pctx*.
+ */
+struct rte_acl_ctx *
+rte_acl_swap(struct rte_acl_ctx **pctx, struct rte_acl_ctx *ctx);
+
 /**
  * De-allocate all memory used by ACL context.
  *
@@ -219,6 +292,29 @@ int
 rte_acl_add_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
 	uint32_t num);
 
+/**
+ * Delete rules from the ACL context.
+ * Every rule of the context equal to one of the given rules, compared byte by
+ * byte over the rule size of the context, is removed. The order of the
+ * remaining rules is preserved.
+ * This function is not multi-thread safe.
+ * Note that internal run-time structures are not affected.
+ *
+ * @param ctx
+ *   ACL context to delete rules from.
+ * @param rules
+ *   Array of rules to delete from the ACL context, in the same format as for
+ *   rte_acl_add_rules().
+ * @param num
+ *   Number of elements in the input array of rules.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - Number of rules removed from the context otherwise.
+ */
+int
+rte_acl_del_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
+	uint32_t num);
+
 /**
  * Delete all rules from the ACL context.
  * This function is not multi-thread safe.
@@ -238,8 +334,11 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
  *   ACL context to build.
  * @param cfg
  *   Pointer to struct rte_acl_config - defines build parameters.
+ *   If the run-time structures exceed cfg->max_size, rules are split into
+ *   more tries (up to cfg->max_tries) until they fit.
  * @return
  *   - -ENOMEM if couldn't allocate enough memory.
+ *   - -ERANGE if the run-time structures don't fit into cfg->max_size.
  *   - -EINVAL if the parameters are invalid.
  *   - Negative error code if operation failed.
  *   - Zero if operation completed successfully.
@@ -247,6 +346,21 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg);
 
+/**
+ * Get statistics of the last build of an ACL context.
+ *
+ * @param ctx
+ *   ACL context to get statistics for.
+ * @param stats
+ *   Structure to fill, zeroed if the context is not built.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_get_build_stats(const struct rte_acl_ctx *ctx,
+	struct rte_acl_build_stats *stats);
+
 /**
  * Delete all rules from the ACL context and
  * destroy all internal run-time structures.
@@ -265,6 +379,7 @@ enum rte_acl_classify_alg {
 	RTE_ACL_CLASSIFY_DEFAULT = 0,
 	RTE_ACL_CLASSIFY_SCALAR = 1,  /**< generic implementation. */
 	RTE_ACL_CLASSIFY_SSE = 2,     /**< requires SSE4.1 support. */
+	RTE_ACL_CLASSIFY_AVX2 = 3,    /**< requires AVX2 support. */
 };
 
 /**
@@ -349,10 +464,10 @@ rte_acl_classify_alg(const struct rte_acl_ctx *ctx,
  *   ACL context to change classify function for.
  * @param alg
  *   New default classify algorithm for given ACL context.
- *   It is the caller responsibility to ensure that the value refers to the
- *   existing algorithm, and that it could be run on the given CPU.
  * @return
  *   - -EINVAL if the parameters are invalid.
+ *   - -ENOTSUP if the algorithm can't be run on the given CPU, or was not
+ *     built in.
  *   - Zero if operation completed successfully.
  */
 extern int
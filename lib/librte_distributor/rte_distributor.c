@@ -41,6 +41,9 @@
 #include <rte_string_fns.h>
 #include <rte_tailq.h>
 #include <rte_eal_memconfig.h>
+#if defined(RTE_MACHINE_CPUFLAG_SSE2) || defined(RTE_MACHINE_CPUFLAG_AVX2)
+#include <rte_common_vect.h>
+#endif
 #include "rte_distributor.h"
 
 #define NO_FLAGS 0
@@ -55,8 +58,9 @@
 #define RTE_DISTRIB_NO_BUF 0       /**< empty flags: no buffer requested */
 #define RTE_DISTRIB_GET_BUF (1)    /**< worker requests a buffer, returns old */
 #define RTE_DISTRIB_RETURN_BUF (2) /**< worker returns a buffer, no request */
+#define RTE_DISTRIB_VALID_BUF (4)  /**< burst slot holds a valid buffer */
 
-#define RTE_DISTRIB_BACKLOG_SIZE 8
+/* the depth of the backlog of each worker is set by the configuration */
 #define RTE_DISTRIB_BACKLOG_MASK (RTE_DISTRIB_BACKLOG_SIZE - 1)
 
 #define RTE_DISTRIB_MAX_RETURNS 128
@@ -74,10 +78,13 @@
  * line aligned, but to improve performance and prevent adjacent cache-line
  * prefetches of buffers for other workers, e.g. when worker 1's buffer is on
  * the next cache line to worker 0, we pad this out to three cache lines.
- * Only 64-bits of the memory is actually used though.
+ * Only 64-bits of the memory is actually used though, or the whole first
+ * cache line in burst mode, where each slot holds one packet and the flags
+ * of the exchange are in the first slot.
  */
 union rte_distributor_buffer {
 	volatile int64_t bufptr64;
+	volatile int64_t burstptr64[RTE_DISTRIB_BURST_SIZE];
 	char pad[RTE_CACHE_LINE_SIZE*3];
 } __rte_cache_aligned;
 
@@ -87,6 +94,20 @@ struct rte_distributor_backlog {
 	int64_t pkts[RTE_DISTRIB_BACKLOG_SIZE];
 };
 
+/*
+ * Packets of a worker in burst mode: the ones it is processing and the ones
+ * queued for its next request, with their tags so that packets of the same
+ * flow are not given to two workers at the same time.
+ */
+struct rte_distributor_burst_backlog {
+	unsigned active;      /**< worker requested packets, not shut down */
+	unsigned in_flight;   /**< number of packets held by the worker */
+	unsigned count;       /**< number of queued packets */
+	uint32_t in_flight_tags[RTE_DISTRIB_BURST_SIZE];
+	uint32_t tags[RTE_DISTRIB_BACKLOG_SIZE];
+	int64_t pkts[RTE_DISTRIB_BACKLOG_SIZE];
+};
+
 struct rte_distributor_returned_pkts {
 	unsigned start;
 	unsigned count;
@@ -98,6 +119,7 @@ struct rte_distributor {
 
 	char name[RTE_DISTRIBUTOR_NAMESIZE];  /**< Name of the ring. */
 	unsigned num_workers;                 /**< Number of workers polling */
+	unsigned burst;                       /**< Packets passed in bursts */
 
 	uint32_t in_flight_tags[RTE_DISTRIB_MAX_WORKERS];
 		/**< Tracks the tag being processed per core */
@@ -108,6 +130,8 @@ struct rte_distributor {
 		 */
 
 	struct rte_distributor_backlog backlog[RTE_DISTRIB_MAX_WORKERS];
+	struct rte_distributor_burst_backlog
+			burst_backlog[RTE_DISTRIB_MAX_WORKERS];
 
 	union rte_distributor_buffer bufs[RTE_DISTRIB_MAX_WORKERS];
 
@@ -165,8 +189,130 @@ rte_distributor_return_pkt(struct rte_distributor *d,
 	return 0;
 }
 
+/* fill the slots of a burst buffer with packets given back, the first slot
+ * is written last with the flags, as it hands the buffer over */
+static inline void
+burst_write(volatile int64_t *slots, struct rte_mbuf **pkts, unsigned count,
+		int64_t flags)
+{
+	unsigned i;
+
+	for (i = 1; i < RTE_DISTRIB_BURST_SIZE; i++)
+		slots[i] = (i < count) ?
+			(((int64_t)(uintptr_t)pkts[i]) << RTE_DISTRIB_FLAG_BITS)
+			| RTE_DISTRIB_VALID_BUF : 0;
+	if (count > 0)
+		flags |= (((int64_t)(uintptr_t)pkts[0]) <<
+				RTE_DISTRIB_FLAG_BITS) | RTE_DISTRIB_VALID_BUF;
+	slots[0] = flags;
+}
+
+void
+rte_distributor_request_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned count)
+{
+	volatile int64_t *slots = d->bufs[worker_id].burstptr64;
+
+	while (unlikely(slots[0] &
+			(RTE_DISTRIB_GET_BUF | RTE_DISTRIB_RETURN_BUF)))
+		rte_pause();
+	burst_write(slots, oldpkt, count, RTE_DISTRIB_GET_BUF);
+}
+
+int
+rte_distributor_poll_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts)
+{
+	volatile int64_t *slots = d->bufs[worker_id].burstptr64;
+	int64_t data = slots[0];
+	unsigned i;
+
+	if (data & RTE_DISTRIB_GET_BUF)
+		return -1;
+
+	/* packets are stored from the first slot, stop at the first empty */
+	for (i = 0; i < RTE_DISTRIB_BURST_SIZE; i++) {
+		if (i > 0)
+			data = slots[i];
+		if (!(data & RTE_DISTRIB_VALID_BUF))
+			break;
+		/* since data is signed, this should be an arithmetic shift */
+		pkts[i] = (struct rte_mbuf *)
+				((uintptr_t)(data >> RTE_DISTRIB_FLAG_BITS));
+	}
+	return i;
+}
+
+int
+rte_distributor_get_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts,
+		struct rte_mbuf **oldpkt, unsigned retcount)
+{
+	int count;
+
+	rte_distributor_request_pkt_burst(d, worker_id, oldpkt, retcount);
+	while ((count = rte_distributor_poll_pkt_burst(d, worker_id,
+			pkts)) < 0)
+		rte_pause();
+	return count;
+}
+
+int
+rte_distributor_return_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned num)
+{
+	burst_write(d->bufs[worker_id].burstptr64, oldpkt, num,
+			RTE_DISTRIB_RETURN_BUF);
+	return 0;
+}
+
 /**** APIs called on distributor core ***/
 
+/*
+ * Compare a tag with the first num entries of an array of tags, and return
+ * a bitmask where a one-bit indicates a match for the entry given by the
+ * bit-position. The vector versions compare a whole vector of tags at a
+ * time, so the array size must be a multiple of 8 entries, the entries
+ * past num being masked out.
+ */
+static inline uint64_t
+match_tags(const uint32_t *tags, unsigned num, uint32_t tag)
+{
+	uint64_t match = 0;
+	unsigned i;
+
+#if defined(RTE_MACHINE_CPUFLAG_AVX2)
+	const __m256i v_tag = _mm256_set1_epi32(tag);
+
+	for (i = 0; i < num; i += 8) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)&tags[i]);
+		v = _mm256_cmpeq_epi32(v, v_tag);
+		match |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(v))
+				<< i;
+	}
+#elif defined(RTE_MACHINE_CPUFLAG_SSE2)
+	const __m128i v_tag = _mm_set1_epi32(tag);
+
+	for (i = 0; i < num; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)&tags[i]);
+		v = _mm_cmpeq_epi32(v, v_tag);
+		match |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(v)) << i;
+	}
+#else
+	/*
+	 * to scan for a match use "xor" and "not" to get a 0/1
+	 * value, then use shifting to merge to single "match"
+	 * variable
+	 */
+	for (i = 0; i < num; i++)
+		match |= (uint64_t)!(tags[i] ^ tag) << i;
+#endif
+
+	if (num < sizeof(match) * CHAR_BIT)
+		match &= (1ULL << num) - 1;
+	return match;
+}
+
 /* as name suggests, adds a packet to the backlog for a particular worker */
 static int
 add_to_backlog(struct rte_distributor_backlog *bl, int64_t item)
@@ -277,6 +423,166 @@ process_returns(struct rte_distributor *d)
 	return flushed;
 }
 
+static int
+process_burst(struct rte_distributor *d,
+		struct rte_mbuf **mbufs, unsigned num_mbufs);
+
+/* give the first queued packets of a worker in one burst buffer */
+static inline void
+burst_send(struct rte_distributor *d, unsigned wkr)
+{
+	volatile int64_t *slots = d->bufs[wkr].burstptr64;
+	struct rte_distributor_burst_backlog *bl = &d->burst_backlog[wkr];
+	const unsigned num = bl->count < RTE_DISTRIB_BURST_SIZE ?
+			bl->count : RTE_DISTRIB_BURST_SIZE;
+	const int64_t first = bl->pkts[0];
+	unsigned i;
+
+	for (i = 1; i < RTE_DISTRIB_BURST_SIZE; i++)
+		slots[i] = (i < num) ? bl->pkts[i] : 0;
+	for (i = 0; i < num; i++)
+		bl->in_flight_tags[i] = bl->tags[i];
+	bl->in_flight = num;
+
+	/* move the remaining packets to the head of the backlog */
+	bl->count -= num;
+	memmove(bl->pkts, &bl->pkts[num], bl->count * sizeof(bl->pkts[0]));
+	memmove(bl->tags, &bl->tags[num], bl->count * sizeof(bl->tags[0]));
+
+	slots[0] = first;
+}
+
+/* a worker in burst mode shuts down: its queued packets are distributed to
+ * the other workers */
+static inline void
+burst_worker_shutdown(struct rte_distributor *d, unsigned wkr)
+{
+	struct rte_distributor_burst_backlog *bl = &d->burst_backlog[wkr];
+	struct rte_mbuf *pkts[RTE_DISTRIB_BACKLOG_SIZE];
+	unsigned i, count = bl->count;
+
+	d->bufs[wkr].burstptr64[0] = 0;
+	bl->active = 0;
+	bl->count = 0;
+	if (unlikely(count != 0)) {
+		for (i = 0; i < count; i++)
+			pkts[i] = (void *)((uintptr_t)(bl->pkts[i] >>
+					RTE_DISTRIB_FLAG_BITS));
+		/* recursive call, the tags are still set in the mbufs */
+		process_burst(d, pkts, count);
+	}
+}
+
+/* check the burst buffer of a worker: store the packets it returned and
+ * give it its queued packets if it requested more. Returns 1 if the worker
+ * had a pending request or shut down. */
+static int
+burst_handle_worker(struct rte_distributor *d, unsigned wkr)
+{
+	volatile int64_t *slots = d->bufs[wkr].burstptr64;
+	struct rte_distributor_burst_backlog *bl = &d->burst_backlog[wkr];
+	const int64_t data = slots[0];
+	int64_t ret = data;
+	unsigned i;
+
+	if (!(data & (RTE_DISTRIB_GET_BUF | RTE_DISTRIB_RETURN_BUF)))
+		return 0;
+
+	/* the packets given to the worker are processed */
+	bl->in_flight = 0;
+	for (i = 0; i < RTE_DISTRIB_BURST_SIZE; i++) {
+		if (i > 0)
+			ret = slots[i];
+		if (!(ret & RTE_DISTRIB_VALID_BUF))
+			break;
+		store_return(ret >> RTE_DISTRIB_FLAG_BITS, d,
+				&d->returns.start, &d->returns.count);
+	}
+
+	if (data & RTE_DISTRIB_RETURN_BUF) {
+		burst_worker_shutdown(d, wkr);
+		return 1;
+	}
+
+	bl->active = 1;
+	if (bl->count != 0)
+		burst_send(d, wkr);
+	else if (i != 0)
+		/* returns are stored, keep the request pending */
+		slots[0] = RTE_DISTRIB_GET_BUF;
+	return 1;
+}
+
+/* return the worker processing or holding a packet with the given tag, or
+ * else the active worker with the fewest packets and room in its backlog.
+ * Returns num_workers if no worker can take the packet. */
+static inline unsigned
+burst_find_worker(const struct rte_distributor *d, uint32_t tag)
+{
+	const struct rte_distributor_burst_backlog *bl;
+	unsigned wkr, load;
+	unsigned best = d->num_workers, best_load = UINT32_MAX;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++) {
+		bl = &d->burst_backlog[wkr];
+		if (match_tags(bl->in_flight_tags, bl->in_flight, tag) ||
+				match_tags(bl->tags, bl->count, tag))
+			return wkr;
+
+		load = bl->in_flight + bl->count;
+		if (bl->active && bl->count < RTE_DISTRIB_BACKLOG_SIZE &&
+				load < best_load) {
+			best = wkr;
+			best_load = load;
+		}
+	}
+	return best;
+}
+
+/* distribute packets in burst mode: each packet is queued for a worker, and
+ * the queue of a worker is given to it in one burst buffer when it requests
+ * packets. */
+static int
+process_burst(struct rte_distributor *d,
+		struct rte_mbuf **mbufs, unsigned num_mbufs)
+{
+	struct rte_distributor_burst_backlog *bl;
+	unsigned next_idx = 0, wkr, handled = 0;
+	uint32_t new_tag;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		handled += burst_handle_worker(d, wkr);
+
+	if (unlikely(num_mbufs == 0))
+		return handled;
+
+	while (next_idx < num_mbufs) {
+		new_tag = mbufs[next_idx]->hash.usr;
+		wkr = burst_find_worker(d, new_tag);
+		if (wkr == d->num_workers ||
+				d->burst_backlog[wkr].count ==
+				RTE_DISTRIB_BACKLOG_SIZE) {
+			/* wait for the workers to take their packets */
+			for (wkr = 0; wkr < d->num_workers; wkr++)
+				burst_handle_worker(d, wkr);
+			continue;
+		}
+
+		bl = &d->burst_backlog[wkr];
+		bl->tags[bl->count] = new_tag;
+		bl->pkts[bl->count++] = (((int64_t)(uintptr_t)mbufs[next_idx++])
+				<< RTE_DISTRIB_FLAG_BITS) | RTE_DISTRIB_VALID_BUF;
+		if (bl->count == RTE_DISTRIB_BURST_SIZE)
+			burst_handle_worker(d, wkr);
+	}
+
+	/* give the partial bursts to the workers waiting for packets */
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		burst_handle_worker(d, wkr);
+
+	return num_mbufs;
+}
+
 /* process a set of packets to distribute them to workers */
 int
 rte_distributor_process(struct rte_distributor *d,
@@ -290,6 +596,9 @@ rte_distributor_process(struct rte_distributor *d,
 	unsigned ret_start = d->returns.start,
 			ret_count = d->returns.count;
 
+	if (d->burst)
+		return process_burst(d, mbufs, num_mbufs);
+
 	if (unlikely(num_mbufs == 0))
 		return process_returns(d);
 
@@ -314,17 +623,8 @@ rte_distributor_process(struct rte_distributor *d,
 			 * Note that if RTE_DISTRIB_MAX_WORKERS is larger than 64
 			 * then the size of match has to be expanded.
 			 */
-			uint64_t match = 0;
-			unsigned i;
-			/*
-			 * to scan for a match use "xor" and "not" to get a 0/1
-			 * value, then use shifting to merge to single "match"
-			 * variable, where a one-bit indicates a match for the
-			 * worker given by the bit-position
-			 */
-			for (i = 0; i < d->num_workers; i++)
-				match |= (!(d->in_flight_tags[i] ^ new_tag)
-					<< i);
+			uint64_t match = match_tags(d->in_flight_tags,
+					d->num_workers, new_tag);
 
 			/* Only turned-on bits are considered as match */
 			match &= d->in_flight_bitmask;
@@ -408,6 +708,14 @@ total_outstanding(const struct rte_distributor *d)
 {
 	unsigned wkr, total_outstanding;
 
+	if (d->burst) {
+		total_outstanding = 0;
+		for (wkr = 0; wkr < d->num_workers; wkr++)
+			total_outstanding += d->burst_backlog[wkr].in_flight +
+					d->burst_backlog[wkr].count;
+		return total_outstanding;
+	}
+
 	total_outstanding = __builtin_popcountl(d->in_flight_bitmask);
 
 	for (wkr = 0; wkr < d->num_workers; wkr++)
@@ -439,11 +747,11 @@ rte_distributor_clear_returns(struct rte_distributor *d)
 #endif
 }
 
-/* creates a distributor instance */
-struct rte_distributor *
-rte_distributor_create(const char *name,
-		unsigned socket_id,
-		unsigned num_workers)
+/* creates a distributor instance, passing packets one at a time or in
+ * bursts */
+static struct rte_distributor *
+distributor_create(const char *name, unsigned socket_id,
+		unsigned num_workers, unsigned burst)
 {
 	struct rte_distributor *d;
 	struct rte_distributor_list *distributor_list;
@@ -455,6 +763,14 @@ rte_distributor_create(const char *name,
 	RTE_BUILD_BUG_ON((RTE_DISTRIB_MAX_WORKERS & 7) != 0);
 	RTE_BUILD_BUG_ON(RTE_DISTRIB_MAX_WORKERS >
 				sizeof(d->in_flight_bitmask) * CHAR_BIT);
+	RTE_BUILD_BUG_ON(sizeof(d->bufs[0].burstptr64) > RTE_CACHE_LINE_SIZE);
+	/* backlog is a power of two, and a multiple of the vector size used
+	 * to match tags */
+	RTE_BUILD_BUG_ON((RTE_DISTRIB_BACKLOG_SIZE &
+			RTE_DISTRIB_BACKLOG_MASK) != 0);
+	RTE_BUILD_BUG_ON(RTE_DISTRIB_BACKLOG_SIZE < RTE_DISTRIB_BURST_SIZE);
+	RTE_BUILD_BUG_ON(RTE_DISTRIB_BACKLOG_SIZE > 64);
+	RTE_BUILD_BUG_ON((RTE_DISTRIB_BURST_SIZE & 7) != 0);
 
 	if (name == NULL || num_workers >= RTE_DISTRIB_MAX_WORKERS) {
 		rte_errno = EINVAL;
@@ -479,6 +795,7 @@ rte_distributor_create(const char *name,
 	d = mz->addr;
 	snprintf(d->name, sizeof(d->name), "%s", name);
 	d->num_workers = num_workers;
+	d->burst = burst;
 
 	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
 	TAILQ_INSERT_TAIL(distributor_list, d, next);
@@ -486,3 +803,19 @@ rte_distributor_create(const char *name,
 
 	return d;
 }
+
+struct rte_distributor *
+rte_distributor_create(const char *name,
+		unsigned socket_id,
+		unsigned num_workers)
+{
+	return distributor_create(name, socket_id, num_workers, 0);
+}
+
+struct rte_distributor *
+rte_distributor_create_burst(const char *name,
+		unsigned socket_id,
+		unsigned num_workers)
+{
+	return distributor_create(name, socket_id, num_workers, 1);
+}
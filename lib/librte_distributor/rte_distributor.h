@@ -39,7 +39,9 @@
  * RTE distributor
  *
  * The distributor is a component which is designed to pass packets
- * one-at-a-time to workers, with dynamic load balancing.
+ * one-at-a-time to workers, with dynamic load balancing. A distributor
+ * created in burst mode passes up to RTE_DISTRIB_BURST_SIZE packets at a
+ * time to each worker instead.
  */
 
 #ifdef __cplusplus
@@ -50,6 +52,9 @@ extern "C" {
 
 #define RTE_DISTRIBUTOR_NAMESIZE 32 /**< Length of name for instance */
 
+/** Maximum number of packets exchanged with a worker at a time in burst mode */
+#define RTE_DISTRIB_BURST_SIZE 8
+
 struct rte_distributor;
 
 /**
@@ -72,6 +77,29 @@ struct rte_distributor *
 rte_distributor_create(const char *name, unsigned socket_id,
 		unsigned num_workers);
 
+/**
+ * Function to create a new distributor instance in burst mode
+ *
+ * Same as rte_distributor_create(), except that packets are passed to and
+ * returned by the workers in bursts of up to RTE_DISTRIB_BURST_SIZE
+ * packets, sharing one cache line per exchange. The workers of such an
+ * instance must use the burst worker APIs, rte_distributor_get_pkt_burst()
+ * and related functions.
+ *
+ * @param name
+ *   The name to be given to the distributor instance.
+ * @param socket_id
+ *   The NUMA node on which the memory is to be allocated
+ * @param num_workers
+ *   The maximum number of workers that will request packets from this
+ *   distributor
+ * @return
+ *   The newly created distributor instance
+ */
+struct rte_distributor *
+rte_distributor_create_burst(const char *name, unsigned socket_id,
+		unsigned num_workers);
+
 /*  *** APIS to be called on the distributor lcore ***  */
 /*
  * The following APIs are the public APIs which are designed for use on a
@@ -241,6 +269,102 @@ struct rte_mbuf *
 rte_distributor_poll_pkt(struct rte_distributor *d,
 		unsigned worker_id);
 
+/*
+ * The following worker APIs are the burst equivalents of the ones above, to
+ * be used with a distributor created by rte_distributor_create_burst().
+ * Packets of the same flow are never processed by two workers at the same
+ * time, a worker is assumed to have completed all the packets of its
+ * previous burst when it requests new ones.
+ */
+
+/**
+ * API called by a worker to get a burst of new packets to process. The
+ * packets of the previous burst given to the worker are assumed to have
+ * completed processing, and may be optionally returned to the distributor
+ * via the oldpkt parameter.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param pkts
+ *   An array of RTE_DISTRIB_BURST_SIZE entries, filled with the new packets.
+ * @param oldpkt
+ *   The previous packets, if any, being processed by the worker
+ * @param retcount
+ *   The number of packets in oldpkt, at most RTE_DISTRIB_BURST_SIZE.
+ *
+ * @return
+ *   The number of new packets in pkts.
+ */
+int
+rte_distributor_get_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts,
+		struct rte_mbuf **oldpkt, unsigned retcount);
+
+/**
+ * API called by a worker to return completed packets without requesting new
+ * packets, for example, because a worker thread is shutting down
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param oldpkt
+ *   The previous packets being processed by the worker
+ * @param num
+ *   The number of packets in oldpkt, at most RTE_DISTRIB_BURST_SIZE.
+ */
+int
+rte_distributor_return_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned num);
+
+/**
+ * API called by a worker to request a burst of new packets to process,
+ * without waiting for them. The previous packets given to the worker are
+ * assumed to have completed processing, and may be optionally returned to
+ * the distributor via the oldpkt parameter.
+ *
+ * NOTE: after calling this function, rte_distributor_poll_pkt_burst() should
+ * be used to poll for the packets requested.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param oldpkt
+ *   The previous packets, if any, being processed by the worker
+ * @param count
+ *   The number of packets in oldpkt, at most RTE_DISTRIB_BURST_SIZE.
+ */
+void
+rte_distributor_request_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned count);
+
+/**
+ * API called by a worker to check for new packets that were previously
+ * requested by a call to rte_distributor_request_pkt_burst(). It does not
+ * wait for the packets to be available.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param pkts
+ *   An array of RTE_DISTRIB_BURST_SIZE entries, filled with the new packets.
+ *
+ * @return
+ *   The number of new packets in pkts, or -1 if the request has not yet
+ *   been fulfilled by the distributor.
+ */
+int
+rte_distributor_poll_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts);
+
 #ifdef __cplusplus
 }
 #endif
@@ -60,16 +60,20 @@ static inline const struct rte_memzone *
 memzone_lookup_thread_unsafe(const char *name)
 {
 	const struct rte_mem_config *mcfg;
-	unsigned i = 0;
+	unsigned i, n;
 
 	/* get pointer to global configuration */
 	mcfg = rte_eal_get_configuration()->mem_config;
 
 	/*
 	 * the algorithm is not optimal (linear), but there are few
-	 * zones and this function should be called at init only
+	 * zones and this function should be called at init only.
+	 * Freed zones leave empty descriptors, skip them.
 	 */
-	for (i = 0; i < RTE_MAX_MEMZONE && mcfg->memzone[i].addr != NULL; i++) {
+	for (i = 0, n = 0; i < RTE_MAX_MEMZONE && n < mcfg->memzone_idx; i++) {
+		if (mcfg->memzone[i].addr == NULL)
+			continue;
+		n++;
 		if (!strncmp(name, mcfg->memzone[i].name, RTE_MEMZONE_NAMESIZE))
 			return &mcfg->memzone[i];
 	}
@@ -77,6 +81,116 @@ memzone_lookup_thread_unsafe(const char *name)
 	return NULL;
 }
 
+/*
+ * Return the index of the physical memory segment holding the given
+ * virtual address, or -1 if there is none.
+ */
+static int
+memseg_lookup_thread_unsafe(const void *addr)
+{
+	const struct rte_memseg *ms = rte_eal_get_physmem_layout();
+	unsigned i;
+
+	for (i = 0; i < RTE_MAX_MEMSEG && ms[i].addr != NULL; i++) {
+		if (addr >= ms[i].addr && addr < RTE_PTR_ADD(ms[i].addr,
+				(size_t)ms[i].len))
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * Return the index of an unused free segment descriptor, or -1 if there
+ * is none. The descriptors after the first one with a NULL address are
+ * never used, so only this one may be returned.
+ */
+static int
+free_memseg_get_slot_thread_unsafe(void)
+{
+	unsigned i;
+
+	for (i = 0; i < RTE_MAX_MEMSEG; i++) {
+		if (free_memseg[i].addr == NULL || free_memseg[i].len == 0)
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * Describe the free memory area [addr, addr + len) of the physical memory
+ * segment ms in a free segment descriptor.
+ */
+static void
+free_memseg_set(struct rte_memseg *fms, const struct rte_memseg *ms,
+		void *addr, size_t len)
+{
+	size_t off = RTE_PTR_DIFF(addr, ms->addr);
+
+	memcpy(fms, ms, sizeof(*fms));
+	fms->addr = addr;
+	fms->phys_addr = ms->phys_addr + off;
+#ifdef RTE_LIBRTE_IVSHMEM
+	fms->ioremap_addr = ms->ioremap_addr + off;
+#endif
+	fms->len = len;
+}
+
+/*
+ * Give back the memory area [addr, addr + len) of the physical memory
+ * segment ms_idx to the free segments, merging it with the free segments
+ * that are contiguous to it. Return -1 if it had to be recorded in a new
+ * descriptor and none was available.
+ */
+static int
+free_memseg_insert_thread_unsafe(int ms_idx, void *addr, size_t len)
+{
+	const struct rte_memseg *ms = &rte_eal_get_physmem_layout()[ms_idx];
+	void *end = RTE_PTR_ADD(addr, len);
+	int i, prev = -1, next = -1;
+
+	if (len == 0)
+		return 0;
+
+	/* find the free segments ending at addr and starting at end */
+	for (i = 0; i < RTE_MAX_MEMSEG && free_memseg[i].addr != NULL; i++) {
+		if (free_memseg[i].len == 0 ||
+				memseg_lookup_thread_unsafe(free_memseg[i].addr) !=
+				ms_idx)
+			continue;
+		if (RTE_PTR_ADD(free_memseg[i].addr,
+				(size_t)free_memseg[i].len) == addr)
+			prev = i;
+		else if (free_memseg[i].addr == end)
+			next = i;
+	}
+
+	if (prev >= 0 && next >= 0) {
+		/* fill the hole between two free segments, keep the first
+		 * descriptor so that the initial ones are reused */
+		if (prev < next) {
+			free_memseg[prev].len += len + free_memseg[next].len;
+			free_memseg[next].len = 0;
+		} else {
+			free_memseg_set(&free_memseg[next], ms,
+				free_memseg[prev].addr,
+				free_memseg[prev].len + len +
+				free_memseg[next].len);
+			free_memseg[prev].len = 0;
+		}
+	} else if (prev >= 0) {
+		free_memseg[prev].len += len;
+	} else if (next >= 0) {
+		free_memseg_set(&free_memseg[next], ms, addr,
+				len + free_memseg[next].len);
+	} else {
+		i = free_memseg_get_slot_thread_unsafe();
+		if (i < 0)
+			return -1;
+		free_memseg_set(&free_memseg[i], ms, addr, len);
+	}
+	return 0;
+}
+
 /*
  * Return a pointer to a correctly filled memzone descriptor. If the
  * allocation cannot be done, return NULL.
@@ -136,6 +250,7 @@ memzone_reserve_aligned_thread_unsafe(const char *name, size_t len,
 	size_t memseg_len = 0;
 	phys_addr_t memseg_physaddr;
 	void *memseg_addr;
+	int ms_idx;
 
 	/* get pointer to global configuration */
 	mcfg = rte_eal_get_configuration()->mem_config;
@@ -288,6 +403,16 @@ memzone_reserve_aligned_thread_unsafe(const char *name, size_t len,
 	/* set length to correct value */
 	len = (size_t)seg_offset + requested_len;
 
+	/* find an empty descriptor, freed zones may have left some */
+	for (i = 0; i < RTE_MAX_MEMZONE; i++) {
+		if (mcfg->memzone[i].addr == NULL)
+			break;
+	}
+	struct rte_memzone *mz = &mcfg->memzone[i];
+	mcfg->memzone_idx++;
+
+	ms_idx = memseg_lookup_thread_unsafe(free_memseg[memseg_idx].addr);
+
 	/* update our internal state */
 	free_memseg[memseg_idx].len -= len;
 	free_memseg[memseg_idx].phys_addr += len;
@@ -295,7 +420,6 @@ memzone_reserve_aligned_thread_unsafe(const char *name, size_t len,
 		(char *)free_memseg[memseg_idx].addr + len;
 
 	/* fill the zone in config */
-	struct rte_memzone *mz = &mcfg->memzone[mcfg->memzone_idx++];
 	snprintf(mz->name, sizeof(mz->name), "%s", name);
 	mz->phys_addr = memseg_physaddr;
 	mz->addr = memseg_addr;
@@ -303,7 +427,7 @@ memzone_reserve_aligned_thread_unsafe(const char *name, size_t len,
 	mz->hugepage_sz = free_memseg[memseg_idx].hugepage_sz;
 	mz->socket_id = free_memseg[memseg_idx].socket_id;
 	mz->flags = 0;
-	mz->memseg_id = memseg_idx;
+	mz->memseg_id = ms_idx < 0 ? (uint32_t)memseg_idx : (uint32_t)ms_idx;
 
 	return mz;
 }
@@ -372,6 +496,57 @@ rte_memzone_reserve_bounded(const char *name, size_t len,
 }
 
 
+/*
+ * Free a memzone, giving its memory back to the free memory segments.
+ */
+int
+rte_memzone_free(const struct rte_memzone *mz)
+{
+	struct rte_mem_config *mcfg;
+	struct rte_memzone *zone;
+	unsigned idx;
+	int ms_idx, ret = 0;
+
+	if (mz == NULL)
+		return -EINVAL;
+
+	/* get pointer to global configuration */
+	mcfg = rte_eal_get_configuration()->mem_config;
+
+	if (mz < mcfg->memzone || mz >= mcfg->memzone + RTE_MAX_MEMZONE)
+		return -EINVAL;
+	idx = mz - mcfg->memzone;
+	zone = &mcfg->memzone[idx];
+
+	rte_rwlock_write_lock(&mcfg->mlock);
+
+	if (zone->addr == NULL) {
+		/* already freed */
+		ret = -EINVAL;
+#ifdef RTE_LIBRTE_IVSHMEM
+	} else if (zone->ioremap_addr != 0) {
+		/* zones shared through IVSHMEM belong to the host */
+		ret = -EINVAL;
+#endif
+	} else if ((ms_idx = memseg_lookup_thread_unsafe(zone->addr)) < 0 ||
+			free_memseg_insert_thread_unsafe(ms_idx, zone->addr,
+				zone->len) < 0) {
+		/* the memory can't be tracked as free, keep the zone */
+		RTE_LOG(ERR, EAL, "%s(): Cannot free memzone <%s>\n",
+			__func__, zone->name);
+		ret = -ENOSPC;
+	} else {
+		/* reserved memory is zeroed, as it is at init */
+		memset(zone->addr, 0, zone->len);
+		memset(zone, 0, sizeof(*zone));
+		mcfg->memzone_idx--;
+	}
+
+	rte_rwlock_write_unlock(&mcfg->mlock);
+
+	return ret;
+}
+
 /*
  * Lookup for the memzone identified by the given name
  */
@@ -406,7 +581,7 @@ rte_memzone_dump(FILE *f)
 	/* dump all zones */
 	for (i=0; i<RTE_MAX_MEMZONE; i++) {
 		if (mcfg->memzone[i].addr == NULL)
-			break;
+			continue;
 		fprintf(f, "Zone %u: name:<%s>, phys:0x%"PRIx64", len:0x%zx"
 		       ", virt:%p, socket_id:%"PRId32", flags:%"PRIx32"\n", i,
 		       mcfg->memzone[i].name,
@@ -53,6 +53,16 @@ extern "C" {
 
 #define	rte_rmb() _mm_lfence()
 
+/*
+ * Stores are not reordered with other stores and loads are not reordered
+ * with other loads, so only the compiler has to be kept from doing so.
+ */
+#define	rte_smp_mb() rte_mb()
+
+#define	rte_smp_wmb() rte_compiler_barrier()
+
+#define	rte_smp_rmb() rte_compiler_barrier()
+
 /*------------------------- 16 bit atomic operations -------------------------*/
 
 #ifndef RTE_FORCE_INTRINSICS
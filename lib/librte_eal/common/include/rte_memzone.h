@@ -239,6 +239,25 @@ const struct rte_memzone *rte_memzone_reserve_bounded(const char *name,
 			size_t len, int socket_id,
 			unsigned flags, unsigned align, unsigned bound);
 
+/**
+ * Free a memzone.
+ *
+ * The memory of the zone is zeroed and given back to the free memory
+ * segments, merged with the free memory around it, and can be reserved
+ * again. The descriptor of the zone is released, so the pointer must not be used
+ * anymore, nor the memory of the zone.
+ *
+ * @param mz
+ *   A pointer to the memzone descriptor returned by a reserve function.
+ * @return
+ *  - 0 on success.
+ *  - -EINVAL if the memzone is not reserved or belongs to the host
+ *    (IVSHMEM).
+ *  - -ENOSPC if there is no descriptor left to track the freed memory; the
+ *    memzone is kept reserved.
+ */
+int rte_memzone_free(const struct rte_memzone *mz);
+
 /**
  * Lookup for a memzone.
  *
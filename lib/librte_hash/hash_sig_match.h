@@ -0,0 +1,63 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _HASH_SIG_MATCH_H_
+#define _HASH_SIG_MATCH_H_
+
+/**
+ * @file
+ *
+ * Signature bucket compare functions used internally by rte_hash.
+ *
+ * Each function returns a bitmask with bit i set when sig_bucket[i] equals
+ * sig, for the first num_sigs entries of the bucket. Signature buckets are
+ * 16-byte aligned and padded to a multiple of 16 bytes, so vector versions
+ * may read the padding but never report matches in it.
+ */
+
+#include <stdint.h>
+
+#include "rte_hash.h"
+
+typedef uint32_t (*hash_sig_match_t)(hash_sig_t sig,
+		const hash_sig_t *sig_bucket, uint32_t num_sigs);
+
+uint32_t
+hash_sig_match_sse(hash_sig_t sig, const hash_sig_t *sig_bucket,
+		uint32_t num_sigs);
+
+uint32_t
+hash_sig_match_avx2(hash_sig_t sig, const hash_sig_t *sig_bucket,
+		uint32_t num_sigs);
+
+#endif /* _HASH_SIG_MATCH_H_ */
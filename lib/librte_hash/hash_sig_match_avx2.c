@@ -0,0 +1,64 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "hash_sig_match.h"
+
+uint32_t
+hash_sig_match_avx2(hash_sig_t sig, const hash_sig_t *sig_bucket,
+		uint32_t num_sigs)
+{
+	const __m256i key = _mm256_set1_epi32(sig);
+	__m256i cmp;
+	__m128i cmp4;
+	uint32_t i, hits = 0;
+
+	/* Buckets of up to 4 entries fit in one 16-byte lane */
+	if (num_sigs <= 4) {
+		cmp4 = _mm_cmpeq_epi32(_mm256_castsi256_si128(key),
+			_mm_load_si128((const __m128i *)sig_bucket));
+		hits = _mm_movemask_ps(_mm_castsi128_ps(cmp4));
+		return hits & ((1 << num_sigs) - 1);
+	}
+
+	for (i = 0; i < num_sigs; i += 8) {
+		cmp = _mm256_cmpeq_epi32(key,
+			_mm256_loadu_si256((const __m256i *)&sig_bucket[i]));
+		hits |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(cmp))
+			<< i;
+	}
+
+	return hits;
+}
@@ -44,6 +44,7 @@
 #include <rte_memcpy.h>
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
+#include <rte_atomic.h>
 #include <rte_memzone.h>
 #include <rte_malloc.h>
 #include <rte_tailq.h>
@@ -54,10 +55,12 @@
 #include <rte_string_fns.h>
 #include <rte_cpuflags.h>
 #include <rte_log.h>
+#include <rte_random.h>
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
 
 #include "rte_hash.h"
+#include "hash_sig_match.h"
 
 
 TAILQ_HEAD(rte_hash_list, rte_tailq_entry);
@@ -89,6 +92,14 @@ TAILQ_HEAD(rte_hash_list, rte_tailq_entry);
 /* The high bit is always set in real signatures */
 #define NULL_SIGNATURE          0
 
+/* Odd multiplier spreading the signature bits used for the alternative
+ * bucket of a cuckoo table over the whole bucket index range */
+#define CUCKOO_ALT_BUCKET_MULT  0x5bd1e995
+
+/* All extra flags known by this implementation */
+#define EXTRA_FLAGS_MASK        (RTE_HASH_EXTRA_FLAGS_CUCKOO | \
+				 RTE_HASH_EXTRA_FLAGS_MULTI_READER)
+
 /* Returns a pointer to the first signature in specified bucket. */
 static inline hash_sig_t *
 get_sig_tbl_bucket(const struct rte_hash *h, uint32_t bucket_index)
@@ -112,6 +123,33 @@ get_key_from_bucket(const struct rte_hash *h, uint8_t *bkt, uint32_t pos)
 	return (void *) &bkt[pos * h->key_tbl_key_size];
 }
 
+/* Returns a pointer to the key slot indexes of a cuckoo table bucket. */
+static inline uint32_t *
+get_idx_tbl_bucket(const struct rte_hash *h, uint32_t bucket_index)
+{
+	return &h->idx_tbl[bucket_index * h->bucket_entries];
+}
+
+/* Returns a pointer to the key stored in a key slot of a cuckoo table. */
+static inline void *
+get_key_from_slot(const struct rte_hash *h, uint32_t key_idx)
+{
+	return (void *) &h->key_tbl[key_idx * h->key_tbl_key_size];
+}
+
+/*
+ * Returns the other candidate bucket of a signature in a cuckoo table. The
+ * bucket index is XORed with a value that depends on the signature only, so
+ * the same call maps the alternative bucket back to the primary one.
+ */
+static inline uint32_t
+get_alt_bucket_index(const struct rte_hash *h, uint32_t bucket_index,
+		hash_sig_t sig)
+{
+	return (bucket_index ^ (((sig >> 16) * CUCKOO_ALT_BUCKET_MULT) | 1)) &
+		h->bucket_bitmask;
+}
+
 /* Does integer division with rounding-up of result. */
 static inline uint32_t
 div_roundup(uint32_t numerator, uint32_t denominator)
@@ -126,15 +164,120 @@ align_size(uint32_t val, uint32_t alignment)
 	return alignment * div_roundup(val, alignment);
 }
 
+/* Signature compare used when no vector unit is available. */
+static uint32_t
+hash_sig_match_scalar(hash_sig_t sig, const hash_sig_t *sig_bucket,
+		uint32_t num_sigs)
+{
+	uint32_t i, hits = 0;
+
+	for (i = 0; i < num_sigs; i++)
+		hits |= (uint32_t)(sig == sig_bucket[i]) << i;
+	return hits;
+}
+
+/* Signature compare selected at start-up, see rte_hash_init(). */
+static hash_sig_match_t sig_match = hash_sig_match_scalar;
+
+static void __attribute__((constructor))
+rte_hash_init(void)
+{
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686)
+#ifdef CC_AVX2_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2)) {
+		sig_match = hash_sig_match_avx2;
+		return;
+	}
+#endif
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE2))
+		sig_match = hash_sig_match_sse;
+#endif
+}
+
 /* Returns the index into the bucket of the first occurrence of a signature. */
 static inline int
 find_first(uint32_t sig, const uint32_t *sig_bucket, uint32_t num_sigs)
 {
+	uint32_t hits = sig_match(sig, sig_bucket, num_sigs);
+
+	return (hits == 0) ? -1 : (int)rte_bsf32(hits);
+}
+
+/*
+ * Bucket versions of RTE_HASH_EXTRA_FLAGS_MULTI_READER tables. The writer
+ * makes the version of a bucket odd before changing it and even again once
+ * done. Readers retry when the version they started with was odd or has
+ * changed by the time they are done. The SMP barriers order the version
+ * accesses with the key and data accesses; on x86 they only stop the
+ * compiler from reordering.
+ */
+static inline uint32_t
+bucket_read_begin(const struct rte_hash *h, uint32_t bucket_index)
+{
+	volatile uint32_t *ver = h->bkt_ver;
+	uint32_t v;
+
+	if (!(h->extra_flag & RTE_HASH_EXTRA_FLAGS_MULTI_READER))
+		return 0;
+
+	while (unlikely((v = ver[bucket_index]) & 1))
+		rte_pause();
+	rte_smp_rmb();
+	return v;
+}
+
+static inline int
+bucket_read_retry(const struct rte_hash *h, uint32_t bucket_index,
+		uint32_t v)
+{
+	volatile uint32_t *ver = h->bkt_ver;
+
+	if (!(h->extra_flag & RTE_HASH_EXTRA_FLAGS_MULTI_READER))
+		return 0;
+
+	rte_smp_rmb();
+	return unlikely(ver[bucket_index] != v);
+}
+
+static inline void
+bucket_write_begin(const struct rte_hash *h, uint32_t bucket_index)
+{
+	volatile uint32_t *ver = h->bkt_ver;
+
+	if (!(h->extra_flag & RTE_HASH_EXTRA_FLAGS_MULTI_READER))
+		return;
+
+	ver[bucket_index]++;
+	rte_smp_wmb();
+}
+
+static inline void
+bucket_write_end(const struct rte_hash *h, uint32_t bucket_index)
+{
+	volatile uint32_t *ver = h->bkt_ver;
+
+	if (!(h->extra_flag & RTE_HASH_EXTRA_FLAGS_MULTI_READER))
+		return;
+
+	rte_smp_wmb();
+	ver[bucket_index]++;
+}
+
+/* Returns the position of a key among the signature hits of a bucket, or -1. */
+static inline int
+find_key_in_bucket(const struct rte_hash *h, uint32_t bucket_index,
+		const void *key, uint32_t hits)
+{
+	uint8_t *key_bucket = get_key_tbl_bucket(h, bucket_index);
 	uint32_t i;
-	for (i = 0; i < num_sigs; i++) {
-		if (sig == sig_bucket[i])
+
+	for (; hits != 0; hits &= hits - 1) {
+		i = rte_bsf32(hits);
+		if (likely(memcmp(key, get_key_from_bucket(h, key_bucket, i),
+				  h->key_len) == 0))
 			return i;
 	}
+
 	return -1;
 }
 
@@ -172,8 +315,10 @@ rte_hash_create(const struct rte_hash_parameters *params)
 {
 	struct rte_hash *h = NULL;
 	struct rte_tailq_entry *te;
-	uint32_t num_buckets, sig_bucket_size, key_size,
-		hash_tbl_size, sig_tbl_size, key_tbl_size, mem_size;
+	uint32_t num_buckets, sig_bucket_size, key_size, hash_tbl_size,
+		sig_tbl_size, key_tbl_size, idx_tbl_size, free_slots_size,
+		bkt_ver_size, mem_size, i;
+	int cuckoo;
 	char hash_name[RTE_HASH_NAMESIZE];
 	struct rte_hash_list *hash_list;
 
@@ -192,7 +337,8 @@ rte_hash_create(const struct rte_hash_parameters *params)
 			!rte_is_power_of_2(params->entries) ||
 			!rte_is_power_of_2(params->bucket_entries) ||
 			(params->key_len == 0) ||
-			(params->key_len > RTE_HASH_KEY_LENGTH_MAX)) {
+			(params->key_len > RTE_HASH_KEY_LENGTH_MAX) ||
+			(params->extra_flag & ~EXTRA_FLAGS_MASK)) {
 		rte_errno = EINVAL;
 		RTE_LOG(ERR, HASH, "rte_hash_create has invalid parameters\n");
 		return NULL;
@@ -212,8 +358,27 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	key_tbl_size = align_size(num_buckets * key_size *
 				  params->bucket_entries, RTE_CACHE_LINE_SIZE);
 
+	/* Cuckoo tables store keys out of line, indexed from each signature */
+	cuckoo = (params->extra_flag & RTE_HASH_EXTRA_FLAGS_CUCKOO) != 0;
+	idx_tbl_size = 0;
+	free_slots_size = 0;
+	if (cuckoo) {
+		idx_tbl_size = align_size(params->entries * sizeof(uint32_t),
+					  RTE_CACHE_LINE_SIZE);
+		free_slots_size = align_size(sizeof(struct rte_hash_free_slots) +
+					     params->entries * sizeof(uint32_t),
+					     RTE_CACHE_LINE_SIZE);
+	}
+
+	/* Multi-reader tables keep one version counter per bucket */
+	bkt_ver_size = 0;
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_MULTI_READER)
+		bkt_ver_size = align_size(num_buckets * sizeof(uint32_t),
+					  RTE_CACHE_LINE_SIZE);
+
 	/* Total memory required for hash context */
-	mem_size = hash_tbl_size + sig_tbl_size + key_tbl_size;
+	mem_size = hash_tbl_size + sig_tbl_size + key_tbl_size +
+		idx_tbl_size + free_slots_size + bkt_ver_size;
 
 	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
 
@@ -255,6 +420,22 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->key_tbl_key_size = key_size;
 	h->hash_func = (params->hash_func == NULL) ?
 		DEFAULT_HASH_FUNC : params->hash_func;
+	h->extra_flag = params->extra_flag;
+
+	if (cuckoo) {
+		h->idx_tbl = (uint32_t *)(h->key_tbl + key_tbl_size);
+		h->free_slots = (struct rte_hash_free_slots *)
+			((uint8_t *)h->idx_tbl + idx_tbl_size);
+
+		/* Stack the key slots so that slot 0 is handed out first */
+		h->free_slots->n_free = h->entries;
+		for (i = 0; i < h->entries; i++)
+			h->free_slots->idx[i] = h->entries - 1 - i;
+	}
+
+	if (bkt_ver_size != 0)
+		h->bkt_ver = (uint32_t *)(h->key_tbl + key_tbl_size +
+					  idx_tbl_size + free_slots_size);
 
 	te->data = (void *) h;
 
@@ -303,15 +484,258 @@ rte_hash_free(struct rte_hash *h)
 	rte_free(te);
 }
 
+/* Returns the position of a key among the signature hits of a cuckoo table
+ * bucket, or -1. */
+static inline int
+cuckoo_find_key_in_bucket(const struct rte_hash *h, uint32_t bucket_index,
+		const void *key, uint32_t hits)
+{
+	const uint32_t *idx_bucket = get_idx_tbl_bucket(h, bucket_index);
+	uint32_t i;
+
+	for (; hits != 0; hits &= hits - 1) {
+		i = rte_bsf32(hits);
+		if (likely(memcmp(key, get_key_from_slot(h, idx_bucket[i]),
+				  h->key_len) == 0))
+			return i;
+	}
+
+	return -1;
+}
+
+/* Returns the position of a key in a cuckoo table bucket, or -1. */
+static inline int
+cuckoo_find_in_bucket(const struct rte_hash *h, uint32_t bucket_index,
+		const void *key, hash_sig_t sig)
+{
+	return cuckoo_find_key_in_bucket(h, bucket_index, key,
+			sig_match(sig, get_sig_tbl_bucket(h, bucket_index),
+				  h->bucket_entries));
+}
+
+/* One step of a cuckoo path: the entry at position pos of bucket
+ * bucket_index is moved to its alternative bucket. */
+struct cuckoo_move {
+	uint32_t bucket_index;
+	uint32_t pos;
+};
+
+/*
+ * Looks for a chain of displacements that frees one slot of the (full)
+ * bucket start_index, without modifying the table. Each entry is displaced
+ * at most once, so applying the path backwards always moves the entry that
+ * was seen here. Returns the number of moves, or -1 if there is no path of
+ * at most RTE_HASH_CUCKOO_MAX_PATH moves.
+ */
+static int
+cuckoo_find_path(const struct rte_hash *h, uint32_t start_index,
+		struct cuckoo_move *path)
+{
+	const hash_sig_t *sig_bucket;
+	uint32_t bucket_index = start_index;
+	uint32_t n, i, k, pos;
+
+	for (n = 0; n < RTE_HASH_CUCKOO_MAX_PATH; n++) {
+		sig_bucket = get_sig_tbl_bucket(h, bucket_index);
+
+		/* Pick a random victim that is not already on the path */
+		pos = rte_rand() & (h->bucket_entries - 1);
+		for (i = 0; i < h->bucket_entries; i++) {
+			for (k = 0; k < n; k++) {
+				if ((path[k].bucket_index == bucket_index) &&
+				    (path[k].pos == pos))
+					break;
+			}
+			if (k == n)
+				break;
+			pos = (pos + 1) & (h->bucket_entries - 1);
+		}
+		if (i == h->bucket_entries)
+			return -1;
+
+		path[n].bucket_index = bucket_index;
+		path[n].pos = pos;
+
+		bucket_index = get_alt_bucket_index(h, bucket_index,
+						    sig_bucket[pos]);
+		if (find_first(NULL_SIGNATURE, get_sig_tbl_bucket(h, bucket_index),
+			       h->bucket_entries) >= 0)
+			return n + 1;
+	}
+
+	return -1;
+}
+
+/*
+ * Moves the entries of a cuckoo path, last one first, so that every entry is
+ * copied to its alternative bucket before its old slot is released.
+ */
+static void
+cuckoo_apply_path(const struct rte_hash *h, const struct cuckoo_move *path,
+		int n)
+{
+	hash_sig_t *src_sig, *dst_sig;
+	uint32_t *src_idx, *dst_idx;
+	uint32_t dst_index;
+	int i, dst_pos;
+
+	for (i = n - 1; i >= 0; i--) {
+		src_sig = get_sig_tbl_bucket(h, path[i].bucket_index);
+		src_idx = get_idx_tbl_bucket(h, path[i].bucket_index);
+		dst_index = get_alt_bucket_index(h, path[i].bucket_index,
+						 src_sig[path[i].pos]);
+		dst_sig = get_sig_tbl_bucket(h, dst_index);
+		dst_idx = get_idx_tbl_bucket(h, dst_index);
+		dst_pos = find_first(NULL_SIGNATURE, dst_sig, h->bucket_entries);
+
+		bucket_write_begin(h, path[i].bucket_index);
+		if (dst_index != path[i].bucket_index)
+			bucket_write_begin(h, dst_index);
+
+		dst_idx[dst_pos] = src_idx[path[i].pos];
+		dst_sig[dst_pos] = src_sig[path[i].pos];
+		src_sig[path[i].pos] = NULL_SIGNATURE;
+
+		if (dst_index != path[i].bucket_index)
+			bucket_write_end(h, dst_index);
+		bucket_write_end(h, path[i].bucket_index);
+	}
+}
+
+static inline int32_t
+__rte_hash_cuckoo_add_key_with_hash(const struct rte_hash *h,
+				const void *key, hash_sig_t sig)
+{
+	struct cuckoo_move path[RTE_HASH_CUCKOO_MAX_PATH];
+	struct rte_hash_free_slots *free_slots = h->free_slots;
+	uint32_t prim_index, alt_index, bucket_index, key_idx;
+	int pos, n;
+
+	/* Get the hash signature and both candidate buckets */
+	sig |= h->sig_msb;
+	prim_index = sig & h->bucket_bitmask;
+	alt_index = get_alt_bucket_index(h, prim_index, sig);
+
+	/* Check if key is already present in the hash */
+	pos = cuckoo_find_in_bucket(h, prim_index, key, sig);
+	if (pos >= 0)
+		return get_idx_tbl_bucket(h, prim_index)[pos];
+	pos = cuckoo_find_in_bucket(h, alt_index, key, sig);
+	if (pos >= 0)
+		return get_idx_tbl_bucket(h, alt_index)[pos];
+
+	if (unlikely(free_slots->n_free == 0))
+		return -ENOSPC;
+
+	/* Use a free slot of either bucket, or make room by displacement */
+	bucket_index = prim_index;
+	pos = find_first(NULL_SIGNATURE, get_sig_tbl_bucket(h, prim_index),
+			 h->bucket_entries);
+	if (pos < 0) {
+		bucket_index = alt_index;
+		pos = find_first(NULL_SIGNATURE,
+				 get_sig_tbl_bucket(h, alt_index),
+				 h->bucket_entries);
+	}
+	if (pos < 0) {
+		bucket_index = prim_index;
+		n = cuckoo_find_path(h, prim_index, path);
+		if (n < 0) {
+			bucket_index = alt_index;
+			n = cuckoo_find_path(h, alt_index, path);
+		}
+		if (unlikely(n < 0))
+			return -ENOSPC;
+
+		cuckoo_apply_path(h, path, n);
+		pos = find_first(NULL_SIGNATURE,
+				 get_sig_tbl_bucket(h, bucket_index),
+				 h->bucket_entries);
+	}
+
+	/* Store the key, then publish it through the signature */
+	key_idx = free_slots->idx[--free_slots->n_free];
+	rte_memcpy(get_key_from_slot(h, key_idx), key, h->key_len);
+	bucket_write_begin(h, bucket_index);
+	get_idx_tbl_bucket(h, bucket_index)[pos] = key_idx;
+	get_sig_tbl_bucket(h, bucket_index)[pos] = sig;
+	bucket_write_end(h, bucket_index);
+	return key_idx;
+}
+
+static inline int32_t
+__rte_hash_cuckoo_del_key_with_hash(const struct rte_hash *h,
+				const void *key, hash_sig_t sig)
+{
+	struct rte_hash_free_slots *free_slots = h->free_slots;
+	uint32_t bucket_index, key_idx;
+	int pos;
+
+	/* Get the hash signature and look in both candidate buckets */
+	sig |= h->sig_msb;
+	bucket_index = sig & h->bucket_bitmask;
+	pos = cuckoo_find_in_bucket(h, bucket_index, key, sig);
+	if (pos < 0) {
+		bucket_index = get_alt_bucket_index(h, bucket_index, sig);
+		pos = cuckoo_find_in_bucket(h, bucket_index, key, sig);
+		if (pos < 0)
+			return -ENOENT;
+	}
+
+	key_idx = get_idx_tbl_bucket(h, bucket_index)[pos];
+	bucket_write_begin(h, bucket_index);
+	get_sig_tbl_bucket(h, bucket_index)[pos] = NULL_SIGNATURE;
+	bucket_write_end(h, bucket_index);
+	free_slots->idx[free_slots->n_free++] = key_idx;
+	return key_idx;
+}
+
+static inline int32_t
+__rte_hash_cuckoo_lookup_with_hash(const struct rte_hash *h,
+				const void *key, hash_sig_t sig)
+{
+	uint32_t prim_index, alt_index, prim_ver, alt_ver;
+	int32_t ret;
+	int pos;
+
+	/* Get the hash signature and both candidate buckets */
+	sig |= h->sig_msb;
+	prim_index = sig & h->bucket_bitmask;
+	alt_index = get_alt_bucket_index(h, prim_index, sig);
+
+	/* Both versions are read first, as the writer may move the key from
+	 * one bucket to the other while it is being looked for */
+	do {
+		prim_ver = bucket_read_begin(h, prim_index);
+		alt_ver = bucket_read_begin(h, alt_index);
+
+		pos = cuckoo_find_in_bucket(h, prim_index, key, sig);
+		if (pos >= 0)
+			ret = get_idx_tbl_bucket(h, prim_index)[pos];
+		else {
+			pos = cuckoo_find_in_bucket(h, alt_index, key, sig);
+			ret = (pos >= 0) ?
+				(int32_t)get_idx_tbl_bucket(h, alt_index)[pos] :
+				-ENOENT;
+		}
+	} while (bucket_read_retry(h, prim_index, prim_ver) ||
+		 bucket_read_retry(h, alt_index, alt_ver));
+
+	return ret;
+}
+
 static inline int32_t
 __rte_hash_add_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig)
 {
 	hash_sig_t *sig_bucket;
 	uint8_t *key_bucket;
-	uint32_t bucket_index, i;
+	uint32_t bucket_index;
 	int32_t pos;
 
+	if (h->extra_flag & RTE_HASH_EXTRA_FLAGS_CUCKOO)
+		return __rte_hash_cuckoo_add_key_with_hash(h, key, sig);
+
 	/* Get the hash signature and bucket index */
 	sig |= h->sig_msb;
 	bucket_index = sig & h->bucket_bitmask;
@@ -319,13 +743,10 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h,
 	key_bucket = get_key_tbl_bucket(h, bucket_index);
 
 	/* Check if key is already present in the hash */
-	for (i = 0; i < h->bucket_entries; i++) {
-		if ((sig == sig_bucket[i]) &&
-		    likely(memcmp(key, get_key_from_bucket(h, key_bucket, i),
-				  h->key_len) == 0)) {
-			return bucket_index * h->bucket_entries + i;
-		}
-	}
+	pos = find_key_in_bucket(h, bucket_index, key,
+			sig_match(sig, sig_bucket, h->bucket_entries));
+	if (pos >= 0)
+		return bucket_index * h->bucket_entries + pos;
 
 	/* Check if any free slot within the bucket to add the new key */
 	pos = find_first(NULL_SIGNATURE, sig_bucket, h->bucket_entries);
@@ -333,9 +754,12 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h,
 	if (unlikely(pos < 0))
 		return -ENOSPC;
 
-	/* Add the new key to the bucket */
-	sig_bucket[pos] = sig;
+	/* Add the new key to the bucket, publishing it with its signature */
+	bucket_write_begin(h, bucket_index);
 	rte_memcpy(get_key_from_bucket(h, key_bucket, pos), key, h->key_len);
+	rte_smp_wmb();
+	sig_bucket[pos] = sig;
+	bucket_write_end(h, bucket_index);
 	return bucket_index * h->bucket_entries + pos;
 }
 
@@ -359,26 +783,27 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig)
 {
 	hash_sig_t *sig_bucket;
-	uint8_t *key_bucket;
-	uint32_t bucket_index, i;
+	uint32_t bucket_index;
+	int pos;
+
+	if (h->extra_flag & RTE_HASH_EXTRA_FLAGS_CUCKOO)
+		return __rte_hash_cuckoo_del_key_with_hash(h, key, sig);
 
 	/* Get the hash signature and bucket index */
 	sig = sig | h->sig_msb;
 	bucket_index = sig & h->bucket_bitmask;
 	sig_bucket = get_sig_tbl_bucket(h, bucket_index);
-	key_bucket = get_key_tbl_bucket(h, bucket_index);
 
 	/* Check if key is already present in the hash */
-	for (i = 0; i < h->bucket_entries; i++) {
-		if ((sig == sig_bucket[i]) &&
-		    likely(memcmp(key, get_key_from_bucket(h, key_bucket, i),
-				  h->key_len) == 0)) {
-			sig_bucket[i] = NULL_SIGNATURE;
-			return bucket_index * h->bucket_entries + i;
-		}
-	}
-
-	return -ENOENT;
+	pos = find_key_in_bucket(h, bucket_index, key,
+			sig_match(sig, sig_bucket, h->bucket_entries));
+	if (pos < 0)
+		return -ENOENT;
+
+	bucket_write_begin(h, bucket_index);
+	sig_bucket[pos] = NULL_SIGNATURE;
+	bucket_write_end(h, bucket_index);
+	return bucket_index * h->bucket_entries + pos;
 }
 
 int32_t
@@ -400,26 +825,27 @@ static inline int32_t
 __rte_hash_lookup_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
 {
-	hash_sig_t *sig_bucket;
-	uint8_t *key_bucket;
-	uint32_t bucket_index, i;
+	uint32_t bucket_index, ver;
+	int pos;
+
+	if (h->extra_flag & RTE_HASH_EXTRA_FLAGS_CUCKOO)
+		return __rte_hash_cuckoo_lookup_with_hash(h, key, sig);
 
 	/* Get the hash signature and bucket index */
 	sig |= h->sig_msb;
 	bucket_index = sig & h->bucket_bitmask;
-	sig_bucket = get_sig_tbl_bucket(h, bucket_index);
-	key_bucket = get_key_tbl_bucket(h, bucket_index);
 
 	/* Check if key is already present in the hash */
-	for (i = 0; i < h->bucket_entries; i++) {
-		if ((sig == sig_bucket[i]) &&
-		    likely(memcmp(key, get_key_from_bucket(h, key_bucket, i),
-				  h->key_len) == 0)) {
-			return bucket_index * h->bucket_entries + i;
-		}
-	}
+	do {
+		ver = bucket_read_begin(h, bucket_index);
+		pos = find_key_in_bucket(h, bucket_index, key,
+				sig_match(sig, get_sig_tbl_bucket(h, bucket_index),
+					  h->bucket_entries));
+	} while (bucket_read_retry(h, bucket_index, ver));
+	if (pos < 0)
+		return -ENOENT;
 
-	return -ENOENT;
+	return bucket_index * h->bucket_entries + pos;
 }
 
 int32_t
@@ -437,46 +863,145 @@ rte_hash_lookup(const struct rte_hash *h, const void *key)
 	return __rte_hash_lookup_with_hash(h, key, rte_hash_hash(h, key));
 }
 
+/*
+ * Bulk lookups run as a three stage pipeline over the whole burst, so that
+ * the memory accesses of one stage are in flight for all keys before the
+ * next stage needs them:
+ *   - stage 0: hash each key and prefetch its signature bucket(s)
+ *   - stage 1: compare signatures and prefetch the first candidate key
+ *   - stage 2: compare keys and return the positions
+ */
+static inline void
+__rte_hash_cuckoo_lookup_bulk(const struct rte_hash *h, const void **keys,
+		      uint32_t num_keys, int32_t *positions)
+{
+	uint32_t i, prim_index, alt_index;
+	uint32_t prim_hits[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t alt_hits[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t prim_ver[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t alt_ver[RTE_HASH_LOOKUP_BULK_MAX];
+	hash_sig_t sigs[RTE_HASH_LOOKUP_BULK_MAX];
+	int pos;
+
+	/* Stage 0: prefetch both candidate buckets */
+	for (i = 0; i < num_keys; i++) {
+		sigs[i] = h->hash_func(keys[i], h->key_len,
+				h->hash_func_init_val) | h->sig_msb;
+		prim_index = sigs[i] & h->bucket_bitmask;
+		alt_index = get_alt_bucket_index(h, prim_index, sigs[i]);
+
+		rte_prefetch0((void *) get_sig_tbl_bucket(h, prim_index));
+		rte_prefetch0((void *) get_idx_tbl_bucket(h, prim_index));
+		rte_prefetch0((void *) get_sig_tbl_bucket(h, alt_index));
+		rte_prefetch1((void *) get_idx_tbl_bucket(h, alt_index));
+		if (h->extra_flag & RTE_HASH_EXTRA_FLAGS_MULTI_READER) {
+			rte_prefetch0((void *) &h->bkt_ver[prim_index]);
+			rte_prefetch0((void *) &h->bkt_ver[alt_index]);
+		}
+	}
+
+	/* Stage 1: signature compare, prefetch the first candidate key */
+	for (i = 0; i < num_keys; i++) {
+		prim_index = sigs[i] & h->bucket_bitmask;
+		alt_index = get_alt_bucket_index(h, prim_index, sigs[i]);
+		prim_ver[i] = bucket_read_begin(h, prim_index);
+		alt_ver[i] = bucket_read_begin(h, alt_index);
+		prim_hits[i] = sig_match(sigs[i],
+				get_sig_tbl_bucket(h, prim_index),
+				h->bucket_entries);
+		alt_hits[i] = sig_match(sigs[i],
+				get_sig_tbl_bucket(h, alt_index),
+				h->bucket_entries);
+
+		if (prim_hits[i] != 0)
+			rte_prefetch0(get_key_from_slot(h,
+				get_idx_tbl_bucket(h, prim_index)
+					[rte_bsf32(prim_hits[i])]));
+		else if (alt_hits[i] != 0)
+			rte_prefetch0(get_key_from_slot(h,
+				get_idx_tbl_bucket(h, alt_index)
+					[rte_bsf32(alt_hits[i])]));
+	}
+
+	/* Stage 2: key compare, primary bucket first */
+	for (i = 0; i < num_keys; i++) {
+		prim_index = sigs[i] & h->bucket_bitmask;
+		alt_index = get_alt_bucket_index(h, prim_index, sigs[i]);
+		pos = cuckoo_find_key_in_bucket(h, prim_index, keys[i],
+						prim_hits[i]);
+		if (likely(pos >= 0))
+			positions[i] = get_idx_tbl_bucket(h, prim_index)[pos];
+		else {
+			pos = cuckoo_find_key_in_bucket(h, alt_index, keys[i],
+							alt_hits[i]);
+			positions[i] = (pos >= 0) ?
+				(int32_t)get_idx_tbl_bucket(h, alt_index)[pos] :
+				-ENOENT;
+		}
+
+		/* Redo the lookup alone if the writer got in the way */
+		if (bucket_read_retry(h, prim_index, prim_ver[i]) ||
+		    bucket_read_retry(h, alt_index, alt_ver[i]))
+			positions[i] = __rte_hash_cuckoo_lookup_with_hash(h,
+							keys[i], sigs[i]);
+	}
+}
+
 int
 rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		      uint32_t num_keys, int32_t *positions)
 {
-	uint32_t i, j, bucket_index;
+	uint32_t i, bucket_index;
+	uint32_t hits[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t vers[RTE_HASH_LOOKUP_BULK_MAX];
 	hash_sig_t sigs[RTE_HASH_LOOKUP_BULK_MAX];
+	int pos;
 
 	RETURN_IF_TRUE(((h == NULL) || (keys == NULL) || (num_keys == 0) ||
 			(num_keys > RTE_HASH_LOOKUP_BULK_MAX) ||
 			(positions == NULL)), -EINVAL);
 
-	/* Get the hash signature and bucket index */
+	if (h->extra_flag & RTE_HASH_EXTRA_FLAGS_CUCKOO) {
+		__rte_hash_cuckoo_lookup_bulk(h, keys, num_keys, positions);
+		return 0;
+	}
+
+	/* Stage 0: get the hash signature and prefetch the bucket */
 	for (i = 0; i < num_keys; i++) {
 		sigs[i] = h->hash_func(keys[i], h->key_len,
 				h->hash_func_init_val) | h->sig_msb;
 		bucket_index = sigs[i] & h->bucket_bitmask;
 
-		/* Pre-fetch relevant buckets */
-		rte_prefetch1((void *) get_sig_tbl_bucket(h, bucket_index));
-		rte_prefetch1((void *) get_key_tbl_bucket(h, bucket_index));
+		rte_prefetch0((void *) get_sig_tbl_bucket(h, bucket_index));
+		if (h->extra_flag & RTE_HASH_EXTRA_FLAGS_MULTI_READER)
+			rte_prefetch0((void *) &h->bkt_ver[bucket_index]);
 	}
 
-	/* Check if key is already present in the hash */
+	/* Stage 1: signature compare, prefetch the first candidate key */
 	for (i = 0; i < num_keys; i++) {
 		bucket_index = sigs[i] & h->bucket_bitmask;
-		hash_sig_t *sig_bucket = get_sig_tbl_bucket(h, bucket_index);
-		uint8_t *key_bucket = get_key_tbl_bucket(h, bucket_index);
-
-		positions[i] = -ENOENT;
-
-		for (j = 0; j < h->bucket_entries; j++) {
-			if ((sigs[i] == sig_bucket[j]) &&
-			    likely(memcmp(keys[i],
-					  get_key_from_bucket(h, key_bucket, j),
-					  h->key_len) == 0)) {
-				positions[i] = bucket_index *
-					h->bucket_entries + j;
-				break;
-			}
-		}
+		vers[i] = bucket_read_begin(h, bucket_index);
+		hits[i] = sig_match(sigs[i], get_sig_tbl_bucket(h, bucket_index),
+				    h->bucket_entries);
+
+		if (hits[i] != 0)
+			rte_prefetch0(get_key_from_bucket(h,
+				get_key_tbl_bucket(h, bucket_index),
+				rte_bsf32(hits[i])));
+	}
+
+	/* Stage 2: check if key is present in the hash */
+	for (i = 0; i < num_keys; i++) {
+		bucket_index = sigs[i] & h->bucket_bitmask;
+		pos = find_key_in_bucket(h, bucket_index, keys[i], hits[i]);
+		positions[i] = (pos >= 0) ?
+			(int32_t)(bucket_index * h->bucket_entries + pos) :
+			-ENOENT;
+
+		/* Redo the lookup alone if the writer got in the way */
+		if (bucket_read_retry(h, bucket_index, vers[i]))
+			positions[i] = __rte_hash_lookup_with_hash(h, keys[i],
+								   sigs[i]);
 	}
 
 	return 0;
@@ -63,6 +63,23 @@ extern "C" {
 /** Max number of characters in hash name.*/
 #define RTE_HASH_NAMESIZE			32
 
+/**
+ * Flag to create a cuckoo hash table: each key has two candidate buckets and
+ * existing keys are displaced to their alternative bucket when both are full.
+ * Positions returned by the API are still stable for the lifetime of a key.
+ */
+#define RTE_HASH_EXTRA_FLAGS_CUCKOO		0x01
+
+/**
+ * Flag to make lookups safe against one concurrent writer thread. Each bucket
+ * gets a version counter that the writer bumps around every change; lookups
+ * never take a lock, they retry when a bucket changed under them.
+ */
+#define RTE_HASH_EXTRA_FLAGS_MULTI_READER	0x02
+
+/** Max number of displacements tried when adding a key to a cuckoo table. */
+#define RTE_HASH_CUCKOO_MAX_PATH		128
+
 /** Signature of key that is stored internally. */
 typedef uint32_t hash_sig_t;
 
@@ -82,6 +99,13 @@ struct rte_hash_parameters {
 	rte_hash_function hash_func;	/**< Function used to calculate hash. */
 	uint32_t hash_func_init_val;	/**< Init value used by hash_func. */
 	int socket_id;			/**< NUMA Socket ID for memory. */
+	uint8_t extra_flag;		/**< RTE_HASH_EXTRA_FLAGS_* bitmask. */
+};
+
+/** Free key slots of a cuckoo hash table, kept as a LIFO stack. */
+struct rte_hash_free_slots {
+	uint32_t n_free;		/**< Number of free key slots. */
+	uint32_t idx[0];		/**< Indexes of the free key slots. */
 };
 
 /** A hash table structure. */
@@ -104,6 +128,13 @@ struct rte_hash {
 	uint32_t key_tbl_key_size;	/**< Keys may be padded for alignment
 					   reasons, and this is the key size
 					   used	by key_tbl. */
+	uint8_t extra_flag;	/**< RTE_HASH_EXTRA_FLAGS_* bitmask. */
+	uint32_t *idx_tbl;	/**< Cuckoo only: key slot index stored for
+				   each signature of sig_tbl. */
+	struct rte_hash_free_slots *free_slots; /**< Cuckoo only: free key
+						   slots of key_tbl. */
+	uint32_t *bkt_ver;	/**< Multi-reader only: version of each bucket,
+				   odd while the bucket is being changed. */
 };
 
 /**
@@ -151,7 +182,8 @@ rte_hash_free(struct rte_hash *h);
 
 /**
  * Add a key to an existing hash table. This operation is not multi-thread safe
- * and should only be called from one thread.
+ * and should only be called from one thread. With
+ * RTE_HASH_EXTRA_FLAGS_MULTI_READER, lookups may run concurrently.
  *
  * @param h
  *   Hash table to add the key to.
@@ -159,7 +191,9 @@ rte_hash_free(struct rte_hash *h);
  *   Key to add to the hash table.
  * @return
  *   - -EINVAL if the parameters are invalid.
- *   - -ENOSPC if there is no space in the hash for this key.
+ *   - -ENOSPC if there is no space in the hash for this key. For cuckoo
+ *     tables this is only returned once no displacement path of up to
+ *     RTE_HASH_CUCKOO_MAX_PATH moves can free a slot for the key.
  *   - A positive value that can be used by the caller as an offset into an
  *     array of user data. This value is unique for this key.
  */
@@ -168,7 +202,8 @@ rte_hash_add_key(const struct rte_hash *h, const void *key);
 
 /**
  * Add a key to an existing hash table. This operation is not multi-thread safe
- * and should only be called from one thread.
+ * and should only be called from one thread. With
+ * RTE_HASH_EXTRA_FLAGS_MULTI_READER, lookups may run concurrently.
  *
  * @param h
  *   Hash table to add the key to.
@@ -178,7 +213,9 @@ rte_hash_add_key(const struct rte_hash *h, const void *key);
  *   Hash value to add to the hash table.
  * @return
  *   - -EINVAL if the parameters are invalid.
- *   - -ENOSPC if there is no space in the hash for this key.
+ *   - -ENOSPC if there is no space in the hash for this key. For cuckoo
+ *     tables this is only returned once no displacement path of up to
+ *     RTE_HASH_CUCKOO_MAX_PATH moves can free a slot for the key.
  *   - A positive value that can be used by the caller as an offset into an
  *     array of user data. This value is unique for this key.
  */
@@ -188,7 +225,8 @@ rte_hash_add_key_with_hash(const struct rte_hash *h,
 
 /**
  * Remove a key from an existing hash table. This operation is not multi-thread
- * safe and should only be called from one thread.
+ * safe and should only be called from one thread. With
+ * RTE_HASH_EXTRA_FLAGS_MULTI_READER, lookups may run concurrently.
  *
  * @param h
  *   Hash table to remove the key from.
@@ -206,7 +244,8 @@ rte_hash_del_key(const struct rte_hash *h, const void *key);
 
 /**
  * Remove a key from an existing hash table. This operation is not multi-thread
- * safe and should only be called from one thread.
+ * safe and should only be called from one thread. With
+ * RTE_HASH_EXTRA_FLAGS_MULTI_READER, lookups may run concurrently.
  *
  * @param h
  *   Hash table to remove the key from.
@@ -227,7 +266,9 @@ rte_hash_del_key_with_hash(const struct rte_hash *h,
 
 
 /**
- * Find a key in the hash table. This operation is multi-thread safe.
+ * Find a key in the hash table. This operation is multi-thread safe with
+ * respect to other lookups, and with respect to one writer thread if the
+ * table was created with RTE_HASH_EXTRA_FLAGS_MULTI_READER.
  *
  * @param h
  *   Hash table to look in.
@@ -244,7 +285,9 @@ int32_t
 rte_hash_lookup(const struct rte_hash *h, const void *key);
 
 /**
- * Find a key in the hash table. This operation is multi-thread safe.
+ * Find a key in the hash table. This operation is multi-thread safe with
+ * respect to other lookups, and with respect to one writer thread if the
+ * table was created with RTE_HASH_EXTRA_FLAGS_MULTI_READER.
  *
  * @param h
  *   Hash table to look in.
@@ -283,7 +326,9 @@ rte_hash_hash(const struct rte_hash *h, const void *key)
 
 #define rte_hash_lookup_multi rte_hash_lookup_bulk
 /**
- * Find multiple keys in the hash table. This operation is multi-thread safe.
+ * Find multiple keys in the hash table. This operation is multi-thread safe
+ * with respect to other lookups, and with respect to one writer thread if the
+ * table was created with RTE_HASH_EXTRA_FLAGS_MULTI_READER.
  *
  * @param h
  *   Hash table to look in.
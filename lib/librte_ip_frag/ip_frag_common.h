@@ -57,24 +57,34 @@ if (!(exp))	{							\
 /* helper macros */
 #define	IP_FRAG_MBUF2DR(dr, mb)	((dr)->row[(dr)->cnt++] = (mb))
 
+/* get the table entry at given index */
+#define	IP_FRAG_TBL_PKT(tbl, idx)	\
+	((struct ip_frag_pkt *)((uintptr_t)(tbl)->pkt + \
+		(uintptr_t)(idx) * (tbl)->entry_size))
+
 #define IPv6_KEY_BYTES(key) \
 	(key)[0], (key)[1], (key)[2], (key)[3]
 #define IPv6_KEY_BYTES_FMT \
 	"%08" PRIx64 "%08" PRIx64 "%08" PRIx64 "%08" PRIx64
 
 /* internal functions declarations */
-struct rte_mbuf * ip_frag_process(struct ip_frag_pkt *fp,
-		struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb,
-		uint16_t ofs, uint16_t len, uint16_t more_frags);
+struct rte_mbuf * ip_frag_process(const struct rte_ip_frag_tbl *tbl,
+		struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
+		struct rte_mbuf *mb, uint16_t ofs, uint16_t len,
+		uint16_t more_frags);
 
 struct ip_frag_pkt * ip_frag_find(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
-		const struct ip_frag_key *key, uint64_t tms);
+		const struct ip_frag_key *key, uint64_t tms,
+		const uint32_t *sig);
 
 struct ip_frag_pkt * ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
+	const struct ip_frag_key *key, uint64_t tms, const uint32_t *sig,
 	struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
 
+struct rte_ip_frag_tbl * ip_frag_tbl_stripe(const struct rte_ip_frag_tbl *tbl,
+	const struct ip_frag_key *key, uint32_t *sig);
+
 /* these functions need to be declared here as ip_frag_process relies on them */
 struct rte_mbuf * ipv4_frag_reassemble(const struct ip_frag_pkt *fp);
 struct rte_mbuf * ipv6_frag_reassemble(const struct ip_frag_pkt *fp);
@@ -148,6 +158,34 @@ ip_frag_inuse(struct rte_ip_frag_tbl *tbl, const struct  ip_frag_pkt *fp)
 	}
 }
 
+/*
+ * misc frag table functions
+ */
+
+/*
+ * for shared table, pick and lock the sub-table owning the key.
+ * The key hash is then stored in sig, to be passed to ip_frag_find().
+ */
+static inline struct rte_ip_frag_tbl *
+ip_frag_tbl_lock(struct rte_ip_frag_tbl *tbl, const struct ip_frag_key *key,
+	uint32_t *sig)
+{
+	if (likely(tbl->nb_stripes == 0))
+		return tbl;
+
+	tbl = ip_frag_tbl_stripe(tbl, key, sig);
+	rte_spinlock_lock(&tbl->lock);
+	return tbl;
+}
+
+/* release the sub-table returned by ip_frag_tbl_lock() */
+static inline void
+ip_frag_tbl_unlock(struct rte_ip_frag_tbl *tbl)
+{
+	if (tbl->locked != 0)
+		rte_spinlock_unlock(&tbl->lock);
+}
+
 /* reset the fragment */
 static inline void
 ip_frag_reset(struct ip_frag_pkt *fp, uint64_t tms)
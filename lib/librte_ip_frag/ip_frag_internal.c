@@ -43,7 +43,7 @@
 #define	PRIME_VALUE	0xeaad8405
 
 #define	IP_FRAG_TBL_POS(tbl, sig)	\
-	((tbl)->pkt + ((sig) & (tbl)->entry_mask))
+	IP_FRAG_TBL_PKT(tbl, (sig) & (tbl)->entry_mask)
 
 #ifdef RTE_LIBRTE_IP_FRAG_TBL_STAT
 #define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	((s)->f += (v))
@@ -137,8 +137,9 @@ ipv6_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
 }
 
 struct rte_mbuf *
-ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
-	struct rte_mbuf *mb, uint16_t ofs, uint16_t len, uint16_t more_frags)
+ip_frag_process(const struct rte_ip_frag_tbl *tbl, struct ip_frag_pkt *fp,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb, uint16_t ofs,
+	uint16_t len, uint16_t more_frags)
 {
 	uint32_t idx;
 
@@ -156,8 +157,7 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 				IP_LAST_FRAG_IDX : UINT32_MAX;
 
 	/* this is the intermediate fragment. */
-	} else if ((idx = fp->last_idx) <
-		sizeof (fp->frags) / sizeof (fp->frags[0])) {
+	} else if ((idx = fp->last_idx) < tbl->max_frags) {
 		fp->last_idx++;
 	}
 
@@ -165,7 +165,7 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 	 * errorneous packet: either exceeed max allowed number of fragments,
 	 * or duplicate first/last fragment encountered.
 	 */
-	if (idx >= sizeof (fp->frags) / sizeof (fp->frags[0])) {
+	if (idx >= tbl->max_frags) {
 
 		/* report an error. */
 		if (fp->key.key_len == IPV4_KEYLEN)
@@ -267,10 +267,11 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
  * Find an entry in the table for the corresponding fragment.
  * If such entry is not present, then allocate a new one.
  * If the entry is stale, then free and reuse it.
+ * sig is the hash of the key if already computed, or NULL.
  */
 struct ip_frag_pkt *
 ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
-	const struct ip_frag_key *key, uint64_t tms)
+	const struct ip_frag_key *key, uint64_t tms, const uint32_t *sig)
 {
 	struct ip_frag_pkt *pkt, *free, *stale, *lru;
 	uint64_t max_cycles;
@@ -285,7 +286,7 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 
 	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, find_num, 1);
 
-	if ((pkt = ip_frag_lookup(tbl, key, tms, &free, &stale)) == NULL) {
+	if ((pkt = ip_frag_lookup(tbl, key, tms, sig, &free, &stale)) == NULL) {
 
 		/*timed-out entry, free and invalidate it*/
 		if (stale != NULL) {
@@ -330,9 +331,34 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 	return (pkt);
 }
 
+/*
+ * select the sub-table of a shared table owning the key.
+ * The two hash values of the key are stored in sig[0] and sig[1].
+ */
+struct rte_ip_frag_tbl *
+ip_frag_tbl_stripe(const struct rte_ip_frag_tbl *tbl,
+	const struct ip_frag_key *key, uint32_t *sig)
+{
+	uint32_t idx;
+
+	if (key->key_len == IPV4_KEYLEN)
+		ipv4_frag_hash(key, &sig[0], &sig[1]);
+	else
+		ipv6_frag_hash(key, &sig[0], &sig[1]);
+
+	/*
+	 * use the top bits of the hash, so the bucket bits
+	 * used inside the sub-table stay evenly spread.
+	 */
+	idx = (uint32_t)((uint64_t)sig[0] >> tbl->stripe_shift);
+
+	return (struct rte_ip_frag_tbl *)((uintptr_t)tbl->pkt +
+		(uintptr_t)idx * tbl->stripe_size);
+}
+
 struct ip_frag_pkt *
 ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
+	const struct ip_frag_key *key, uint64_t tms, const uint32_t *sig,
 	struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
 {
 	struct ip_frag_pkt *p1, *p2;
@@ -350,7 +376,10 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 		return (tbl->last);
 
 	/* different hashing methods for IPv4 and IPv6 */
-	if (key->key_len == IPV4_KEYLEN)
+	if (sig != NULL) {
+		sig1 = sig[0];
+		sig2 = sig[1];
+	} else if (key->key_len == IPV4_KEYLEN)
 		ipv4_frag_hash(key, &sig1, &sig2);
 	else
 		ipv6_frag_hash(key, &sig1, &sig2);
@@ -367,7 +396,7 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p1, i, assoc,
-			p1[i].key.src_dst[0], p1[i].key.id, p1[i].start);
+			p1->key.src_dst[0], p1->key.id, p1->start);
 		else
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 					"tbl: %p, max_entries: %u, use_entries: %u\n"
@@ -376,14 +405,14 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p1, i, assoc,
-			IPv6_KEY_BYTES(p1[i].key.src_dst), p1[i].key.id, p1[i].start);
+			IPv6_KEY_BYTES(p1->key.src_dst), p1->key.id, p1->start);
 
-		if (ip_frag_key_cmp(key, &p1[i].key) == 0)
-			return (p1 + i);
-		else if (ip_frag_key_is_empty(&p1[i].key))
-			empty = (empty == NULL) ? (p1 + i) : empty;
-		else if (max_cycles + p1[i].start < tms)
-			old = (old == NULL) ? (p1 + i) : old;
+		if (ip_frag_key_cmp(key, &p1->key) == 0)
+			return (p1);
+		else if (ip_frag_key_is_empty(&p1->key))
+			empty = (empty == NULL) ? p1 : empty;
+		else if (max_cycles + p1->start < tms)
+			old = (old == NULL) ? p1 : old;
 
 		if (p2->key.key_len == IPV4_KEYLEN)
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
@@ -393,7 +422,7 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p2, i, assoc,
-			p2[i].key.src_dst[0], p2[i].key.id, p2[i].start);
+			p2->key.src_dst[0], p2->key.id, p2->start);
 		else
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 					"tbl: %p, max_entries: %u, use_entries: %u\n"
@@ -402,14 +431,18 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p2, i, assoc,
-			IPv6_KEY_BYTES(p2[i].key.src_dst), p2[i].key.id, p2[i].start);
-
-		if (ip_frag_key_cmp(key, &p2[i].key) == 0)
-			return (p2 + i);
-		else if (ip_frag_key_is_empty(&p2[i].key))
-			empty = (empty == NULL) ?( p2 + i) : empty;
-		else if (max_cycles + p2[i].start < tms)
-			old = (old == NULL) ? (p2 + i) : old;
+			IPv6_KEY_BYTES(p2->key.src_dst), p2->key.id, p2->start);
+
+		if (ip_frag_key_cmp(key, &p2->key) == 0)
+			return (p2);
+		else if (ip_frag_key_is_empty(&p2->key))
+			empty = (empty == NULL) ? p2 : empty;
+		else if (max_cycles + p2->start < tms)
+			old = (old == NULL) ? p2 : old;
+
+		/* entries are entry_size bytes apart. */
+		p1 = (struct ip_frag_pkt *)((uintptr_t)p1 + tbl->entry_size);
+		p2 = (struct ip_frag_pkt *)((uintptr_t)p2 + tbl->entry_size);
 	}
 
 	*free = empty;
@@ -49,6 +49,7 @@
 #include <rte_memory.h>
 #include <rte_ip.h>
 #include <rte_byteorder.h>
+#include <rte_spinlock.h>
 
 enum {
 	IP_LAST_FRAG_IDX,    /**< index of last fragment */
@@ -75,6 +76,8 @@ struct ip_frag_key {
 /*
  * @internal Fragmented packet to reassemble.
  * First two entries in the frags[] array are for the last and first fragments.
+ * The frags[] array is sized at table creation time (see max_frags),
+ * so table entries are tbl->entry_size bytes apart.
  */
 struct ip_frag_pkt {
 	TAILQ_ENTRY(ip_frag_pkt) lru;   /**< LRU list */
@@ -83,7 +86,7 @@ struct ip_frag_pkt {
 	uint32_t             total_size;  /**< expected reassembled size */
 	uint32_t             frag_size;   /**< size of fragments received */
 	uint32_t             last_idx;    /**< index of next entry to fill */
-	struct ip_frag       frags[IP_MAX_FRAG_NUM]; /**< fragments */
+	struct ip_frag       frags[0];    /**< fragments */
 } __rte_cache_aligned;
 
 #define IP_FRAG_DEATH_ROW_LEN 32 /**< death row size (in packets) */
@@ -107,7 +110,13 @@ struct ip_frag_tbl_stat {
 	uint64_t fail_nospace;  /**< # of 'no space' add failures. */
 } __rte_cache_aligned;
 
-/** fragmentation table */
+/**
+ * fragmentation table
+ *
+ * A shared table (nb_stripes != 0) holds no entries of its own: pkt[]
+ * is an array of nb_stripes sub-tables, each with its own lock, LRU list,
+ * statistics and entries.
+ */
 struct rte_ip_frag_tbl {
 	uint64_t             max_cycles;      /**< ttl for table entries. */
 	uint32_t             entry_mask;      /**< hash value mask. */
@@ -116,6 +125,13 @@ struct rte_ip_frag_tbl {
 	uint32_t             bucket_entries;  /**< hash assocaitivity. */
 	uint32_t             nb_entries;      /**< total size of the table. */
 	uint32_t             nb_buckets;      /**< num of associativity lines. */
+	uint32_t             max_frags;       /**< max fragments per packet. */
+	uint32_t             entry_size;      /**< size of one entry in bytes. */
+	uint32_t             nb_stripes;      /**< num of sub-tables, if shared. */
+	uint32_t             stripe_shift;    /**< hash shift to select stripe. */
+	uint64_t             stripe_size;     /**< size of one sub-table. */
+	rte_spinlock_t       lock;            /**< sub-table lock. */
+	uint32_t             locked;          /**< sub-table of a shared table. */
 	struct ip_frag_pkt *last;         /**< last used entry. */
 	struct ip_pkt_list lru;           /**< LRU list for table entries. */
 	struct ip_frag_tbl_stat stat;     /**< statistics counters. */
@@ -164,6 +180,47 @@ struct rte_ip_frag_tbl * rte_ip_frag_table_create(uint32_t bucket_num,
 		uint32_t bucket_entries,  uint32_t max_entries,
 		uint64_t max_cycles, int socket_id);
 
+/*
+ * Create a new IP fragmentation table, with the maximum number of
+ * fragments per packet chosen at runtime and optional sharing between lcores.
+ *
+ * Each entry only reserves room for max_frags fragments, so a table
+ * sized for few fragments stays small, while up to IP_MAX_FRAG_NUM
+ * (RTE_LIBRTE_IP_FRAG_MAX_FRAG) fragments can be accepted when needed.
+ *
+ * If nb_stripes is not zero, the table may be used concurrently by
+ * several lcores: buckets and max_entries are split evenly between
+ * nb_stripes sub-tables, each protected by its own spinlock, and every
+ * datagram is assigned to one sub-table by its key hash. Each lcore still
+ * needs its own death row.
+ *
+ * @param bucket_num
+ *   Number of buckets in the hash table.
+ * @param bucket_entries
+ *   Number of entries per bucket (e.g. hash associativity).
+ *   Should be power of two.
+ * @param max_entries
+ *   Maximum number of entries that could be stored in the table.
+ *   The value should be less or equal then bucket_num * bucket_entries.
+ * @param max_cycles
+ *   Maximum TTL in cycles for each fragmented packet.
+ * @param max_frags
+ *   Maximum number of fragments per packet,
+ *   between IP_MIN_FRAG_NUM and IP_MAX_FRAG_NUM.
+ * @param nb_stripes
+ *   0 for a table used by a single lcore, otherwise number of lock stripes
+ *   of a shared table. Should be power of two, not greater than bucket_num.
+ * @param socket_id
+ *   The *socket_id* argument is the socket identifier in the case of
+ *   NUMA. The value can be *SOCKET_ID_ANY* if there is no NUMA constraints.
+ * @return
+ *   The pointer to the new allocated fragmentation table, on success. NULL on error.
+ */
+struct rte_ip_frag_tbl * rte_ip_frag_table_create_ext(uint32_t bucket_num,
+		uint32_t bucket_entries, uint32_t max_entries,
+		uint64_t max_cycles, uint32_t max_frags, uint32_t nb_stripes,
+		int socket_id);
+
 /*
  * Free allocated IP fragmentation table.
  *
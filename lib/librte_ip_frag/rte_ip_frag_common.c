@@ -33,6 +33,8 @@
 
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
 
 #include <rte_memory.h>
 #include <rte_log.h>
@@ -65,28 +67,72 @@ rte_ip_frag_free_death_row(struct rte_ip_frag_death_row *dr,
 	dr->cnt = 0;
 }
 
+/* setup a single lcore table or one sub-table of a shared table */
+static void
+ip_frag_tbl_init(struct rte_ip_frag_tbl *tbl, uint32_t bucket_num,
+	uint32_t bucket_entries, uint32_t max_entries, uint64_t max_cycles,
+	uint32_t nb_entries, uint32_t max_frags, uint32_t entry_size)
+{
+	tbl->max_cycles = max_cycles;
+	tbl->max_entries = max_entries;
+	tbl->nb_entries = nb_entries;
+	tbl->nb_buckets = bucket_num;
+	tbl->bucket_entries = bucket_entries;
+	tbl->entry_mask = (tbl->nb_entries - 1) & ~(tbl->bucket_entries  - 1);
+	tbl->max_frags = max_frags;
+	tbl->entry_size = entry_size;
+
+	TAILQ_INIT(&(tbl->lru));
+}
+
 /* create fragmentation table */
 struct rte_ip_frag_tbl *
 rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 	uint32_t max_entries, uint64_t max_cycles, int socket_id)
 {
-	struct rte_ip_frag_tbl *tbl;
-	size_t sz;
+	return (rte_ip_frag_table_create_ext(bucket_num, bucket_entries,
+		max_entries, max_cycles, IP_MAX_FRAG_NUM, 0, socket_id));
+}
+
+/* create fragmentation table, possibly shared between lcores */
+struct rte_ip_frag_tbl *
+rte_ip_frag_table_create_ext(uint32_t bucket_num, uint32_t bucket_entries,
+	uint32_t max_entries, uint64_t max_cycles, uint32_t max_frags,
+	uint32_t nb_stripes, int socket_id)
+{
+	struct rte_ip_frag_tbl *tbl, *st;
+	size_t sz, stripe_size;
 	uint64_t nb_entries;
+	uint32_t i, n, entry_size, stripe_buckets, stripe_entries;
 
-	nb_entries = rte_align32pow2(bucket_num);
+	/* split buckets and entries evenly between the sub-tables. */
+	n = RTE_MAX(nb_stripes, 1U);
+	stripe_buckets = bucket_num / n;
+	stripe_entries = (max_entries + n - 1) / n;
+
+	nb_entries = rte_align32pow2(stripe_buckets);
 	nb_entries *= bucket_entries;
 	nb_entries *= IP_FRAG_HASH_FNUM;
 
 	/* check input parameters. */
 	if (rte_is_power_of_2(bucket_entries) == 0 ||
-			nb_entries > UINT32_MAX || nb_entries == 0 ||
-			nb_entries < max_entries) {
+			rte_is_power_of_2(n) == 0 ||
+			nb_entries * n > UINT32_MAX || nb_entries == 0 ||
+			nb_entries < stripe_entries ||
+			max_frags < IP_MIN_FRAG_NUM ||
+			max_frags > IP_MAX_FRAG_NUM) {
 		RTE_LOG(ERR, USER1, "%s: invalid input parameter\n", __func__);
 		return (NULL);
 	}
 
-	sz = sizeof (*tbl) + nb_entries * sizeof (tbl->pkt[0]);
+	/* only keep room for max_frags fragments in each entry. */
+	entry_size = RTE_CACHE_LINE_ROUNDUP(offsetof(struct ip_frag_pkt,
+		frags) + max_frags * sizeof(struct ip_frag));
+
+	stripe_size = sizeof (*tbl) + nb_entries * entry_size;
+	sz = (nb_stripes == 0) ? stripe_size :
+		sizeof (*tbl) + n * stripe_size;
+
 	if ((tbl = rte_zmalloc_socket(__func__, sz, RTE_CACHE_LINE_SIZE,
 			socket_id)) == NULL) {
 		RTE_LOG(ERR, USER1,
@@ -98,14 +144,32 @@ rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 	RTE_LOG(INFO, USER1, "%s: allocated of %zu bytes at socket %d\n",
 		__func__, sz, socket_id);
 
-	tbl->max_cycles = max_cycles;
-	tbl->max_entries = max_entries;
-	tbl->nb_entries = (uint32_t)nb_entries;
-	tbl->nb_buckets = bucket_num;
-	tbl->bucket_entries = bucket_entries;
-	tbl->entry_mask = (tbl->nb_entries - 1) & ~(tbl->bucket_entries  - 1);
+	if (nb_stripes == 0) {
+		ip_frag_tbl_init(tbl, bucket_num, bucket_entries,
+			max_entries, max_cycles, (uint32_t)nb_entries,
+			max_frags, entry_size);
+		return (tbl);
+	}
+
+	/* shared table: the top level only dispatches to sub-tables. */
+	ip_frag_tbl_init(tbl, bucket_num, bucket_entries,
+		stripe_entries * n, max_cycles, (uint32_t)nb_entries * n,
+		max_frags, entry_size);
+	tbl->entry_mask = 0;
+	tbl->nb_stripes = n;
+	tbl->stripe_shift = CHAR_BIT * sizeof (uint32_t) - rte_bsf32(n);
+	tbl->stripe_size = stripe_size;
+
+	for (i = 0; i != n; i++) {
+		st = (struct rte_ip_frag_tbl *)((uintptr_t)tbl->pkt +
+			i * stripe_size);
+		ip_frag_tbl_init(st, stripe_buckets, bucket_entries,
+			stripe_entries, max_cycles, (uint32_t)nb_entries,
+			max_frags, entry_size);
+		rte_spinlock_init(&st->lock);
+		st->locked = 1;
+	}
 
-	TAILQ_INIT(&(tbl->lru));
 	return (tbl);
 }
 
@@ -113,10 +177,33 @@ rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 void
 rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
 {
+	const struct rte_ip_frag_tbl *st;
+	struct ip_frag_tbl_stat stat;
 	uint64_t fail_total, fail_nospace;
+	uint32_t i, use_entries;
+
+	/* sum up sub-tables counters for shared table. */
+	if (tbl->nb_stripes == 0) {
+		stat = tbl->stat;
+		use_entries = tbl->use_entries;
+	} else {
+		memset(&stat, 0, sizeof (stat));
+		use_entries = 0;
+		for (i = 0; i != tbl->nb_stripes; i++) {
+			st = (const struct rte_ip_frag_tbl *)
+				((uintptr_t)tbl->pkt + i * tbl->stripe_size);
+			stat.find_num += st->stat.find_num;
+			stat.add_num += st->stat.add_num;
+			stat.del_num += st->stat.del_num;
+			stat.reuse_num += st->stat.reuse_num;
+			stat.fail_total += st->stat.fail_total;
+			stat.fail_nospace += st->stat.fail_nospace;
+			use_entries += st->use_entries;
+		}
+	}
 
-	fail_total = tbl->stat.fail_total;
-	fail_nospace = tbl->stat.fail_nospace;
+	fail_total = stat.fail_total;
+	fail_nospace = stat.fail_nospace;
 
 	fprintf(f, "max entries:\t%u;\n"
 		"entries in use:\t%u;\n"
@@ -128,11 +215,11 @@ rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
 		"add no-space failures:\t%" PRIu64 ";\n"
 		"add hash-collisions failures:\t%" PRIu64 ";\n",
 		tbl->max_entries,
-		tbl->use_entries,
-		tbl->stat.find_num,
-		tbl->stat.add_num,
-		tbl->stat.del_num,
-		tbl->stat.reuse_num,
+		use_entries,
+		stat.find_num,
+		stat.add_num,
+		stat.del_num,
+		stat.reuse_num,
 		fail_total,
 		fail_nospace,
 		fail_total - fail_nospace);
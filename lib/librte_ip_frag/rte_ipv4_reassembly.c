@@ -121,6 +121,7 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 {
 	struct ip_frag_pkt *fp;
 	struct ip_frag_key key;
+	uint32_t sig[2];
 	const uint64_t *psd;
 	uint16_t ip_len;
 	uint16_t flag_offset, ip_ofs, ip_flag;
@@ -149,9 +150,14 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		tbl, tbl->max_cycles, tbl->entry_mask, tbl->max_entries,
 		tbl->use_entries);
 
+	/* for shared table, lock the sub-table owning that packet. */
+	tbl = ip_frag_tbl_lock(tbl, &key, sig);
+
 	/* try to find/add entry into the fragment's table. */
-	if ((fp = ip_frag_find(tbl, dr, &key, tms)) == NULL) {
+	if ((fp = ip_frag_find(tbl, dr, &key, tms,
+			(tbl->locked != 0) ? sig : NULL)) == NULL) {
 		IP_FRAG_MBUF2DR(dr, mb);
+		ip_frag_tbl_unlock(tbl);
 		return (NULL);
 	}
 
@@ -166,7 +172,7 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 
 	/* process the fragmented packet. */
-	mb = ip_frag_process(fp, dr, mb, ip_ofs, ip_len, ip_flag);
+	mb = ip_frag_process(tbl, fp, dr, mb, ip_ofs, ip_len, ip_flag);
 	ip_frag_inuse(tbl, fp);
 
 	IP_FRAG_LOG(DEBUG, "%s:%d:\n"
@@ -179,5 +185,6 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		fp, fp->key.src_dst[0], fp->key.id, fp->start,
 		fp->total_size, fp->frag_size, fp->last_idx);
 
+	ip_frag_tbl_unlock(tbl);
 	return (mb);
 }
@@ -159,6 +159,7 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 {
 	struct ip_frag_pkt *fp;
 	struct ip_frag_key key;
+	uint32_t sig[2];
 	uint16_t ip_len, ip_ofs;
 
 	rte_memcpy(&key.src_dst[0], ip_hdr->src_addr, 16);
@@ -186,10 +187,15 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		tbl, tbl->max_cycles, tbl->entry_mask, tbl->max_entries,
 		tbl->use_entries);
 
+	/* for shared table, lock the sub-table owning that packet. */
+	tbl = ip_frag_tbl_lock(tbl, &key, sig);
+
 	/* try to find/add entry into the fragment's table. */
-	fp = ip_frag_find(tbl, dr, &key, tms);
+	fp = ip_frag_find(tbl, dr, &key, tms,
+		(tbl->locked != 0) ? sig : NULL);
 	if (fp == NULL) {
 		IP_FRAG_MBUF2DR(dr, mb);
+		ip_frag_tbl_unlock(tbl);
 		return NULL;
 	}
 
@@ -204,7 +210,7 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 
 	/* process the fragmented packet. */
-	mb = ip_frag_process(fp, dr, mb, ip_ofs, ip_len,
+	mb = ip_frag_process(tbl, fp, dr, mb, ip_ofs, ip_len,
 			MORE_FRAGS(frag_hdr->frag_data));
 	ip_frag_inuse(tbl, fp);
 
@@ -218,5 +224,6 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		fp, IPv6_KEY_BYTES(fp->key.src_dst), fp->key.id, fp->start,
 		fp->total_size, fp->frag_size, fp->last_idx);
 
+	ip_frag_tbl_unlock(tbl);
 	return mb;
 }
@@ -53,6 +53,7 @@
 #include <rte_errno.h>
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
+#include <rte_atomic.h>
 
 #include "rte_lpm.h"
 
@@ -60,6 +61,12 @@ TAILQ_HEAD(rte_lpm_list, rte_tailq_entry);
 
 #define MAX_DEPTH_TBL24 24
 
+#define LPM_VALID_FLAGS RTE_LPM_F_TBL8_DEFER_FREE
+
+/* Golden ratio multiplier used to spread IPs in the bulk add lookup table. */
+#define RULE_HT_MULT 0x9e3779b1
+#define RULE_HT_EMPTY UINT32_MAX
+
 enum valid_flag {
 	INVALID = 0,
 	VALID
@@ -150,12 +157,39 @@ rte_lpm_find_existing(const char *name)
  */
 struct rte_lpm *
 rte_lpm_create(const char *name, int socket_id, int max_rules,
-		__rte_unused int flags)
+		int flags)
+{
+	/*
+	 * flags only ever took the deprecated RTE_LPM_HEAP/RTE_LPM_MEMZONE
+	 * values, none of which is an RTE_LPM_F_* flag.
+	 */
+	struct rte_lpm_config config = {
+		.max_rules = max_rules,
+		.number_tbl8s = RTE_LPM_TBL8_NUM_GROUPS,
+		.flags = 0,
+	};
+
+	RTE_SET_USED(flags);
+
+	if (max_rules <= 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	return rte_lpm_create_config(name, socket_id, &config);
+}
+
+/*
+ * Allocates memory for LPM object, with a caller sized tbl8
+ */
+struct rte_lpm *
+rte_lpm_create_config(const char *name, int socket_id,
+		const struct rte_lpm_config *config)
 {
 	char mem_name[RTE_LPM_NAMESIZE];
 	struct rte_lpm *lpm = NULL;
 	struct rte_tailq_entry *te;
-	uint32_t mem_size;
+	size_t mem_size, rules_size, tbl8_size, pending_size;
 	struct rte_lpm_list *lpm_list;
 
 	/* check that we have an initialised tail queue */
@@ -165,19 +199,36 @@ rte_lpm_create(const char *name, int socket_id, int max_rules,
 		return NULL;
 	}
 
-	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl24_entry) != 2);
-	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl8_entry) != 2);
+	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl24_entry) != 4);
+	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl8_entry) != 4);
 
 	/* Check user arguments. */
-	if ((name == NULL) || (socket_id < -1) || (max_rules == 0)){
+	if ((name == NULL) || (socket_id < -1) || (config == NULL) ||
+			(config->max_rules == 0) ||
+			(config->number_tbl8s == 0) ||
+			(config->number_tbl8s > RTE_LPM_MAX_TBL8_NUM_GROUPS) ||
+			(config->flags & ~LPM_VALID_FLAGS)) {
 		rte_errno = EINVAL;
 		return NULL;
 	}
 
 	snprintf(mem_name, sizeof(mem_name), "LPM_%s", name);
 
-	/* Determine the amount of memory to allocate. */
-	mem_size = sizeof(*lpm) + (sizeof(lpm->rules_tbl[0]) * max_rules);
+	/*
+	 * Determine the amount of memory to allocate. The tbl8 groups are
+	 * placed after the rules table, on their own cache line, followed by
+	 * the list of groups waiting for reclaim when it is needed.
+	 */
+	rules_size = RTE_ALIGN_CEIL(sizeof(lpm->rules_tbl[0]) *
+			(size_t)config->max_rules, RTE_CACHE_LINE_SIZE);
+	tbl8_size = sizeof(struct rte_lpm_tbl8_entry) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
+			(size_t)config->number_tbl8s;
+	pending_size = 0;
+	if (config->flags & RTE_LPM_F_TBL8_DEFER_FREE)
+		pending_size = sizeof(struct rte_lpm_tbl8_pending) *
+				(size_t)config->number_tbl8s;
+	mem_size = sizeof(*lpm) + rules_size + tbl8_size + pending_size;
 
 	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
 
@@ -207,7 +258,14 @@ rte_lpm_create(const char *name, int socket_id, int max_rules,
 	}
 
 	/* Save user arguments. */
-	lpm->max_rules = max_rules;
+	lpm->max_rules = config->max_rules;
+	lpm->number_tbl8s = config->number_tbl8s;
+	lpm->flags = config->flags;
+	lpm->tbl8 = (struct rte_lpm_tbl8_entry *)
+			((uint8_t *)lpm->rules_tbl + rules_size);
+	if (pending_size != 0)
+		lpm->tbl8_pending = (struct rte_lpm_tbl8_pending *)
+				((uint8_t *)lpm->tbl8 + tbl8_size);
 	snprintf(lpm->name, sizeof(lpm->name), "%s", name);
 
 	te->data = (void *) lpm;
@@ -271,33 +329,20 @@ rte_lpm_free(struct rte_lpm *lpm)
  * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
  */
 static inline int32_t
-rule_add(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
-	uint8_t next_hop)
+rule_insert(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
+	uint32_t next_hop)
 {
-	uint32_t rule_gindex, rule_index, last_rule;
+	uint32_t rule_index;
 	int i;
 
 	VERIFY_DEPTH(depth);
 
-	/* Scan through rule group to see if rule already exists. */
 	if (lpm->rule_info[depth - 1].used_rules > 0) {
-
-		/* rule_gindex stands for rule group index. */
-		rule_gindex = lpm->rule_info[depth - 1].first_rule;
-		/* Initialise rule_index to point to start of rule group. */
-		rule_index = rule_gindex;
-		/* Last rule = Last used rule in this rule group. */
-		last_rule = rule_gindex + lpm->rule_info[depth - 1].used_rules;
-
-		for (; rule_index < last_rule; rule_index++) {
-
-			/* If rule already exists update its next_hop and return. */
-			if (lpm->rules_tbl[rule_index].ip == ip_masked) {
-				lpm->rules_tbl[rule_index].next_hop = next_hop;
-
-				return rule_index;
-			}
-		}
+		/* The new rule goes right after the last rule of its group. */
+		rule_index = lpm->rule_info[depth - 1].first_rule +
+				lpm->rule_info[depth - 1].used_rules;
+		if (rule_index == lpm->max_rules)
+			return -ENOSPC;
 	} else {
 		/* Calculate the position in which the rule will be stored. */
 		rule_index = 0;
@@ -336,6 +381,33 @@ rule_add(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 	return rule_index;
 }
 
+static inline int32_t
+rule_add(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
+	uint32_t next_hop)
+{
+	uint32_t rule_gindex, rule_index, last_rule;
+
+	VERIFY_DEPTH(depth);
+
+	/* rule_gindex stands for rule group index. */
+	rule_gindex = lpm->rule_info[depth - 1].first_rule;
+	/* Last rule = Last used rule in this rule group. */
+	last_rule = rule_gindex + lpm->rule_info[depth - 1].used_rules;
+
+	/* Scan through rule group to see if rule already exists. */
+	for (rule_index = rule_gindex; rule_index < last_rule; rule_index++) {
+
+		/* If rule already exists update its next_hop and return. */
+		if (lpm->rules_tbl[rule_index].ip == ip_masked) {
+			lpm->rules_tbl[rule_index].next_hop = next_hop;
+
+			return rule_index;
+		}
+	}
+
+	return rule_insert(lpm, ip_masked, depth, next_hop);
+}
+
 /*
  * Delete a rule from the rule table.
  * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
@@ -390,14 +462,13 @@ rule_find(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth)
  * Find, clean and allocate a tbl8.
  */
 static inline int32_t
-tbl8_alloc(struct rte_lpm_tbl8_entry *tbl8)
+tbl8_alloc(struct rte_lpm_tbl8_entry *tbl8, uint32_t number_tbl8s)
 {
 	uint32_t tbl8_gindex; /* tbl8 group index. */
 	struct rte_lpm_tbl8_entry *tbl8_entry;
 
 	/* Scan through tbl8 to find a free (i.e. INVALID) tbl8 group. */
-	for (tbl8_gindex = 0; tbl8_gindex < RTE_LPM_TBL8_NUM_GROUPS;
-			tbl8_gindex++) {
+	for (tbl8_gindex = 0; tbl8_gindex < number_tbl8s; tbl8_gindex++) {
 		tbl8_entry = &tbl8[tbl8_gindex *
 		                   RTE_LPM_TBL8_GROUP_NUM_ENTRIES];
 		/* If a free tbl8 group is found clean it and set as VALID. */
@@ -417,16 +488,35 @@ tbl8_alloc(struct rte_lpm_tbl8_entry *tbl8)
 	return -ENOSPC;
 }
 
+/*
+ * Free a tbl8 group. The caller has already unlinked it from tbl24, but
+ * lookups that read the old tbl24 entry may still be reading the group, so
+ * with RTE_LPM_F_TBL8_DEFER_FREE the group keeps its content and stays
+ * allocated until rte_lpm_tbl8_reclaim() is called for a grace period that
+ * started after this point.
+ */
 static inline void
-tbl8_free(struct rte_lpm_tbl8_entry *tbl8, uint32_t tbl8_group_start)
+tbl8_free(struct rte_lpm *lpm, uint32_t tbl8_group_start)
 {
+	struct rte_lpm_tbl8_pending *pending;
+
+	if (lpm->flags & RTE_LPM_F_TBL8_DEFER_FREE) {
+		pending = &lpm->tbl8_pending[lpm->tbl8_pending_tail %
+				lpm->number_tbl8s];
+		pending->group_idx = tbl8_group_start /
+				RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		pending->gp_gen = lpm->tbl8_gp_gen;
+		lpm->tbl8_pending_tail++;
+		return;
+	}
+
 	/* Set tbl8 group invalid*/
-	tbl8[tbl8_group_start].valid_group = INVALID;
+	lpm->tbl8[tbl8_group_start].valid_group = INVALID;
 }
 
 static inline int32_t
 add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
 	uint32_t tbl24_index, tbl24_range, tbl8_index, tbl8_group_end, i, j;
 
@@ -443,7 +533,7 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 				lpm->tbl24[i].depth <= depth)) {
 
 			struct rte_lpm_tbl24_entry new_tbl24_entry = {
-				{ .next_hop = next_hop, },
+				.next_hop = next_hop,
 				.valid = VALID,
 				.ext_entry = 0,
 				.depth = depth,
@@ -456,9 +546,13 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 			continue;
 		}
 
+		/* A more specific rule already owns this tbl24 entry. */
+		if (lpm->tbl24[i].ext_entry == 0)
+			continue;
+
 		/* If tbl24 entry is valid and extended calculate the index
 		 * into tbl8. */
-		tbl8_index = lpm->tbl24[i].tbl8_gindex *
+		tbl8_index = lpm->tbl24[i].next_hop *
 				RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 		tbl8_group_end = tbl8_index + RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 
@@ -488,7 +582,7 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 
 static inline int32_t
 add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
 	uint32_t tbl24_index;
 	int32_t tbl8_group_index, tbl8_group_start, tbl8_group_end, tbl8_index,
@@ -499,7 +593,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 
 	if (!lpm->tbl24[tbl24_index].valid) {
 		/* Search for a free tbl8 group. */
-		tbl8_group_index = tbl8_alloc(lpm->tbl8);
+		tbl8_group_index = tbl8_alloc(lpm->tbl8, lpm->number_tbl8s);
 
 		/* Check tbl8 allocation was successful. */
 		if (tbl8_group_index < 0) {
@@ -524,8 +618,11 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 		 * so assign whole structure in one go
 		 */
 
+		/* The tbl8 group must be visible before tbl24 points to it. */
+		rte_wmb();
+
 		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-			{ .tbl8_gindex = (uint8_t)tbl8_group_index, },
+			.next_hop = tbl8_group_index,
 			.valid = VALID,
 			.ext_entry = 1,
 			.depth = 0,
@@ -536,7 +633,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 	}/* If valid entry but not extended calculate the index into Table8. */
 	else if (lpm->tbl24[tbl24_index].ext_entry == 0) {
 		/* Search for free tbl8 group. */
-		tbl8_group_index = tbl8_alloc(lpm->tbl8);
+		tbl8_group_index = tbl8_alloc(lpm->tbl8, lpm->number_tbl8s);
 
 		if (tbl8_group_index < 0) {
 			return tbl8_group_index;
@@ -575,8 +672,11 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 		 * so assign whole structure in one go.
 		 */
 
+		/* The tbl8 group must be visible before tbl24 points to it. */
+		rte_wmb();
+
 		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-				{ .tbl8_gindex = (uint8_t)tbl8_group_index, },
+				.next_hop = tbl8_group_index,
 				.valid = VALID,
 				.ext_entry = 1,
 				.depth = 0,
@@ -588,7 +688,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 	else { /*
 		* If it is valid, extended entry calculate the index into tbl8.
 		*/
-		tbl8_group_index = lpm->tbl24[tbl24_index].tbl8_gindex;
+		tbl8_group_index = lpm->tbl24[tbl24_index].next_hop;
 		tbl8_group_start = tbl8_group_index *
 				RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 		tbl8_index = tbl8_group_start + (ip_masked & 0xFF);
@@ -623,13 +723,14 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
  */
 int
 rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
 	int32_t rule_index, status = 0;
 	uint32_t ip_masked;
 
 	/* Check user arguments. */
-	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH))
+	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH) ||
+			(next_hop > RTE_LPM_MAX_NEXT_HOP))
 		return -EINVAL;
 
 	ip_masked = ip & depth_to_mask(depth);
@@ -662,12 +763,165 @@ rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 	return 0;
 }
 
+/*
+ * Slot of the open addressing table that rte_lpm_add_bulk() uses to find the
+ * rules of one depth, instead of scanning the rule group for every rule.
+ */
+struct rule_ht_entry {
+	uint32_t ip;         /* Masked rule IP. */
+	uint32_t rule_index; /* Index in rules_tbl, RULE_HT_EMPTY if unused. */
+};
+
+/*
+ * Returns the slot holding ip_masked, or the empty slot where it would go.
+ * The table is at least twice as large as the number of rules it holds.
+ */
+static inline struct rule_ht_entry *
+rule_ht_find(struct rule_ht_entry *ht, uint32_t ht_mask, uint32_t ip_masked)
+{
+	uint32_t i = (ip_masked * RULE_HT_MULT) & ht_mask;
+
+	while (ht[i].rule_index != RULE_HT_EMPTY && ht[i].ip != ip_masked)
+		i = (i + 1) & ht_mask;
+
+	return &ht[i];
+}
+
+static void
+rule_ht_build(struct rte_lpm *lpm, uint8_t depth, struct rule_ht_entry *ht,
+		uint32_t ht_mask)
+{
+	struct rule_ht_entry *slot;
+	uint32_t rule_index, last_rule;
+
+	memset(ht, 0xff, sizeof(ht[0]) * (ht_mask + 1));
+
+	rule_index = lpm->rule_info[depth - 1].first_rule;
+	last_rule = rule_index + lpm->rule_info[depth - 1].used_rules;
+	for (; rule_index < last_rule; rule_index++) {
+		slot = rule_ht_find(ht, ht_mask, lpm->rules_tbl[rule_index].ip);
+		slot->ip = lpm->rules_tbl[rule_index].ip;
+		slot->rule_index = rule_index;
+	}
+}
+
+/*
+ * Add several routes
+ *
+ * Rules are applied one depth at a time, from the shortest prefix. Adding a
+ * rule only moves rules of greater depths in the rules table, so the index of
+ * the current depth built by rule_ht_build() stays valid while its rules are
+ * added. Rules of the same depth are applied in array order, a prefix given
+ * twice ends up with its last next hop.
+ */
+int
+rte_lpm_add_bulk(struct rte_lpm *lpm, const uint32_t *ips,
+		const uint8_t *depths, const uint32_t *next_hops, unsigned n)
+{
+	uint32_t depth_first[RTE_LPM_MAX_DEPTH + 1];
+	uint32_t depth_count[RTE_LPM_MAX_DEPTH];
+	struct rule_ht_entry *ht, *slot;
+	uint32_t *order;
+	uint32_t ht_mask, max_group, ip_masked, i, k;
+	int32_t rule_index, status;
+	uint8_t depth;
+	int n_added = 0;
+
+	/* Check user arguments. */
+	if ((lpm == NULL) || (ips == NULL) || (depths == NULL) ||
+			(next_hops == NULL))
+		return -EINVAL;
+
+	/* Count the valid rules of each depth, invalid ones are skipped. */
+	memset(depth_count, 0, sizeof(depth_count));
+	for (i = 0; i < n; i++) {
+		if ((depths[i] < 1) || (depths[i] > RTE_LPM_MAX_DEPTH) ||
+				(next_hops[i] > RTE_LPM_MAX_NEXT_HOP))
+			continue;
+		depth_count[depths[i] - 1]++;
+	}
+
+	max_group = 0;
+	depth_first[0] = 0;
+	for (i = 0; i < RTE_LPM_MAX_DEPTH; i++) {
+		depth_first[i + 1] = depth_first[i] + depth_count[i];
+		if (depth_count[i] != 0)
+			max_group = RTE_MAX(max_group, depth_count[i] +
+					lpm->rule_info[i].used_rules);
+	}
+	if (max_group == 0)
+		return 0;
+
+	ht_mask = rte_align32pow2(max_group * 2) - 1;
+	order = rte_malloc("LPM_BULK", sizeof(order[0]) * n +
+			sizeof(ht[0]) * (ht_mask + 1), 0);
+	if (order == NULL)
+		return -ENOMEM;
+	ht = (struct rule_ht_entry *)&order[n];
+
+	/* Sort the rule indexes by depth, keeping the array order. */
+	memset(depth_count, 0, sizeof(depth_count));
+	for (i = 0; i < n; i++) {
+		if ((depths[i] < 1) || (depths[i] > RTE_LPM_MAX_DEPTH) ||
+				(next_hops[i] > RTE_LPM_MAX_NEXT_HOP))
+			continue;
+		order[depth_first[depths[i] - 1] +
+				depth_count[depths[i] - 1]++] = i;
+	}
+
+	for (depth = 1; depth <= RTE_LPM_MAX_DEPTH; depth++) {
+		if (depth_count[depth - 1] == 0)
+			continue;
+
+		rule_ht_build(lpm, depth, ht, ht_mask);
+
+		for (k = depth_first[depth - 1]; k < depth_first[depth]; k++) {
+			i = order[k];
+			ip_masked = ips[i] & depth_to_mask(depth);
+
+			/* Update the rule if it exists, insert it otherwise. */
+			slot = rule_ht_find(ht, ht_mask, ip_masked);
+			if (slot->rule_index != RULE_HT_EMPTY) {
+				rule_index = slot->rule_index;
+				lpm->rules_tbl[rule_index].next_hop =
+						next_hops[i];
+			} else {
+				rule_index = rule_insert(lpm, ip_masked, depth,
+						next_hops[i]);
+				if (rule_index < 0)
+					continue;
+				slot->ip = ip_masked;
+				slot->rule_index = rule_index;
+			}
+
+			if (depth <= MAX_DEPTH_TBL24) {
+				add_depth_small(lpm, ip_masked, depth,
+						next_hops[i]);
+			} else {
+				status = add_depth_big(lpm, ip_masked, depth,
+						next_hops[i]);
+				/* Same as rte_lpm_add() on tbl8 exhaustion. */
+				if (status < 0) {
+					rule_delete(lpm, rule_index, depth);
+					rule_ht_build(lpm, depth, ht, ht_mask);
+					continue;
+				}
+			}
+			n_added++;
+		}
+	}
+
+	rte_free(order);
+
+	return n_added;
+}
+
 /*
  * Look for a rule in the high-level rules table
  */
 int
 rte_lpm_is_rule_present(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-uint8_t *next_hop)
+uint32_t *next_hop)
 {
 	uint32_t ip_masked;
 	int32_t rule_index;
@@ -737,14 +991,14 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 					lpm->tbl24[i].depth <= depth ) {
 				lpm->tbl24[i].valid = INVALID;
 			}
-			else {
+			else if (lpm->tbl24[i].ext_entry == 1) {
 				/*
 				 * If TBL24 entry is extended, then there has
 				 * to be a rule with depth >= 25 in the
 				 * associated TBL8 group.
 				 */
 
-				tbl8_group_index = lpm->tbl24[i].tbl8_gindex;
+				tbl8_group_index = lpm->tbl24[i].next_hop;
 				tbl8_index = tbl8_group_index *
 						RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 
@@ -764,14 +1018,19 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 		 */
 
 		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-			{.next_hop = lpm->rules_tbl[sub_rule_index].next_hop,},
+			.next_hop = lpm->rules_tbl[sub_rule_index].next_hop,
 			.valid = VALID,
 			.ext_entry = 0,
 			.depth = sub_rule_depth,
 		};
 
+		/*
+		 * The entries replaced below belong to allocated groups, keep
+		 * valid_group set so that tbl8_alloc() does not hand them out.
+		 */
 		struct rte_lpm_tbl8_entry new_tbl8_entry = {
 			.valid = VALID,
+			.valid_group = VALID,
 			.depth = sub_rule_depth,
 			.next_hop = lpm->rules_tbl
 			[sub_rule_index].next_hop,
@@ -783,14 +1042,14 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 					lpm->tbl24[i].depth <= depth ) {
 				lpm->tbl24[i] = new_tbl24_entry;
 			}
-			else {
+			else if (lpm->tbl24[i].ext_entry == 1) {
 				/*
 				 * If TBL24 entry is extended, then there has
 				 * to be a rule with depth >= 25 in the
 				 * associated TBL8 group.
 				 */
 
-				tbl8_group_index = lpm->tbl24[i].tbl8_gindex;
+				tbl8_group_index = lpm->tbl24[i].next_hop;
 				tbl8_index = tbl8_group_index *
 						RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 
@@ -829,11 +1088,11 @@ tbl8_recycle_check(struct rte_lpm_tbl8_entry *tbl8, uint32_t tbl8_group_start)
 	 */
 	if (tbl8[tbl8_group_start].valid) {
 		/*
-		 * If first entry is valid check if the depth is less than 24
+		 * If first entry is valid check if the depth is at most 24
 		 * and if so check the rest of the entries to verify that they
 		 * are all of this depth.
 		 */
-		if (tbl8[tbl8_group_start].depth < MAX_DEPTH_TBL24) {
+		if (tbl8[tbl8_group_start].depth <= MAX_DEPTH_TBL24) {
 			for (i = (tbl8_group_start + 1); i < tbl8_group_end;
 					i++) {
 
@@ -876,7 +1135,7 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 	tbl24_index = ip_masked >> 8;
 
 	/* Calculate the index into tbl8 and range. */
-	tbl8_group_index = lpm->tbl24[tbl24_index].tbl8_gindex;
+	tbl8_group_index = lpm->tbl24[tbl24_index].next_hop;
 	tbl8_group_start = tbl8_group_index * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 	tbl8_index = tbl8_group_start + (ip_masked & 0xFF);
 	tbl8_range = depth_to_range(depth);
@@ -921,12 +1180,12 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 	if (tbl8_recycle_index == -EINVAL){
 		/* Set tbl24 before freeing tbl8 to avoid race condition. */
 		lpm->tbl24[tbl24_index].valid = 0;
-		tbl8_free(lpm->tbl8, tbl8_group_start);
+		tbl8_free(lpm, tbl8_group_start);
 	}
 	else if (tbl8_recycle_index > -1) {
 		/* Update tbl24 entry. */
 		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-			{ .next_hop = lpm->tbl8[tbl8_recycle_index].next_hop, },
+			.next_hop = lpm->tbl8[tbl8_recycle_index].next_hop,
 			.valid = VALID,
 			.ext_entry = 0,
 			.depth = lpm->tbl8[tbl8_recycle_index].depth,
@@ -934,7 +1193,7 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 
 		/* Set tbl24 before freeing tbl8 to avoid race condition. */
 		lpm->tbl24[tbl24_index] = new_tbl24_entry;
-		tbl8_free(lpm->tbl8, tbl8_group_start);
+		tbl8_free(lpm, tbl8_group_start);
 	}
 
 	return 0;
@@ -1002,16 +1261,77 @@ rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
 void
 rte_lpm_delete_all(struct rte_lpm *lpm)
 {
+	struct rte_lpm_tbl24_entry tbl24_entry;
+	const struct rte_lpm_tbl24_entry zero_tbl24_entry = { .valid = INVALID, };
+	uint32_t i;
+
 	/* Zero rule information. */
 	memset(lpm->rule_info, 0, sizeof(lpm->rule_info));
 
-	/* Zero tbl24. */
-	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
+	/*
+	 * Zero tbl24 one entry at a time, so that a concurrent lookup sees
+	 * either the old entry or an invalid one, and free the tbl8 groups
+	 * that were linked from it.
+	 */
+	for (i = 0; i < RTE_LPM_TBL24_NUM_ENTRIES; i++) {
+		tbl24_entry = lpm->tbl24[i];
+		if (!tbl24_entry.valid)
+			continue;
+
+		lpm->tbl24[i] = zero_tbl24_entry;
+		if (tbl24_entry.ext_entry)
+			tbl8_free(lpm, tbl24_entry.next_hop *
+					RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
+	}
 
-	/* Zero tbl8. */
-	memset(lpm->tbl8, 0, sizeof(lpm->tbl8));
+	/* Zero tbl8, unless freed groups wait for rte_lpm_tbl8_reclaim(). */
+	if (!(lpm->flags & RTE_LPM_F_TBL8_DEFER_FREE))
+		memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0]) *
+				RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
+				lpm->number_tbl8s);
 
 	/* Delete all rules form the rules table. */
 	memset(lpm->rules_tbl, 0, sizeof(lpm->rules_tbl[0]) * lpm->max_rules);
 }
 
+/*
+ * Start a grace period for the tbl8 groups freed so far.
+ */
+uint32_t
+rte_lpm_tbl8_gp_start(struct rte_lpm *lpm)
+{
+	/* Order the tbl24 updates before the caller waits for readers. */
+	rte_mb();
+
+	return ++lpm->tbl8_gp_gen;
+}
+
+/*
+ * Make the tbl8 groups freed before the grace period started by
+ * rte_lpm_tbl8_gp_start() available for allocation again.
+ */
+int
+rte_lpm_tbl8_reclaim(struct rte_lpm *lpm, uint32_t gp_token)
+{
+	struct rte_lpm_tbl8_pending *pending;
+	int n_reclaimed = 0;
+
+	/* Check user arguments. */
+	if ((lpm == NULL) || !(lpm->flags & RTE_LPM_F_TBL8_DEFER_FREE))
+		return -EINVAL;
+
+	/* Groups are queued in the order they were freed. */
+	while (lpm->tbl8_pending_head != lpm->tbl8_pending_tail) {
+		pending = &lpm->tbl8_pending[lpm->tbl8_pending_head %
+				lpm->number_tbl8s];
+		if ((int32_t)(pending->gp_gen - gp_token) >= 0)
+			break;
+
+		lpm->tbl8[pending->group_idx *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES].valid_group = INVALID;
+		lpm->tbl8_pending_head++;
+		n_reclaimed++;
+	}
+
+	return n_reclaimed;
+}
@@ -74,12 +74,22 @@ extern "C" {
 /** @internal Number of entries in a tbl8 group. */
 #define RTE_LPM_TBL8_GROUP_NUM_ENTRIES  256
 
-/** @internal Total number of tbl8 groups in the tbl8. */
+/** Default number of tbl8 groups, used by rte_lpm_create(). */
 #define RTE_LPM_TBL8_NUM_GROUPS         256
 
-/** @internal Total number of tbl8 entries. */
-#define RTE_LPM_TBL8_NUM_ENTRIES        (RTE_LPM_TBL8_NUM_GROUPS * \
-					RTE_LPM_TBL8_GROUP_NUM_ENTRIES)
+/** Maximum number of tbl8 groups that can be configured. */
+#define RTE_LPM_MAX_TBL8_NUM_GROUPS     (1 << 23)
+
+/** Maximum next hop value, next hops are stored on 24 bits. */
+#define RTE_LPM_MAX_NEXT_HOP            ((1 << 24) - 1)
+
+/**
+ * Flag for rte_lpm_config: freed tbl8 groups are not reused until
+ * rte_lpm_tbl8_reclaim() is called after a grace period, so that lookups
+ * running concurrently with rte_lpm_delete() never read a recycled group.
+ * Its value does not overlap the deprecated RTE_LPM_MEMZONE.
+ */
+#define RTE_LPM_F_TBL8_DEFER_FREE       0x2
 
 /** @internal Macro to enable/disable run-time checks. */
 #if defined(RTE_LIBRTE_LPM_DEBUG)
@@ -91,37 +101,45 @@ extern "C" {
 #endif
 
 /** @internal bitmask with valid and ext_entry/valid_group fields set */
-#define RTE_LPM_VALID_EXT_ENTRY_BITMASK 0x0300
+#define RTE_LPM_VALID_EXT_ENTRY_BITMASK 0x03000000
 
 /** Bitmask used to indicate successful lookup */
-#define RTE_LPM_LOOKUP_SUCCESS          0x0100
+#define RTE_LPM_LOOKUP_SUCCESS          0x01000000
+
+/** Bitmask to extract the next hop from a lookup result */
+#define RTE_LPM_NEXT_HOP_MASK           0x00ffffff
 
 /** @internal Tbl24 entry structure. */
 struct rte_lpm_tbl24_entry {
-	/* Stores Next hop or group index (i.e. gindex)into tbl8. */
-	union {
-		uint8_t next_hop;
-		uint8_t tbl8_gindex;
-	};
-	/* Using single uint8_t to store 3 values. */
-	uint8_t valid     :1; /**< Validation flag. */
-	uint8_t ext_entry :1; /**< External entry. */
-	uint8_t depth     :6; /**< Rule depth. */
+	/*
+	 * Stores next hop, or group index into tbl8 when ext_entry is set.
+	 * Using single uint32_t to store 4 values.
+	 */
+	uint32_t next_hop  :24; /**< Next hop or tbl8 group index. */
+	uint32_t valid     :1;  /**< Validation flag. */
+	uint32_t ext_entry :1;  /**< External entry. */
+	uint32_t depth     :6;  /**< Rule depth. */
 };
 
 /** @internal Tbl8 entry structure. */
 struct rte_lpm_tbl8_entry {
-	uint8_t next_hop; /**< next hop. */
-	/* Using single uint8_t to store 3 values. */
-	uint8_t valid       :1; /**< Validation flag. */
-	uint8_t valid_group :1; /**< Group validation flag. */
-	uint8_t depth       :6; /**< Rule depth. */
+	/* Using single uint32_t to store 4 values. */
+	uint32_t next_hop    :24; /**< Next hop. */
+	uint32_t valid       :1;  /**< Validation flag. */
+	uint32_t valid_group :1;  /**< Group validation flag. */
+	uint32_t depth       :6;  /**< Rule depth. */
 };
 
 /** @internal Rule structure. */
 struct rte_lpm_rule {
 	uint32_t ip; /**< Rule IP address. */
-	uint8_t  next_hop; /**< Rule next hop. */
+	uint32_t next_hop; /**< Rule next hop. */
+};
+
+/** @internal Freed tbl8 group waiting for the end of a grace period. */
+struct rte_lpm_tbl8_pending {
+	uint32_t group_idx; /**< tbl8 group index. */
+	uint32_t gp_gen;    /**< Grace period generation when it was freed. */
 };
 
 /** @internal Contains metadata about the rules table. */
@@ -136,17 +154,29 @@ struct rte_lpm {
 	char name[RTE_LPM_NAMESIZE];        /**< Name of the lpm. */
 	int mem_location; /**< @deprecated @see RTE_LPM_HEAP and RTE_LPM_MEMZONE. */
 	uint32_t max_rules; /**< Max. balanced rules per lpm. */
+	uint32_t number_tbl8s; /**< Number of tbl8 groups. */
+	int flags; /**< RTE_LPM_F_* flags given at creation. */
+	uint32_t tbl8_gp_gen; /**< Current grace period generation. */
+	uint32_t tbl8_pending_head; /**< First freed group not reclaimed yet. */
+	uint32_t tbl8_pending_tail; /**< Next slot in tbl8_pending. */
 	struct rte_lpm_rule_info rule_info[RTE_LPM_MAX_DEPTH]; /**< Rule info table. */
+	struct rte_lpm_tbl8_entry *tbl8; /**< LPM tbl8 table, after rules_tbl. */
+	struct rte_lpm_tbl8_pending *tbl8_pending; /**< Freed groups, after tbl8. */
 
 	/* LPM Tables. */
 	struct rte_lpm_tbl24_entry tbl24[RTE_LPM_TBL24_NUM_ENTRIES] \
 			__rte_cache_aligned; /**< LPM tbl24 table. */
-	struct rte_lpm_tbl8_entry tbl8[RTE_LPM_TBL8_NUM_ENTRIES] \
-			__rte_cache_aligned; /**< LPM tbl8 table. */
 	struct rte_lpm_rule rules_tbl[0] \
 			__rte_cache_aligned; /**< LPM rules. */
 };
 
+/** LPM configuration structure. */
+struct rte_lpm_config {
+	uint32_t max_rules;      /**< Max number of rules. */
+	uint32_t number_tbl8s;   /**< Number of tbl8 groups to allocate. */
+	int flags;               /**< RTE_LPM_F_* flags. */
+};
+
 /**
  * Create an LPM object.
  *
@@ -172,6 +202,30 @@ struct rte_lpm {
 struct rte_lpm *
 rte_lpm_create(const char *name, int socket_id, int max_rules, int flags);
 
+/**
+ * Create an LPM object with an explicit configuration.
+ *
+ * Same as rte_lpm_create(), but also lets the caller size the tbl8, i.e.
+ * the number of /24 prefixes that can hold rules deeper than 24 bits.
+ * rte_lpm_create() uses RTE_LPM_TBL8_NUM_GROUPS groups.
+ *
+ * @param name
+ *   LPM object name
+ * @param socket_id
+ *   NUMA socket ID for LPM table memory allocation
+ * @param config
+ *   Structure containing the configuration; number_tbl8s must be in the
+ *   range 1 .. RTE_LPM_MAX_TBL8_NUM_GROUPS, flags is a combination of
+ *   RTE_LPM_F_* values
+ * @return
+ *   Handle to LPM object on success, NULL otherwise with rte_errno set
+ *   to an appropriate values. Possible rte_errno values are the same
+ *   as for rte_lpm_create().
+ */
+struct rte_lpm *
+rte_lpm_create_config(const char *name, int socket_id,
+		const struct rte_lpm_config *config);
+
 /**
  * Find an existing LPM object and return a pointer to it.
  *
@@ -206,12 +260,40 @@ rte_lpm_free(struct rte_lpm *lpm);
  * @param depth
  *   Depth of the rule to be added to the LPM table
  * @param next_hop
- *   Next hop of the rule to be added to the LPM table
+ *   Next hop of the rule to be added to the LPM table, at most
+ *   RTE_LPM_MAX_NEXT_HOP
  * @return
  *   0 on success, negative value otherwise
  */
 int
-rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint8_t next_hop);
+rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint32_t next_hop);
+
+/**
+ * Add several rules to the LPM table.
+ *
+ * Equivalent to calling rte_lpm_add() for each rule, but the rules table is
+ * searched once per depth instead of once per rule, which makes loading or
+ * refreshing a large routing table much faster. Rules with an invalid depth
+ * or next hop, or that do not fit in the rules table or tbl8, are skipped.
+ * Existing rules are updated in place, lookups running concurrently keep
+ * getting either the old or the new next hop.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param ips
+ *   Array of n IPs of the rules to be added
+ * @param depths
+ *   Array of n depths of the rules to be added
+ * @param next_hops
+ *   Array of n next hops of the rules to be added
+ * @param n
+ *   Number of rules to add
+ * @return
+ *   Number of rules added or updated, -EINVAL or -ENOMEM on failure
+ */
+int
+rte_lpm_add_bulk(struct rte_lpm *lpm, const uint32_t *ips,
+		const uint8_t *depths, const uint32_t *next_hops, unsigned n);
 
 /**
  * Check if a rule is present in the LPM table,
@@ -230,7 +312,7 @@ rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint8_t next_hop);
  */
 int
 rte_lpm_is_rule_present(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-uint8_t *next_hop);
+uint32_t *next_hop);
 
 /**
  * Delete a rule from the LPM table.
@@ -250,12 +332,49 @@ rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth);
 /**
  * Delete all rules from the LPM table.
  *
+ * The tbl24 entries are invalidated one at a time, lookups running
+ * concurrently either hit a not yet deleted rule or miss. To replace a
+ * routing table without a window of misses, add the new rules over the old
+ * ones with rte_lpm_add_bulk() and delete the stale ones afterwards.
+ *
  * @param lpm
  *   LPM object handle
  */
 void
 rte_lpm_delete_all(struct rte_lpm *lpm);
 
+/**
+ * Start a grace period for the tbl8 groups freed so far by rte_lpm_delete()
+ * and rte_lpm_delete_all() on a table created with RTE_LPM_F_TBL8_DEFER_FREE.
+ *
+ * The caller then waits until every lcore doing lookups has gone through a
+ * quiescent state, i.e. has finished the lookups it had started before this
+ * call, and passes the returned token to rte_lpm_tbl8_reclaim().
+ *
+ * @param lpm
+ *   LPM object handle
+ * @return
+ *   Token to pass to rte_lpm_tbl8_reclaim()
+ */
+uint32_t
+rte_lpm_tbl8_gp_start(struct rte_lpm *lpm);
+
+/**
+ * Make the tbl8 groups freed before the given grace period started
+ * available to rte_lpm_add() again. Like the other update functions, this
+ * must not be called concurrently with them.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param gp_token
+ *   Token returned by rte_lpm_tbl8_gp_start(), once the grace period is over
+ * @return
+ *   Number of tbl8 groups reclaimed, -EINVAL if the table was not created
+ *   with RTE_LPM_F_TBL8_DEFER_FREE
+ */
+int
+rte_lpm_tbl8_reclaim(struct rte_lpm *lpm, uint32_t gp_token);
+
 /**
  * Lookup an IP into the LPM table.
  *
@@ -269,28 +388,32 @@ rte_lpm_delete_all(struct rte_lpm *lpm);
  *   -EINVAL for incorrect arguments, -ENOENT on lookup miss, 0 on lookup hit
  */
 static inline int
-rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint8_t *next_hop)
+rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint32_t *next_hop)
 {
 	unsigned tbl24_index = (ip >> 8);
-	uint16_t tbl_entry;
+	uint32_t tbl_entry;
+	const uint32_t *ptbl;
 
 	/* DEBUG: Check user input arguments. */
 	RTE_LPM_RETURN_IF_TRUE(((lpm == NULL) || (next_hop == NULL)), -EINVAL);
 
 	/* Copy tbl24 entry */
-	tbl_entry = *(const uint16_t *)&lpm->tbl24[tbl24_index];
+	ptbl = (const uint32_t *)&lpm->tbl24[tbl24_index];
+	tbl_entry = *ptbl;
 
 	/* Copy tbl8 entry (only if needed) */
 	if (unlikely((tbl_entry & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 
 		unsigned tbl8_index = (uint8_t)ip +
-				((uint8_t)tbl_entry * RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
+				((tbl_entry & RTE_LPM_NEXT_HOP_MASK) *
+				 RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
 
-		tbl_entry = *(const uint16_t *)&lpm->tbl8[tbl8_index];
+		ptbl = (const uint32_t *)&lpm->tbl8[tbl8_index];
+		tbl_entry = *ptbl;
 	}
 
-	*next_hop = (uint8_t)tbl_entry;
+	*next_hop = tbl_entry & RTE_LPM_NEXT_HOP_MASK;
 	return (tbl_entry & RTE_LPM_LOOKUP_SUCCESS) ? 0 : -ENOENT;
 }
 
@@ -304,10 +427,10 @@ rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint8_t *next_hop)
  *   Array of IPs to be looked up in the LPM table
  * @param next_hops
  *   Next hop of the most specific rule found for IP (valid on lookup hit only).
- *   This is an array of two byte values. The most significant byte in each
+ *   This is an array of four byte values. The most significant byte in each
  *   value says whether the lookup was successful (bitmask
- *   RTE_LPM_LOOKUP_SUCCESS is set). The least significant byte is the
- *   actual next hop.
+ *   RTE_LPM_LOOKUP_SUCCESS is set). The three least significant bytes
+ *   (bitmask RTE_LPM_NEXT_HOP_MASK) are the actual next hop.
  * @param n
  *   Number of elements in ips (and next_hops) array to lookup. This should be a
  *   compile time constant, and divisible by 8 for best performance.
@@ -319,10 +442,11 @@ rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint8_t *next_hop)
 
 static inline int
 rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
-		uint16_t * next_hops, const unsigned n)
+		uint32_t * next_hops, const unsigned n)
 {
 	unsigned i;
 	unsigned tbl24_indexes[n];
+	const uint32_t *ptbl;
 
 	/* DEBUG: Check user input arguments. */
 	RTE_LPM_RETURN_IF_TRUE(((lpm == NULL) || (ips == NULL) ||
@@ -334,24 +458,26 @@ rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
 
 	for (i = 0; i < n; i++) {
 		/* Simply copy tbl24 entry to output */
-		next_hops[i] = *(const uint16_t *)&lpm->tbl24[tbl24_indexes[i]];
+		ptbl = (const uint32_t *)&lpm->tbl24[tbl24_indexes[i]];
+		next_hops[i] = *ptbl;
 
 		/* Overwrite output with tbl8 entry if needed */
 		if (unlikely((next_hops[i] & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 				RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 
 			unsigned tbl8_index = (uint8_t)ips[i] +
-					((uint8_t)next_hops[i] *
+					((next_hops[i] & RTE_LPM_NEXT_HOP_MASK) *
 					 RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
 
-			next_hops[i] = *(const uint16_t *)&lpm->tbl8[tbl8_index];
+			ptbl = (const uint32_t *)&lpm->tbl8[tbl8_index];
+			next_hops[i] = *ptbl;
 		}
 	}
 	return 0;
 }
 
-/* Mask four results. */
-#define	 RTE_LPM_MASKX4_RES	UINT64_C(0x00ff00ff00ff00ff)
+/* Mask four results, two per 64-bit word. */
+#define	 RTE_LPM_MASKX4_RES	UINT64_C(0x00ffffff00ffffff)
 
 /**
  * Lookup four IP addresses in an LPM table.
@@ -362,10 +488,10 @@ rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
  *   Four IPs to be looked up in the LPM table
  * @param hop
  *   Next hop of the most specific rule found for IP (valid on lookup hit only).
- *   This is an 4 elements array of two byte values.
- *   If the lookup was succesfull for the given IP, then least significant byte
- *   of the corresponding element is the  actual next hop and the most
- *   significant byte is zero.
+ *   This is an 4 elements array of four byte values.
+ *   If the lookup was succesfull for the given IP, then the three least
+ *   significant bytes of the corresponding element are the actual next hop
+ *   and the most significant byte is zero.
  *   If the lookup for the given IP failed, then corresponding element would
  *   contain default value, see description of then next parameter.
  * @param defv
@@ -373,36 +499,33 @@ rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
  *   if lookup would fail.
  */
 static inline void
-rte_lpm_lookupx4(const struct rte_lpm *lpm, __m128i ip, uint16_t hop[4],
-	uint16_t defv)
+rte_lpm_lookupx4(const struct rte_lpm *lpm, __m128i ip, uint32_t hop[4],
+	uint32_t defv)
 {
 	__m128i i24;
 	rte_xmm_t i8;
-	uint16_t tbl[4];
-	uint64_t idx, pt;
+	uint32_t tbl[4];
+	uint64_t idx, pt, pt2;
+	const uint32_t *ptbl;
 
 	const __m128i mask8 =
 		_mm_set_epi32(UINT8_MAX, UINT8_MAX, UINT8_MAX, UINT8_MAX);
 
 	/*
-	 * RTE_LPM_VALID_EXT_ENTRY_BITMASK for 4 LPM entries
-	 * as one 64-bit value (0x0300030003000300).
+	 * RTE_LPM_VALID_EXT_ENTRY_BITMASK for 2 LPM entries
+	 * as one 64-bit value (0x0300000003000000).
 	 */
 	const uint64_t mask_xv =
 		((uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK |
-		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 16 |
-		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 32 |
-		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 48);
+		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 32);
 
 	/*
-	 * RTE_LPM_LOOKUP_SUCCESS for 4 LPM entries
-	 * as one 64-bit value (0x0100010001000100).
+	 * RTE_LPM_LOOKUP_SUCCESS for 2 LPM entries
+	 * as one 64-bit value (0x0100000001000000).
 	 */
 	const uint64_t mask_v =
 		((uint64_t)RTE_LPM_LOOKUP_SUCCESS |
-		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 16 |
-		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 32 |
-		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 48);
+		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 32);
 
 	/* get 4 indexes for tbl24[]. */
 	i24 = _mm_srli_epi32(ip, CHAR_BIT);
@@ -411,58 +534,76 @@ rte_lpm_lookupx4(const struct rte_lpm *lpm, __m128i ip, uint16_t hop[4],
 	idx = _mm_cvtsi128_si64(i24);
 	i24 = _mm_srli_si128(i24, sizeof(uint64_t));
 
-	tbl[0] = *(const uint16_t *)&lpm->tbl24[(uint32_t)idx];
-	tbl[1] = *(const uint16_t *)&lpm->tbl24[idx >> 32];
+	ptbl = (const uint32_t *)&lpm->tbl24[(uint32_t)idx];
+	tbl[0] = *ptbl;
+	ptbl = (const uint32_t *)&lpm->tbl24[idx >> 32];
+	tbl[1] = *ptbl;
 
 	idx = _mm_cvtsi128_si64(i24);
 
-	tbl[2] = *(const uint16_t *)&lpm->tbl24[(uint32_t)idx];
-	tbl[3] = *(const uint16_t *)&lpm->tbl24[idx >> 32];
+	ptbl = (const uint32_t *)&lpm->tbl24[(uint32_t)idx];
+	tbl[2] = *ptbl;
+	ptbl = (const uint32_t *)&lpm->tbl24[idx >> 32];
+	tbl[3] = *ptbl;
 
 	/* get 4 indexes for tbl8[]. */
 	i8.m = _mm_and_si128(ip, mask8);
 
 	pt = (uint64_t)tbl[0] |
-		(uint64_t)tbl[1] << 16 |
-		(uint64_t)tbl[2] << 32 |
-		(uint64_t)tbl[3] << 48;
+		(uint64_t)tbl[1] << 32;
+	pt2 = (uint64_t)tbl[2] |
+		(uint64_t)tbl[3] << 32;
 
 	/* search successfully finished for all 4 IP addresses. */
-	if (likely((pt & mask_xv) == mask_v)) {
+	if (likely((pt & mask_xv) == mask_v) &&
+			likely((pt2 & mask_xv) == mask_v)) {
 		uintptr_t ph = (uintptr_t)hop;
 		*(uint64_t *)ph = pt & RTE_LPM_MASKX4_RES;
+		*(uint64_t *)(ph + sizeof(uint64_t)) = pt2 & RTE_LPM_MASKX4_RES;
 		return;
 	}
 
 	if (unlikely((pt & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 		i8.u32[0] = i8.u32[0] +
-			(uint8_t)tbl[0] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[0] = *(const uint16_t *)&lpm->tbl8[i8.u32[0]];
+			(tbl[0] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		ptbl = (const uint32_t *)&lpm->tbl8[i8.u32[0]];
+		tbl[0] = *ptbl;
 	}
-	if (unlikely((pt >> 16 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
+	if (unlikely((pt >> 32 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 		i8.u32[1] = i8.u32[1] +
-			(uint8_t)tbl[1] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[1] = *(const uint16_t *)&lpm->tbl8[i8.u32[1]];
+			(tbl[1] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		ptbl = (const uint32_t *)&lpm->tbl8[i8.u32[1]];
+		tbl[1] = *ptbl;
 	}
-	if (unlikely((pt >> 32 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
+	if (unlikely((pt2 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 		i8.u32[2] = i8.u32[2] +
-			(uint8_t)tbl[2] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[2] = *(const uint16_t *)&lpm->tbl8[i8.u32[2]];
+			(tbl[2] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		ptbl = (const uint32_t *)&lpm->tbl8[i8.u32[2]];
+		tbl[2] = *ptbl;
 	}
-	if (unlikely((pt >> 48 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
+	if (unlikely((pt2 >> 32 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 		i8.u32[3] = i8.u32[3] +
-			(uint8_t)tbl[3] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[3] = *(const uint16_t *)&lpm->tbl8[i8.u32[3]];
+			(tbl[3] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		ptbl = (const uint32_t *)&lpm->tbl8[i8.u32[3]];
+		tbl[3] = *ptbl;
 	}
 
-	hop[0] = (tbl[0] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[0] : defv;
-	hop[1] = (tbl[1] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[1] : defv;
-	hop[2] = (tbl[2] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[2] : defv;
-	hop[3] = (tbl[3] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[3] : defv;
+	hop[0] = (tbl[0] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[0] & RTE_LPM_NEXT_HOP_MASK : defv;
+	hop[1] = (tbl[1] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[1] & RTE_LPM_NEXT_HOP_MASK : defv;
+	hop[2] = (tbl[2] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[2] & RTE_LPM_NEXT_HOP_MASK : defv;
+	hop[3] = (tbl[3] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[3] & RTE_LPM_NEXT_HOP_MASK : defv;
 }
 
 #ifdef __cplusplus
@@ -53,6 +53,7 @@
 #include <rte_errno.h>
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
+#include <rte_prefetch.h>
 
 #include "rte_lpm6.h"
 
@@ -68,6 +69,7 @@
 #define LOOKUP_FIRST_BYTE                         4
 #define BYTE_SIZE                                 8
 #define BYTES2_SIZE                              16
+#define LOOKUP_BULK_BURST                        16
 
 #define lpm6_tbl8_gindex next_hop
 
@@ -276,7 +278,7 @@ rte_lpm6_free(struct rte_lpm6 *lpm)
 
 	/* check that we have an initialised tail queue */
 	if ((lpm_list =
-	     RTE_TAILQ_LOOKUP_BY_IDX(RTE_TAILQ_LPM, rte_lpm6_list)) == NULL) {
+	     RTE_TAILQ_LOOKUP_BY_IDX(RTE_TAILQ_LPM6, rte_lpm6_list)) == NULL) {
 		rte_errno = E_RTE_NO_TAILQ;
 		return;
 	}
@@ -297,6 +299,7 @@ rte_lpm6_free(struct rte_lpm6 *lpm)
 
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 
+	rte_free(lpm->rules_tbl);
 	rte_free(lpm);
 	rte_free(te);
 }
@@ -637,43 +640,70 @@ rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint8_t *next_hop)
 
 /*
  * Looks up a group of IP addresses
+ *
+ * The addresses are walked down the tables in bursts of LOOKUP_BULK_BURST,
+ * one level at a time for the whole burst: the entry of the next level of
+ * each address is prefetched, and read only once all the other addresses of
+ * the burst moved down one level, so that the memory accesses of the burst
+ * overlap instead of being serialized.
  */
 int
 rte_lpm6_lookup_bulk_func(const struct rte_lpm6 *lpm,
 		uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE],
 		int16_t * next_hops, unsigned n)
 {
-	unsigned i;
-	const struct rte_lpm6_tbl_entry *tbl;
-	const struct rte_lpm6_tbl_entry *tbl_next;
-	uint32_t tbl24_index;
-	uint8_t first_byte, next_hop;
-	int status;
+	const struct rte_lpm6_tbl_entry *tbl[LOOKUP_BULK_BURST];
+	uint32_t tbl24_index, tbl8_index, tbl_entry, pending;
+	unsigned i, j, burst;
+	uint8_t first_byte;
 
 	/* DEBUG: Check user input arguments. */
 	if ((lpm == NULL) || (ips == NULL) || (next_hops == NULL)) {
 		return -EINVAL;
 	}
 
-	for (i = 0; i < n; i++) {
+	for (i = 0; i < n; i += burst) {
+		burst = RTE_MIN(n - i, (unsigned)LOOKUP_BULK_BURST);
+
+		/* Calculate pointers to the first entries to be inspected */
+		for (j = 0; j < burst; j++) {
+			tbl24_index = (ips[i + j][0] << BYTES2_SIZE) |
+					(ips[i + j][1] << BYTE_SIZE) |
+					ips[i + j][2];
+			tbl[j] = &lpm->tbl24[tbl24_index];
+			rte_prefetch0((void *)(uintptr_t)tbl[j]);
+		}
+
+		/* Bitmask of the addresses still walking down the tables. */
+		pending = (uint32_t)((1ULL << burst) - 1);
 		first_byte = LOOKUP_FIRST_BYTE;
-		tbl24_index = (ips[i][0] << BYTES2_SIZE) |
-				(ips[i][1] << BYTE_SIZE) | ips[i][2];
-
-		/* Calculate pointer to the first entry to be inspected */
-		tbl = &lpm->tbl24[tbl24_index];
-
-		do {
-			/* Continue inspecting following levels until success or failure */
-			status = lookup_step(lpm, tbl, &tbl_next, ips[i], first_byte++,
-					&next_hop);
-			tbl = tbl_next;
-		} while (status == 1);
-
-		if (status < 0)
-			next_hops[i] = -1;
-		else
-			next_hops[i] = next_hop;
+
+		while (pending != 0) {
+			for (j = 0; j < burst; j++) {
+				if ((pending & (1U << j)) == 0)
+					continue;
+
+				tbl_entry = *(const uint32_t *)tbl[j];
+
+				if ((tbl_entry & RTE_LPM6_VALID_EXT_ENTRY_BITMASK) ==
+						RTE_LPM6_VALID_EXT_ENTRY_BITMASK) {
+					tbl8_index = ips[i + j][first_byte - 1] +
+						((tbl_entry & RTE_LPM6_TBL8_BITMASK) *
+						RTE_LPM6_TBL8_GROUP_NUM_ENTRIES);
+					tbl[j] = &lpm->tbl8[tbl8_index];
+					rte_prefetch0((void *)(uintptr_t)tbl[j]);
+					continue;
+				}
+
+				/* If not extended then we can have a match. */
+				if (tbl_entry & RTE_LPM6_LOOKUP_SUCCESS)
+					next_hops[i + j] = (uint8_t)tbl_entry;
+				else
+					next_hops[i + j] = -1;
+				pending &= ~(1U << j);
+			}
+			first_byte++;
+		}
 	}
 
 	return 0;
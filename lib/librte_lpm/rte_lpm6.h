@@ -203,6 +203,11 @@ rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint8_t *next_hop);
 /**
  * Lookup multiple IP addresses in an LPM table.
  *
+ * The lookups are interleaved, with prefetches between table levels, so
+ * this is much faster than calling rte_lpm6_lookup() for each address when
+ * the tables do not fit in the cache. Batches of 16 addresses or more get
+ * the full benefit.
+ *
  * @param lpm
  *   LPM object handle
  * @param ips
@@ -42,7 +42,8 @@ struct malloc_heap;
 enum elem_state {
 	ELEM_FREE = 0,
 	ELEM_BUSY,
-	ELEM_PAD  /* element is a padding-only header */
+	ELEM_PAD,  /* element is a padding-only header */
+	ELEM_CACHED /* element is freed but held in an lcore cache */
 };
 
 struct malloc_elem {
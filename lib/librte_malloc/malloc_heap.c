@@ -174,6 +174,44 @@ malloc_heap_alloc(struct malloc_heap *heap,
 
 }
 
+/*
+ * Give back to the memzone allocator the memzones of the heap that are
+ * entirely free, i.e. holding a single free element followed by the
+ * end-of-memzone marker. Returns the number of bytes released.
+ */
+size_t
+malloc_heap_trim(struct malloc_heap *heap)
+{
+	struct malloc_elem *elem, *next, *end;
+	const struct rte_memzone *mz;
+	size_t idx, mz_len, released = 0;
+
+	rte_spinlock_lock(&heap->lock);
+	for (idx = 0; idx < RTE_HEAP_NUM_FREELISTS; idx++) {
+		for (elem = LIST_FIRST(&heap->free_head[idx]);
+				elem != NULL; elem = next) {
+			next = LIST_NEXT(elem, free_list);
+			end = RTE_PTR_ADD(elem, elem->size);
+			mz = elem->mz;
+			if (elem->prev != NULL || (void *)elem != mz->addr ||
+					end->size != 0 || end->state != ELEM_BUSY)
+				continue;
+
+			/* the descriptor is cleared when the zone is freed */
+			mz_len = mz->len;
+			LIST_REMOVE(elem, free_list);
+			if (rte_memzone_free(mz) < 0) {
+				malloc_elem_free_list_insert(elem);
+				continue;
+			}
+			heap->total_size -= mz_len - MALLOC_ELEM_OVERHEAD;
+			released += mz_len;
+		}
+	}
+	rte_spinlock_unlock(&heap->lock);
+	return released;
+}
+
 /*
  * Function to retrieve data for heap on given socket
  */
@@ -191,10 +229,12 @@ malloc_heap_get_stats(const struct malloc_heap *heap,
 
 	/* Iterate through free list */
 	for (idx = 0; idx < RTE_HEAP_NUM_FREELISTS; idx++) {
+		socket_stats->freelist_count[idx] = 0;
 		for (elem = LIST_FIRST(&heap->free_head[idx]);
 			!!elem; elem = LIST_NEXT(elem, free_list))
 		{
 			socket_stats->free_count++;
+			socket_stats->freelist_count[idx]++;
 			socket_stats->heap_freesz_bytes += elem->size;
 			if (elem->size > socket_stats->greatest_free_size)
 				socket_stats->greatest_free_size = elem->size;
@@ -205,6 +245,14 @@ malloc_heap_get_stats(const struct malloc_heap *heap,
 	socket_stats->heap_allocsz_bytes = (socket_stats->heap_totalsz_bytes -
 			socket_stats->heap_freesz_bytes);
 	socket_stats->alloc_count = heap->alloc_count;
+
+	/* share of free memory that can't serve the largest request */
+	if (socket_stats->heap_freesz_bytes == 0)
+		socket_stats->fragmentation = 0;
+	else
+		socket_stats->fragmentation = (unsigned)(100 -
+			(socket_stats->greatest_free_size * 100) /
+			socket_stats->heap_freesz_bytes);
 	return 0;
 }
 
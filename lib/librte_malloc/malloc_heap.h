@@ -51,6 +51,9 @@ void *
 malloc_heap_alloc(struct malloc_heap *heap, const char *type,
 		size_t size, unsigned align);
 
+size_t
+malloc_heap_trim(struct malloc_heap *heap);
+
 int
 malloc_heap_get_stats(const struct malloc_heap *heap,
 		struct rte_malloc_socket_stats *socket_stats);
@@ -55,12 +55,130 @@
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 
+#if RTE_MALLOC_CACHE_SIZE > 0
+
+/* size of the blocks held in a class of the per-lcore caches */
+#define MALLOC_CACHE_CLASS_SIZE(idx) ((size_t)RTE_CACHE_LINE_SIZE << (idx))
+#define MALLOC_CACHE_MAX_SIZE \
+	MALLOC_CACHE_CLASS_SIZE(RTE_MALLOC_CACHE_NUM_CLASSES - 1)
+
+/*
+ * Per-lcore cache of small freed blocks, sorted by size class. It only
+ * holds blocks of the heap of the lcore socket, and is only accessed by
+ * its lcore, so no lock is needed. Cached blocks stay allocated from the
+ * heap point of view.
+ */
+struct malloc_lcore_cache {
+	unsigned len[RTE_MALLOC_CACHE_NUM_CLASSES];
+	void *objs[RTE_MALLOC_CACHE_NUM_CLASSES][RTE_MALLOC_CACHE_SIZE];
+} __rte_cache_aligned;
+
+static struct malloc_lcore_cache malloc_lcore_cache[RTE_MAX_LCORE];
+
+/* return the smallest class holding blocks of at least size bytes */
+static inline unsigned
+malloc_cache_class(size_t size)
+{
+	unsigned idx = 0;
+
+	while (MALLOC_CACHE_CLASS_SIZE(idx) < size)
+		idx++;
+	return idx;
+}
+
+/*
+ * Get a block of the given class from the cache of the calling lcore,
+ * or NULL if it is empty.
+ */
+static inline void *
+malloc_cache_get(unsigned lcore_id, unsigned idx)
+{
+	struct malloc_lcore_cache *cache = &malloc_lcore_cache[lcore_id];
+	void *data;
+
+	if (cache->len[idx] == 0)
+		return NULL;
+
+	data = cache->objs[idx][--cache->len[idx]];
+	malloc_elem_from_data(data)->state = ELEM_BUSY;
+	return data;
+}
+
+/*
+ * Put a block in the cache of the calling lcore if it is small enough,
+ * belongs to the heap of the lcore socket and the cache is not full.
+ * Return 0 if the block was cached.
+ */
+static inline int
+malloc_cache_put(struct malloc_elem *elem, void *data)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct malloc_lcore_cache *cache;
+	unsigned lcore_id = rte_lcore_id();
+	size_t size;
+	unsigned idx;
+
+	if (lcore_id >= RTE_MAX_LCORE || elem == NULL ||
+			elem->state != ELEM_BUSY ||
+			elem->heap != &mcfg->malloc_heaps[rte_socket_id()])
+		return -1;
+
+	size = elem->size - elem->pad - MALLOC_ELEM_OVERHEAD;
+	if (size < MALLOC_CACHE_CLASS_SIZE(0) || size > MALLOC_CACHE_MAX_SIZE)
+		return -1;
+
+	/* the class may only hold blocks at least as large as its size */
+	idx = malloc_cache_class(size);
+	if (MALLOC_CACHE_CLASS_SIZE(idx) > size)
+		idx--;
+
+	cache = &malloc_lcore_cache[lcore_id];
+	if (cache->len[idx] == RTE_MALLOC_CACHE_SIZE)
+		return -1;
+
+	elem->state = ELEM_CACHED;
+	cache->objs[idx][cache->len[idx]++] = data;
+	return 0;
+}
+
+/* Return the blocks cached by the calling lcore to the heap */
+void
+rte_malloc_cache_flush(void)
+{
+	unsigned lcore_id = rte_lcore_id();
+	unsigned idx;
+	void *data;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return;
+
+	for (idx = 0; idx < RTE_MALLOC_CACHE_NUM_CLASSES; idx++) {
+		while ((data = malloc_cache_get(lcore_id, idx)) != NULL)
+			malloc_elem_free(malloc_elem_from_data(data));
+	}
+}
+
+#else /* RTE_MALLOC_CACHE_SIZE == 0 */
+
+void
+rte_malloc_cache_flush(void)
+{
+}
+
+#endif /* RTE_MALLOC_CACHE_SIZE */
 
 /* Free the memory space back to heap */
 void rte_free(void *addr)
 {
+	struct malloc_elem *elem;
+
 	if (addr == NULL) return;
-	if (malloc_elem_free(malloc_elem_from_data(addr)) < 0)
+	elem = malloc_elem_from_data(addr);
+#if RTE_MALLOC_CACHE_SIZE > 0
+	if (malloc_cache_put(elem, addr) == 0)
+		return;
+#endif
+	if (malloc_elem_free(elem) < 0)
 		rte_panic("Fatal error: Invalid memory\n");
 }
 
@@ -87,6 +205,24 @@ rte_malloc_socket(const char *type, size_t size, unsigned align, int socket_arg)
 	if (socket >= RTE_MAX_NUMA_NODES)
 		return NULL;
 
+#if RTE_MALLOC_CACHE_SIZE > 0
+	/*
+	 * small blocks of the local heap are first taken from the lcore
+	 * cache; on a miss, the size is rounded up to its class so that the
+	 * block can be cached when it is freed
+	 */
+	if (size <= MALLOC_CACHE_MAX_SIZE && align <= RTE_CACHE_LINE_SIZE &&
+			rte_lcore_id() < RTE_MAX_LCORE &&
+			socket == (int)malloc_get_numa_socket()) {
+		unsigned idx = malloc_cache_class(size);
+
+		ret = malloc_cache_get(rte_lcore_id(), idx);
+		if (ret != NULL)
+			return ret;
+		size = MALLOC_CACHE_CLASS_SIZE(idx);
+	}
+#endif
+
 	ret = malloc_heap_alloc(&mcfg->malloc_heaps[socket], type,
 				size, align == 0 ? 1 : align);
 	if (ret != NULL || socket_arg != SOCKET_ID_ANY)
@@ -207,10 +343,49 @@ rte_malloc_get_socket_stats(int socket,
 {
 	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
 
+	unsigned lcore_id, idx;
+
 	if (socket >= RTE_MAX_NUMA_NODES || socket < 0)
 		return -1;
 
-	return malloc_heap_get_stats(&mcfg->malloc_heaps[socket], socket_stats);
+	if (malloc_heap_get_stats(&mcfg->malloc_heaps[socket],
+			socket_stats) < 0)
+		return -1;
+
+	/* blocks held by the caches of the lcores of this socket */
+	socket_stats->cache_sz_bytes = 0;
+	for (idx = 0; idx < RTE_MALLOC_CACHE_NUM_CLASSES; idx++)
+		socket_stats->cache_count[idx] = 0;
+#if RTE_MALLOC_CACHE_SIZE > 0
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (rte_lcore_to_socket_id(lcore_id) != (unsigned)socket)
+			continue;
+		for (idx = 0; idx < RTE_MALLOC_CACHE_NUM_CLASSES; idx++) {
+			unsigned len = malloc_lcore_cache[lcore_id].len[idx];
+
+			socket_stats->cache_count[idx] += len;
+			socket_stats->cache_sz_bytes +=
+				len * MALLOC_CACHE_CLASS_SIZE(idx);
+		}
+	}
+#else
+	RTE_SET_USED(lcore_id);
+#endif
+	return 0;
+}
+
+/*
+ * Release the entirely free memzones of the heap on given socket
+ */
+size_t
+rte_malloc_heap_trim(int socket)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+
+	if (socket >= RTE_MAX_NUMA_NODES || socket < 0)
+		return 0;
+
+	return malloc_heap_trim(&mcfg->malloc_heaps[socket]);
 }
 
 /*
@@ -234,6 +409,9 @@ rte_malloc_dump_stats(FILE *f, __rte_unused const char *type)
 				sock_stats.greatest_free_size);
 		fprintf(f, "\tAlloc_count:%u,\n",sock_stats.alloc_count);
 		fprintf(f, "\tFree_count:%u,\n", sock_stats.free_count);
+		fprintf(f, "\tFragmentation:%u%%,\n",
+				sock_stats.fragmentation);
+		fprintf(f, "\tCache_size:%zu,\n", sock_stats.cache_sz_bytes);
 	}
 	return;
 }
@@ -43,11 +43,18 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <rte_memory.h>
+#include <rte_malloc_heap.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Number of size classes of the per-lcore caches. Class i holds blocks of
+ * (RTE_CACHE_LINE_SIZE << i) bytes; larger allocations bypass the caches.
+ */
+#define RTE_MALLOC_CACHE_NUM_CLASSES 4
+
 /**
  *  Structure to hold heap statistics obtained from rte_malloc_get_socket_stats function.
  */
@@ -58,6 +65,14 @@ struct rte_malloc_socket_stats {
 	unsigned free_count;       /**< Number of free elements on heap */
 	unsigned alloc_count;      /**< Number of allocated elements on heap */
 	size_t heap_allocsz_bytes; /**< Total allocated bytes on heap */
+	/** Percentage of free bytes that are not in the largest free block */
+	unsigned fragmentation;
+	/** Number of free elements in each free list of the heap */
+	unsigned freelist_count[RTE_HEAP_NUM_FREELISTS];
+	/** Number of freed blocks held in lcore caches, per size class */
+	unsigned cache_count[RTE_MALLOC_CACHE_NUM_CLASSES];
+	/** Bytes held in lcore caches, accounted as allocated on the heap */
+	size_t cache_sz_bytes;
 };
 
 /**
@@ -291,6 +306,35 @@ int
 rte_malloc_get_socket_stats(int socket,
 		struct rte_malloc_socket_stats *socket_stats);
 
+/**
+ * Release the unused memory of a heap.
+ *
+ * The heap grows by reserving memzones, which are kept when the memory
+ * allocated from them is freed. This function frees the memzones of the
+ * heap of the given socket that are entirely free, so that their memory
+ * can be used again by other memzones. Blocks held in lcore caches are
+ * still allocated, see rte_malloc_cache_flush().
+ *
+ * @param socket
+ *   The socket of the heap.
+ * @return
+ *   The number of bytes released, 0 if none or if socket is invalid.
+ */
+size_t
+rte_malloc_heap_trim(int socket);
+
+/**
+ * Return the blocks held in the cache of the calling lcore to the heap.
+ *
+ * Small blocks freed by an lcore are kept in a per-lcore cache, per size
+ * class, so that they can be allocated again by this lcore without
+ * taking the heap lock. Flushing the cache makes this memory available to
+ * other lcores again and allows it to be merged with neighbouring free
+ * blocks. It does nothing when called from a non-EAL thread.
+ */
+void
+rte_malloc_cache_flush(void);
+
 /**
  * Dump statistics.
  *
@@ -187,6 +187,30 @@ const char *rte_get_rx_ol_flag_name(uint64_t mask);
  */
 const char *rte_get_tx_ol_flag_name(uint64_t mask);
 
+/**
+ * Function called to free an external buffer when the last mbuf attached
+ * to it is freed or detached.
+ *
+ * @param addr
+ *   The address of the external buffer, as given to
+ *   rte_pktmbuf_attach_extbuf().
+ * @param opaque
+ *   The opaque argument stored in the shared info of the buffer.
+ */
+typedef void (*rte_mbuf_extbuf_free_callback_t)(void *addr, void *opaque);
+
+/**
+ * Shared data of an external buffer attached to one or more mbufs.
+ *
+ * It is owned by the application and must stay valid until the free
+ * callback is invoked. It may be stored inside the external buffer itself.
+ */
+struct rte_mbuf_ext_shared_info {
+	rte_mbuf_extbuf_free_callback_t free_cb; /**< Free callback. */
+	void *fcb_opaque;                        /**< Free callback argument. */
+	rte_atomic16_t refcnt_atomic;            /**< Number of attached mbufs. */
+};
+
 /* define a set of marker types that can be used to refer to set points in the
  * mbuf */
 typedef void    *MARKER[0];   /**< generic marker for a point in a structure */
@@ -289,6 +313,9 @@ struct rte_mbuf {
 			/* uint64_t unused:8; */
 		};
 	};
+
+	/** Shared info of the attached external buffer, NULL if none. */
+	struct rte_mbuf_ext_shared_info *shinfo;
 } __rte_cache_aligned;
 
 /**
@@ -302,10 +329,17 @@ struct rte_mbuf {
  */
 #define RTE_MBUF_TO_BADDR(mb)       (((struct rte_mbuf *)(mb)) + 1)
 
+/**
+ * Returns TRUE if given mbuf has an external buffer attached, or FALSE
+ * otherwise.
+ */
+#define RTE_MBUF_HAS_EXTBUF(mb) ((mb)->shinfo != NULL)
+
 /**
  * Returns TRUE if given mbuf is indirect, or FALSE otherwise.
  */
-#define RTE_MBUF_INDIRECT(mb)   (RTE_MBUF_FROM_BADDR((mb)->buf_addr) != (mb))
+#define RTE_MBUF_INDIRECT(mb)   (!RTE_MBUF_HAS_EXTBUF(mb) && \
+	RTE_MBUF_FROM_BADDR((mb)->buf_addr) != (mb))
 
 /**
  * Returns TRUE if given mbuf is direct, or FALSE otherwise.
@@ -673,14 +707,71 @@ static inline struct rte_mbuf *rte_pktmbuf_alloc(struct rte_mempool *mp)
 	return (m);
 }
 
+/**
+ * @internal Initialize an mbuf just taken from its mempool, as
+ * rte_pktmbuf_alloc() does.
+ */
+static inline void __attribute__((always_inline))
+__rte_pktmbuf_init_alloc(struct rte_mbuf *m)
+{
+#ifdef RTE_MBUF_REFCNT
+	RTE_MBUF_ASSERT(rte_mbuf_refcnt_read(m) == 0);
+	rte_mbuf_refcnt_set(m, 1);
+#endif /* RTE_MBUF_REFCNT */
+	rte_pktmbuf_reset(m);
+}
+
+/**
+ * Allocate a bulk of mbufs from a mempool.
+ *
+ * All the mbufs are taken from the mempool with one call to
+ * rte_mempool_get_bulk(), then initialized as by rte_pktmbuf_alloc().
+ * Either all mbufs are allocated, or none.
+ *
+ * @param mp
+ *   The mempool from which the mbufs are allocated.
+ * @param mbufs
+ *   Array of pointers to mbufs, filled on success.
+ * @param count
+ *   The number of mbufs to allocate.
+ * @return
+ *   - 0: Success.
+ *   - -ENOENT: Not enough mbufs in the mempool; no mbuf is allocated.
+ */
+static inline int rte_pktmbuf_alloc_bulk(struct rte_mempool *mp,
+	 struct rte_mbuf **mbufs, unsigned count)
+{
+	unsigned idx = 0;
+	int rc;
+
+	rc = rte_mempool_get_bulk(mp, (void **)mbufs, count);
+	if (unlikely(rc != 0))
+		return rc;
+
+	/* the mbufs were just taken together, initialize them four by four */
+	for (; idx + 4 <= count; idx += 4) {
+		__rte_pktmbuf_init_alloc(mbufs[idx]);
+		__rte_pktmbuf_init_alloc(mbufs[idx + 1]);
+		__rte_pktmbuf_init_alloc(mbufs[idx + 2]);
+		__rte_pktmbuf_init_alloc(mbufs[idx + 3]);
+	}
+	for (; idx < count; idx++)
+		__rte_pktmbuf_init_alloc(mbufs[idx]);
+
+	return 0;
+}
+
 #ifdef RTE_MBUF_REFCNT
 
 /**
  * Attach packet mbuf to another packet mbuf.
  * After attachment we refer the mbuf we attached as 'indirect',
  * while mbuf we attached to as 'direct'.
+ * If md has an external buffer attached, mi is attached to the same
+ * external buffer instead, and takes a reference on its shared info.
  * Right now, not supported:
- *  - attachment to indirect mbuf (e.g. - md  has to be direct).
+ *  - attachment to indirect mbuf (e.g. - md  has to be direct or have an
+ *    external buffer).
  *  - attachment for already indirect mbuf (e.g. - mi has to be direct).
  *  - mbuf we trying to attach (mi) is used by someone else
  *    e.g. it's reference counter is greater then 1.
@@ -693,11 +784,15 @@ static inline struct rte_mbuf *rte_pktmbuf_alloc(struct rte_mempool *mp)
 
 static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *md)
 {
-	RTE_MBUF_ASSERT(RTE_MBUF_DIRECT(md) &&
+	RTE_MBUF_ASSERT((RTE_MBUF_DIRECT(md) || RTE_MBUF_HAS_EXTBUF(md)) &&
 	    RTE_MBUF_DIRECT(mi) &&
 	    rte_mbuf_refcnt_read(mi) == 1);
 
-	rte_mbuf_refcnt_update(md, 1);
+	if (unlikely(RTE_MBUF_HAS_EXTBUF(md))) {
+		rte_atomic16_add(&md->shinfo->refcnt_atomic, 1);
+		mi->shinfo = md->shinfo;
+	} else
+		rte_mbuf_refcnt_update(md, 1);
 	mi->buf_physaddr = md->buf_physaddr;
 	mi->buf_addr = md->buf_addr;
 	mi->buf_len = md->buf_len;
@@ -720,12 +815,88 @@ static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *md)
 	__rte_mbuf_sanity_check(md, 0);
 }
 
+/**
+ * Initialize the shared info of an external buffer.
+ *
+ * The reference counter is set to zero: it is incremented by each mbuf
+ * attached to the buffer, and the free callback is invoked when the last
+ * of them is freed or detached.
+ *
+ * @param shinfo
+ *   The shared info to initialize.
+ * @param free_cb
+ *   The function called to free the external buffer.
+ * @param fcb_opaque
+ *   The argument given to free_cb.
+ */
+static inline void
+rte_pktmbuf_ext_shinfo_init(struct rte_mbuf_ext_shared_info *shinfo,
+	rte_mbuf_extbuf_free_callback_t free_cb, void *fcb_opaque)
+{
+	shinfo->free_cb = free_cb;
+	shinfo->fcb_opaque = fcb_opaque;
+	rte_atomic16_set(&shinfo->refcnt_atomic, 0);
+}
+
+/**
+ * Attach an external buffer to a packet mbuf.
+ *
+ * The mbuf data then points to application memory (for instance a
+ * hugepage backed arena or a guest buffer) instead of its own buffer, so
+ * it can be transmitted without copying the payload. The mbuf takes a
+ * reference on the shared info, which is released when the mbuf is freed
+ * or detached; the free callback is invoked once the last mbuf attached
+ * to the buffer releases it. The data offset and length are reset to 0,
+ * the caller sets them to describe the payload. Attaching more mbufs to
+ * the same buffer can be done with this function or with
+ * rte_pktmbuf_attach() / rte_pktmbuf_clone().
+ *
+ * Right now, not supported:
+ *  - attachment for an indirect or already attached mbuf (e.g. - m has to
+ *    be direct).
+ *  - mbuf we trying to attach is used by someone else
+ *    e.g. it's reference counter is greater then 1.
+ *
+ * @param m
+ *   The packet mbuf.
+ * @param buf_addr
+ *   The virtual address of the external buffer.
+ * @param buf_physaddr
+ *   The physical address of the external buffer.
+ * @param buf_len
+ *   The length of the external buffer.
+ * @param shinfo
+ *   The shared info of the external buffer, initialized with
+ *   rte_pktmbuf_ext_shinfo_init().
+ */
+static inline void
+rte_pktmbuf_attach_extbuf(struct rte_mbuf *m, void *buf_addr,
+	phys_addr_t buf_physaddr, uint16_t buf_len,
+	struct rte_mbuf_ext_shared_info *shinfo)
+{
+	RTE_MBUF_ASSERT(RTE_MBUF_DIRECT(m) &&
+	    rte_mbuf_refcnt_read(m) == 1);
+
+	rte_atomic16_add(&shinfo->refcnt_atomic, 1);
+	m->shinfo = shinfo;
+
+	m->buf_addr = buf_addr;
+	m->buf_physaddr = buf_physaddr;
+	m->buf_len = buf_len;
+
+	m->data_off = 0;
+	m->data_len = 0;
+}
+
 /**
  * Detach an indirect packet mbuf -
  *  - restore original mbuf address and length values.
  *  - reset pktmbuf data and data_len to their default values.
  *  All other fields of the given packet mbuf will be left intact.
  *
+ * If an external buffer is attached, its reference is released and the
+ * free callback is invoked if the mbuf was the last one attached to it.
+ *
  * @param m
  *   The indirect attached packet mbuf.
  */
@@ -735,6 +906,14 @@ static inline void rte_pktmbuf_detach(struct rte_mbuf *m)
 	const struct rte_mempool *mp = m->pool;
 	void *buf = RTE_MBUF_TO_BADDR(m);
 	uint32_t buf_len = mp->elt_size - sizeof(*m);
+	struct rte_mbuf_ext_shared_info *shinfo = m->shinfo;
+
+	if (unlikely(shinfo != NULL)) {
+		m->shinfo = NULL;
+		if (rte_atomic16_add_return(&shinfo->refcnt_atomic, -1) == 0)
+			shinfo->free_cb(m->buf_addr, shinfo->fcb_opaque);
+	}
+
 	m->buf_physaddr = rte_mempool_virt2phy(mp, m) + sizeof (*m);
 
 	m->buf_addr = buf;
@@ -764,8 +943,11 @@ __rte_pktmbuf_prefree_seg(struct rte_mbuf *m)
 		/* if this is an indirect mbuf, then
 		 *  - detach mbuf
 		 *  - free attached mbuf segment
+		 * if an external buffer is attached, detaching releases it
 		 */
-		if (unlikely (md != m)) {
+		if (unlikely (RTE_MBUF_HAS_EXTBUF(m)))
+			rte_pktmbuf_detach(m);
+		else if (unlikely (md != m)) {
 			rte_pktmbuf_detach(m);
 			if (rte_mbuf_refcnt_update(md, -1) == 0)
 				__rte_mbuf_raw_free(md);
@@ -818,6 +1000,62 @@ static inline void rte_pktmbuf_free(struct rte_mbuf *m)
 	}
 }
 
+/** Maximum number of segments put back in a mempool at once on bulk free. */
+#define RTE_PKTMBUF_FREE_BULK_SZ 64
+
+/**
+ * Free a bulk of packet mbufs back into their original mempools.
+ *
+ * Free the mbufs and all their segments, like rte_pktmbuf_free(). The
+ * segments that are released are gathered and put back in their mempool
+ * with one call to rte_mempool_put_bulk() for each run of segments
+ * coming from the same mempool, so it is most efficient when the mbufs
+ * come from the same pool.
+ *
+ * @param mbufs
+ *   Array of pointers to the packet mbufs to be freed. NULL pointers are
+ *   skipped.
+ * @param count
+ *   The number of mbufs in the array.
+ */
+static inline void rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs,
+	unsigned count)
+{
+	void *pending[RTE_PKTMBUF_FREE_BULK_SZ];
+	struct rte_mempool *pending_mp = NULL;
+	struct rte_mbuf *m, *m_next;
+	unsigned idx, nb_pending = 0;
+
+	for (idx = 0; idx < count; idx++) {
+		m = mbufs[idx];
+		if (unlikely(m == NULL))
+			continue;
+
+		__rte_mbuf_sanity_check(m, 1);
+
+		do {
+			m_next = m->next;
+			m = __rte_pktmbuf_prefree_seg(m);
+			if (likely(m != NULL)) {
+				m->next = NULL;
+				if (unlikely(m->pool != pending_mp ||
+				    nb_pending == RTE_PKTMBUF_FREE_BULK_SZ)) {
+					if (nb_pending != 0)
+						rte_mempool_put_bulk(pending_mp,
+							pending, nb_pending);
+					pending_mp = m->pool;
+					nb_pending = 0;
+				}
+				pending[nb_pending++] = m;
+			}
+			m = m_next;
+		} while (m != NULL);
+	}
+
+	if (nb_pending != 0)
+		rte_mempool_put_bulk(pending_mp, pending, nb_pending);
+}
+
 #ifdef RTE_MBUF_REFCNT
 
 /**
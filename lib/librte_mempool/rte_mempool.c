@@ -140,8 +140,8 @@ mempool_add_elem(struct rte_mempool *mp, void *obj, uint32_t obj_idx,
 	if (obj_init)
 		obj_init(mp, obj_init_arg, obj, obj_idx);
 
-	/* enqueue in ring */
-	rte_ring_sp_enqueue(mp->ring, obj);
+	/* enqueue in common pool */
+	__mempool_handler_put(mp, &obj, 1, 0);
 }
 
 uint32_t
@@ -387,6 +387,27 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
 #endif
 }
 
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+static void
+mempool_cache_init(struct rte_mempool_cache *cache, struct rte_mempool *mp,
+	uint32_t size)
+{
+	cache->mp = mp;
+	cache->size = size;
+	cache->flushthresh = (uint32_t)(size * CACHE_FLUSHTHRESH_MULTIPLIER);
+	cache->len = 0;
+}
+#endif
+
+/* get the default handler for the given mempool flags */
+static const char *
+mempool_default_handler(unsigned flags)
+{
+	if (flags & MEMPOOL_F_SP_PUT)
+		return (flags & MEMPOOL_F_SC_GET) ? "ring_sp_sc" : "ring_sp_mc";
+	return (flags & MEMPOOL_F_SC_GET) ? "ring_mp_sc" : "ring_mp_mc";
+}
+
 /*
  * Create the mempool over already allocated chunk of memory.
  * That external memory buffer can consists of physically disjoint pages.
@@ -394,27 +415,29 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
  * and allocate space for mempool and it's elements as one big chunk of
  * physically continuos memory.
  * */
-struct rte_mempool *
-rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
+static struct rte_mempool *
+mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 		unsigned cache_size, unsigned private_data_size,
 		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
 		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
 		int socket_id, unsigned flags, void *vaddr,
-		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift)
+		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift,
+		const char *handler)
 {
 	char mz_name[RTE_MEMZONE_NAMESIZE];
-	char rg_name[RTE_RING_NAMESIZE];
 	struct rte_mempool *mp = NULL;
 	struct rte_tailq_entry *te;
-	struct rte_ring *r;
 	const struct rte_memzone *mz;
 	size_t mempool_size;
 	int mz_flags = RTE_MEMZONE_1GB|RTE_MEMZONE_SIZE_HINT_ONLY;
-	int rg_flags = 0;
+	int handler_idx;
 	void *obj;
 	struct rte_mempool_objsz objsz;
 	void *startaddr;
 	int page_size = getpagesize();
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	unsigned lcore_id;
+#endif
 
 	/* compilation-time checks */
 	RTE_BUILD_BUG_ON((sizeof(struct rte_mempool) &
@@ -461,11 +484,15 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	if (flags & MEMPOOL_F_NO_CACHE_ALIGN)
 		flags |= MEMPOOL_F_NO_SPREAD;
 
-	/* ring flags */
-	if (flags & MEMPOOL_F_SP_PUT)
-		rg_flags |= RING_F_SP_ENQ;
-	if (flags & MEMPOOL_F_SC_GET)
-		rg_flags |= RING_F_SC_DEQ;
+	/* find the handler storing the objects */
+	if (handler == NULL)
+		handler = mempool_default_handler(flags);
+	handler_idx = rte_mempool_handler_lookup(handler);
+	if (handler_idx < 0) {
+		RTE_LOG(ERR, MEMPOOL, "Unknown mempool handler %s\n", handler);
+		rte_errno = EINVAL;
+		return NULL;
+	}
 
 	/* calculate mempool object sizes. */
 	if (!rte_mempool_calc_obj_size(elt_size, flags, &objsz)) {
@@ -475,15 +502,6 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 
 	rte_rwlock_write_lock(RTE_EAL_MEMPOOL_RWLOCK);
 
-	/* allocate the ring that will be used to store objects */
-	/* Ring functions will return appropriate errors if we are
-	 * running as a secondary process etc., so no checks made
-	 * in this function for that condition */
-	snprintf(rg_name, sizeof(rg_name), RTE_MEMPOOL_MZ_FORMAT, name);
-	r = rte_ring_create(rg_name, rte_align32pow2(n+1), socket_id, rg_flags);
-	if (r == NULL)
-		goto exit;
-
 	/*
 	 * reserve a memory zone for this mempool: private data is
 	 * cache-aligned
@@ -532,10 +550,7 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 
 	mz = rte_memzone_reserve(mz_name, mempool_size, socket_id, mz_flags);
 
-	/*
-	 * no more memory: in this case we loose previously reserved
-	 * space for the as we cannot free it
-	 */
+	/* no more memory */
 	if (mz == NULL) {
 		rte_free(te);
 		goto exit;
@@ -558,7 +573,6 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	memset(mp, 0, sizeof(*mp));
 	snprintf(mp->name, sizeof(mp->name), "%s", name);
 	mp->phys_addr = mz->phys_addr;
-	mp->ring = r;
 	mp->size = n;
 	mp->flags = flags;
 	mp->elt_size = objsz.elt_size;
@@ -568,6 +582,14 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	mp->cache_flushthresh = (uint32_t)
 		(cache_size * CACHE_FLUSHTHRESH_MULTIPLIER);
 	mp->private_data_size = private_data_size;
+	mp->socket_id = socket_id;
+	mp->handler_idx = handler_idx;
+	mp->mz = mz;
+
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		mempool_cache_init(&mp->local_cache[lcore_id], mp, cache_size);
+#endif
 
 	/* calculate address of the first element for continuous mempool. */
 	obj = (char *)mp + MEMPOOL_HEADER_SIZE(mp, pg_num) +
@@ -592,6 +614,17 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 
 	mp->elt_va_end = mp->elt_va_start;
 
+	/* allocate the handler data that will be used to store objects */
+	mp->pool = rte_mempool_handler_table.handler[handler_idx].alloc(mp);
+	if (mp->pool == NULL) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate %s handler data\n",
+			handler);
+		rte_memzone_free(mz);
+		rte_free(te);
+		mp = NULL;
+		goto exit;
+	}
+
 	/* call the initializer */
 	if (mp_init)
 		mp_init(mp, mp_init_arg);
@@ -608,13 +641,185 @@ exit:
 	return mp;
 }
 
+/* free a mempool */
+void
+rte_mempool_free(struct rte_mempool *mp)
+{
+	struct rte_mempool_list *mempool_list;
+	struct rte_tailq_entry *te;
+	rte_mempool_free_t handler_free;
+
+	if (mp == NULL)
+		return;
+
+	if ((mempool_list =
+	     RTE_TAILQ_LOOKUP_BY_IDX(RTE_TAILQ_MEMPOOL, rte_mempool_list)) == NULL) {
+		rte_errno = E_RTE_NO_TAILQ;
+		return;
+	}
+
+	rte_rwlock_write_lock(RTE_EAL_MEMPOOL_RWLOCK);
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* find out tailq entry */
+	TAILQ_FOREACH(te, mempool_list, next) {
+		if (te->data == (void *) mp)
+			break;
+	}
+
+	if (te == NULL) {
+		rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+		rte_rwlock_write_unlock(RTE_EAL_MEMPOOL_RWLOCK);
+		return;
+	}
+
+	TAILQ_REMOVE(mempool_list, te, next);
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	handler_free = rte_mempool_handler_table.handler[mp->handler_idx].free;
+	if (handler_free != NULL)
+		handler_free(mp->pool);
+
+	if (rte_memzone_free(mp->mz) != 0)
+		RTE_LOG(ERR, MEMPOOL, "Cannot free memory of mempool %s\n",
+			mp->name);
+
+	rte_rwlock_write_unlock(RTE_EAL_MEMPOOL_RWLOCK);
+
+	rte_free(te);
+}
+
+struct rte_mempool *
+rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, void *vaddr,
+		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift)
+{
+	return mempool_xmem_create(name, n, elt_size,
+		cache_size, private_data_size,
+		mp_init, mp_init_arg,
+		obj_init, obj_init_arg,
+		socket_id, flags,
+		vaddr, paddr, pg_num, pg_shift, NULL);
+}
+
+/* create the mempool with the given handler */
+struct rte_mempool *
+rte_mempool_create_with_handler(const char *name, unsigned n,
+		unsigned elt_size, unsigned cache_size,
+		unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, const char *handler)
+{
+#ifdef RTE_LIBRTE_XEN_DOM0
+	RTE_SET_USED(name);
+	RTE_SET_USED(n);
+	RTE_SET_USED(elt_size);
+	RTE_SET_USED(cache_size);
+	RTE_SET_USED(private_data_size);
+	RTE_SET_USED(mp_init);
+	RTE_SET_USED(mp_init_arg);
+	RTE_SET_USED(obj_init);
+	RTE_SET_USED(obj_init_arg);
+	RTE_SET_USED(socket_id);
+	RTE_SET_USED(flags);
+	RTE_SET_USED(handler);
+	rte_errno = ENOTSUP;
+	return NULL;
+#else
+	if (handler == NULL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	return mempool_xmem_create(name, n, elt_size,
+		cache_size, private_data_size,
+		mp_init, mp_init_arg,
+		obj_init, obj_init_arg,
+		socket_id, flags,
+		NULL, NULL, MEMPOOL_PG_NUM_DEFAULT, MEMPOOL_PG_SHIFT_MAX,
+		handler);
+#endif
+}
+
+/* create a mempool cache owned by the user */
+struct rte_mempool_cache *
+rte_mempool_cache_create(struct rte_mempool *mp, uint32_t size,
+	int socket_id)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	struct rte_mempool_cache *cache;
+
+	if (mp == NULL || size == 0 || size > RTE_MEMPOOL_CACHE_MAX_SIZE) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	cache = rte_zmalloc_socket("MEMPOOL_CACHE", sizeof(*cache),
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (cache == NULL) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate mempool cache\n");
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	mempool_cache_init(cache, mp, size);
+	return cache;
+#else
+	RTE_SET_USED(mp);
+	RTE_SET_USED(size);
+	RTE_SET_USED(socket_id);
+	rte_errno = EINVAL;
+	return NULL;
+#endif
+}
+
+/* return all objects of a mempool cache to the common pool */
+void
+rte_mempool_cache_flush(struct rte_mempool_cache *cache)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	if (cache->len == 0)
+		return;
+
+	__mempool_handler_put(cache->mp, cache->objs, cache->len,
+		!(cache->mp->flags & MEMPOOL_F_SP_PUT));
+	cache->len = 0;
+#else
+	RTE_SET_USED(cache);
+#endif
+}
+
+/* flush and free a mempool cache owned by the user */
+void
+rte_mempool_cache_free(struct rte_mempool_cache *cache)
+{
+	if (cache == NULL)
+		return;
+
+	rte_mempool_cache_flush(cache);
+	rte_free(cache);
+}
+
+/* Return the number of entries in the common pool */
+static unsigned
+mempool_handler_count(const struct rte_mempool *mp)
+{
+	return rte_mempool_handler_table.handler[mp->handler_idx].get_count(
+		mp->pool);
+}
+
 /* Return the number of entries in the mempool */
 unsigned
 rte_mempool_count(const struct rte_mempool *mp)
 {
 	unsigned count;
 
-	count = rte_ring_count(mp->ring);
+	count = mempool_handler_count(mp);
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 	{
@@ -770,7 +975,9 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 
 	fprintf(f, "mempool <%s>@%p\n", mp->name, mp);
 	fprintf(f, "  flags=%x\n", mp->flags);
-	fprintf(f, "  ring=<%s>@%p\n", mp->ring->name, mp->ring);
+	fprintf(f, "  handler=<%s>@%p\n",
+		rte_mempool_handler_table.handler[mp->handler_idx].name,
+		mp->pool);
 	fprintf(f, "  phys_addr=0x%" PRIx64 "\n", mp->phys_addr);
 	fprintf(f, "  size=%"PRIu32"\n", mp->size);
 	fprintf(f, "  header_size=%"PRIu32"\n", mp->header_size);
@@ -793,7 +1000,7 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 			mp->size);
 
 	cache_count = rte_mempool_dump_cache(f, mp);
-	common_count = rte_ring_count(mp->ring);
+	common_count = mempool_handler_count(mp);
 	if ((cache_count + common_count) > mp->size)
 		common_count = mp->size - cache_count;
 	fprintf(f, "  common_pool_count=%u\n", common_count);
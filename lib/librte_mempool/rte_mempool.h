@@ -57,6 +57,9 @@
  * example, in linuxapp environment, a thread that is not created by
  * the EAL must not use mempools. This is due to the per-lcore cache
  * that won't work as rte_lcore_id() will not return a correct value.
+ * Such a thread can instead create its own cache with
+ * rte_mempool_cache_create() and pass it to rte_mempool_generic_get()
+ * and rte_mempool_generic_put().
  */
 
 #include <stdio.h>
@@ -71,6 +74,7 @@
 #include <rte_lcore.h>
 #include <rte_memory.h>
 #include <rte_branch_prediction.h>
+#include <rte_spinlock.h>
 #include <rte_ring.h>
 
 #ifdef __cplusplus
@@ -97,9 +101,14 @@ struct rte_mempool_debug_stats {
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 /**
- * A structure that stores a per-core object cache.
+ * A structure that stores an object cache: either the per-lcore default
+ * cache of a mempool, or a cache created with rte_mempool_cache_create()
+ * and owned by the user.
  */
 struct rte_mempool_cache {
+	struct rte_mempool *mp; /**< Mempool the cache belongs to. */
+	uint32_t size;        /**< Size of the cache */
+	uint32_t flushthresh; /**< Threshold before we flush excess elements */
 	unsigned len; /**< Cache len */
 	/*
 	 * Cache is allocated to this size to allow it to overflow in certain
@@ -144,7 +153,10 @@ struct rte_mempool_objsz {
  */
 struct rte_mempool {
 	char name[RTE_MEMPOOL_NAMESIZE]; /**< Name of mempool. */
-	struct rte_ring *ring;           /**< Ring to store objects. */
+	union {
+		void *pool;              /**< Handler private data. */
+		struct rte_ring *ring;   /**< Ring to store objects. */
+	};
 	phys_addr_t phys_addr;           /**< Phys. addr. of mempool struct. */
 	int flags;                       /**< Flags of the mempool. */
 	uint32_t size;                   /**< Size of the mempool. */
@@ -157,6 +169,9 @@ struct rte_mempool {
 	uint32_t trailer_size;           /**< Size of trailer (after elt). */
 
 	unsigned private_data_size;      /**< Size of private data. */
+	int socket_id;                   /**< Socket of the mempool memory. */
+	uint32_t handler_idx;            /**< Index of the mempool handler. */
+	const struct rte_memzone *mz;    /**< Memzone of the mempool. */
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 	/** Per-lcore local cache. */
@@ -188,6 +203,140 @@ struct rte_mempool {
 #define MEMPOOL_F_SP_PUT         0x0004 /**< Default put is "single-producer".*/
 #define MEMPOOL_F_SC_GET         0x0008 /**< Default get is "single-consumer".*/
 
+#define RTE_MEMPOOL_HANDLER_NAMESIZE 32 /**< Max length of a handler name. */
+#define RTE_MEMPOOL_MAX_HANDLER_IDX  16 /**< Max number of handlers. */
+
+/**
+ * Allocate the private data of a mempool handler, that will store the
+ * free objects of the mempool. The name, size, flags and socket_id fields
+ * of the mempool are set when this is called.
+ *
+ * The private data is shared between processes, so it must be allocated
+ * in shared memory (rte_malloc, memzone).
+ *
+ * @return
+ *   A pointer to the handler private data, or NULL on error.
+ */
+typedef void *(*rte_mempool_alloc_t)(struct rte_mempool *mp);
+
+/** Put objects in the common pool. Return 0 on success, or -ENOBUFS. */
+typedef int (*rte_mempool_put_t)(void *p, void * const *obj_table,
+		unsigned n);
+
+/** Get objects from the common pool. Return 0 on success, or -ENOENT. */
+typedef int (*rte_mempool_get_t)(void *p, void **obj_table, unsigned n);
+
+/** Return the number of objects in the common pool. */
+typedef unsigned (*rte_mempool_get_count_t)(void *p);
+
+/**
+ * Free the private data of a mempool handler when the mempool is freed.
+ * Optional, nothing is done if it is NULL.
+ */
+typedef void (*rte_mempool_free_t)(void *p);
+
+/**
+ * A mempool handler: the operations used to store the free objects of a
+ * mempool outside of its caches.
+ *
+ * put and get are the default operations of the handler, which may be
+ * single-producer or single-consumer. When they are, mp_put and mc_get
+ * must be given for the multi-producers and multi-consumers safe entry
+ * points; otherwise they may be left NULL.
+ */
+struct rte_mempool_handler {
+	char name[RTE_MEMPOOL_HANDLER_NAMESIZE]; /**< Name of the handler. */
+	rte_mempool_alloc_t alloc;         /**< Allocate private data. */
+	rte_mempool_put_t put;             /**< Put objects in pool. */
+	rte_mempool_get_t get;             /**< Get objects from pool. */
+	rte_mempool_get_count_t get_count; /**< Count objects in pool. */
+	rte_mempool_free_t free;           /**< Free private data. */
+	rte_mempool_put_t mp_put;          /**< Multi-producers safe put. */
+	rte_mempool_get_t mc_get;          /**< Multi-consumers safe get. */
+} __rte_cache_aligned;
+
+/**
+ * The table of registered mempool handlers.
+ *
+ * A mempool stores the index of its handler, since function pointers are
+ * not valid across processes. Handlers are registered by constructors, so
+ * the indexes are the same in all processes running the same binary.
+ */
+struct rte_mempool_handler_table {
+	rte_spinlock_t sl;     /**< Protects registration. */
+	uint32_t num_handlers; /**< Number of registered handlers. */
+	/** Registered handlers. */
+	struct rte_mempool_handler handler[RTE_MEMPOOL_MAX_HANDLER_IDX];
+} __rte_cache_aligned;
+
+/** The table of all registered mempool handlers. */
+extern struct rte_mempool_handler_table rte_mempool_handler_table;
+
+/**
+ * Register a mempool handler.
+ *
+ * @param h
+ *   A pointer to the handler, copied in the handler table.
+ * @return
+ *   - >=0: The index of the handler.
+ *   - -EINVAL: A field of the handler is missing.
+ *   - -EEXIST: A handler with the same name is already registered.
+ *   - -ENOSPC: The handler table is full.
+ */
+int rte_mempool_handler_register(const struct rte_mempool_handler *h);
+
+/**
+ * Get the index of a registered mempool handler.
+ *
+ * @param name
+ *   The name of the handler.
+ * @return
+ *   The index of the handler, or -ENOENT if it is not registered.
+ */
+int rte_mempool_handler_lookup(const char *name);
+
+/**
+ * Register a mempool handler when the application starts.
+ */
+#define MEMPOOL_REGISTER_HANDLER(h)					\
+void mp_hdlr_init_##h(void);						\
+void __attribute__((constructor, used)) mp_hdlr_init_##h(void)		\
+{									\
+	rte_mempool_handler_register(&h);				\
+}
+
+/**
+ * @internal Put objects in the common pool through the mempool handler.
+ * If is_mp is set, the operation is multi-producers safe.
+ */
+static inline int __attribute__((always_inline))
+__mempool_handler_put(struct rte_mempool *mp, void * const *obj_table,
+		      unsigned n, int is_mp)
+{
+	const struct rte_mempool_handler *h =
+		&rte_mempool_handler_table.handler[mp->handler_idx];
+
+	if (is_mp && h->mp_put != NULL)
+		return h->mp_put(mp->pool, obj_table, n);
+	return h->put(mp->pool, obj_table, n);
+}
+
+/**
+ * @internal Get objects from the common pool through the mempool handler.
+ * If is_mc is set, the operation is multi-consumers safe.
+ */
+static inline int __attribute__((always_inline))
+__mempool_handler_get(struct rte_mempool *mp, void **obj_table, unsigned n,
+		      int is_mc)
+{
+	const struct rte_mempool_handler *h =
+		&rte_mempool_handler_table.handler[mp->handler_idx];
+
+	if (is_mc && h->mc_get != NULL)
+		return h->mc_get(mp->pool, obj_table, n);
+	return h->get(mp->pool, obj_table, n);
+}
+
 /**
  * @internal When debug is enabled, store some statistics.
  * @param mp
@@ -200,8 +349,10 @@ struct rte_mempool {
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
 #define __MEMPOOL_STAT_ADD(mp, name, n) do {			\
 		unsigned __lcore_id = rte_lcore_id();		\
-		mp->stats[__lcore_id].name##_objs += n;		\
-		mp->stats[__lcore_id].name##_bulk += 1;		\
+		if (__lcore_id < RTE_MAX_LCORE) {		\
+			mp->stats[__lcore_id].name##_objs += n;	\
+			mp->stats[__lcore_id].name##_bulk += 1;	\
+		}						\
 	} while(0)
 #else
 #define __MEMPOOL_STAT_ADD(mp, name, n) do {} while(0)
@@ -728,6 +879,50 @@ rte_dom0_mempool_create(const char *name, unsigned n, unsigned elt_size,
 		int socket_id, unsigned flags);
 #endif
 
+/**
+ * Create a new mempool named *name* in memory, with a given handler.
+ *
+ * This function is the same as rte_mempool_create(), except that the
+ * free objects of the pool are stored by the mempool handler *handler*
+ * instead of the ring selected by the MEMPOOL_F_SP_PUT and
+ * MEMPOOL_F_SC_GET flags. The built-in handlers are:
+ *   - "ring_mp_mc", "ring_sp_sc", "ring_mp_sc", "ring_sp_mc": a ring with
+ *     the given producer and consumer modes.
+ *   - "stack": a LIFO protected by a spinlock, which gives back the most
+ *     recently freed objects first, while they are likely still in the
+ *     CPU caches.
+ *
+ * @param handler
+ *   The name of a registered mempool handler.
+ * @return
+ *   The pointer to the new allocated mempool, on success. NULL on error
+ *   with rte_errno set appropriately. Possible rte_errno values include
+ *   the ones of rte_mempool_create(), and:
+ *    - EINVAL - the handler is not registered
+ *    - ENOTSUP - not supported with Xen Dom0
+ */
+struct rte_mempool *
+rte_mempool_create_with_handler(const char *name, unsigned n,
+		unsigned elt_size, unsigned cache_size,
+		unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, const char *handler);
+
+/**
+ * Free a mempool.
+ *
+ * The mempool is removed from the list of mempools, the private data of
+ * its handler is freed, and the memzone holding the mempool (and its
+ * objects unless they were given by the application) is released. The
+ * mempool must not be used by any lcore anymore, and none of its objects
+ * must be in use.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ */
+void rte_mempool_free(struct rte_mempool *mp);
+
 /**
  * Dump the status of the mempool to the console.
  *
@@ -738,6 +933,80 @@ rte_dom0_mempool_create(const char *name, unsigned n, unsigned elt_size,
  */
 void rte_mempool_dump(FILE *f, const struct rte_mempool *mp);
 
+/**
+ * Create a user-owned mempool cache.
+ *
+ * This can be used by threads that are not EAL lcores, or by lcores
+ * that need a cache size different from the one given at mempool
+ * creation, with rte_mempool_generic_get() and rte_mempool_generic_put().
+ *
+ * @param mp
+ *   A pointer to the mempool the cache will be used with.
+ * @param size
+ *   The size of the cache, lower or equal to RTE_MEMPOOL_CACHE_MAX_SIZE.
+ *   Up to 1.5 times this number of objects can be held in the cache
+ *   before it is flushed to the common pool.
+ * @param socket_id
+ *   The socket identifier where the cache memory is allocated, or
+ *   SOCKET_ID_ANY.
+ * @return
+ *   A pointer to the cache on success, or NULL on error with rte_errno
+ *   set appropriately. Possible rte_errno values include:
+ *    - EINVAL - size is 0 or too large
+ *    - ENOMEM - no appropriate memory area found
+ */
+struct rte_mempool_cache *
+rte_mempool_cache_create(struct rte_mempool *mp, uint32_t size,
+	int socket_id);
+
+/**
+ * Flush a mempool cache.
+ *
+ * Return all the objects held in the cache to the common pool of the
+ * mempool it belongs to.
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ */
+void rte_mempool_cache_flush(struct rte_mempool_cache *cache);
+
+/**
+ * Free a user-owned mempool cache.
+ *
+ * The objects held in the cache are first returned to the mempool.
+ *
+ * @param cache
+ *   A pointer to a cache created with rte_mempool_cache_create(), or
+ *   NULL.
+ */
+void rte_mempool_cache_free(struct rte_mempool_cache *cache);
+
+/**
+ * Get a pointer to the per-lcore default cache of a mempool.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The logical core id.
+ * @return
+ *   A pointer to the mempool cache, or NULL if the mempool has no cache
+ *   or if lcore_id is not an EAL lcore (e.g. LCORE_ID_ANY).
+ */
+static inline struct rte_mempool_cache * __attribute__((always_inline))
+rte_mempool_default_cache(struct rte_mempool *mp, unsigned lcore_id)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	if (mp->cache_size == 0 || lcore_id >= RTE_MAX_LCORE)
+		return NULL;
+
+	return &mp->local_cache[lcore_id];
+#else
+	RTE_SET_USED(mp);
+	RTE_SET_USED(lcore_id);
+	return NULL;
+#endif
+}
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -747,35 +1016,32 @@ void rte_mempool_dump(FILE *f, const struct rte_mempool *mp);
  * @param n
  *   The number of objects to store back in the mempool, must be strictly
  *   positive.
+ * @param cache
+ *   A pointer to a mempool cache structure. May be NULL if not needed.
  * @param is_mp
- *   Mono-producer (0) or multi-producers (1).
+ *   Mono-producer (0) or multi-producers (1) access to the common pool.
  */
 static inline void __attribute__((always_inline))
 __mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
-		    unsigned n, int is_mp)
+		    unsigned n, struct rte_mempool_cache *cache, int is_mp)
 {
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	struct rte_mempool_cache *cache;
 	uint32_t index;
 	void **cache_objs;
-	unsigned lcore_id = rte_lcore_id();
-	uint32_t cache_size = mp->cache_size;
-	uint32_t flushthresh = mp->cache_flushthresh;
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
 	/* increment stat now, adding in mempool always success */
 	__MEMPOOL_STAT_ADD(mp, put, n);
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	/* cache is not enabled or single producer */
-	if (unlikely(cache_size == 0 || is_mp == 0))
+	/* no cache provided */
+	if (unlikely(cache == NULL))
 		goto ring_enqueue;
 
 	/* Go straight to ring if put would overflow mem allocated for cache */
 	if (unlikely(n > RTE_MEMPOOL_CACHE_MAX_SIZE))
 		goto ring_enqueue;
 
-	cache = &mp->local_cache[lcore_id];
 	cache_objs = &cache->objs[cache->len];
 
 	/*
@@ -791,10 +1057,10 @@ __mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 
 	cache->len += n;
 
-	if (cache->len >= flushthresh) {
-		rte_ring_mp_enqueue_bulk(mp->ring, &cache->objs[cache_size],
-				cache->len - cache_size);
-		cache->len = cache_size;
+	if (cache->len >= cache->flushthresh) {
+		__mempool_handler_put(mp, &cache->objs[cache->size],
+				cache->len - cache->size, is_mp);
+		cache->len = cache->size;
 	}
 
 	return;
@@ -802,24 +1068,44 @@ __mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 ring_enqueue:
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
-	/* push remaining objects in ring */
+	/* push remaining objects in common pool */
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
-	if (is_mp) {
-		if (rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n) < 0)
-			rte_panic("cannot put objects in mempool\n");
-	}
-	else {
-		if (rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n) < 0)
-			rte_panic("cannot put objects in mempool\n");
-	}
+	if (__mempool_handler_put(mp, obj_table, n, is_mp) < 0)
+		rte_panic("cannot put objects in mempool\n");
 #else
-	if (is_mp)
-		rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n);
-	else
-		rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n);
+	__mempool_handler_put(mp, obj_table, n, is_mp);
 #endif
 }
 
+/**
+ * Put several objects back in the mempool, through a given cache.
+ *
+ * Any thread can use this function with a cache it owns, including a
+ * thread that is not an EAL lcore. A cache must not be used by two
+ * threads at the same time. The common pool is accessed as with
+ * rte_mempool_put_bulk(): multi-producers safe unless the mempool was
+ * created with MEMPOOL_F_SP_PUT.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the mempool from the obj_table.
+ * @param cache
+ *   A pointer to a mempool cache structure belonging to mp, as returned
+ *   by rte_mempool_cache_create() or rte_mempool_default_cache(). May be
+ *   NULL to put the objects directly in the common pool.
+ */
+static inline void __attribute__((always_inline))
+rte_mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
+			unsigned n, struct rte_mempool_cache *cache)
+{
+	__mempool_check_cookies(mp, obj_table, n, 0);
+	__mempool_put_bulk(mp, obj_table, n, cache,
+		!(mp->flags & MEMPOOL_F_SP_PUT));
+}
+
 
 /**
  * Put several objects back in the mempool (multi-producers safe).
@@ -836,7 +1122,8 @@ rte_mempool_mp_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 			unsigned n)
 {
 	__mempool_check_cookies(mp, obj_table, n, 0);
-	__mempool_put_bulk(mp, obj_table, n, 1);
+	__mempool_put_bulk(mp, obj_table, n,
+		rte_mempool_default_cache(mp, rte_lcore_id()), 1);
 }
 
 /**
@@ -854,7 +1141,7 @@ rte_mempool_sp_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 			unsigned n)
 {
 	__mempool_check_cookies(mp, obj_table, n, 0);
-	__mempool_put_bulk(mp, obj_table, n, 0);
+	__mempool_put_bulk(mp, obj_table, n, NULL, 0);
 }
 
 /**
@@ -875,8 +1162,10 @@ static inline void __attribute__((always_inline))
 rte_mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 		     unsigned n)
 {
-	__mempool_check_cookies(mp, obj_table, n, 0);
-	__mempool_put_bulk(mp, obj_table, n, !(mp->flags & MEMPOOL_F_SP_PUT));
+	if (mp->flags & MEMPOOL_F_SP_PUT)
+		rte_mempool_sp_put_bulk(mp, obj_table, n);
+	else
+		rte_mempool_mp_put_bulk(mp, obj_table, n);
 }
 
 /**
@@ -933,38 +1222,37 @@ rte_mempool_put(struct rte_mempool *mp, void *obj)
  *   A pointer to a table of void * pointers (objects).
  * @param n
  *   The number of objects to get, must be strictly positive.
+ * @param cache
+ *   A pointer to a mempool cache structure. May be NULL if not needed.
  * @param is_mc
- *   Mono-consumer (0) or multi-consumers (1).
+ *   Mono-consumer (0) or multi-consumers (1) access to the common pool.
  * @return
  *   - >=0: Success; number of objects supplied.
  *   - <0: Error; code of ring dequeue function.
  */
 static inline int __attribute__((always_inline))
 __mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
-		   unsigned n, int is_mc)
+		   unsigned n, struct rte_mempool_cache *cache, int is_mc)
 {
 	int ret;
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	struct rte_mempool_cache *cache;
 	uint32_t index, len;
 	void **cache_objs;
-	unsigned lcore_id = rte_lcore_id();
-	uint32_t cache_size = mp->cache_size;
 
-	/* cache is not enabled or single consumer */
-	if (unlikely(cache_size == 0 || is_mc == 0 || n >= cache_size))
+	/* no cache provided or cannot be satisfied from cache */
+	if (unlikely(cache == NULL || n >= cache->size))
 		goto ring_dequeue;
 
-	cache = &mp->local_cache[lcore_id];
 	cache_objs = cache->objs;
 
 	/* Can this be satisfied from the cache? */
 	if (cache->len < n) {
 		/* No. Backfill the cache first, and then fill from it */
-		uint32_t req = n + (cache_size - cache->len);
+		uint32_t req = n + (cache->size - cache->len);
 
 		/* How many do we require i.e. number to fill the cache + the request */
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, &cache->objs[cache->len], req);
+		ret = __mempool_handler_get(mp, &cache->objs[cache->len], req,
+				is_mc);
 		if (unlikely(ret < 0)) {
 			/*
 			 * In the offchance that we are buffer constrained,
@@ -991,11 +1279,8 @@ __mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
 ring_dequeue:
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
-	/* get remaining objects from ring */
-	if (is_mc)
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, obj_table, n);
-	else
-		ret = rte_ring_sc_dequeue_bulk(mp->ring, obj_table, n);
+	/* get remaining objects from common pool */
+	ret = __mempool_handler_get(mp, obj_table, n, is_mc);
 
 	if (ret < 0)
 		__MEMPOOL_STAT_ADD(mp, get_fail, n);
@@ -1005,6 +1290,46 @@ ring_dequeue:
 	return ret;
 }
 
+/**
+ * Get several objects from the mempool, through a given cache.
+ *
+ * Any thread can use this function with a cache it owns, including a
+ * thread that is not an EAL lcore. A cache must not be used by two
+ * threads at the same time.
+ *
+ * The common pool is accessed as with rte_mempool_get_bulk():
+ * multi-consumers safe unless the mempool was created with MEMPOOL_F_SC_GET.
+ *
+ * If a cache is given, objects will be retrieved first from it,
+ * subsequently from the common pool. Note that it can return -ENOENT when
+ * the cache and common pool are empty, even if other caches are full.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to get from the mempool to obj_table.
+ * @param cache
+ *   A pointer to a mempool cache structure belonging to mp, as returned
+ *   by rte_mempool_cache_create() or rte_mempool_default_cache(). May be
+ *   NULL to get the objects directly from the common pool.
+ * @return
+ *   - 0: Success; objects taken.
+ *   - -ENOENT: Not enough entries in the mempool; no object is retrieved.
+ */
+static inline int __attribute__((always_inline))
+rte_mempool_generic_get(struct rte_mempool *mp, void **obj_table,
+			unsigned n, struct rte_mempool_cache *cache)
+{
+	int ret;
+	ret = __mempool_get_bulk(mp, obj_table, n, cache,
+		!(mp->flags & MEMPOOL_F_SC_GET));
+	if (ret == 0)
+		__mempool_check_cookies(mp, obj_table, n, 1);
+	return ret;
+}
+
 /**
  * Get several objects from the mempool (multi-consumers safe).
  *
@@ -1027,7 +1352,8 @@ static inline int __attribute__((always_inline))
 rte_mempool_mc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 {
 	int ret;
-	ret = __mempool_get_bulk(mp, obj_table, n, 1);
+	ret = __mempool_get_bulk(mp, obj_table, n,
+		rte_mempool_default_cache(mp, rte_lcore_id()), 1);
 	if (ret == 0)
 		__mempool_check_cookies(mp, obj_table, n, 1);
 	return ret;
@@ -1056,7 +1382,7 @@ static inline int __attribute__((always_inline))
 rte_mempool_sc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 {
 	int ret;
-	ret = __mempool_get_bulk(mp, obj_table, n, 0);
+	ret = __mempool_get_bulk(mp, obj_table, n, NULL, 0);
 	if (ret == 0)
 		__mempool_check_cookies(mp, obj_table, n, 1);
 	return ret;
@@ -1087,12 +1413,9 @@ rte_mempool_sc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 static inline int __attribute__((always_inline))
 rte_mempool_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 {
-	int ret;
-	ret = __mempool_get_bulk(mp, obj_table, n,
-				 !(mp->flags & MEMPOOL_F_SC_GET));
-	if (ret == 0)
-		__mempool_check_cookies(mp, obj_table, n, 1);
-	return ret;
+	if (mp->flags & MEMPOOL_F_SC_GET)
+		return rte_mempool_sc_get_bulk(mp, obj_table, n);
+	return rte_mempool_mc_get_bulk(mp, obj_table, n);
 }
 
 /**
@@ -1170,7 +1493,7 @@ rte_mempool_get(struct rte_mempool *mp, void **obj_p)
  *
  * When cache is enabled, this function has to browse the length of
  * all lcores, so it should not be used in a data path, but only for
- * debug purposes.
+ * debug purposes. Objects held in user-owned caches are not counted.
  *
  * @param mp
  *   A pointer to the mempool structure.
@@ -0,0 +1,217 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_ring.h>
+#include <rte_spinlock.h>
+
+#include "rte_mempool.h"
+
+/* the table of all registered handlers */
+struct rte_mempool_handler_table rte_mempool_handler_table = {
+	.sl =  RTE_SPINLOCK_INITIALIZER,
+	.num_handlers = 0
+};
+
+/* add a new handler in the handler table */
+int
+rte_mempool_handler_register(const struct rte_mempool_handler *h)
+{
+	struct rte_mempool_handler_table *tbl = &rte_mempool_handler_table;
+	uint32_t i;
+	int idx;
+
+	if (h->alloc == NULL || h->put == NULL || h->get == NULL ||
+			h->get_count == NULL || h->name[0] == '\0') {
+		RTE_LOG(ERR, MEMPOOL, "Missing callback in mempool handler\n");
+		return -EINVAL;
+	}
+
+	rte_spinlock_lock(&tbl->sl);
+
+	for (i = 0; i < tbl->num_handlers; i++) {
+		if (strncmp(tbl->handler[i].name, h->name,
+				sizeof(tbl->handler[i].name)) == 0) {
+			rte_spinlock_unlock(&tbl->sl);
+			RTE_LOG(ERR, MEMPOOL,
+				"Mempool handler %s already registered\n",
+				h->name);
+			return -EEXIST;
+		}
+	}
+
+	if (tbl->num_handlers >= RTE_MEMPOOL_MAX_HANDLER_IDX) {
+		rte_spinlock_unlock(&tbl->sl);
+		RTE_LOG(ERR, MEMPOOL, "Maximum number of mempool handlers\n");
+		return -ENOSPC;
+	}
+
+	idx = tbl->num_handlers++;
+	tbl->handler[idx] = *h;
+	tbl->handler[idx].name[sizeof(tbl->handler[idx].name) - 1] = '\0';
+
+	rte_spinlock_unlock(&tbl->sl);
+
+	return idx;
+}
+
+/* get the index of a handler from its name */
+int
+rte_mempool_handler_lookup(const char *name)
+{
+	struct rte_mempool_handler_table *tbl = &rte_mempool_handler_table;
+	uint32_t i;
+
+	for (i = 0; i < tbl->num_handlers; i++) {
+		if (strncmp(tbl->handler[i].name, name,
+				sizeof(tbl->handler[i].name)) == 0)
+			return i;
+	}
+	return -ENOENT;
+}
+
+/*
+ * Ring handlers: the default ones, selected by the MEMPOOL_F_SP_PUT and
+ * MEMPOOL_F_SC_GET flags. The single-producer/consumer ones still provide
+ * the multi-producers/consumers operations, for rte_mempool_mp_put() and
+ * rte_mempool_mc_get().
+ */
+
+static int
+ring_mp_put(void *p, void * const *obj_table, unsigned n)
+{
+	return rte_ring_mp_enqueue_bulk(p, obj_table, n);
+}
+
+static int
+ring_sp_put(void *p, void * const *obj_table, unsigned n)
+{
+	return rte_ring_sp_enqueue_bulk(p, obj_table, n);
+}
+
+static int
+ring_mc_get(void *p, void **obj_table, unsigned n)
+{
+	return rte_ring_mc_dequeue_bulk(p, obj_table, n);
+}
+
+static int
+ring_sc_get(void *p, void **obj_table, unsigned n)
+{
+	return rte_ring_sc_dequeue_bulk(p, obj_table, n);
+}
+
+static unsigned
+ring_get_count(void *p)
+{
+	return rte_ring_count(p);
+}
+
+static void
+ring_free(void *p)
+{
+	rte_ring_free(p);
+}
+
+static void *
+ring_alloc(struct rte_mempool *mp)
+{
+	char rg_name[RTE_RING_NAMESIZE];
+	int rg_flags = 0;
+
+	if (mp->flags & MEMPOOL_F_SP_PUT)
+		rg_flags |= RING_F_SP_ENQ;
+	if (mp->flags & MEMPOOL_F_SC_GET)
+		rg_flags |= RING_F_SC_DEQ;
+
+	/* Ring functions will return appropriate errors if we are
+	 * running as a secondary process etc., so no checks made
+	 * in this function for that condition */
+	if (snprintf(rg_name, sizeof(rg_name), RTE_MEMPOOL_MZ_FORMAT,
+			mp->name) < 0)
+		return NULL;
+	return rte_ring_create(rg_name, rte_align32pow2(mp->size + 1),
+		mp->socket_id, rg_flags);
+}
+
+static struct rte_mempool_handler handler_ring_mp_mc = {
+	.name = "ring_mp_mc",
+	.alloc = ring_alloc,
+	.put = ring_mp_put,
+	.get = ring_mc_get,
+	.get_count = ring_get_count,
+	.free = ring_free,
+};
+
+static struct rte_mempool_handler handler_ring_sp_sc = {
+	.name = "ring_sp_sc",
+	.alloc = ring_alloc,
+	.put = ring_sp_put,
+	.get = ring_sc_get,
+	.get_count = ring_get_count,
+	.free = ring_free,
+	.mp_put = ring_mp_put,
+	.mc_get = ring_mc_get,
+};
+
+static struct rte_mempool_handler handler_ring_mp_sc = {
+	.name = "ring_mp_sc",
+	.alloc = ring_alloc,
+	.put = ring_mp_put,
+	.get = ring_sc_get,
+	.get_count = ring_get_count,
+	.free = ring_free,
+	.mc_get = ring_mc_get,
+};
+
+static struct rte_mempool_handler handler_ring_sp_mc = {
+	.name = "ring_sp_mc",
+	.alloc = ring_alloc,
+	.put = ring_sp_put,
+	.get = ring_mc_get,
+	.get_count = ring_get_count,
+	.free = ring_free,
+	.mp_put = ring_mp_put,
+};
+
+MEMPOOL_REGISTER_HANDLER(handler_ring_mp_mc);
+MEMPOOL_REGISTER_HANDLER(handler_ring_sp_sc);
+MEMPOOL_REGISTER_HANDLER(handler_ring_mp_sc);
+MEMPOOL_REGISTER_HANDLER(handler_ring_sp_mc);
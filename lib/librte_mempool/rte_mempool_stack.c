@@ -0,0 +1,138 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_malloc.h>
+#include <rte_spinlock.h>
+
+#include "rte_mempool.h"
+
+/*
+ * Stack handler: a LIFO of objects protected by a spinlock. The last
+ * objects freed are the first allocated, so they are likely to still be
+ * in the CPU caches.
+ */
+struct rte_mempool_stack {
+	rte_spinlock_t sl;
+	uint32_t size;
+	uint32_t len;
+	void *objs[0] __rte_cache_aligned;
+};
+
+static void *
+stack_alloc(struct rte_mempool *mp)
+{
+	struct rte_mempool_stack *s;
+
+	s = rte_zmalloc_socket("MEMPOOL_STACK",
+		sizeof(*s) + mp->size * sizeof(s->objs[0]),
+		RTE_CACHE_LINE_SIZE, mp->socket_id);
+	if (s == NULL)
+		return NULL;
+
+	rte_spinlock_init(&s->sl);
+	s->size = mp->size;
+	return s;
+}
+
+static int
+stack_put(void *p, void * const *obj_table, unsigned n)
+{
+	struct rte_mempool_stack *s = p;
+	void **cache_objs;
+	unsigned index;
+
+	rte_spinlock_lock(&s->sl);
+	if (unlikely(s->len + n > s->size)) {
+		rte_spinlock_unlock(&s->sl);
+		return -ENOBUFS;
+	}
+
+	cache_objs = &s->objs[s->len];
+	for (index = 0; index < n; index++)
+		cache_objs[index] = obj_table[index];
+
+	s->len += n;
+	rte_spinlock_unlock(&s->sl);
+	return 0;
+}
+
+static int
+stack_get(void *p, void **obj_table, unsigned n)
+{
+	struct rte_mempool_stack *s = p;
+	unsigned index, len;
+
+	rte_spinlock_lock(&s->sl);
+	if (unlikely(n > s->len)) {
+		rte_spinlock_unlock(&s->sl);
+		return -ENOENT;
+	}
+
+	/* most recently freed objects first */
+	for (index = 0, len = s->len - 1; index < n; index++, len--)
+		obj_table[index] = s->objs[len];
+
+	s->len -= n;
+	rte_spinlock_unlock(&s->sl);
+	return 0;
+}
+
+static unsigned
+stack_get_count(void *p)
+{
+	struct rte_mempool_stack *s = p;
+
+	return s->len;
+}
+
+static void
+stack_free(void *p)
+{
+	rte_free(p);
+}
+
+static struct rte_mempool_handler handler_stack = {
+	.name = "stack",
+	.alloc = stack_alloc,
+	.put = stack_put,
+	.get = stack_get,
+	.get_count = stack_get_count,
+	.free = stack_free,
+};
+
+MEMPOOL_REGISTER_HANDLER(handler_stack);
@@ -118,3 +118,106 @@ rte_meter_trtcm_config(struct rte_meter_trtcm *m, struct rte_meter_trtcm_params
 
 	return 0;
 }
+
+int
+rte_meter_srtcm_profile_config(struct rte_meter_srtcm_profile *p, struct rte_meter_srtcm_params *params)
+{
+	uint64_t hz;
+
+	/* Check input parameters */
+	if ((p == NULL) || (params == NULL)) {
+		return -1;
+	}
+
+	if ((params->cir == 0) || ((params->cbs == 0) && (params->ebs == 0))) {
+		return -2;
+	}
+
+	/* Compact meters keep their buckets on 32 bits */
+	if ((params->cbs > INT32_MAX) || (params->ebs > INT32_MAX)) {
+		return -3;
+	}
+
+	/* Initialize srTCM profile structure */
+	hz = rte_get_tsc_hz();
+	p->cbs = (uint32_t) params->cbs;
+	p->ebs = (uint32_t) params->ebs;
+	p->tb_max = RTE_MAX(p->cbs, p->ebs);
+	rte_meter_get_tb_params(hz, params->cir, &p->cir_period, &p->cir_bytes_per_period);
+
+	RTE_LOG(INFO, METER, "Low level srTCM profile config: \n"
+		"\tCIR period = %" PRIu64 ", CIR bytes per period = %" PRIu64 "\n",
+		p->cir_period, p->cir_bytes_per_period);
+
+	return 0;
+}
+
+int
+rte_meter_trtcm_profile_config(struct rte_meter_trtcm_profile *p, struct rte_meter_trtcm_params *params)
+{
+	uint64_t hz;
+
+	/* Check input parameters */
+	if ((p == NULL) || (params == NULL)) {
+		return -1;
+	}
+
+	if ((params->cir == 0) || (params->pir == 0) || (params->pir < params->cir) ||
+		(params->cbs == 0) || (params->pbs == 0)) {
+		return -2;
+	}
+
+	/* Compact meters keep their buckets on 32 bits */
+	if ((params->cbs > INT32_MAX) || (params->pbs > INT32_MAX)) {
+		return -3;
+	}
+
+	/* Initialize trTCM profile structure */
+	hz = rte_get_tsc_hz();
+	p->cbs = (uint32_t) params->cbs;
+	p->pbs = (uint32_t) params->pbs;
+	rte_meter_get_tb_params(hz, params->cir, &p->cir_period, &p->cir_bytes_per_period);
+	rte_meter_get_tb_params(hz, params->pir, &p->pir_period, &p->pir_bytes_per_period);
+
+	RTE_LOG(INFO, METER, "Low level trTCM profile config: \n"
+		"\tCIR period = %" PRIu64 ", CIR bytes per period = %" PRIu64 "\n"
+		"\tPIR period = %" PRIu64 ", PIR bytes per period = %" PRIu64 "\n",
+		p->cir_period, p->cir_bytes_per_period,
+		p->pir_period, p->pir_bytes_per_period);
+
+	return 0;
+}
+
+int
+rte_meter_srtcm_compact_config(struct rte_meter_srtcm_compact *m, const struct rte_meter_srtcm_profile *p)
+{
+	/* Check input parameters */
+	if ((m == NULL) || (p == NULL)) {
+		return -1;
+	}
+
+	/* Initialize compact srTCM run-time structure */
+	m->time = rte_get_tsc_cycles();
+	m->tc = p->cbs;
+	m->te = p->ebs;
+	m->profile = p;
+
+	return 0;
+}
+
+int
+rte_meter_trtcm_compact_config(struct rte_meter_trtcm_compact *m, const struct rte_meter_trtcm_profile *p)
+{
+	/* Check input parameters */
+	if ((m == NULL) || (p == NULL)) {
+		return -1;
+	}
+
+	/* Initialize compact trTCM run-time structure */
+	m->time_tc = m->time_tp = rte_get_tsc_cycles();
+	m->tc = p->cbs;
+	m->tp = p->pbs;
+	m->profile = p;
+
+	return 0;
+}
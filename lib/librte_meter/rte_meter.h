@@ -48,8 +48,15 @@ extern "C" {
  *
  ***/
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include <rte_prefetch.h>
+#include <rte_branch_prediction.h>
+#if defined(RTE_MACHINE_CPUFLAG_SSE4_1) || defined(RTE_MACHINE_CPUFLAG_SSE4_2)
+#include <rte_common_vect.h>
+#endif
+
 /*
  * Application Programmer's Interface (API)
  *
@@ -88,6 +95,20 @@ struct rte_meter_srtcm;
 /** Internal data structure storing the trTCM run-time context per metered traffic flow. */
 struct rte_meter_trtcm;
 
+/** Internal data structure storing the srTCM configuration shared by compact meters. */
+struct rte_meter_srtcm_profile;
+
+/** Internal data structure storing the trTCM configuration shared by compact meters. */
+struct rte_meter_trtcm_profile;
+
+/** Internal data structure storing the srTCM run-time context per metered traffic flow
+for flows sharing their configuration through a profile. */
+struct rte_meter_srtcm_compact;
+
+/** Internal data structure storing the trTCM run-time context per metered traffic flow
+for flows sharing their configuration through a profile. */
+struct rte_meter_trtcm_compact;
+
 /**
  * srTCM configuration per metered traffic flow
  *
@@ -116,6 +137,64 @@ int
 rte_meter_trtcm_config(struct rte_meter_trtcm *m,
 	struct rte_meter_trtcm_params *params);
 
+/**
+ * srTCM profile configuration, to be shared by multiple compact srTCM meters.
+ * CBS and EBS are limited to INT32_MAX bytes.
+ *
+ * @param p
+ *    Pointer to pre-allocated srTCM profile data structure
+ * @param params
+ *    User parameters shared by the srTCM metered traffic flows
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int
+rte_meter_srtcm_profile_config(struct rte_meter_srtcm_profile *p,
+	struct rte_meter_srtcm_params *params);
+
+/**
+ * trTCM profile configuration, to be shared by multiple compact trTCM meters.
+ * CBS and PBS are limited to INT32_MAX bytes.
+ *
+ * @param p
+ *    Pointer to pre-allocated trTCM profile data structure
+ * @param params
+ *    User parameters shared by the trTCM metered traffic flows
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int
+rte_meter_trtcm_profile_config(struct rte_meter_trtcm_profile *p,
+	struct rte_meter_trtcm_params *params);
+
+/**
+ * Compact srTCM configuration per metered traffic flow
+ *
+ * @param m
+ *    Pointer to pre-allocated compact srTCM data structure
+ * @param p
+ *    srTCM profile, which has to stay valid for the lifetime of the meter
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int
+rte_meter_srtcm_compact_config(struct rte_meter_srtcm_compact *m,
+	const struct rte_meter_srtcm_profile *p);
+
+/**
+ * Compact trTCM configuration per metered traffic flow
+ *
+ * @param m
+ *    Pointer to pre-allocated compact trTCM data structure
+ * @param p
+ *    trTCM profile, which has to stay valid for the lifetime of the meter
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int
+rte_meter_trtcm_compact_config(struct rte_meter_trtcm_compact *m,
+	const struct rte_meter_trtcm_profile *p);
+
 /**
  * srTCM color blind traffic metering
  *
@@ -190,6 +269,202 @@ rte_meter_trtcm_color_aware_check(struct rte_meter_trtcm *m,
 	uint32_t pkt_len,
 	enum rte_meter_color pkt_color);
 
+/**
+ * srTCM color blind traffic metering for a burst of packets. All the packets
+ * are metered against the same time stamp; several packets of the burst may
+ * belong to the same meter.
+ *
+ * @param m
+ *    Array of n_pkts handles to srTCM instances, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of n_pkts IP packet lengths (measured in bytes)
+ * @param color
+ *    Array of n_pkts entries where the color assigned to each packet is stored
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+static inline void
+rte_meter_srtcm_color_blind_check_bulk(struct rte_meter_srtcm **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
+/**
+ * srTCM color aware traffic metering for a burst of packets. All the packets
+ * are metered against the same time stamp; several packets of the burst may
+ * belong to the same meter.
+ *
+ * @param m
+ *    Array of n_pkts handles to srTCM instances, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of n_pkts IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array of n_pkts input packet colors
+ * @param color
+ *    Array of n_pkts entries where the color assigned to each packet is stored
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+static inline void
+rte_meter_srtcm_color_aware_check_bulk(struct rte_meter_srtcm **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
+/**
+ * Compact srTCM color blind traffic metering for a burst of packets. All the packets
+ * are metered against the same time stamp; several packets of the burst may
+ * belong to the same meter.
+ *
+ * @param m
+ *    Array of n_pkts handles to compact srTCM instances, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of n_pkts IP packet lengths (measured in bytes)
+ * @param color
+ *    Array of n_pkts entries where the color assigned to each packet is stored
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+static inline void
+rte_meter_srtcm_compact_color_blind_check_bulk(struct rte_meter_srtcm_compact **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
+/**
+ * Compact srTCM color aware traffic metering for a burst of packets. All the packets
+ * are metered against the same time stamp; several packets of the burst may
+ * belong to the same meter.
+ *
+ * @param m
+ *    Array of n_pkts handles to compact srTCM instances, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of n_pkts IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array of n_pkts input packet colors
+ * @param color
+ *    Array of n_pkts entries where the color assigned to each packet is stored
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+static inline void
+rte_meter_srtcm_compact_color_aware_check_bulk(struct rte_meter_srtcm_compact **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
+/**
+ * trTCM color blind traffic metering for a burst of packets. All the packets
+ * are metered against the same time stamp; several packets of the burst may
+ * belong to the same meter.
+ *
+ * @param m
+ *    Array of n_pkts handles to trTCM instances, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of n_pkts IP packet lengths (measured in bytes)
+ * @param color
+ *    Array of n_pkts entries where the color assigned to each packet is stored
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+static inline void
+rte_meter_trtcm_color_blind_check_bulk(struct rte_meter_trtcm **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
+/**
+ * trTCM color aware traffic metering for a burst of packets. All the packets
+ * are metered against the same time stamp; several packets of the burst may
+ * belong to the same meter.
+ *
+ * @param m
+ *    Array of n_pkts handles to trTCM instances, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of n_pkts IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array of n_pkts input packet colors
+ * @param color
+ *    Array of n_pkts entries where the color assigned to each packet is stored
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+static inline void
+rte_meter_trtcm_color_aware_check_bulk(struct rte_meter_trtcm **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
+/**
+ * Compact trTCM color blind traffic metering for a burst of packets. All the packets
+ * are metered against the same time stamp; several packets of the burst may
+ * belong to the same meter.
+ *
+ * @param m
+ *    Array of n_pkts handles to compact trTCM instances, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of n_pkts IP packet lengths (measured in bytes)
+ * @param color
+ *    Array of n_pkts entries where the color assigned to each packet is stored
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+static inline void
+rte_meter_trtcm_compact_color_blind_check_bulk(struct rte_meter_trtcm_compact **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
+/**
+ * Compact trTCM color aware traffic metering for a burst of packets. All the packets
+ * are metered against the same time stamp; several packets of the burst may
+ * belong to the same meter.
+ *
+ * @param m
+ *    Array of n_pkts handles to compact trTCM instances, one per packet
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Array of n_pkts IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array of n_pkts input packet colors
+ * @param color
+ *    Array of n_pkts entries where the color assigned to each packet is stored
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+static inline void
+rte_meter_trtcm_compact_color_aware_check_bulk(struct rte_meter_trtcm_compact **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
 /*
  * Inline implementation of run-time methods
  *
@@ -202,6 +477,7 @@ struct rte_meter_srtcm {
 	uint64_t te;   /* Number of bytes currently available in the excess (E) token bucket */
 	uint64_t cbs;  /* Upper limit for C token bucket */
 	uint64_t ebs;  /* Upper limit for E token bucket */
+	/* The bulk functions update tc/te against cbs/ebs as pairs, keep them adjacent */
 	uint64_t cir_period; /* Number of CPU cycles for one update of C and E token buckets */
 	uint64_t cir_bytes_per_period; /* Number of bytes to add to C and E token buckets on each update */
 };
@@ -214,12 +490,49 @@ struct rte_meter_trtcm {
 	uint64_t tp;      /* Number of bytes currently available in the peak (P) token bucket */
 	uint64_t cbs;     /* Upper limit for C token bucket */
 	uint64_t pbs;     /* Upper limit for P token bucket */
+	/* The bulk functions update tc/tp against cbs/pbs as pairs, keep them adjacent */
 	uint64_t cir_period; /* Number of CPU cycles for one update of C token bucket */
 	uint64_t cir_bytes_per_period; /* Number of bytes to add to C token bucket on each update */
 	uint64_t pir_period; /* Number of CPU cycles for one update of P token bucket */
 	uint64_t pir_bytes_per_period; /* Number of bytes to add to P token bucket on each update */
 };
 
+/* Internal data structure storing the srTCM configuration shared by compact meters. */
+struct rte_meter_srtcm_profile {
+	uint64_t cir_period; /* Number of CPU cycles for one update of C and E token buckets */
+	uint64_t cir_bytes_per_period; /* Number of bytes to add to C and E token buckets on each update */
+	uint32_t cbs;  /* Upper limit for C token bucket */
+	uint32_t ebs;  /* Upper limit for E token bucket */
+	uint32_t tb_max; /* Largest of the two token bucket upper limits */
+};
+
+/* Internal data structure storing the trTCM configuration shared by compact meters. */
+struct rte_meter_trtcm_profile {
+	uint64_t cir_period; /* Number of CPU cycles for one update of C token bucket */
+	uint64_t cir_bytes_per_period; /* Number of bytes to add to C token bucket on each update */
+	uint64_t pir_period; /* Number of CPU cycles for one update of P token bucket */
+	uint64_t pir_bytes_per_period; /* Number of bytes to add to P token bucket on each update */
+	uint32_t cbs;     /* Upper limit for C token bucket */
+	uint32_t pbs;     /* Upper limit for P token bucket */
+};
+
+/* Internal data structure storing the compact srTCM run-time context per metered traffic flow. */
+struct rte_meter_srtcm_compact {
+	uint64_t time; /* Time of latest update of C and E token buckets */
+	uint32_t tc;   /* Number of bytes currently available in the committed (C) token bucket */
+	uint32_t te;   /* Number of bytes currently available in the excess (E) token bucket */
+	const struct rte_meter_srtcm_profile *profile; /* Shared configuration */
+};
+
+/* Internal data structure storing the compact trTCM run-time context per metered traffic flow. */
+struct rte_meter_trtcm_compact {
+	uint64_t time_tc; /* Time of latest update of C token bucket */
+	uint64_t time_tp; /* Time of latest update of P token bucket */
+	uint32_t tc;      /* Number of bytes currently available in the committed (C) token bucket */
+	uint32_t tp;      /* Number of bytes currently available in the peak (P) token bucket */
+	const struct rte_meter_trtcm_profile *profile; /* Shared configuration */
+};
+
 static inline enum rte_meter_color
 rte_meter_srtcm_color_blind_check(struct rte_meter_srtcm *m,
 	uint64_t time,
@@ -380,6 +693,404 @@ rte_meter_trtcm_color_aware_check(struct rte_meter_trtcm *m,
 	return e_RTE_METER_GREEN;
 }
 
+
+/*
+ * Bulk metering
+ *
+ * The buckets of all the meters of a burst are first brought up to the burst
+ * time stamp, then the packets are colored in order. Updating a meter more than
+ * once for the same time stamp adds no credits, so a meter may appear several
+ * times in a burst.
+ */
+
+#ifndef RTE_METER_BULK_PREFETCH_OFFSET
+#define RTE_METER_BULK_PREFETCH_OFFSET 4
+#endif
+
+/* tokens[i] = min(tokens[i] + add_i, size[i]), i = 0 .. 1 */
+static inline void
+__rte_meter_tb_update_x2(uint64_t *tokens, const uint64_t *size,
+	uint64_t add0, uint64_t add1)
+{
+#ifdef RTE_MACHINE_CPUFLAG_SSE4_2
+	__m128i t = _mm_loadu_si128((const __m128i *) tokens);
+	__m128i s = _mm_loadu_si128((const __m128i *) size);
+
+	t = _mm_add_epi64(t, _mm_set_epi64x((int64_t) add1, (int64_t) add0));
+	t = _mm_blendv_epi8(t, s, _mm_cmpgt_epi64(t, s));
+	_mm_storeu_si128((__m128i *) tokens, t);
+#else
+	uint64_t t0 = tokens[0] + add0;
+	uint64_t t1 = tokens[1] + add1;
+
+	tokens[0] = (t0 > size[0]) ? size[0] : t0;
+	tokens[1] = (t1 > size[1]) ? size[1] : t1;
+#endif
+}
+
+/* Same as above for the 32-bit buckets of two compact meters at once */
+static inline void
+__rte_meter_tb_update_x4(uint32_t *tokens0, const uint32_t *size0,
+	uint32_t add0_0, uint32_t add0_1,
+	uint32_t *tokens1, const uint32_t *size1,
+	uint32_t add1_0, uint32_t add1_1)
+{
+#ifdef RTE_MACHINE_CPUFLAG_SSE4_1
+	__m128i t = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *) tokens0),
+		_mm_loadl_epi64((const __m128i *) tokens1));
+	__m128i s = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *) size0),
+		_mm_loadl_epi64((const __m128i *) size1));
+
+	t = _mm_add_epi32(t, _mm_set_epi32((int) add1_1, (int) add1_0, (int) add0_1, (int) add0_0));
+	t = _mm_min_epu32(t, s);
+	_mm_storel_epi64((__m128i *) tokens0, t);
+	_mm_storel_epi64((__m128i *) tokens1, _mm_unpackhi_epi64(t, t));
+#else
+	uint32_t t[4];
+
+	t[0] = tokens0[0] + add0_0;
+	t[1] = tokens0[1] + add0_1;
+	t[2] = tokens1[0] + add1_0;
+	t[3] = tokens1[1] + add1_1;
+
+	tokens0[0] = (t[0] > size0[0]) ? size0[0] : t[0];
+	tokens0[1] = (t[1] > size0[1]) ? size0[1] : t[1];
+	tokens1[0] = (t[2] > size1[0]) ? size1[0] : t[2];
+	tokens1[1] = (t[3] > size1[1]) ? size1[1] : t[3];
+#endif
+}
+
+static inline void
+__rte_meter_srtcm_update(struct rte_meter_srtcm *m, uint64_t time)
+{
+	uint64_t n_periods, n_bytes;
+
+	n_periods = (time - m->time) / m->cir_period;
+	n_bytes = n_periods * m->cir_bytes_per_period;
+	m->time += n_periods * m->cir_period;
+
+	__rte_meter_tb_update_x2(&m->tc, &m->cbs, n_bytes, n_bytes);
+}
+
+static inline void
+__rte_meter_trtcm_update(struct rte_meter_trtcm *m, uint64_t time)
+{
+	uint64_t n_periods_tc, n_periods_tp;
+
+	n_periods_tc = (time - m->time_tc) / m->cir_period;
+	n_periods_tp = (time - m->time_tp) / m->pir_period;
+	m->time_tc += n_periods_tc * m->cir_period;
+	m->time_tp += n_periods_tp * m->pir_period;
+
+	__rte_meter_tb_update_x2(&m->tc, &m->cbs,
+		n_periods_tc * m->cir_bytes_per_period,
+		n_periods_tp * m->pir_bytes_per_period);
+}
+
+/* Credits to add to the buckets of a compact srTCM, capped to fit in 32 bits */
+static inline uint32_t
+__rte_meter_srtcm_compact_advance(struct rte_meter_srtcm_compact *m, uint64_t time)
+{
+	const struct rte_meter_srtcm_profile *p = m->profile;
+	uint64_t n_periods, n_bytes;
+
+	n_periods = (time - m->time) / p->cir_period;
+	n_bytes = n_periods * p->cir_bytes_per_period;
+	m->time += n_periods * p->cir_period;
+
+	return (n_bytes > p->tb_max) ? p->tb_max : (uint32_t) n_bytes;
+}
+
+static inline void
+__rte_meter_trtcm_compact_advance(struct rte_meter_trtcm_compact *m, uint64_t time,
+	uint32_t *add_tc, uint32_t *add_tp)
+{
+	const struct rte_meter_trtcm_profile *p = m->profile;
+	uint64_t n_periods_tc, n_periods_tp, n_bytes_tc, n_bytes_tp;
+
+	n_periods_tc = (time - m->time_tc) / p->cir_period;
+	n_periods_tp = (time - m->time_tp) / p->pir_period;
+	m->time_tc += n_periods_tc * p->cir_period;
+	m->time_tp += n_periods_tp * p->pir_period;
+
+	n_bytes_tc = n_periods_tc * p->cir_bytes_per_period;
+	n_bytes_tp = n_periods_tp * p->pir_bytes_per_period;
+	*add_tc = (n_bytes_tc > p->cbs) ? p->cbs : (uint32_t) n_bytes_tc;
+	*add_tp = (n_bytes_tp > p->pbs) ? p->pbs : (uint32_t) n_bytes_tp;
+}
+
+static inline void
+__rte_meter_srtcm_compact_update_bulk(struct rte_meter_srtcm_compact **m,
+	uint64_t time,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; i + 1 < n_pkts; i += 2) {
+		struct rte_meter_srtcm_compact *m0 = m[i];
+		struct rte_meter_srtcm_compact *m1 = m[i + 1];
+		uint32_t add0, add1;
+
+		add0 = __rte_meter_srtcm_compact_advance(m0, time);
+		if (unlikely(m0 == m1)) {
+			__rte_meter_tb_update_x4(&m0->tc, &m0->profile->cbs, add0, add0,
+				&m0->tc, &m0->profile->cbs, add0, add0);
+			continue;
+		}
+		add1 = __rte_meter_srtcm_compact_advance(m1, time);
+
+		__rte_meter_tb_update_x4(&m0->tc, &m0->profile->cbs, add0, add0,
+			&m1->tc, &m1->profile->cbs, add1, add1);
+	}
+
+	if (i < n_pkts) {
+		struct rte_meter_srtcm_compact *m0 = m[i];
+		uint32_t add0 = __rte_meter_srtcm_compact_advance(m0, time);
+
+		__rte_meter_tb_update_x4(&m0->tc, &m0->profile->cbs, add0, add0,
+			&m0->tc, &m0->profile->cbs, add0, add0);
+	}
+}
+
+static inline void
+__rte_meter_trtcm_compact_update_bulk(struct rte_meter_trtcm_compact **m,
+	uint64_t time,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; i + 1 < n_pkts; i += 2) {
+		struct rte_meter_trtcm_compact *m0 = m[i];
+		struct rte_meter_trtcm_compact *m1 = m[i + 1];
+		uint32_t add0_tc, add0_tp, add1_tc, add1_tp;
+
+		__rte_meter_trtcm_compact_advance(m0, time, &add0_tc, &add0_tp);
+		if (unlikely(m0 == m1)) {
+			__rte_meter_tb_update_x4(&m0->tc, &m0->profile->cbs, add0_tc, add0_tp,
+				&m0->tc, &m0->profile->cbs, add0_tc, add0_tp);
+			continue;
+		}
+		__rte_meter_trtcm_compact_advance(m1, time, &add1_tc, &add1_tp);
+
+		__rte_meter_tb_update_x4(&m0->tc, &m0->profile->cbs, add0_tc, add0_tp,
+			&m1->tc, &m1->profile->cbs, add1_tc, add1_tp);
+	}
+
+	if (i < n_pkts) {
+		struct rte_meter_trtcm_compact *m0 = m[i];
+		uint32_t add0_tc, add0_tp;
+
+		__rte_meter_trtcm_compact_advance(m0, time, &add0_tc, &add0_tp);
+		__rte_meter_tb_update_x4(&m0->tc, &m0->profile->cbs, add0_tc, add0_tp,
+			&m0->tc, &m0->profile->cbs, add0_tc, add0_tp);
+	}
+}
+
+/* srTCM color logic once the buckets are up to date; color blind when pkt_color is NULL */
+#define __RTE_METER_SRTCM_COLOR(m, pkt_len, pkt_color, i, color)              \
+do {                                                                          \
+	enum rte_meter_color in = ((pkt_color) == NULL) ?                         \
+		e_RTE_METER_GREEN : (pkt_color)[i];                                   \
+	uint32_t len = (pkt_len)[i];                                              \
+                                                                              \
+	if ((in == e_RTE_METER_GREEN) && ((m)->tc >= len)) {                      \
+		(m)->tc -= len;                                                       \
+		(color)[i] = e_RTE_METER_GREEN;                                       \
+	} else if ((in != e_RTE_METER_RED) && ((m)->te >= len)) {                 \
+		(m)->te -= len;                                                       \
+		(color)[i] = e_RTE_METER_YELLOW;                                      \
+	} else {                                                                  \
+		(color)[i] = e_RTE_METER_RED;                                         \
+	}                                                                         \
+} while (0)
+
+/* trTCM color logic once the buckets are up to date; color blind when pkt_color is NULL */
+#define __RTE_METER_TRTCM_COLOR(m, pkt_len, pkt_color, i, color)              \
+do {                                                                          \
+	enum rte_meter_color in = ((pkt_color) == NULL) ?                         \
+		e_RTE_METER_GREEN : (pkt_color)[i];                                   \
+	uint32_t len = (pkt_len)[i];                                              \
+                                                                              \
+	if ((in == e_RTE_METER_RED) || ((m)->tp < len)) {                         \
+		(color)[i] = e_RTE_METER_RED;                                         \
+	} else if ((in == e_RTE_METER_YELLOW) || ((m)->tc < len)) {               \
+		(m)->tp -= len;                                                       \
+		(color)[i] = e_RTE_METER_YELLOW;                                      \
+	} else {                                                                  \
+		(m)->tc -= len;                                                       \
+		(m)->tp -= len;                                                       \
+		(color)[i] = e_RTE_METER_GREEN;                                       \
+	}                                                                         \
+} while (0)
+
+static inline void
+__rte_meter_srtcm_check_bulk(struct rte_meter_srtcm **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; (i < RTE_METER_BULK_PREFETCH_OFFSET) && (i < n_pkts); i ++)
+		rte_prefetch0(m[i]);
+
+	for (i = 0; i < n_pkts; i ++) {
+		if (i + RTE_METER_BULK_PREFETCH_OFFSET < n_pkts)
+			rte_prefetch0(m[i + RTE_METER_BULK_PREFETCH_OFFSET]);
+		__rte_meter_srtcm_update(m[i], time);
+	}
+
+	for (i = 0; i < n_pkts; i ++)
+		__RTE_METER_SRTCM_COLOR(m[i], pkt_len, pkt_color, i, color);
+}
+
+static inline void
+__rte_meter_trtcm_check_bulk(struct rte_meter_trtcm **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; (i < RTE_METER_BULK_PREFETCH_OFFSET) && (i < n_pkts); i ++)
+		rte_prefetch0(m[i]);
+
+	for (i = 0; i < n_pkts; i ++) {
+		if (i + RTE_METER_BULK_PREFETCH_OFFSET < n_pkts)
+			rte_prefetch0(m[i + RTE_METER_BULK_PREFETCH_OFFSET]);
+		__rte_meter_trtcm_update(m[i], time);
+	}
+
+	for (i = 0; i < n_pkts; i ++)
+		__RTE_METER_TRTCM_COLOR(m[i], pkt_len, pkt_color, i, color);
+}
+
+static inline void
+__rte_meter_srtcm_compact_check_bulk(struct rte_meter_srtcm_compact **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; i < n_pkts; i ++)
+		rte_prefetch0(m[i]);
+
+	__rte_meter_srtcm_compact_update_bulk(m, time, n_pkts);
+
+	for (i = 0; i < n_pkts; i ++)
+		__RTE_METER_SRTCM_COLOR(m[i], pkt_len, pkt_color, i, color);
+}
+
+static inline void
+__rte_meter_trtcm_compact_check_bulk(struct rte_meter_trtcm_compact **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	uint32_t i;
+
+	for (i = 0; i < n_pkts; i ++)
+		rte_prefetch0(m[i]);
+
+	__rte_meter_trtcm_compact_update_bulk(m, time, n_pkts);
+
+	for (i = 0; i < n_pkts; i ++)
+		__RTE_METER_TRTCM_COLOR(m[i], pkt_len, pkt_color, i, color);
+}
+
+static inline void
+rte_meter_srtcm_color_blind_check_bulk(struct rte_meter_srtcm **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	__rte_meter_srtcm_check_bulk(m, time, pkt_len, NULL, color, n_pkts);
+}
+
+static inline void
+rte_meter_srtcm_color_aware_check_bulk(struct rte_meter_srtcm **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	__rte_meter_srtcm_check_bulk(m, time, pkt_len, pkt_color, color, n_pkts);
+}
+
+static inline void
+rte_meter_srtcm_compact_color_blind_check_bulk(struct rte_meter_srtcm_compact **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	__rte_meter_srtcm_compact_check_bulk(m, time, pkt_len, NULL, color, n_pkts);
+}
+
+static inline void
+rte_meter_srtcm_compact_color_aware_check_bulk(struct rte_meter_srtcm_compact **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	__rte_meter_srtcm_compact_check_bulk(m, time, pkt_len, pkt_color, color, n_pkts);
+}
+
+static inline void
+rte_meter_trtcm_color_blind_check_bulk(struct rte_meter_trtcm **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	__rte_meter_trtcm_check_bulk(m, time, pkt_len, NULL, color, n_pkts);
+}
+
+static inline void
+rte_meter_trtcm_color_aware_check_bulk(struct rte_meter_trtcm **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	__rte_meter_trtcm_check_bulk(m, time, pkt_len, pkt_color, color, n_pkts);
+}
+
+static inline void
+rte_meter_trtcm_compact_color_blind_check_bulk(struct rte_meter_trtcm_compact **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	__rte_meter_trtcm_compact_check_bulk(m, time, pkt_len, NULL, color, n_pkts);
+}
+
+static inline void
+rte_meter_trtcm_compact_color_aware_check_bulk(struct rte_meter_trtcm_compact **m,
+	uint64_t time,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	__rte_meter_trtcm_compact_check_bulk(m, time, pkt_len, pkt_color, color, n_pkts);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -141,6 +141,7 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 	r->prod.watermark = count;
 	r->prod.sp_enqueue = !!(flags & RING_F_SP_ENQ);
 	r->cons.sc_dequeue = !!(flags & RING_F_SC_DEQ);
+	r->prod.rts = r->cons.rts = !!(flags & RING_F_RTS);
 	r->prod.size = r->cons.size = count;
 	r->prod.mask = r->cons.mask = count-1;
 	r->prod.head = r->cons.head = 0;
@@ -197,6 +198,7 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 		rte_ring_init(r, name, count, flags);
 
 		te->data = (void *) r;
+		r->memzone = mz;
 
 		TAILQ_INSERT_TAIL(ring_list, te, next);
 	} else {
@@ -209,6 +211,58 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 	return r;
 }
 
+/* free the ring */
+void
+rte_ring_free(struct rte_ring *r)
+{
+	struct rte_ring_list *ring_list = NULL;
+	struct rte_tailq_entry *te;
+
+	if (r == NULL)
+		return;
+
+	/*
+	 * Ring was not created with rte_ring_create,
+	 * therefore, there is no memzone to free.
+	 */
+	if (r->memzone == NULL) {
+		RTE_LOG(ERR, RING,
+			"Cannot free ring <%s> (not created with rte_ring_create())\n",
+			r->name);
+		return;
+	}
+
+	/* check that we have an initialised tail queue */
+	if ((ring_list =
+	     RTE_TAILQ_LOOKUP_BY_IDX(RTE_TAILQ_RING, rte_ring_list)) == NULL) {
+		rte_errno = E_RTE_NO_TAILQ;
+		return;
+	}
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* find out tailq entry */
+	TAILQ_FOREACH(te, ring_list, next) {
+		if (te->data == (void *) r)
+			break;
+	}
+
+	if (te == NULL) {
+		rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+		return;
+	}
+
+	TAILQ_REMOVE(ring_list, te, next);
+
+	if (rte_memzone_free(r->memzone) != 0)
+		RTE_LOG(ERR, RING, "Cannot free memory for ring <%s>\n",
+			r->name);
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	rte_free(te);
+}
+
 /*
  * change the high water mark. If *count* is 0, water marking is
  * disabled
@@ -140,6 +140,8 @@ struct rte_ring_debug_stats {
 struct rte_ring {
 	char name[RTE_RING_NAMESIZE];    /**< Name of the ring. */
 	int flags;                       /**< Flags supplied at creation. */
+	const struct rte_memzone *memzone;
+			/**< Memzone, if any, containing the rte_ring */
 
 	/** Ring producer status. */
 	struct prod {
@@ -147,8 +149,23 @@ struct rte_ring {
 		uint32_t sp_enqueue;     /**< True, if single producer. */
 		uint32_t size;           /**< Size of ring. */
 		uint32_t mask;           /**< Mask (size-1) of ring. */
-		volatile uint32_t head;  /**< Producer head. */
-		volatile uint32_t tail;  /**< Producer tail. */
+		uint32_t rts;            /**< True, if relaxed tail sync. */
+		union {
+			/** Head and its update counter, for RING_F_RTS. */
+			volatile uint64_t head_raw;
+			struct {
+				volatile uint32_t head;     /**< Producer head. */
+				volatile uint32_t head_cnt; /**< Head updates. */
+			};
+		};
+		union {
+			/** Tail and its update counter, for RING_F_RTS. */
+			volatile uint64_t tail_raw;
+			struct {
+				volatile uint32_t tail;     /**< Producer tail. */
+				volatile uint32_t tail_cnt; /**< Tail updates. */
+			};
+		};
 	} prod __rte_cache_aligned;
 
 	/** Ring consumer status. */
@@ -156,8 +173,23 @@ struct rte_ring {
 		uint32_t sc_dequeue;     /**< True, if single consumer. */
 		uint32_t size;           /**< Size of the ring. */
 		uint32_t mask;           /**< Mask (size-1) of ring. */
-		volatile uint32_t head;  /**< Consumer head. */
-		volatile uint32_t tail;  /**< Consumer tail. */
+		uint32_t rts;            /**< True, if relaxed tail sync. */
+		union {
+			/** Head and its update counter, for RING_F_RTS. */
+			volatile uint64_t head_raw;
+			struct {
+				volatile uint32_t head;     /**< Consumer head. */
+				volatile uint32_t head_cnt; /**< Head updates. */
+			};
+		};
+		union {
+			/** Tail and its update counter, for RING_F_RTS. */
+			volatile uint64_t tail_raw;
+			struct {
+				volatile uint32_t tail;     /**< Consumer tail. */
+				volatile uint32_t tail_cnt; /**< Tail updates. */
+			};
+		};
 #ifdef RTE_RING_SPLIT_PROD_CONS
 	} cons __rte_cache_aligned;
 #else
@@ -175,6 +207,7 @@ struct rte_ring {
 
 #define RING_F_SP_ENQ 0x0001 /**< The default enqueue is "single-producer". */
 #define RING_F_SC_DEQ 0x0002 /**< The default dequeue is "single-consumer". */
+#define RING_F_RTS    0x0004 /**< Multi-producer/consumer ops complete out of order. */
 #define RTE_RING_QUOT_EXCEED (1 << 31)  /**< Quota exceed for burst ops */
 #define RTE_RING_SZ_MASK  (unsigned)(0x0fffffff) /**< Ring size mask */
 
@@ -244,6 +277,10 @@ ssize_t rte_ring_get_memsize(unsigned count);
  *    - RING_F_SC_DEQ: If this flag is set, the default behavior when
  *      using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *      is "single-consumer". Otherwise, it is "multi-consumers".
+ *    - RING_F_RTS: If this flag is set, multi-producers enqueues and
+ *      multi-consumers dequeues use relaxed tail synchronization: they
+ *      may complete out of order instead of waiting for the previous
+ *      ones, and the tail is moved by the last one to finish.
  * @return
  *   0 on success, or a negative value on error.
  */
@@ -279,6 +316,10 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
  *    - RING_F_SC_DEQ: If this flag is set, the default behavior when
  *      using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *      is "single-consumer". Otherwise, it is "multi-consumers".
+ *    - RING_F_RTS: If this flag is set, multi-producers enqueues and
+ *      multi-consumers dequeues use relaxed tail synchronization: they
+ *      may complete out of order instead of waiting for the previous
+ *      ones, and the tail is moved by the last one to finish.
  * @return
  *   On success, the pointer to the new allocated ring. NULL on error with
  *    rte_errno set appropriately. Possible errno values include:
@@ -293,6 +334,18 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 struct rte_ring *rte_ring_create(const char *name, unsigned count,
 				 int socket_id, unsigned flags);
 
+/**
+ * De-allocate all memory used by the ring.
+ *
+ * The ring is removed from the list of rings and its memzone is freed.
+ * It must not be used by any lcore anymore. Rings initialized with
+ * rte_ring_init() in memory provided by the application are not freed.
+ *
+ * @param r
+ *   Ring to free, created with rte_ring_create().
+ */
+void rte_ring_free(struct rte_ring *r);
+
 /**
  * Change the high water mark.
  *
@@ -375,6 +428,229 @@ void rte_ring_dump(FILE *f, const struct rte_ring *r);
 	} \
 } while (0)
 
+/**
+ * @internal Index and update counter of a head or tail, as stored in the
+ * head_raw and tail_raw fields of a RING_F_RTS ring.
+ */
+union __rte_ring_rts_poscnt {
+	uint64_t raw;
+	struct {
+		uint32_t pos;    /**< Head or tail index. */
+		uint32_t cnt;    /**< Number of updates. */
+	} val;
+};
+
+/* Maximum head to tail distance before new RING_F_RTS operations wait. */
+#define __RTE_RING_RTS_HTD_MAX(mask) (((mask) + 1) / 8)
+
+/**
+ * @internal Atomically read a 64-bit head or tail of a RING_F_RTS ring.
+ */
+static inline uint64_t __attribute__((always_inline))
+__rte_ring_rts_load(volatile uint64_t *raw)
+{
+#ifdef RTE_ARCH_64
+	return *raw;
+#else
+	uint64_t v;
+
+	do {
+		v = *raw;
+	} while (rte_atomic64_cmpset(raw, v, v) == 0);
+	return v;
+#endif
+}
+
+/**
+ * @internal Complete an operation on a RING_F_RTS ring.
+ *
+ * Each completed operation increments the tail counter. The one that
+ * brings it level with the head counter is the last one in flight, and
+ * moves the tail index up to the head.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_rts_update_tail(volatile uint64_t *head_raw,
+			   volatile uint64_t *tail_raw)
+{
+	union __rte_ring_rts_poscnt h, ot, nt;
+
+	do {
+		ot.raw = __rte_ring_rts_load(tail_raw);
+		h.raw = __rte_ring_rts_load(head_raw);
+
+		nt.raw = ot.raw;
+		if (++nt.val.cnt == h.val.cnt)
+			nt.val.pos = h.val.pos;
+	} while (unlikely(rte_atomic64_cmpset(tail_raw, ot.raw,
+					      nt.raw) == 0));
+}
+
+/**
+ * @internal Enqueue several objects on a RING_F_RTS ring (multi-producers
+ * safe).
+ *
+ * The producer head index and its update counter are moved together by a
+ * 64-bit "compare and set". Producers do not wait for the previous ones to
+ * complete: the last producer in flight moves the tail. The head is not
+ * allowed to get further than __RTE_RING_RTS_HTD_MAX() entries ahead of
+ * the tail, so that a steady stream of producers cannot hold it back.
+ *
+ * Parameters and return values are the same as __rte_ring_mp_do_enqueue().
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_rts_do_enqueue(struct rte_ring *r, void * const *obj_table,
+			  unsigned n, enum rte_ring_queue_behavior behavior,
+			  unsigned *free_space)
+{
+	union __rte_ring_rts_poscnt oh, nh;
+	uint32_t prod_head, cons_tail, free_entries;
+	const unsigned max = n;
+	unsigned i;
+	uint32_t mask = r->prod.mask;
+	const uint32_t htd_max = __RTE_RING_RTS_HTD_MAX(mask);
+	int ret;
+
+	/* move prod.head and its counter atomically */
+	do {
+		/* Reset n to the initial burst count */
+		n = max;
+
+		oh.raw = __rte_ring_rts_load(&r->prod.head_raw);
+
+		/* let the tail catch up if it is too far behind */
+		while (unlikely(oh.val.pos - r->prod.tail > htd_max)) {
+			rte_pause();
+			oh.raw = __rte_ring_rts_load(&r->prod.head_raw);
+		}
+
+		prod_head = oh.val.pos;
+		cons_tail = r->cons.tail;
+		free_entries = (mask + cons_tail - prod_head);
+
+		/* check that we have enough room in ring */
+		if (unlikely(n > free_entries)) {
+			if (behavior == RTE_RING_QUEUE_FIXED) {
+				if (free_space != NULL)
+					*free_space = free_entries;
+				__RING_STAT_ADD(r, enq_fail, n);
+				return -ENOBUFS;
+			}
+			else {
+				/* No free entry available */
+				if (unlikely(free_entries == 0)) {
+					if (free_space != NULL)
+						*free_space = free_entries;
+					__RING_STAT_ADD(r, enq_fail, n);
+					return 0;
+				}
+
+				n = free_entries;
+			}
+		}
+
+		nh.val.pos = prod_head + n;
+		nh.val.cnt = oh.val.cnt + 1;
+	} while (unlikely(rte_atomic64_cmpset(&r->prod.head_raw, oh.raw,
+					      nh.raw) == 0));
+
+	/* write entries in ring */
+	ENQUEUE_PTRS();
+	rte_compiler_barrier();
+
+	if (free_space != NULL)
+		*free_space = free_entries - n;
+
+	/* if we exceed the watermark */
+	if (unlikely(((mask + 1) - free_entries + n) > r->prod.watermark)) {
+		ret = (behavior == RTE_RING_QUEUE_FIXED) ? -EDQUOT :
+				(int)(n | RTE_RING_QUOT_EXCEED);
+		__RING_STAT_ADD(r, enq_quota, n);
+	}
+	else {
+		ret = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : n;
+		__RING_STAT_ADD(r, enq_success, n);
+	}
+
+	__rte_ring_rts_update_tail(&r->prod.head_raw, &r->prod.tail_raw);
+	return ret;
+}
+
+/**
+ * @internal Dequeue several objects from a RING_F_RTS ring
+ * (multi-consumers safe).
+ *
+ * Consumers complete out of order in the same way as producers in
+ * __rte_ring_rts_do_enqueue().
+ *
+ * Parameters and return values are the same as __rte_ring_mc_do_dequeue().
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_rts_do_dequeue(struct rte_ring *r, void **obj_table,
+			  unsigned n, enum rte_ring_queue_behavior behavior,
+			  unsigned *available)
+{
+	union __rte_ring_rts_poscnt oh, nh;
+	uint32_t cons_head, prod_tail, entries;
+	const unsigned max = n;
+	unsigned i;
+	uint32_t mask = r->prod.mask;
+	const uint32_t htd_max = __RTE_RING_RTS_HTD_MAX(mask);
+
+	/* move cons.head and its counter atomically */
+	do {
+		/* Restore n as it may change every loop */
+		n = max;
+
+		oh.raw = __rte_ring_rts_load(&r->cons.head_raw);
+
+		/* let the tail catch up if it is too far behind */
+		while (unlikely(oh.val.pos - r->cons.tail > htd_max)) {
+			rte_pause();
+			oh.raw = __rte_ring_rts_load(&r->cons.head_raw);
+		}
+
+		cons_head = oh.val.pos;
+		prod_tail = r->prod.tail;
+		entries = (prod_tail - cons_head);
+
+		/* Set the actual entries for dequeue */
+		if (n > entries) {
+			if (behavior == RTE_RING_QUEUE_FIXED) {
+				if (available != NULL)
+					*available = entries;
+				__RING_STAT_ADD(r, deq_fail, n);
+				return -ENOENT;
+			}
+			else {
+				if (unlikely(entries == 0)){
+					if (available != NULL)
+						*available = entries;
+					__RING_STAT_ADD(r, deq_fail, n);
+					return 0;
+				}
+
+				n = entries;
+			}
+		}
+
+		nh.val.pos = cons_head + n;
+		nh.val.cnt = oh.val.cnt + 1;
+	} while (unlikely(rte_atomic64_cmpset(&r->cons.head_raw, oh.raw,
+					      nh.raw) == 0));
+
+	/* copy in table */
+	DEQUEUE_PTRS();
+	rte_compiler_barrier();
+
+	if (available != NULL)
+		*available = entries - n;
+
+	__RING_STAT_ADD(r, deq_success, n);
+	__rte_ring_rts_update_tail(&r->cons.head_raw, &r->cons.tail_raw);
+
+	return behavior == RTE_RING_QUEUE_FIXED ? 0 : n;
+}
+
 /**
  * @internal Enqueue several objects on the ring (multi-producers safe).
  *
@@ -390,6 +666,9 @@ void rte_ring_dump(FILE *f, const struct rte_ring *r);
  * @param behavior
  *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
  *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items a possible from ring
+ * @param free_space
+ *   If non-NULL, returns the amount of space left in the ring after the
+ *   enqueue, as seen by this producer.
  * @return
  *   Depend on the behavior value
  *   if behavior = RTE_RING_QUEUE_FIXED
@@ -402,7 +681,8 @@ void rte_ring_dump(FILE *f, const struct rte_ring *r);
  */
 static inline int __attribute__((always_inline))
 __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
-			 unsigned n, enum rte_ring_queue_behavior behavior)
+			 unsigned n, enum rte_ring_queue_behavior behavior,
+			 unsigned *free_space)
 {
 	uint32_t prod_head, prod_next;
 	uint32_t cons_tail, free_entries;
@@ -412,6 +692,10 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	uint32_t mask = r->prod.mask;
 	int ret;
 
+	if (r->prod.rts)
+		return __rte_ring_rts_do_enqueue(r, obj_table, n, behavior,
+			free_space);
+
 	/* move prod.head atomically */
 	do {
 		/* Reset n to the initial burst count */
@@ -428,12 +712,16 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 		/* check that we have enough room in ring */
 		if (unlikely(n > free_entries)) {
 			if (behavior == RTE_RING_QUEUE_FIXED) {
+				if (free_space != NULL)
+					*free_space = free_entries;
 				__RING_STAT_ADD(r, enq_fail, n);
 				return -ENOBUFS;
 			}
 			else {
 				/* No free entry available */
 				if (unlikely(free_entries == 0)) {
+					if (free_space != NULL)
+						*free_space = free_entries;
 					__RING_STAT_ADD(r, enq_fail, n);
 					return 0;
 				}
@@ -451,6 +739,9 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	ENQUEUE_PTRS();
 	rte_compiler_barrier();
 
+	if (free_space != NULL)
+		*free_space = free_entries - n;
+
 	/* if we exceed the watermark */
 	if (unlikely(((mask + 1) - free_entries + n) > r->prod.watermark)) {
 		ret = (behavior == RTE_RING_QUEUE_FIXED) ? -EDQUOT :
@@ -485,6 +776,9 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  * @param behavior
  *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
  *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items a possible from ring
+ * @param free_space
+ *   If non-NULL, returns the amount of space left in the ring after the
+ *   enqueue, as seen by this producer.
  * @return
  *   Depend on the behavior value
  *   if behavior = RTE_RING_QUEUE_FIXED
@@ -497,7 +791,8 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  */
 static inline int __attribute__((always_inline))
 __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
-			 unsigned n, enum rte_ring_queue_behavior behavior)
+			 unsigned n, enum rte_ring_queue_behavior behavior,
+			 unsigned *free_space)
 {
 	uint32_t prod_head, cons_tail;
 	uint32_t prod_next, free_entries;
@@ -516,12 +811,16 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	/* check that we have enough room in ring */
 	if (unlikely(n > free_entries)) {
 		if (behavior == RTE_RING_QUEUE_FIXED) {
+			if (free_space != NULL)
+				*free_space = free_entries;
 			__RING_STAT_ADD(r, enq_fail, n);
 			return -ENOBUFS;
 		}
 		else {
 			/* No free entry available */
 			if (unlikely(free_entries == 0)) {
+				if (free_space != NULL)
+					*free_space = free_entries;
 				__RING_STAT_ADD(r, enq_fail, n);
 				return 0;
 			}
@@ -537,6 +836,9 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	ENQUEUE_PTRS();
 	rte_compiler_barrier();
 
+	if (free_space != NULL)
+		*free_space = free_entries - n;
+
 	/* if we exceed the watermark */
 	if (unlikely(((mask + 1) - free_entries + n) > r->prod.watermark)) {
 		ret = (behavior == RTE_RING_QUEUE_FIXED) ? -EDQUOT :
@@ -569,6 +871,9 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  * @param behavior
  *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
  *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items a possible from ring
+ * @param available
+ *   If non-NULL, returns the number of objects left in the ring after the
+ *   dequeue, as seen by this consumer.
  * @return
  *   Depend on the behavior value
  *   if behavior = RTE_RING_QUEUE_FIXED
@@ -581,7 +886,8 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 
 static inline int __attribute__((always_inline))
 __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
-		 unsigned n, enum rte_ring_queue_behavior behavior)
+		 unsigned n, enum rte_ring_queue_behavior behavior,
+		 unsigned *available)
 {
 	uint32_t cons_head, prod_tail;
 	uint32_t cons_next, entries;
@@ -590,6 +896,10 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
 	unsigned i;
 	uint32_t mask = r->prod.mask;
 
+	if (r->cons.rts)
+		return __rte_ring_rts_do_dequeue(r, obj_table, n, behavior,
+			available);
+
 	/* move cons.head atomically */
 	do {
 		/* Restore n as it may change every loop */
@@ -606,11 +916,15 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
 		/* Set the actual entries for dequeue */
 		if (n > entries) {
 			if (behavior == RTE_RING_QUEUE_FIXED) {
+				if (available != NULL)
+					*available = entries;
 				__RING_STAT_ADD(r, deq_fail, n);
 				return -ENOENT;
 			}
 			else {
 				if (unlikely(entries == 0)){
+					if (available != NULL)
+						*available = entries;
 					__RING_STAT_ADD(r, deq_fail, n);
 					return 0;
 				}
@@ -628,6 +942,9 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
 	DEQUEUE_PTRS();
 	rte_compiler_barrier();
 
+	if (available != NULL)
+		*available = entries - n;
+
 	/*
 	 * If there are other dequeues in progress that preceded us,
 	 * we need to wait for them to complete
@@ -655,6 +972,9 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
  * @param behavior
  *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
  *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items a possible from ring
+ * @param available
+ *   If non-NULL, returns the number of objects left in the ring after the
+ *   dequeue, as seen by this consumer.
  * @return
  *   Depend on the behavior value
  *   if behavior = RTE_RING_QUEUE_FIXED
@@ -666,7 +986,8 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
  */
 static inline int __attribute__((always_inline))
 __rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
-		 unsigned n, enum rte_ring_queue_behavior behavior)
+		 unsigned n, enum rte_ring_queue_behavior behavior,
+		 unsigned *available)
 {
 	uint32_t cons_head, prod_tail;
 	uint32_t cons_next, entries;
@@ -683,11 +1004,15 @@ __rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
 
 	if (n > entries) {
 		if (behavior == RTE_RING_QUEUE_FIXED) {
+			if (available != NULL)
+				*available = entries;
 			__RING_STAT_ADD(r, deq_fail, n);
 			return -ENOENT;
 		}
 		else {
 			if (unlikely(entries == 0)){
+				if (available != NULL)
+					*available = entries;
 				__RING_STAT_ADD(r, deq_fail, n);
 				return 0;
 			}
@@ -703,6 +1028,9 @@ __rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
 	DEQUEUE_PTRS();
 	rte_compiler_barrier();
 
+	if (available != NULL)
+		*available = entries - n;
+
 	__RING_STAT_ADD(r, deq_success, n);
 	r->cons.tail = cons_next;
 	return behavior == RTE_RING_QUEUE_FIXED ? 0 : n;
@@ -730,7 +1058,8 @@ static inline int __attribute__((always_inline))
 rte_ring_mp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
 			 unsigned n)
 {
-	return __rte_ring_mp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	return __rte_ring_mp_do_enqueue(r, obj_table, n,
+		RTE_RING_QUEUE_FIXED, NULL);
 }
 
 /**
@@ -752,7 +1081,8 @@ static inline int __attribute__((always_inline))
 rte_ring_sp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
 			 unsigned n)
 {
-	return __rte_ring_sp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	return __rte_ring_sp_do_enqueue(r, obj_table, n,
+		RTE_RING_QUEUE_FIXED, NULL);
 }
 
 /**
@@ -871,7 +1201,8 @@ rte_ring_enqueue(struct rte_ring *r, void *obj)
 static inline int __attribute__((always_inline))
 rte_ring_mc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
 {
-	return __rte_ring_mc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	return __rte_ring_mc_do_dequeue(r, obj_table, n,
+		RTE_RING_QUEUE_FIXED, NULL);
 }
 
 /**
@@ -892,7 +1223,8 @@ rte_ring_mc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
 static inline int __attribute__((always_inline))
 rte_ring_sc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
 {
-	return __rte_ring_sc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	return __rte_ring_sc_do_dequeue(r, obj_table, n,
+		RTE_RING_QUEUE_FIXED, NULL);
 }
 
 /**
@@ -1091,7 +1423,8 @@ static inline unsigned __attribute__((always_inline))
 rte_ring_mp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
 			 unsigned n)
 {
-	return __rte_ring_mp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	return __rte_ring_mp_do_enqueue(r, obj_table, n,
+		RTE_RING_QUEUE_VARIABLE, NULL);
 }
 
 /**
@@ -1110,7 +1443,8 @@ static inline unsigned __attribute__((always_inline))
 rte_ring_sp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
 			 unsigned n)
 {
-	return __rte_ring_sp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	return __rte_ring_sp_do_enqueue(r, obj_table, n,
+		RTE_RING_QUEUE_VARIABLE, NULL);
 }
 
 /**
@@ -1159,7 +1493,8 @@ rte_ring_enqueue_burst(struct rte_ring *r, void * const *obj_table,
 static inline unsigned __attribute__((always_inline))
 rte_ring_mc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
 {
-	return __rte_ring_mc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	return __rte_ring_mc_do_dequeue(r, obj_table, n,
+		RTE_RING_QUEUE_VARIABLE, NULL);
 }
 
 /**
@@ -1179,7 +1514,8 @@ rte_ring_mc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
 static inline unsigned __attribute__((always_inline))
 rte_ring_sc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
 {
-	return __rte_ring_sc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	return __rte_ring_sc_do_dequeue(r, obj_table, n,
+		RTE_RING_QUEUE_VARIABLE, NULL);
 }
 
 /**
@@ -1207,6 +1543,173 @@ rte_ring_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
 		return rte_ring_mc_dequeue_burst(r, obj_table, n);
 }
 
+/**
+ * Enqueue several objects on the ring (multi-producers safe), and return
+ * the space left in the ring.
+ *
+ * This is rte_ring_mp_enqueue_burst(), that also returns the free space
+ * seen while moving the producer index, so that the caller can size the
+ * next burst without reading the consumer index again.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   If non-NULL, returns the amount of space left in the ring after the
+ *   enqueue.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_enqueue_burst_free(struct rte_ring *r, void * const *obj_table,
+			 unsigned n, unsigned *free_space)
+{
+	return __rte_ring_mp_do_enqueue(r, obj_table, n,
+		RTE_RING_QUEUE_VARIABLE, free_space);
+}
+
+/**
+ * Enqueue several objects on a ring (NOT multi-producers safe), and return
+ * the space left in the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   If non-NULL, returns the amount of space left in the ring after the
+ *   enqueue.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_sp_enqueue_burst_free(struct rte_ring *r, void * const *obj_table,
+			 unsigned n, unsigned *free_space)
+{
+	return __rte_ring_sp_do_enqueue(r, obj_table, n,
+		RTE_RING_QUEUE_VARIABLE, free_space);
+}
+
+/**
+ * Enqueue several objects on a ring, and return the space left in the ring.
+ *
+ * This function calls the multi-producer or the single-producer
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   If non-NULL, returns the amount of space left in the ring after the
+ *   enqueue.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_enqueue_burst_free(struct rte_ring *r, void * const *obj_table,
+		      unsigned n, unsigned *free_space)
+{
+	if (r->prod.sp_enqueue)
+		return rte_ring_sp_enqueue_burst_free(r, obj_table, n,
+			free_space);
+	else
+		return rte_ring_mp_enqueue_burst_free(r, obj_table, n,
+			free_space);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe), and return
+ * the number of objects left in the ring.
+ *
+ * This is rte_ring_mc_dequeue_burst(), that also returns the number of
+ * entries seen while moving the consumer index, so that the caller can
+ * size the next burst without reading the producer index again.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of objects left in the ring after the
+ *   dequeue.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_dequeue_burst_avail(struct rte_ring *r, void **obj_table,
+		unsigned n, unsigned *available)
+{
+	return __rte_ring_mc_do_dequeue(r, obj_table, n,
+		RTE_RING_QUEUE_VARIABLE, available);
+}
+
+/**
+ * Dequeue several objects from a ring (NOT multi-consumers safe), and
+ * return the number of objects left in the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of objects left in the ring after the
+ *   dequeue.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_sc_dequeue_burst_avail(struct rte_ring *r, void **obj_table,
+		unsigned n, unsigned *available)
+{
+	return __rte_ring_sc_do_dequeue(r, obj_table, n,
+		RTE_RING_QUEUE_VARIABLE, available);
+}
+
+/**
+ * Dequeue multiple objects from a ring up to a maximum number, and return
+ * the number of objects left in the ring.
+ *
+ * This function calls the multi-consumers or the single-consumer
+ * version, depending on the default behaviour that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of objects left in the ring after the
+ *   dequeue.
+ * @return
+ *   - Number of objects dequeued
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_dequeue_burst_avail(struct rte_ring *r, void **obj_table,
+		unsigned n, unsigned *available)
+{
+	if (r->cons.sc_dequeue)
+		return rte_ring_sc_dequeue_burst_avail(r, obj_table, n,
+			available);
+	else
+		return rte_ring_mc_dequeue_burst_avail(r, obj_table, n,
+			available);
+}
+
 #ifdef __cplusplus
 }
 #endif
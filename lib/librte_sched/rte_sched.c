@@ -33,6 +33,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 
 #include <rte_common.h>
 #include <rte_log.h>
@@ -41,6 +42,8 @@
 #include <rte_cycles.h>
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
+#include <rte_spinlock.h>
+#include <rte_ring.h>
 #include <rte_mbuf.h>
 
 #include "rte_sched.h"
@@ -92,16 +95,21 @@
 #if (RTE_SCHED_PORT_N_GRINDERS == 0) || (RTE_SCHED_PORT_N_GRINDERS & (RTE_SCHED_PORT_N_GRINDERS - 1))
 #error Number of grinders must be non-zero and a power of 2
 #endif
-#if (RTE_SCHED_OPTIMIZATIONS && (RTE_SCHED_PORT_N_GRINDERS != 8))
-#error Number of grinders must be 8 when RTE_SCHED_OPTIMIZATIONS is set
+#if (RTE_SCHED_OPTIMIZATIONS && (RTE_SCHED_PORT_N_GRINDERS & 3))
+#error Number of grinders must be a multiple of 4 when RTE_SCHED_OPTIMIZATIONS is set
 #endif
 
-#define RTE_SCHED_GRINDER_PCACHE_SIZE         (64 / RTE_SCHED_QUEUES_PER_PIPE)
+/* One bitmap slab holds up to 64 pipes (pipes with a single queue) */
+#define RTE_SCHED_GRINDER_PCACHE_SIZE         64
 
 #define RTE_SCHED_PIPE_INVALID                UINT32_MAX
 
 #define RTE_SCHED_BMP_POS_INVALID             UINT32_MAX
 
+/* Port group: packets moved per shard dequeue, shard output ring size */
+#define RTE_SCHED_PORT_GROUP_BURST            64
+#define RTE_SCHED_PORT_GROUP_RING_SIZE        1024
+
 struct rte_sched_subport {
 	/* Token bucket (TB) */
 	uint64_t tb_time; /* time of last update */
@@ -138,6 +146,7 @@ struct rte_sched_pipe_profile {
 	/* Pipe traffic classes */
 	uint32_t tc_period;
 	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_ov_rate;
 	uint8_t tc_ov_weight;
 
 	/* Pipe queues */
@@ -186,7 +195,7 @@ enum grinder_state {
 
 struct rte_sched_grinder {
 	/* Pipe cache */
-	uint16_t pcache_qmask[RTE_SCHED_GRINDER_PCACHE_SIZE];
+	uint64_t pcache_qmask[RTE_SCHED_GRINDER_PCACHE_SIZE];
 	uint32_t pcache_qindex[RTE_SCHED_GRINDER_PCACHE_SIZE];
 	uint32_t pcache_w;
 	uint32_t pcache_r;
@@ -200,16 +209,16 @@ struct rte_sched_grinder {
 	struct rte_sched_pipe_profile *pipe_params;
 
 	/* TC cache */
-	uint8_t tccache_qmask[4];
-	uint32_t tccache_qindex[4];
+	uint8_t tccache_qmask[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tccache_qindex[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
 	uint32_t tccache_w;
 	uint32_t tccache_r;
 
 	/* Current TC */
 	uint32_t tc_index;
-	struct rte_sched_queue *queue[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	struct rte_mbuf **qbase[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t qindex[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	struct rte_sched_queue *queue[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
+	struct rte_mbuf **qbase[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
+	uint32_t qindex[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
 	uint16_t qsize;
 	uint32_t qmask;
 	uint32_t qpos;
@@ -225,12 +234,15 @@ struct rte_sched_port {
 	/* User parameters */
 	uint32_t n_subports_per_port;
 	uint32_t n_pipes_per_subport;
+	uint32_t n_traffic_classes;
+	uint32_t n_queues_per_traffic_class;
+	uint32_t n_grinders;
 	uint32_t rate;
 	uint32_t mtu;
 	uint32_t frame_overhead;
 	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
 	uint32_t n_pipe_profiles;
-	uint32_t pipe_tc3_rate_max;
+	uint32_t pipe_tc_ov_rate_max;
 #ifdef RTE_SCHED_RED
 	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS];
 #endif
@@ -241,6 +253,11 @@ struct rte_sched_port {
 	uint64_t time;                /* Current NIC TX time measured in bytes */
 	double cycles_per_byte;       /* CPU cycles per byte */
 
+	/* Port group (shard of a multi-core port) */
+	struct rte_sched_port_group *group;
+	uint32_t subport_base;        /* ID of the first subport owned by this shard */
+	int64_t port_credits;         /* Output port credits owned by this shard */
+
 	/* Scheduling loop detection */
 	uint32_t pipe_loop;
 	uint32_t pipe_exhaustion;
@@ -255,6 +272,14 @@ struct rte_sched_port {
 	struct rte_mbuf **pkts_out;
 	uint32_t n_pkts_out;
 
+	/* Queue index layout */
+	uint32_t n_queues_per_pipe;
+	uint32_t queue_bits;          /* log2(n_queues_per_traffic_class) */
+	uint32_t pipe_queue_bits;     /* log2(n_queues_per_pipe) */
+	uint32_t tc_ov_index;         /* Last traffic class, subject to oversubscription */
+	uint32_t tc_qmask;            /* Queue mask of one traffic class */
+	uint64_t pipe_qmask;          /* Queue mask of one pipe */
+
 	/* Queue base calculation */
 	uint32_t qsize_add[RTE_SCHED_QUEUES_PER_PIPE];
 	uint32_t qsize_sum;
@@ -270,6 +295,38 @@ struct rte_sched_port {
 	uint8_t memory[0] __rte_cache_aligned;
 } __rte_cache_aligned;
 
+struct rte_sched_port_group_merge {
+	struct rte_mbuf *pkts[RTE_SCHED_PORT_GROUP_BURST];
+	uint32_t n_pkts;
+	uint32_t pos;
+	int32_t deficit;
+} __rte_cache_aligned;
+
+struct rte_sched_port_group {
+	/* Output port token bucket shared by all shards */
+	struct {
+		rte_spinlock_t lock;
+		uint64_t time_cpu_cycles; /* CPU time of bucket creation */
+		uint64_t time;            /* Time of last update measured in bytes */
+		int64_t credits;
+		int64_t size;
+		int64_t chunk;            /* Maximum credits handed to a shard at once */
+		double cycles_per_byte;
+	} tb __rte_cache_aligned;
+
+	/* Shards */
+	uint32_t n_shards;
+	uint32_t n_subports_per_shard;
+	uint32_t frame_overhead;
+	int32_t quantum;
+	struct rte_sched_port *shard[RTE_SCHED_PORT_GROUP_SHARDS_MAX];
+	struct rte_ring *ring[RTE_SCHED_PORT_GROUP_SHARDS_MAX];
+
+	/* Merge stage (deficit round robin over the shard output rings) */
+	uint32_t merge_pos;
+	struct rte_sched_port_group_merge merge[RTE_SCHED_PORT_GROUP_SHARDS_MAX];
+};
+
 enum rte_sched_port_array {
 	e_RTE_SCHED_PORT_ARRAY_SUBPORT = 0,
 	e_RTE_SCHED_PORT_ARRAY_PIPE,
@@ -286,7 +343,7 @@ enum rte_sched_port_array {
 static inline uint32_t
 rte_sched_port_queues_per_subport(struct rte_sched_port *port)
 {
-	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport;
+	return port->n_queues_per_pipe * port->n_pipes_per_subport;
 }
 
 #endif
@@ -294,13 +351,86 @@ rte_sched_port_queues_per_subport(struct rte_sched_port *port)
 static inline uint32_t
 rte_sched_port_queues_per_port(struct rte_sched_port *port)
 {
-	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport * port->n_subports_per_port;
+	return port->n_queues_per_pipe * port->n_pipes_per_subport * port->n_subports_per_port;
+}
+
+static inline uint32_t
+rte_sched_port_subport_index(struct rte_sched_port *port, uint32_t subport_id)
+{
+	/* Shards own a contiguous range of the port subports */
+	return subport_id - port->subport_base;
+}
+
+static inline uint32_t
+rte_sched_port_params_n_tcs(struct rte_sched_port_params *params)
+{
+	return (params->n_traffic_classes == 0) ?
+		RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE : params->n_traffic_classes;
+}
+
+static inline uint32_t
+rte_sched_port_params_n_queues(struct rte_sched_port_params *params)
+{
+	return (params->n_queues_per_traffic_class == 0) ?
+		RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS : params->n_queues_per_traffic_class;
+}
+
+static inline uint32_t
+rte_sched_port_params_n_grinders(struct rte_sched_port_params *params)
+{
+	return (params->n_grinders == 0) ?
+		RTE_SCHED_PORT_N_GRINDERS : params->n_grinders;
+}
+
+static int
+rte_sched_pipe_profile_check(struct rte_sched_pipe_params *p,
+	uint32_t rate, uint32_t n_tcs, uint32_t n_queues)
+{
+	uint32_t j;
+
+	/* TB rate: non-zero, not greater than port rate */
+	if ((p->tb_rate == 0) || (p->tb_rate > rate)) {
+		return -10;
+	}
+
+	/* TB size: non-zero */
+	if (p->tb_size == 0) {
+		return -11;
+	}
+
+	/* TC rate: non-zero, less than pipe rate */
+	for (j = 0; j < n_tcs; j ++) {
+		if ((p->tc_rate[j] == 0) || (p->tc_rate[j] > p->tb_rate)) {
+			return -12;
+		}
+	}
+
+	/* TC period: non-zero */
+	if (p->tc_period == 0) {
+		return -13;
+	}
+
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	/* Last TC oversubscription weight: non-zero */
+	if (p->tc_ov_weight == 0) {
+		return -14;
+	}
+#endif
+
+	/* Queue WRR weights: non-zero */
+	for (j = 0; j < n_tcs * n_queues; j ++) {
+		if (p->wrr_weights[j] == 0) {
+			return -15;
+		}
+	}
+
+	return 0;
 }
 
 static int
 rte_sched_port_check_params(struct rte_sched_port_params *params)
 {
-	uint32_t i, j;
+	uint32_t n_tcs, n_queues, i;
 
 	if (params == NULL) {
 		return -1;
@@ -331,8 +461,18 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 		return -7;
 	}
 
+	/* n_traffic_classes, n_queues_per_traffic_class, n_grinders: power of 2, within the compile-time limits */
+	n_tcs = rte_sched_port_params_n_tcs(params);
+	n_queues = rte_sched_port_params_n_queues(params);
+	if ((n_tcs > RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE) || (!rte_is_power_of_2(n_tcs)) ||
+	    (n_queues > RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS) || (!rte_is_power_of_2(n_queues)) ||
+	    (rte_sched_port_params_n_grinders(params) > RTE_SCHED_PORT_N_GRINDERS) ||
+	    (!rte_is_power_of_2(rte_sched_port_params_n_grinders(params)))) {
+		return -16;
+	}
+
 	/* qsize: non-zero, power of 2, no bigger than 32K (due to 16-bit read/write pointers) */
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+	for (i = 0; i < n_tcs; i ++) {
 		uint16_t qsize = params->qsize[i];
 
 		if ((qsize == 0) || (!rte_is_power_of_2(qsize))) {
@@ -348,42 +488,12 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 	}
 
 	for (i = 0; i < params->n_pipe_profiles; i ++) {
-		struct rte_sched_pipe_params *p = params->pipe_profiles + i;
+		int status;
 
-		/* TB rate: non-zero, not greater than port rate */
-		if ((p->tb_rate == 0) || (p->tb_rate > params->rate)) {
-			return -10;
-		}
-
-		/* TB size: non-zero */
-		if (p->tb_size == 0) {
-			return -11;
-		}
-
-		/* TC rate: non-zero, less than pipe rate */
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
-			if ((p->tc_rate[j] == 0) || (p->tc_rate[j] > p->tb_rate)) {
-				return -12;
-			}
-		}
-
-		/* TC period: non-zero */
-		if (p->tc_period == 0) {
-			return -13;
-		}
-
-#ifdef RTE_SCHED_SUBPORT_TC_OV
-		/* TC3 oversubscription weight: non-zero */
-		if (p->tc_ov_weight == 0) {
-			return -14;
-		}
-#endif
-
-		/* Queue WRR weights: non-zero */
-		for (j = 0; j < RTE_SCHED_QUEUES_PER_PIPE; j ++) {
-			if (p->wrr_weights[j] == 0) {
-				return -15;
-			}
+		status = rte_sched_pipe_profile_check(params->pipe_profiles + i,
+			params->rate, n_tcs, n_queues);
+		if (status != 0) {
+			return status;
 		}
 	}
 
@@ -396,7 +506,9 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 	uint32_t n_subports_per_port = params->n_subports_per_port;
 	uint32_t n_pipes_per_subport = params->n_pipes_per_subport;
 	uint32_t n_pipes_per_port = n_pipes_per_subport * n_subports_per_port;
-	uint32_t n_queues_per_port = RTE_SCHED_QUEUES_PER_PIPE * n_pipes_per_subport * n_subports_per_port;
+	uint32_t n_tcs = rte_sched_port_params_n_tcs(params);
+	uint32_t n_queues = rte_sched_port_params_n_queues(params);
+	uint32_t n_queues_per_port = n_tcs * n_queues * n_pipes_per_subport * n_subports_per_port;
 
 	uint32_t size_subport = n_subports_per_port * sizeof(struct rte_sched_subport);
 	uint32_t size_pipe = n_pipes_per_port * sizeof(struct rte_sched_pipe);
@@ -409,8 +521,8 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 	uint32_t base, i;
 
 	size_per_pipe_queue_array = 0;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
-		size_per_pipe_queue_array += RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * params->qsize[i] * sizeof(struct rte_mbuf *);
+	for (i = 0; i < n_tcs; i ++) {
+		size_per_pipe_queue_array += n_queues * params->qsize[i] * sizeof(struct rte_mbuf *);
 	}
 	size_queue_array = n_pipes_per_port * size_per_pipe_queue_array;
 
@@ -462,43 +574,55 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params)
 static void
 rte_sched_port_config_qsize(struct rte_sched_port *port)
 {
-	/* TC 0 */
+	uint32_t i;
+
+	/* Queues of the same traffic class are stored back to back */
 	port->qsize_add[0] = 0;
-	port->qsize_add[1] = port->qsize_add[0] + port->qsize[0];
-	port->qsize_add[2] = port->qsize_add[1] + port->qsize[0];
-	port->qsize_add[3] = port->qsize_add[2] + port->qsize[0];
+	for (i = 1; i < port->n_queues_per_pipe; i ++) {
+		uint32_t tc = (i - 1) >> port->queue_bits;
 
-	/* TC 1 */
-	port->qsize_add[4] = port->qsize_add[3] + port->qsize[0];
-	port->qsize_add[5] = port->qsize_add[4] + port->qsize[1];
-	port->qsize_add[6] = port->qsize_add[5] + port->qsize[1];
-	port->qsize_add[7] = port->qsize_add[6] + port->qsize[1];
+		port->qsize_add[i] = port->qsize_add[i - 1] + port->qsize[tc];
+	}
 
-	/* TC 2 */
-	port->qsize_add[8] = port->qsize_add[7] + port->qsize[1];
-	port->qsize_add[9] = port->qsize_add[8] + port->qsize[2];
-	port->qsize_add[10] = port->qsize_add[9] + port->qsize[2];
-	port->qsize_add[11] = port->qsize_add[10] + port->qsize[2];
+	port->qsize_sum = port->qsize_add[port->n_queues_per_pipe - 1] +
+		port->qsize[port->n_traffic_classes - 1];
+}
 
-	/* TC 3 */
-	port->qsize_add[12] = port->qsize_add[11] + port->qsize[2];
-	port->qsize_add[13] = port->qsize_add[12] + port->qsize[3];
-	port->qsize_add[14] = port->qsize_add[13] + port->qsize[3];
-	port->qsize_add[15] = port->qsize_add[14] + port->qsize[3];
+static void
+rte_sched_log_u32_array(char *buf, uint32_t size, const uint32_t *array, uint32_t n)
+{
+	uint32_t i, len;
 
-	port->qsize_sum = port->qsize_add[15] + port->qsize[3];
+	len = snprintf(buf, size, "[");
+	for (i = 0; (i < n) && (len < size); i ++) {
+		len += snprintf(buf + len, size - len, (i == 0) ? "%u" : ", %u", array[i]);
+	}
+	if (len < size) {
+		snprintf(buf + len, size - len, "]");
+	}
 }
 
 static void
 rte_sched_port_log_pipe_profile(struct rte_sched_port *port, uint32_t i)
 {
 	struct rte_sched_pipe_profile *p = port->pipe_profiles + i;
+	uint32_t wrr_cost[RTE_SCHED_QUEUES_PER_PIPE];
+	char tc_credits[16 * RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	char wrr[8 * RTE_SCHED_QUEUES_PER_PIPE];
+	uint32_t j;
+
+	rte_sched_log_u32_array(tc_credits, sizeof(tc_credits),
+		p->tc_credits_per_period, port->n_traffic_classes);
+	for (j = 0; j < port->n_queues_per_pipe; j ++) {
+		wrr_cost[j] = p->wrr_cost[j];
+	}
+	rte_sched_log_u32_array(wrr, sizeof(wrr), wrr_cost, port->n_queues_per_pipe);
 
 	RTE_LOG(INFO, SCHED, "Low level config for pipe profile %u:\n"
 		"\tToken bucket: period = %u, credits per period = %u, size = %u\n"
-		"\tTraffic classes: period = %u, credits per period = [%u, %u, %u, %u]\n"
-		"\tTraffic class 3 oversubscription: weight = %hhu\n"
-		"\tWRR cost: [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu]\n",
+		"\tTraffic classes: period = %u, credits per period = %s\n"
+		"\tTraffic class %u oversubscription: weight = %hhu\n"
+		"\tWRR cost: %s\n",
 		i,
 
 		/* Token bucket */
@@ -508,19 +632,14 @@ rte_sched_port_log_pipe_profile(struct rte_sched_port *port, uint32_t i)
 
 		/* Traffic classes */
 		p->tc_period,
-		p->tc_credits_per_period[0],
-		p->tc_credits_per_period[1],
-		p->tc_credits_per_period[2],
-		p->tc_credits_per_period[3],
+		tc_credits,
 
-		/* Traffic class 3 oversubscription */
+		/* Last traffic class oversubscription */
+		port->tc_ov_index,
 		p->tc_ov_weight,
 
 		/* WRR */
-		p->wrr_cost[ 0], p->wrr_cost[ 1], p->wrr_cost[ 2], p->wrr_cost[ 3],
-		p->wrr_cost[ 4], p->wrr_cost[ 5], p->wrr_cost[ 6], p->wrr_cost[ 7],
-		p->wrr_cost[ 8], p->wrr_cost[ 9], p->wrr_cost[10], p->wrr_cost[11],
-		p->wrr_cost[12], p->wrr_cost[13], p->wrr_cost[14], p->wrr_cost[15]);
+		wrr);
 }
 
 static inline uint64_t
@@ -533,77 +652,107 @@ rte_sched_time_ms_to_bytes(uint32_t time_ms, uint32_t rate)
 }
 
 static void
-rte_sched_port_config_pipe_profile_table(struct rte_sched_port *port, struct rte_sched_port_params *params)
+rte_sched_port_config_pipe_profile(struct rte_sched_port *port,
+	struct rte_sched_pipe_params *src,
+	struct rte_sched_pipe_profile *dst)
 {
-	uint32_t i, j;
+	uint32_t j;
 
-	for (i = 0; i < port->n_pipe_profiles; i ++) {
-		struct rte_sched_pipe_params *src = params->pipe_profiles + i;
-		struct rte_sched_pipe_profile *dst = port->pipe_profiles + i;
-
-		/* Token Bucket */
-		if (src->tb_rate == params->rate) {
-			dst->tb_credits_per_period = 1;
-			dst->tb_period = 1;
-		} else {
-			double tb_rate = ((double) src->tb_rate) / ((double) params->rate);
-			double d = RTE_SCHED_TB_RATE_CONFIG_ERR;
+	/* Token Bucket */
+	if (src->tb_rate == port->rate) {
+		dst->tb_credits_per_period = 1;
+		dst->tb_period = 1;
+	} else {
+		double tb_rate = ((double) src->tb_rate) / ((double) port->rate);
+		double d = RTE_SCHED_TB_RATE_CONFIG_ERR;
 
-			rte_approx(tb_rate, d, &dst->tb_credits_per_period, &dst->tb_period);
-		}
-		dst->tb_size = src->tb_size;
+		rte_approx(tb_rate, d, &dst->tb_credits_per_period, &dst->tb_period);
+	}
+	dst->tb_size = src->tb_size;
 
-		/* Traffic Classes */
-		dst->tc_period = (uint32_t) rte_sched_time_ms_to_bytes(src->tc_period, params->rate);
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
-			dst->tc_credits_per_period[j] = (uint32_t) rte_sched_time_ms_to_bytes(src->tc_period, src->tc_rate[j]);
-		}
+	/* Traffic Classes */
+	dst->tc_period = (uint32_t) rte_sched_time_ms_to_bytes(src->tc_period, port->rate);
+	for (j = 0; j < port->n_traffic_classes; j ++) {
+		dst->tc_credits_per_period[j] = (uint32_t) rte_sched_time_ms_to_bytes(src->tc_period, src->tc_rate[j]);
+	}
+	dst->tc_ov_rate = src->tc_rate[port->tc_ov_index];
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		dst->tc_ov_weight = src->tc_ov_weight;
+	dst->tc_ov_weight = src->tc_ov_weight;
 #endif
 
-		/* WRR */
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
-			uint32_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-			uint32_t lcd, lcd1, lcd2;
-			uint32_t qindex;
-
-			qindex = j * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
-
-			wrr_cost[0] = src->wrr_weights[qindex];
-			wrr_cost[1] = src->wrr_weights[qindex + 1];
-			wrr_cost[2] = src->wrr_weights[qindex + 2];
-			wrr_cost[3] = src->wrr_weights[qindex + 3];
-
-			lcd1 = rte_get_lcd(wrr_cost[0], wrr_cost[1]);
-			lcd2 = rte_get_lcd(wrr_cost[2], wrr_cost[3]);
-			lcd = rte_get_lcd(lcd1, lcd2);
-
-			wrr_cost[0] = lcd / wrr_cost[0];
-			wrr_cost[1] = lcd / wrr_cost[1];
-			wrr_cost[2] = lcd / wrr_cost[2];
-			wrr_cost[3] = lcd / wrr_cost[3];
-
-			dst->wrr_cost[qindex] = (uint8_t) wrr_cost[0];
-			dst->wrr_cost[qindex + 1] = (uint8_t) wrr_cost[1];
-			dst->wrr_cost[qindex + 2] = (uint8_t) wrr_cost[2];
-			dst->wrr_cost[qindex + 3] = (uint8_t) wrr_cost[3];
+	/* WRR */
+	for (j = 0; j < port->n_traffic_classes; j ++) {
+		uint32_t lcd, qindex, k;
+
+		qindex = j * port->n_queues_per_traffic_class;
+
+		lcd = src->wrr_weights[qindex];
+		for (k = 1; k < port->n_queues_per_traffic_class; k ++) {
+			lcd = rte_get_lcd(lcd, src->wrr_weights[qindex + k]);
 		}
 
-		rte_sched_port_log_pipe_profile(port, i);
+		for (k = 0; k < port->n_queues_per_traffic_class; k ++) {
+			dst->wrr_cost[qindex + k] = (uint8_t) (lcd / src->wrr_weights[qindex + k]);
+		}
 	}
+}
+
+static void
+rte_sched_port_config_pipe_tc_ov_rate_max(struct rte_sched_port *port)
+{
+	uint32_t i;
 
-	port->pipe_tc3_rate_max = 0;
+	port->pipe_tc_ov_rate_max = 0;
 	for (i = 0; i < port->n_pipe_profiles; i ++) {
-		struct rte_sched_pipe_params *src = params->pipe_profiles + i;
-		uint32_t pipe_tc3_rate = src->tc_rate[3];
+		uint32_t pipe_tc_ov_rate = port->pipe_profiles[i].tc_ov_rate;
+
+		if (port->pipe_tc_ov_rate_max < pipe_tc_ov_rate) {
+			port->pipe_tc_ov_rate_max = pipe_tc_ov_rate;
+		}
+	}
+}
 
-		if (port->pipe_tc3_rate_max < pipe_tc3_rate) {
-			port->pipe_tc3_rate_max = pipe_tc3_rate;
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+
+/* Refresh the oversubscription state and watermark of the configured subports
+ * after a change of the pipe profiles */
+static void
+rte_sched_port_config_subport_tc_ov_wm(struct rte_sched_port *port)
+{
+	uint32_t i;
+
+	for (i = 0; i < port->n_subports_per_port; i ++) {
+		struct rte_sched_subport *s = port->subport + i;
+		double subport_tc_ov_rate;
+
+		if (s->tb_period == 0) {
+			continue;
+		}
+
+		subport_tc_ov_rate = ((double) s->tc_credits_per_period[port->tc_ov_index]) / ((double) s->tc_period);
+		s->tc_ov = s->tc_ov_rate > subport_tc_ov_rate;
+		s->tc_ov_wm_max = (uint32_t) (((uint64_t) s->tc_period * port->pipe_tc_ov_rate_max) / port->rate);
+		if (s->tc_ov_wm > s->tc_ov_wm_max) {
+			s->tc_ov_wm = s->tc_ov_wm_max;
 		}
 	}
 }
 
+#endif /* RTE_SCHED_SUBPORT_TC_OV */
+
+static void
+rte_sched_port_config_pipe_profile_table(struct rte_sched_port *port, struct rte_sched_port_params *params)
+{
+	uint32_t i;
+
+	for (i = 0; i < port->n_pipe_profiles; i ++) {
+		rte_sched_port_config_pipe_profile(port, params->pipe_profiles + i, port->pipe_profiles + i);
+		rte_sched_port_log_pipe_profile(port, i);
+	}
+
+	rte_sched_port_config_pipe_tc_ov_rate_max(port);
+}
+
 struct rte_sched_port *
 rte_sched_port_config(struct rte_sched_port_params *params)
 {
@@ -625,6 +774,9 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	/* User parameters */
 	port->n_subports_per_port = params->n_subports_per_port;
 	port->n_pipes_per_subport = params->n_pipes_per_subport;
+	port->n_traffic_classes = rte_sched_port_params_n_tcs(params);
+	port->n_queues_per_traffic_class = rte_sched_port_params_n_queues(params);
+	port->n_grinders = rte_sched_port_params_n_grinders(params);
 	port->rate = params->rate;
 	port->mtu = params->mtu + params->frame_overhead;
 	port->frame_overhead = params->frame_overhead;
@@ -632,7 +784,7 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	port->n_pipe_profiles = params->n_pipe_profiles;
 
 #ifdef RTE_SCHED_RED
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->n_traffic_classes; i++) {
 		uint32_t j;
 
 		for (j = 0; j < e_RTE_METER_COLORS; j++) {
@@ -662,6 +814,15 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	port->pkts_out = NULL;
 	port->n_pkts_out = 0;
 
+	/* Queue index layout */
+	port->n_queues_per_pipe = port->n_traffic_classes * port->n_queues_per_traffic_class;
+	port->queue_bits = rte_bsf32(port->n_queues_per_traffic_class);
+	port->pipe_queue_bits = rte_bsf32(port->n_queues_per_pipe);
+	port->tc_ov_index = port->n_traffic_classes - 1;
+	port->tc_qmask = (1 << port->n_queues_per_traffic_class) - 1;
+	port->pipe_qmask = (port->n_queues_per_pipe == 64) ?
+		UINT64_MAX : ((1LLU << port->n_queues_per_pipe) - 1);
+
 	/* Queue base calculation */
 	rte_sched_port_config_qsize(port);
 
@@ -708,12 +869,16 @@ static void
 rte_sched_port_log_subport_config(struct rte_sched_port *port, uint32_t i)
 {
 	struct rte_sched_subport *s = port->subport + i;
+	char tc_credits[16 * RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+
+	rte_sched_log_u32_array(tc_credits, sizeof(tc_credits),
+		s->tc_credits_per_period, port->n_traffic_classes);
 
 	RTE_LOG(INFO, SCHED, "Low level config for subport %u:\n"
 		"\tToken bucket: period = %u, credits per period = %u, size = %u\n"
-		"\tTraffic classes: period = %u, credits per period = [%u, %u, %u, %u]\n"
-		"\tTraffic class 3 oversubscription: wm min = %u, wm max = %u\n",
-		i,
+		"\tTraffic classes: period = %u, credits per period = %s\n"
+		"\tTraffic class %u oversubscription: wm min = %u, wm max = %u\n",
+		port->subport_base + i,
 
 		/* Token bucket */
 		s->tb_period,
@@ -722,12 +887,10 @@ rte_sched_port_log_subport_config(struct rte_sched_port *port, uint32_t i)
 
 		/* Traffic classes */
 		s->tc_period,
-		s->tc_credits_per_period[0],
-		s->tc_credits_per_period[1],
-		s->tc_credits_per_period[2],
-		s->tc_credits_per_period[3],
+		tc_credits,
 
-		/* Traffic class 3 oversubscription */
+		/* Last traffic class oversubscription */
+		port->tc_ov_index,
 		s->tc_ov_wm_min,
 		s->tc_ov_wm_max);
 }
@@ -738,14 +901,15 @@ rte_sched_subport_config(struct rte_sched_port *port,
 	struct rte_sched_subport_params *params)
 {
 	struct rte_sched_subport *s;
-	uint32_t i;
+	uint32_t subport_index, i;
 
 	/* Check user parameters */
 	if ((port == NULL) ||
-	    (subport_id >= port->n_subports_per_port) ||
+	    (rte_sched_port_subport_index(port, subport_id) >= port->n_subports_per_port) ||
 		(params == NULL)) {
 		return -1;
 	}
+	subport_index = rte_sched_port_subport_index(port, subport_id);
 
 	if ((params->tb_rate == 0) || (params->tb_rate > port->rate)) {
 		return -2;
@@ -755,7 +919,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		return -3;
 	}
 
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+	for (i = 0; i < port->n_traffic_classes; i ++) {
 		if ((params->tc_rate[i] == 0) || (params->tc_rate[i] > params->tb_rate)) {
 			return -4;
 		}
@@ -765,7 +929,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		return -5;
 	}
 
-	s = port->subport + subport_id;
+	s = port->subport + subport_index;
 
 	/* Token Bucket (TB) */
 	if (params->tb_rate == port->rate) {
@@ -783,18 +947,18 @@ rte_sched_subport_config(struct rte_sched_port *port,
 
 	/* Traffic Classes (TCs) */
 	s->tc_period = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, port->rate);
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+	for (i = 0; i < port->n_traffic_classes; i ++) {
 		s->tc_credits_per_period[i] = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, params->tc_rate[i]);
 	}
 	s->tc_time = port->time + s->tc_period;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+	for (i = 0; i < port->n_traffic_classes; i ++) {
 		s->tc_credits[i] = s->tc_credits_per_period[i];
 	}
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	/* TC oversubscription */
 	s->tc_ov_wm_min = port->mtu;
-	s->tc_ov_wm_max = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, port->pipe_tc3_rate_max);
+	s->tc_ov_wm_max = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, port->pipe_tc_ov_rate_max);
 	s->tc_ov_wm = s->tc_ov_wm_max;
 	s->tc_ov_period_id = 0;
 	s->tc_ov = 0;
@@ -802,7 +966,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 	s->tc_ov_rate = 0;
 #endif
 
-	rte_sched_port_log_subport_config(port, subport_id);
+	rte_sched_port_log_subport_config(port, subport_index);
 
 	return 0;
 }
@@ -816,43 +980,44 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	struct rte_sched_subport *s;
 	struct rte_sched_pipe *p;
 	struct rte_sched_pipe_profile *params;
-	uint32_t deactivate, profile, i;
+	uint32_t deactivate, profile, subport_index, i;
 
 	/* Check user parameters */
 	profile = (uint32_t) pipe_profile;
 	deactivate = (pipe_profile < 0);
 	if ((port == NULL) ||
-	    (subport_id >= port->n_subports_per_port) ||
+	    (rte_sched_port_subport_index(port, subport_id) >= port->n_subports_per_port) ||
 		(pipe_id >= port->n_pipes_per_subport) ||
 		((!deactivate) && (profile >= port->n_pipe_profiles))) {
 		return -1;
 	}
+	subport_index = rte_sched_port_subport_index(port, subport_id);
 
 	/* Check that subport configuration is valid */
-	s = port->subport + subport_id;
+	s = port->subport + subport_index;
 	if (s->tb_period == 0) {
 		return -2;
 	}
 
-	p = port->pipe + (subport_id * port->n_pipes_per_subport + pipe_id);
+	p = port->pipe + (subport_index * port->n_pipes_per_subport + pipe_id);
 
 	/* Handle the case when pipe already has a valid configuration */
 	if (p->tb_time) {
 		params = port->pipe_profiles + p->profile;
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		double subport_tc3_rate = ((double) s->tc_credits_per_period[3]) / ((double) s->tc_period);
-		double pipe_tc3_rate = ((double) params->tc_credits_per_period[3]) / ((double) params->tc_period);
-		uint32_t tc3_ov = s->tc_ov;
+		double subport_tc_ov_rate = ((double) s->tc_credits_per_period[port->tc_ov_index]) / ((double) s->tc_period);
+		double pipe_tc_ov_rate = ((double) params->tc_credits_per_period[port->tc_ov_index]) / ((double) params->tc_period);
+		uint32_t tc_ov = s->tc_ov;
 
 		/* Unplug pipe from its subport */
 		s->tc_ov_n -= params->tc_ov_weight;
-		s->tc_ov_rate -= pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+		s->tc_ov_rate -= pipe_tc_ov_rate;
+		s->tc_ov = s->tc_ov_rate > subport_tc_ov_rate;
 
-		if (s->tc_ov != tc3_ov) {
-			RTE_LOG(INFO, SCHED, "Subport %u TC3 oversubscription is OFF (%.4lf >= %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+		if (s->tc_ov != tc_ov) {
+			RTE_LOG(INFO, SCHED, "Subport %u TC%u oversubscription is OFF (%.4lf >= %.4lf)\n",
+				subport_id, port->tc_ov_index, subport_tc_ov_rate, s->tc_ov_rate);
 		}
 #endif
 
@@ -874,24 +1039,24 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 
 	/* Traffic Classes (TCs) */
 	p->tc_time = port->time + params->tc_period;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+	for (i = 0; i < port->n_traffic_classes; i ++) {
 		p->tc_credits[i] = params->tc_credits_per_period[i];
 	}
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	{
-		/* Subport TC3 oversubscription */
-		double subport_tc3_rate = ((double) s->tc_credits_per_period[3]) / ((double) s->tc_period);
-		double pipe_tc3_rate = ((double) params->tc_credits_per_period[3]) / ((double) params->tc_period);
-		uint32_t tc3_ov = s->tc_ov;
+		/* Subport last TC oversubscription */
+		double subport_tc_ov_rate = ((double) s->tc_credits_per_period[port->tc_ov_index]) / ((double) s->tc_period);
+		double pipe_tc_ov_rate = ((double) params->tc_credits_per_period[port->tc_ov_index]) / ((double) params->tc_period);
+		uint32_t tc_ov = s->tc_ov;
 
 		s->tc_ov_n += params->tc_ov_weight;
-		s->tc_ov_rate += pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+		s->tc_ov_rate += pipe_tc_ov_rate;
+		s->tc_ov = s->tc_ov_rate > subport_tc_ov_rate;
 
-		if (s->tc_ov != tc3_ov) {
-			RTE_LOG(INFO, SCHED, "Subport %u TC3 oversubscription is ON (%.4lf < %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+		if (s->tc_ov != tc_ov) {
+			RTE_LOG(INFO, SCHED, "Subport %u TC%u oversubscription is ON (%.4lf < %.4lf)\n",
+				subport_id, port->tc_ov_index, subport_tc_ov_rate, s->tc_ov_rate);
 		}
 		p->tc_ov_period_id = s->tc_ov_period_id;
 		p->tc_ov_credits = s->tc_ov_wm;
@@ -901,6 +1066,102 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	return 0;
 }
 
+int
+rte_sched_port_pipe_profile_add(struct rte_sched_port *port,
+	struct rte_sched_pipe_params *params,
+	uint32_t *pipe_profile_id)
+{
+	uint32_t profile;
+	int status;
+
+	/* Check user parameters */
+	if ((port == NULL) ||
+	    (params == NULL) ||
+	    (pipe_profile_id == NULL) ||
+	    (port->n_pipe_profiles >= RTE_SCHED_PIPE_PROFILES_PER_PORT)) {
+		return -1;
+	}
+
+	status = rte_sched_pipe_profile_check(params, port->rate,
+		port->n_traffic_classes, port->n_queues_per_traffic_class);
+	if (status != 0) {
+		return status;
+	}
+
+	/* The new profile is not used by any pipe yet, so it can be appended in place */
+	profile = port->n_pipe_profiles;
+	rte_sched_port_config_pipe_profile(port, params, port->pipe_profiles + profile);
+	port->n_pipe_profiles ++;
+
+	rte_sched_port_log_pipe_profile(port, profile);
+	*pipe_profile_id = profile;
+
+	rte_sched_port_config_pipe_tc_ov_rate_max(port);
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	rte_sched_port_config_subport_tc_ov_wm(port);
+#endif
+
+	return 0;
+}
+
+int
+rte_sched_port_pipe_profile_modify(struct rte_sched_port *port,
+	uint32_t pipe_profile_id,
+	struct rte_sched_pipe_params *params)
+{
+	struct rte_sched_pipe_profile *profile;
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	double pipe_tc_ov_rate_old, pipe_tc_ov_rate_new;
+	uint32_t tc_ov_weight_old, n_pipes_per_port, i;
+#endif
+	int status;
+
+	/* Check user parameters */
+	if ((port == NULL) ||
+	    (params == NULL) ||
+	    (pipe_profile_id >= port->n_pipe_profiles)) {
+		return -1;
+	}
+
+	status = rte_sched_pipe_profile_check(params, port->rate,
+		port->n_traffic_classes, port->n_queues_per_traffic_class);
+	if (status != 0) {
+		return status;
+	}
+
+	/* The grinders read the profile on each credit update, so pipes using it switch over
+	 * at their next token bucket and traffic class refill without being reset */
+	profile = port->pipe_profiles + pipe_profile_id;
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	pipe_tc_ov_rate_old = ((double) profile->tc_credits_per_period[port->tc_ov_index]) / ((double) profile->tc_period);
+	tc_ov_weight_old = profile->tc_ov_weight;
+#endif
+	rte_sched_port_config_pipe_profile(port, params, profile);
+	rte_sched_port_log_pipe_profile(port, pipe_profile_id);
+	rte_sched_port_config_pipe_tc_ov_rate_max(port);
+
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	/* Move the subport oversubscription accounting of the pipes using this profile */
+	pipe_tc_ov_rate_new = ((double) profile->tc_credits_per_period[port->tc_ov_index]) / ((double) profile->tc_period);
+	n_pipes_per_port = port->n_subports_per_port * port->n_pipes_per_subport;
+	for (i = 0; i < n_pipes_per_port; i ++) {
+		struct rte_sched_pipe *p = port->pipe + i;
+		struct rte_sched_subport *s = port->subport + (i / port->n_pipes_per_subport);
+
+		if ((p->tb_time == 0) || (p->profile != pipe_profile_id)) {
+			continue;
+		}
+
+		s->tc_ov_n = s->tc_ov_n - tc_ov_weight_old + profile->tc_ov_weight;
+		s->tc_ov_rate += pipe_tc_ov_rate_new - pipe_tc_ov_rate_old;
+	}
+
+	rte_sched_port_config_subport_tc_ov_wm(port);
+#endif
+
+	return 0;
+}
+
 int
 rte_sched_subport_read_stats(struct rte_sched_port *port,
 	uint32_t subport_id,
@@ -911,12 +1172,12 @@ rte_sched_subport_read_stats(struct rte_sched_port *port,
 
 	/* Check user parameters */
 	if ((port == NULL) ||
-	    (subport_id >= port->n_subports_per_port) ||
+	    (rte_sched_port_subport_index(port, subport_id) >= port->n_subports_per_port) ||
 		(stats == NULL) ||
 		(tc_ov == NULL)) {
 		return -1;
 	}
-	s = port->subport + subport_id;
+	s = port->subport + rte_sched_port_subport_index(port, subport_id);
 
 	/* Copy subport stats and clear */
 	memcpy(stats, &s->stats, sizeof(struct rte_sched_subport_stats));
@@ -936,16 +1197,20 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 {
 	struct rte_sched_queue *q;
 	struct rte_sched_queue_extra *qe;
+	uint32_t qindex;
 
 	/* Check user parameters */
-	if ((port == NULL) ||
-	    (queue_id >= rte_sched_port_queues_per_port(port)) ||
+	if (port == NULL) {
+		return -1;
+	}
+	qindex = queue_id - port->subport_base * port->n_pipes_per_subport * port->n_queues_per_pipe;
+	if ((qindex >= rte_sched_port_queues_per_port(port)) ||
 		(stats == NULL) ||
 		(qlen == NULL)) {
 		return -1;
 	}
-	q = port->queue + queue_id;
-	qe = port->queue_extra + queue_id;
+	q = port->queue + qindex;
+	qe = port->queue_extra + qindex;
 
 	/* Copy queue stats and clear */
 	memcpy(stats, &qe->stats, sizeof(struct rte_sched_queue_stats));
@@ -957,14 +1222,64 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 	return 0;
 }
 
+int
+rte_sched_pipe_read_stats_bulk(struct rte_sched_port *port,
+	uint32_t subport_id,
+	uint32_t pipe_id,
+	uint32_t n_pipes,
+	struct rte_sched_pipe_stats *stats)
+{
+#ifdef RTE_SCHED_COLLECT_STATS
+	struct rte_sched_queue_extra *qe;
+	uint32_t subport_index, i;
+#endif
+
+	/* Check user parameters */
+	if ((port == NULL) ||
+	    (rte_sched_port_subport_index(port, subport_id) >= port->n_subports_per_port) ||
+	    (pipe_id >= port->n_pipes_per_subport) ||
+	    (n_pipes > port->n_pipes_per_subport - pipe_id) ||
+	    (stats == NULL)) {
+		return -1;
+	}
+
+#ifndef RTE_SCHED_COLLECT_STATS
+	/* The queue counters are not maintained */
+	return -ENOTSUP;
+#else
+	subport_index = rte_sched_port_subport_index(port, subport_id);
+
+	/* The counters are only read, never cleared, so the scheduler lcore is not disturbed */
+	qe = port->queue_extra +
+		((subport_index * port->n_pipes_per_subport + pipe_id) << port->pipe_queue_bits);
+	for (i = 0; i < n_pipes; i ++) {
+		struct rte_sched_pipe_stats *ps = stats + i;
+		uint32_t tc, q;
+
+		rte_prefetch0(qe + port->n_queues_per_pipe);
+		memset(ps, 0, sizeof(struct rte_sched_pipe_stats));
+
+		for (tc = 0; tc < port->n_traffic_classes; tc ++) {
+			for (q = 0; q < port->n_queues_per_traffic_class; q ++, qe ++) {
+				ps->n_pkts_tc[tc] += qe->stats.n_pkts;
+				ps->n_pkts_tc_dropped[tc] += qe->stats.n_pkts_dropped;
+				ps->n_bytes_tc[tc] += qe->stats.n_bytes;
+				ps->n_bytes_tc_dropped[tc] += qe->stats.n_bytes_dropped;
+			}
+		}
+	}
+
+	return 0;
+#endif
+}
+
 static inline uint32_t
 rte_sched_port_qindex(struct rte_sched_port *port, uint32_t subport, uint32_t pipe, uint32_t traffic_class, uint32_t queue)
 {
 	uint32_t result;
 
-	result = subport * port->n_pipes_per_subport + pipe;
-	result = result * RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE + traffic_class;
-	result = result * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + queue;
+	result = rte_sched_port_subport_index(port, subport) * port->n_pipes_per_subport + pipe;
+	result = (result << port->pipe_queue_bits) | (traffic_class << port->queue_bits) | queue;
 
 	return result;
 }
@@ -972,16 +1287,22 @@ rte_sched_port_qindex(struct rte_sched_port *port, uint32_t subport, uint32_t pi
 static inline struct rte_mbuf **
 rte_sched_port_qbase(struct rte_sched_port *port, uint32_t qindex)
 {
-	uint32_t pindex = qindex >> 4;
-	uint32_t qpos = qindex & 0xF;
+	uint32_t pindex = qindex >> port->pipe_queue_bits;
+	uint32_t qpos = qindex & (port->n_queues_per_pipe - 1);
 
 	return (port->queue_array + pindex * port->qsize_sum + port->qsize_add[qpos]);
 }
 
+static inline uint32_t
+rte_sched_port_qindex_tc(struct rte_sched_port *port, uint32_t qindex)
+{
+	return (qindex >> port->queue_bits) & (port->n_traffic_classes - 1);
+}
+
 static inline uint16_t
 rte_sched_port_qsize(struct rte_sched_port *port, uint32_t qindex)
 {
-	uint32_t tc = (qindex >> 2) & 0x3;
+	uint32_t tc = rte_sched_port_qindex_tc(port, qindex);
 
 	return port->qsize[tc];
 }
@@ -1014,7 +1335,7 @@ static inline void
 rte_sched_port_update_subport_stats(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt)
 {
 	struct rte_sched_subport *s = port->subport + (qindex / rte_sched_port_queues_per_subport(port));
-	uint32_t tc_index = (qindex >> 2) & 0x3;
+	uint32_t tc_index = rte_sched_port_qindex_tc(port, qindex);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	s->stats.n_pkts_tc[tc_index] += 1;
@@ -1025,7 +1346,7 @@ static inline void
 rte_sched_port_update_subport_stats_on_drop(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt)
 {
 	struct rte_sched_subport *s = port->subport + (qindex / rte_sched_port_queues_per_subport(port));
-	uint32_t tc_index = (qindex >> 2) & 0x3;
+	uint32_t tc_index = rte_sched_port_qindex_tc(port, qindex);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	s->stats.n_pkts_tc_dropped[tc_index] += 1;
@@ -1065,7 +1386,7 @@ rte_sched_port_red_drop(struct rte_sched_port *port, struct rte_mbuf *pkt, uint3
 	uint32_t tc_index;
 	enum rte_meter_color color;
 
-	tc_index = (qindex >> 2) & 0x3;
+	tc_index = rte_sched_port_qindex_tc(port, qindex);
 	color = rte_sched_port_pkt_read_color(pkt);
 	red_cfg = &port->red_config[tc_index][color];
 
@@ -1102,9 +1423,9 @@ debug_pipe_is_empty(struct rte_sched_port *port, uint32_t pindex)
 {
 	uint32_t qindex, i;
 
-	qindex = pindex << 4;
+	qindex = pindex << port->pipe_queue_bits;
 
-	for (i = 0; i < 16; i ++){
+	for (i = 0; i < port->n_queues_per_pipe; i ++){
 		uint32_t queue_empty = rte_sched_port_queue_is_empty(port, qindex + i);
 		uint32_t bmp_bit_clear = (rte_bitmap_get(port->bmp, qindex + i) == 0);
 
@@ -1443,19 +1764,15 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Subport TCs */
 	if (unlikely(port->time >= subport->tc_time)) {
-		subport->tc_credits[0] = subport->tc_credits_per_period[0];
-		subport->tc_credits[1] = subport->tc_credits_per_period[1];
-		subport->tc_credits[2] = subport->tc_credits_per_period[2];
-		subport->tc_credits[3] = subport->tc_credits_per_period[3];
+		memcpy(subport->tc_credits, subport->tc_credits_per_period,
+			port->n_traffic_classes * sizeof(uint32_t));
 		subport->tc_time = port->time + subport->tc_period;
 	}
 
 	/* Pipe TCs */
 	if (unlikely(port->time >= pipe->tc_time)) {
-		pipe->tc_credits[0] = params->tc_credits_per_period[0];
-		pipe->tc_credits[1] = params->tc_credits_per_period[1];
-		pipe->tc_credits[2] = params->tc_credits_per_period[2];
-		pipe->tc_credits[3] = params->tc_credits_per_period[3];
+		memcpy(pipe->tc_credits, params->tc_credits_per_period,
+			port->n_traffic_classes * sizeof(uint32_t));
 		pipe->tc_time = port->time + params->tc_period;
 	}
 }
@@ -1467,23 +1784,23 @@ grinder_tc_ov_credits_update(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_subport *subport = grinder->subport;
-	uint32_t tc_ov_consumption[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t tc_ov_consumption_max;
+	uint32_t tc_ov_index = port->tc_ov_index;
+	uint32_t tc_ov_consumption, tc_ov_consumption_max;
 	uint32_t tc_ov_wm = subport->tc_ov_wm;
+	uint32_t i;
 
 	if (subport->tc_ov == 0) {
 		return subport->tc_ov_wm_max;
 	}
 
-	tc_ov_consumption[0] = subport->tc_credits_per_period[0] - subport->tc_credits[0];
-	tc_ov_consumption[1] = subport->tc_credits_per_period[1] - subport->tc_credits[1];
-	tc_ov_consumption[2] = subport->tc_credits_per_period[2] - subport->tc_credits[2];
-	tc_ov_consumption[3] = subport->tc_credits_per_period[3] - subport->tc_credits[3];
-
-	tc_ov_consumption_max = subport->tc_credits_per_period[3] -
-		(tc_ov_consumption[0] + tc_ov_consumption[1] + tc_ov_consumption[2]);
+	/* Credits of the last TC left over by the higher priority TCs */
+	tc_ov_consumption_max = subport->tc_credits_per_period[tc_ov_index];
+	for (i = 0; i < tc_ov_index; i ++) {
+		tc_ov_consumption_max -= subport->tc_credits_per_period[i] - subport->tc_credits[i];
+	}
+	tc_ov_consumption = subport->tc_credits_per_period[tc_ov_index] - subport->tc_credits[tc_ov_index];
 
-	if (tc_ov_consumption[3] > (tc_ov_consumption_max - port->mtu)) {
+	if (tc_ov_consumption > (tc_ov_consumption_max - port->mtu)) {
 		tc_ov_wm  -= tc_ov_wm >> 7;
 		if (tc_ov_wm < subport->tc_ov_wm_min) {
 			tc_ov_wm = subport->tc_ov_wm_min;
@@ -1523,10 +1840,8 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 	if (unlikely(port->time >= subport->tc_time)) {
 		subport->tc_ov_wm = grinder_tc_ov_credits_update(port, pos);
 
-		subport->tc_credits[0] = subport->tc_credits_per_period[0];
-		subport->tc_credits[1] = subport->tc_credits_per_period[1];
-		subport->tc_credits[2] = subport->tc_credits_per_period[2];
-		subport->tc_credits[3] = subport->tc_credits_per_period[3];
+		memcpy(subport->tc_credits, subport->tc_credits_per_period,
+			port->n_traffic_classes * sizeof(uint32_t));
 
 		subport->tc_time = port->time + subport->tc_period;
 		subport->tc_ov_period_id ++;
@@ -1534,10 +1849,8 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Pipe TCs */
 	if (unlikely(port->time >= pipe->tc_time)) {
-		pipe->tc_credits[0] = params->tc_credits_per_period[0];
-		pipe->tc_credits[1] = params->tc_credits_per_period[1];
-		pipe->tc_credits[2] = params->tc_credits_per_period[2];
-		pipe->tc_credits[3] = params->tc_credits_per_period[3];
+		memcpy(pipe->tc_credits, params->tc_credits_per_period,
+			port->n_traffic_classes * sizeof(uint32_t));
 		pipe->tc_time = port->time + params->tc_period;
 	}
 
@@ -1604,9 +1917,8 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 	uint32_t subport_tc_credits = subport->tc_credits[tc_index];
 	uint32_t pipe_tb_credits = pipe->tb_credits;
 	uint32_t pipe_tc_credits = pipe->tc_credits[tc_index];
-	uint32_t pipe_tc_ov_mask1[] = {UINT32_MAX, UINT32_MAX, UINT32_MAX, pipe->tc_ov_credits};
-	uint32_t pipe_tc_ov_mask2[] = {0, 0, 0, UINT32_MAX};
-	uint32_t pipe_tc_ov_credits = pipe_tc_ov_mask1[tc_index];
+	uint32_t pipe_tc_ov_mask = (tc_index == port->tc_ov_index) ? UINT32_MAX : 0;
+	uint32_t pipe_tc_ov_credits = (pipe->tc_ov_credits & pipe_tc_ov_mask) | ~pipe_tc_ov_mask;
 	int enough_credits;
 
 	/* Check pipe and subport credits */
@@ -1625,7 +1937,7 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 	subport->tc_credits[tc_index] -= pkt_len;
 	pipe->tb_credits -= pkt_len;
 	pipe->tc_credits[tc_index] -= pkt_len;
-	pipe->tc_ov_credits -= pipe_tc_ov_mask2[tc_index] & pkt_len;
+	pipe->tc_ov_credits -= pipe_tc_ov_mask & pkt_len;
 
 	return 1;
 }
@@ -1650,6 +1962,7 @@ grinder_schedule(struct rte_sched_port *port, uint32_t pos)
 
 	/* Advance port time */
 	port->time += pkt_len;
+	port->port_credits -= pkt_len;
 
 	/* Send packet */
 	port->pkts_out[port->n_pkts_out ++] = pkt;
@@ -1677,11 +1990,15 @@ static inline int
 grinder_pipe_exists(struct rte_sched_port *port, uint32_t base_pipe)
 {
 	__m128i index = _mm_set1_epi32 (base_pipe);
-	__m128i pipes = _mm_load_si128((__m128i *)port->grinder_base_bmp_pos);
-	__m128i res = _mm_cmpeq_epi32(pipes, index);
-	pipes = _mm_load_si128((__m128i *)(port->grinder_base_bmp_pos + 4));
-	pipes = _mm_cmpeq_epi32(pipes, index);
-	res = _mm_or_si128(res, pipes);
+	__m128i res = _mm_setzero_si128();
+	uint32_t i;
+
+	/* Unused grinders hold an invalid position, so all of them can be compared */
+	for (i = 0; i < RTE_SCHED_PORT_N_GRINDERS; i += 4) {
+		__m128i pipes = _mm_load_si128((__m128i *)(port->grinder_base_bmp_pos + i));
+
+		res = _mm_or_si128(res, _mm_cmpeq_epi32(pipes, index));
+	}
 
 	if (_mm_testz_si128(res, res))
 		return 0;
@@ -1696,7 +2013,7 @@ grinder_pipe_exists(struct rte_sched_port *port, uint32_t base_pipe)
 {
 	uint32_t i;
 
-	for (i = 0; i < RTE_SCHED_PORT_N_GRINDERS; i ++) {
+	for (i = 0; i < port->n_grinders; i ++) {
 		if (port->grinder_base_bmp_pos[i] == base_pipe) {
 			return 1;
 		}
@@ -1711,62 +2028,92 @@ static inline void
 grinder_pcache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t bmp_pos, uint64_t bmp_slab)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint16_t w[4];
+	uint32_t i;
 
 	grinder->pcache_w = 0;
 	grinder->pcache_r = 0;
 
-	w[0] = (uint16_t) bmp_slab;
-	w[1] = (uint16_t) (bmp_slab >> 16);
-	w[2] = (uint16_t) (bmp_slab >> 32);
-	w[3] = (uint16_t) (bmp_slab >> 48);
+	/* Default layout: 4 pipes of 16 queues per bitmap slab */
+	if (likely(port->n_queues_per_pipe == 16)) {
+		uint16_t w[4];
+
+		w[0] = (uint16_t) bmp_slab;
+		w[1] = (uint16_t) (bmp_slab >> 16);
+		w[2] = (uint16_t) (bmp_slab >> 32);
+		w[3] = (uint16_t) (bmp_slab >> 48);
 
-	grinder->pcache_qmask[grinder->pcache_w] = w[0];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos;
-	grinder->pcache_w += (w[0] != 0);
+		grinder->pcache_qmask[grinder->pcache_w] = w[0];
+		grinder->pcache_qindex[grinder->pcache_w] = bmp_pos;
+		grinder->pcache_w += (w[0] != 0);
 
-	grinder->pcache_qmask[grinder->pcache_w] = w[1];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 16;
-	grinder->pcache_w += (w[1] != 0);
+		grinder->pcache_qmask[grinder->pcache_w] = w[1];
+		grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 16;
+		grinder->pcache_w += (w[1] != 0);
 
-	grinder->pcache_qmask[grinder->pcache_w] = w[2];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 32;
-	grinder->pcache_w += (w[2] != 0);
+		grinder->pcache_qmask[grinder->pcache_w] = w[2];
+		grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 32;
+		grinder->pcache_w += (w[2] != 0);
 
-	grinder->pcache_qmask[grinder->pcache_w] = w[3];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 48;
-	grinder->pcache_w += (w[3] != 0);
+		grinder->pcache_qmask[grinder->pcache_w] = w[3];
+		grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 48;
+		grinder->pcache_w += (w[3] != 0);
+
+		return;
+	}
+
+	for (i = 0; i < RTE_BITMAP_SLAB_BIT_SIZE; i += port->n_queues_per_pipe) {
+		uint64_t w = (bmp_slab >> i) & port->pipe_qmask;
+
+		grinder->pcache_qmask[grinder->pcache_w] = w;
+		grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + i;
+		grinder->pcache_w += (w != 0);
+	}
 }
 
 static inline void
-grinder_tccache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t qindex, uint16_t qmask)
+grinder_tccache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t qindex, uint64_t qmask)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint8_t b[4];
+	uint32_t i;
 
 	grinder->tccache_w = 0;
 	grinder->tccache_r = 0;
 
-	b[0] = (uint8_t) (qmask & 0xF);
-	b[1] = (uint8_t) ((qmask >> 4) & 0xF);
-	b[2] = (uint8_t) ((qmask >> 8) & 0xF);
-	b[3] = (uint8_t) ((qmask >> 12) & 0xF);
+	/* Default layout: 4 traffic classes of 4 queues */
+	if (likely(port->n_queues_per_pipe == 16)) {
+		uint8_t b[4];
+
+		b[0] = (uint8_t) (qmask & 0xF);
+		b[1] = (uint8_t) ((qmask >> 4) & 0xF);
+		b[2] = (uint8_t) ((qmask >> 8) & 0xF);
+		b[3] = (uint8_t) ((qmask >> 12) & 0xF);
+
+		grinder->tccache_qmask[grinder->tccache_w] = b[0];
+		grinder->tccache_qindex[grinder->tccache_w] = qindex;
+		grinder->tccache_w += (b[0] != 0);
 
-	grinder->tccache_qmask[grinder->tccache_w] = b[0];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex;
-	grinder->tccache_w += (b[0] != 0);
+		grinder->tccache_qmask[grinder->tccache_w] = b[1];
+		grinder->tccache_qindex[grinder->tccache_w] = qindex + 4;
+		grinder->tccache_w += (b[1] != 0);
 
-	grinder->tccache_qmask[grinder->tccache_w] = b[1];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 4;
-	grinder->tccache_w += (b[1] != 0);
+		grinder->tccache_qmask[grinder->tccache_w] = b[2];
+		grinder->tccache_qindex[grinder->tccache_w] = qindex + 8;
+		grinder->tccache_w += (b[2] != 0);
+
+		grinder->tccache_qmask[grinder->tccache_w] = b[3];
+		grinder->tccache_qindex[grinder->tccache_w] = qindex + 12;
+		grinder->tccache_w += (b[3] != 0);
+
+		return;
+	}
 
-	grinder->tccache_qmask[grinder->tccache_w] = b[2];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 8;
-	grinder->tccache_w += (b[2] != 0);
+	for (i = 0; i < port->n_queues_per_pipe; i += port->n_queues_per_traffic_class) {
+		uint8_t b = (uint8_t) ((qmask >> i) & port->tc_qmask);
 
-	grinder->tccache_qmask[grinder->tccache_w] = b[3];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 12;
-	grinder->tccache_w += (b[3] != 0);
+		grinder->tccache_qmask[grinder->tccache_w] = b;
+		grinder->tccache_qindex[grinder->tccache_w] = qindex + i;
+		grinder->tccache_w += (b != 0);
+	}
 }
 
 static inline int
@@ -1774,7 +2121,7 @@ grinder_next_tc(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_mbuf **qbase;
-	uint32_t qindex;
+	uint32_t qindex, i;
 	uint16_t qsize;
 
 	if (grinder->tccache_r == grinder->tccache_w) {
@@ -1785,24 +2132,32 @@ grinder_next_tc(struct rte_sched_port *port, uint32_t pos)
 	qbase = rte_sched_port_qbase(port, qindex);
 	qsize = rte_sched_port_qsize(port, qindex);
 
-	grinder->tc_index = (qindex >> 2) & 0x3;
+	grinder->tc_index = rte_sched_port_qindex_tc(port, qindex);
 	grinder->qmask = grinder->tccache_qmask[grinder->tccache_r];
 	grinder->qsize = qsize;
 
-	grinder->qindex[0] = qindex;
-	grinder->qindex[1] = qindex + 1;
-	grinder->qindex[2] = qindex + 2;
-	grinder->qindex[3] = qindex + 3;
-
-	grinder->queue[0] = port->queue + qindex;
-	grinder->queue[1] = port->queue + qindex + 1;
-	grinder->queue[2] = port->queue + qindex + 2;
-	grinder->queue[3] = port->queue + qindex + 3;
-
-	grinder->qbase[0] = qbase;
-	grinder->qbase[1] = qbase + qsize;
-	grinder->qbase[2] = qbase + 2 * qsize;
-	grinder->qbase[3] = qbase + 3 * qsize;
+	if (likely(port->n_queues_per_traffic_class == 4)) {
+		grinder->qindex[0] = qindex;
+		grinder->qindex[1] = qindex + 1;
+		grinder->qindex[2] = qindex + 2;
+		grinder->qindex[3] = qindex + 3;
+
+		grinder->queue[0] = port->queue + qindex;
+		grinder->queue[1] = port->queue + qindex + 1;
+		grinder->queue[2] = port->queue + qindex + 2;
+		grinder->queue[3] = port->queue + qindex + 3;
+
+		grinder->qbase[0] = qbase;
+		grinder->qbase[1] = qbase + qsize;
+		grinder->qbase[2] = qbase + 2 * qsize;
+		grinder->qbase[3] = qbase + 3 * qsize;
+	} else {
+		for (i = 0; i < port->n_queues_per_traffic_class; i ++) {
+			grinder->qindex[i] = qindex + i;
+			grinder->queue[i] = port->queue + qindex + i;
+			grinder->qbase[i] = qbase + i * qsize;
+		}
+	}
 
 	grinder->tccache_r ++;
 	return 1;
@@ -1813,7 +2168,7 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	uint32_t pipe_qindex;
-	uint16_t pipe_qmask;
+	uint64_t pipe_qmask;
 
 	if (grinder->pcache_r < grinder->pcache_w) {
 		pipe_qmask = grinder->pcache_qmask[grinder->pcache_r];
@@ -1848,7 +2203,7 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 	}
 
 	/* Install new pipe in the grinder */
-	grinder->pindex = pipe_qindex >> 4;
+	grinder->pindex = pipe_qindex >> port->pipe_queue_bits;
 	grinder->subport = port->subport + (grinder->pindex / port->n_pipes_per_subport);
 	grinder->pipe = port->pipe + grinder->pindex;
 	grinder->pipe_params = NULL; /* to be set after the pipe structure is prefetched */
@@ -1893,24 +2248,34 @@ grinder_wrr_load(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_pipe_profile *pipe_params = grinder->pipe_params;
 	uint32_t tc_index = grinder->tc_index;
 	uint32_t qmask = grinder->qmask;
-	uint32_t qindex;
+	uint32_t qindex, i;
+
+	qindex = tc_index << port->queue_bits;
 
-	qindex = tc_index * 4;
+	if (likely(port->n_queues_per_traffic_class == 4)) {
+		grinder->wrr_tokens[0] = ((uint16_t) pipe->wrr_tokens[qindex]) << RTE_SCHED_WRR_SHIFT;
+		grinder->wrr_tokens[1] = ((uint16_t) pipe->wrr_tokens[qindex + 1]) << RTE_SCHED_WRR_SHIFT;
+		grinder->wrr_tokens[2] = ((uint16_t) pipe->wrr_tokens[qindex + 2]) << RTE_SCHED_WRR_SHIFT;
+		grinder->wrr_tokens[3] = ((uint16_t) pipe->wrr_tokens[qindex + 3]) << RTE_SCHED_WRR_SHIFT;
 
-	grinder->wrr_tokens[0] = ((uint16_t) pipe->wrr_tokens[qindex]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[1] = ((uint16_t) pipe->wrr_tokens[qindex + 1]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[2] = ((uint16_t) pipe->wrr_tokens[qindex + 2]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[3] = ((uint16_t) pipe->wrr_tokens[qindex + 3]) << RTE_SCHED_WRR_SHIFT;
+		grinder->wrr_mask[0] = (qmask & 0x1) * 0xFFFF;
+		grinder->wrr_mask[1] = ((qmask >> 1) & 0x1) * 0xFFFF;
+		grinder->wrr_mask[2] = ((qmask >> 2) & 0x1) * 0xFFFF;
+		grinder->wrr_mask[3] = ((qmask >> 3) & 0x1) * 0xFFFF;
 
-	grinder->wrr_mask[0] = (qmask & 0x1) * 0xFFFF;
-	grinder->wrr_mask[1] = ((qmask >> 1) & 0x1) * 0xFFFF;
-	grinder->wrr_mask[2] = ((qmask >> 2) & 0x1) * 0xFFFF;
-	grinder->wrr_mask[3] = ((qmask >> 3) & 0x1) * 0xFFFF;
+		grinder->wrr_cost[0] = pipe_params->wrr_cost[qindex];
+		grinder->wrr_cost[1] = pipe_params->wrr_cost[qindex + 1];
+		grinder->wrr_cost[2] = pipe_params->wrr_cost[qindex + 2];
+		grinder->wrr_cost[3] = pipe_params->wrr_cost[qindex + 3];
 
-	grinder->wrr_cost[0] = pipe_params->wrr_cost[qindex];
-	grinder->wrr_cost[1] = pipe_params->wrr_cost[qindex + 1];
-	grinder->wrr_cost[2] = pipe_params->wrr_cost[qindex + 2];
-	grinder->wrr_cost[3] = pipe_params->wrr_cost[qindex + 3];
+		return;
+	}
+
+	for (i = 0; i < port->n_queues_per_traffic_class; i ++) {
+		grinder->wrr_tokens[i] = ((uint16_t) pipe->wrr_tokens[qindex + i]) << RTE_SCHED_WRR_SHIFT;
+		grinder->wrr_mask[i] = ((qmask >> i) & 0x1) * 0xFFFF;
+		grinder->wrr_cost[i] = pipe_params->wrr_cost[qindex + i];
+	}
 }
 
 static inline void
@@ -1919,14 +2284,22 @@ grinder_wrr_store(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	uint32_t tc_index = grinder->tc_index;
-	uint32_t qindex;
+	uint32_t qindex, i;
 
-	qindex = tc_index * 4;
+	qindex = tc_index << port->queue_bits;
 
-	pipe->wrr_tokens[qindex] = (uint8_t) ((grinder->wrr_tokens[0] & grinder->wrr_mask[0]) >> RTE_SCHED_WRR_SHIFT);
-	pipe->wrr_tokens[qindex + 1] = (uint8_t) ((grinder->wrr_tokens[1] & grinder->wrr_mask[1]) >> RTE_SCHED_WRR_SHIFT);
-	pipe->wrr_tokens[qindex + 2] = (uint8_t) ((grinder->wrr_tokens[2] & grinder->wrr_mask[2]) >> RTE_SCHED_WRR_SHIFT);
-	pipe->wrr_tokens[qindex + 3] = (uint8_t) ((grinder->wrr_tokens[3] & grinder->wrr_mask[3]) >> RTE_SCHED_WRR_SHIFT);
+	if (likely(port->n_queues_per_traffic_class == 4)) {
+		pipe->wrr_tokens[qindex] = (uint8_t) ((grinder->wrr_tokens[0] & grinder->wrr_mask[0]) >> RTE_SCHED_WRR_SHIFT);
+		pipe->wrr_tokens[qindex + 1] = (uint8_t) ((grinder->wrr_tokens[1] & grinder->wrr_mask[1]) >> RTE_SCHED_WRR_SHIFT);
+		pipe->wrr_tokens[qindex + 2] = (uint8_t) ((grinder->wrr_tokens[2] & grinder->wrr_mask[2]) >> RTE_SCHED_WRR_SHIFT);
+		pipe->wrr_tokens[qindex + 3] = (uint8_t) ((grinder->wrr_tokens[3] & grinder->wrr_mask[3]) >> RTE_SCHED_WRR_SHIFT);
+
+		return;
+	}
+
+	for (i = 0; i < port->n_queues_per_traffic_class; i ++) {
+		pipe->wrr_tokens[qindex + i] = (uint8_t) ((grinder->wrr_tokens[i] & grinder->wrr_mask[i]) >> RTE_SCHED_WRR_SHIFT);
+	}
 }
 
 static inline void
@@ -1934,19 +2307,35 @@ grinder_wrr(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	uint16_t wrr_tokens_min;
+	uint32_t i;
+
+	if (likely(port->n_queues_per_traffic_class == 4)) {
+		grinder->wrr_tokens[0] |= ~grinder->wrr_mask[0];
+		grinder->wrr_tokens[1] |= ~grinder->wrr_mask[1];
+		grinder->wrr_tokens[2] |= ~grinder->wrr_mask[2];
+		grinder->wrr_tokens[3] |= ~grinder->wrr_mask[3];
 
-	grinder->wrr_tokens[0] |= ~grinder->wrr_mask[0];
-	grinder->wrr_tokens[1] |= ~grinder->wrr_mask[1];
-	grinder->wrr_tokens[2] |= ~grinder->wrr_mask[2];
-	grinder->wrr_tokens[3] |= ~grinder->wrr_mask[3];
+		grinder->qpos = rte_min_pos_4_u16(grinder->wrr_tokens);
+		wrr_tokens_min = grinder->wrr_tokens[grinder->qpos];
+
+		grinder->wrr_tokens[0] -= wrr_tokens_min;
+		grinder->wrr_tokens[1] -= wrr_tokens_min;
+		grinder->wrr_tokens[2] -= wrr_tokens_min;
+		grinder->wrr_tokens[3] -= wrr_tokens_min;
+
+		return;
+	}
+
+	for (i = 0; i < port->n_queues_per_traffic_class; i ++) {
+		grinder->wrr_tokens[i] |= ~grinder->wrr_mask[i];
+	}
 
-	grinder->qpos = rte_min_pos_4_u16(grinder->wrr_tokens);
+	grinder->qpos = rte_min_pos_n_u16(grinder->wrr_tokens, port->n_queues_per_traffic_class);
 	wrr_tokens_min = grinder->wrr_tokens[grinder->qpos];
 
-	grinder->wrr_tokens[0] -= wrr_tokens_min;
-	grinder->wrr_tokens[1] -= wrr_tokens_min;
-	grinder->wrr_tokens[2] -= wrr_tokens_min;
-	grinder->wrr_tokens[3] -= wrr_tokens_min;
+	for (i = 0; i < port->n_queues_per_traffic_class; i ++) {
+		grinder->wrr_tokens[i] -= wrr_tokens_min;
+	}
 }
 
 #else
@@ -1970,22 +2359,36 @@ static inline void
 grinder_prefetch_tc_queue_arrays(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint16_t qsize, qr[4];
+	uint16_t qsize, qr[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
+	uint32_t i;
 
 	qsize = grinder->qsize;
-	qr[0] = grinder->queue[0]->qr & (qsize - 1);
-	qr[1] = grinder->queue[1]->qr & (qsize - 1);
-	qr[2] = grinder->queue[2]->qr & (qsize - 1);
-	qr[3] = grinder->queue[3]->qr & (qsize - 1);
 
-	rte_prefetch0(grinder->qbase[0] + qr[0]);
-	rte_prefetch0(grinder->qbase[1] + qr[1]);
+	if (likely(port->n_queues_per_traffic_class == 4)) {
+		qr[0] = grinder->queue[0]->qr & (qsize - 1);
+		qr[1] = grinder->queue[1]->qr & (qsize - 1);
+		qr[2] = grinder->queue[2]->qr & (qsize - 1);
+		qr[3] = grinder->queue[3]->qr & (qsize - 1);
+
+		rte_prefetch0(grinder->qbase[0] + qr[0]);
+		rte_prefetch0(grinder->qbase[1] + qr[1]);
+
+		grinder_wrr_load(port, pos);
+		grinder_wrr(port, pos);
+
+		rte_prefetch0(grinder->qbase[2] + qr[2]);
+		rte_prefetch0(grinder->qbase[3] + qr[3]);
+
+		return;
+	}
+
+	for (i = 0; i < port->n_queues_per_traffic_class; i ++) {
+		qr[i] = grinder->queue[i]->qr & (qsize - 1);
+		rte_prefetch0(grinder->qbase[i] + qr[i]);
+	}
 
 	grinder_wrr_load(port, pos);
 	grinder_wrr(port, pos);
-
-	rte_prefetch0(grinder->qbase[2] + qr[2]);
-	rte_prefetch0(grinder->qbase[3] + qr[3]);
 }
 
 static inline void
@@ -2127,6 +2530,66 @@ rte_sched_port_exceptions(struct rte_sched_port *port, int second_pass)
 	return exceptions;
 }
 
+static inline void
+rte_sched_port_group_credits_get(struct rte_sched_port *port, uint32_t n_pkts)
+{
+	struct rte_sched_port_group *group = port->group;
+	int64_t credits;
+	uint64_t time;
+
+	if (likely(group == NULL)) {
+		port->port_credits = INT64_MAX;
+		return;
+	}
+
+	rte_spinlock_lock(&group->tb.lock);
+
+	/* Refill the shared output port bucket */
+	time = (uint64_t) (((double) (rte_get_tsc_cycles() - group->tb.time_cpu_cycles)) /
+		group->tb.cycles_per_byte);
+	group->tb.credits += (int64_t) (time - group->tb.time);
+	group->tb.time = time;
+	if (group->tb.credits > group->tb.size) {
+		group->tb.credits = group->tb.size;
+	}
+
+	/* Take no more than a fair share of the bucket */
+	credits = (int64_t) n_pkts * port->mtu;
+	if (credits > group->tb.chunk) {
+		credits = group->tb.chunk;
+	}
+	if (credits > group->tb.credits) {
+		credits = group->tb.credits;
+	}
+	if (credits < 0) {
+		credits = 0;
+	}
+	group->tb.credits -= credits;
+
+	rte_spinlock_unlock(&group->tb.lock);
+
+	port->port_credits = credits;
+}
+
+static inline void
+rte_sched_port_group_credits_put(struct rte_sched_port *port)
+{
+	struct rte_sched_port_group *group = port->group;
+
+	if (likely(group == NULL) || (port->port_credits == 0)) {
+		return;
+	}
+
+	rte_spinlock_lock(&group->tb.lock);
+	group->tb.credits += port->port_credits;
+	if (group->tb.credits > group->tb.size) {
+		group->tb.credits = group->tb.size;
+	}
+	rte_spinlock_unlock(&group->tb.lock);
+
+	port->port_credits = 0;
+}
+
 int
 rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
 {
@@ -2136,15 +2599,231 @@ rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 	port->n_pkts_out = 0;
 
 	rte_sched_port_time_resync(port);
+	rte_sched_port_group_credits_get(port, n_pkts);
+	if (unlikely(port->port_credits < port->mtu)) {
+		rte_sched_port_group_credits_put(port);
+		return 0;
+	}
 
 	/* Take each queue in the grinder one step further */
 	for (i = 0, count = 0; ; i ++)  {
-		count += grinder_handle(port, i & (RTE_SCHED_PORT_N_GRINDERS - 1));
+		count += grinder_handle(port, i & (port->n_grinders - 1));
 		if ((count == n_pkts) ||
-		    rte_sched_port_exceptions(port, i >= RTE_SCHED_PORT_N_GRINDERS)) {
+		    (port->port_credits < port->mtu) ||
+		    rte_sched_port_exceptions(port, i >= port->n_grinders)) {
 			break;
 		}
 	}
 
+	rte_sched_port_group_credits_put(port);
+
+	return count;
+}
+
+/*
+ * Port group
+ *
+ ***/
+
+struct rte_sched_port_group *
+rte_sched_port_group_config(struct rte_sched_port_params *params, uint32_t n_shards)
+{
+	struct rte_sched_port_group *group;
+	struct rte_sched_port_params shard_params;
+	uint32_t i;
+
+	/* Check user parameters */
+	if ((rte_sched_port_check_params(params) != 0) ||
+	    (params->name == NULL) ||
+	    (n_shards == 0) ||
+	    (n_shards > RTE_SCHED_PORT_GROUP_SHARDS_MAX) ||
+	    (!rte_is_power_of_2(n_shards)) ||
+	    (n_shards > params->n_subports_per_port)) {
+		return NULL;
+	}
+
+	group = rte_zmalloc_socket("qos_group", sizeof(struct rte_sched_port_group),
+		RTE_CACHE_LINE_SIZE, params->socket);
+	if (group == NULL) {
+		return NULL;
+	}
+
+	group->n_shards = n_shards;
+	group->n_subports_per_shard = params->n_subports_per_port / n_shards;
+	group->frame_overhead = params->frame_overhead;
+	group->quantum = (int32_t) (params->mtu + params->frame_overhead);
+
+	/* Output port token bucket: one full dequeue burst per shard */
+	rte_spinlock_init(&group->tb.lock);
+	group->tb.time_cpu_cycles = rte_get_tsc_cycles();
+	group->tb.time = 0;
+	group->tb.chunk = (int64_t) RTE_SCHED_PORT_GROUP_BURST * group->quantum;
+	group->tb.size = group->tb.chunk * n_shards;
+	group->tb.credits = group->tb.size;
+	group->tb.cycles_per_byte = ((double) rte_get_tsc_hz()) / ((double) params->rate);
+
+	/* Each shard is a regular port owning a contiguous range of subports */
+	shard_params = *params;
+	shard_params.n_subports_per_port = group->n_subports_per_shard;
+
+	for (i = 0; i < n_shards; i ++) {
+		char ring_name[RTE_RING_NAMESIZE];
+
+		group->shard[i] = rte_sched_port_config(&shard_params);
+		if (group->shard[i] == NULL) {
+			RTE_LOG(INFO, SCHED, "Shard %u config error\n", i);
+			goto error;
+		}
+		group->shard[i]->group = group;
+		group->shard[i]->subport_base = i * group->n_subports_per_shard;
+
+		snprintf(ring_name, sizeof(ring_name), "%s_SHARD%u", params->name, i);
+		group->ring[i] = rte_ring_create(ring_name, RTE_SCHED_PORT_GROUP_RING_SIZE,
+			params->socket, RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (group->ring[i] == NULL) {
+			RTE_LOG(INFO, SCHED, "Shard %u ring create error\n", i);
+			goto error;
+		}
+	}
+
+	group->merge_pos = 0;
+	group->merge[0].deficit = group->quantum;
+
+	return group;
+
+error:
+	rte_sched_port_group_free(group);
+	return NULL;
+}
+
+void
+rte_sched_port_group_free(struct rte_sched_port_group *group)
+{
+	uint32_t i;
+
+	/* Check user parameters */
+	if (group == NULL) {
+		return;
+	}
+
+	for (i = 0; i < group->n_shards; i ++) {
+		rte_sched_port_free(group->shard[i]);
+		if (group->ring[i] != NULL) {
+			rte_ring_free(group->ring[i]);
+		}
+	}
+
+	rte_free(group);
+}
+
+struct rte_sched_port *
+rte_sched_port_group_shard(struct rte_sched_port_group *group, uint32_t shard_id)
+{
+	/* Check user parameters */
+	if ((group == NULL) || (shard_id >= group->n_shards)) {
+		return NULL;
+	}
+
+	return group->shard[shard_id];
+}
+
+int
+rte_sched_port_group_shard_id(struct rte_sched_port_group *group, uint32_t subport_id)
+{
+	uint32_t shard_id;
+
+	/* Check user parameters */
+	if (group == NULL) {
+		return -1;
+	}
+
+	shard_id = subport_id / group->n_subports_per_shard;
+	if (shard_id >= group->n_shards) {
+		return -1;
+	}
+
+	return (int) shard_id;
+}
+
+int
+rte_sched_port_group_shard_dequeue(struct rte_sched_port_group *group, uint32_t shard_id, uint32_t n_pkts)
+{
+	struct rte_mbuf *pkts[RTE_SCHED_PORT_GROUP_BURST];
+	struct rte_ring *ring;
+	uint32_t n_free;
+	int count;
+
+	if ((group == NULL) || (shard_id >= group->n_shards)) {
+		return -1;
+	}
+	ring = group->ring[shard_id];
+
+	/* Never dequeue more than the merge stage can take */
+	n_free = rte_ring_free_count(ring);
+	if (n_pkts > n_free) {
+		n_pkts = n_free;
+	}
+	if (n_pkts > RTE_SCHED_PORT_GROUP_BURST) {
+		n_pkts = RTE_SCHED_PORT_GROUP_BURST;
+	}
+	if (n_pkts == 0) {
+		return 0;
+	}
+
+	count = rte_sched_port_dequeue(group->shard[shard_id], pkts, n_pkts);
+
+	/* Single producer: the free space checked above is still available */
+	rte_ring_sp_enqueue_burst(ring, (void * const *) pkts, count);
+
+	return count;
+}
+
+static inline struct rte_mbuf *
+rte_sched_port_group_merge_peek(struct rte_sched_port_group *group, uint32_t shard_id)
+{
+	struct rte_sched_port_group_merge *m = &group->merge[shard_id];
+
+	if (m->pos == m->n_pkts) {
+		m->n_pkts = rte_ring_sc_dequeue_burst(group->ring[shard_id],
+			(void **) m->pkts, RTE_SCHED_PORT_GROUP_BURST);
+		m->pos = 0;
+		if (m->n_pkts == 0) {
+			return NULL;
+		}
+	}
+
+	return m->pkts[m->pos];
+}
+
+int
+rte_sched_port_group_dequeue(struct rte_sched_port_group *group, struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	uint32_t count, n_idle;
+
+	for (count = 0, n_idle = 0; (count < n_pkts) && (n_idle < group->n_shards); ) {
+		struct rte_sched_port_group_merge *m = &group->merge[group->merge_pos];
+		struct rte_mbuf *pkt;
+		int32_t pkt_len;
+
+		pkt = rte_sched_port_group_merge_peek(group, group->merge_pos);
+		if (pkt == NULL) {
+			m->deficit = 0;
+			n_idle ++;
+		} else {
+			n_idle = 0;
+			pkt_len = (int32_t) (pkt->pkt_len + group->frame_overhead);
+			if (pkt_len <= m->deficit) {
+				m->deficit -= pkt_len;
+				m->pos ++;
+				pkts[count ++] = pkt;
+				continue;
+			}
+		}
+
+		/* Move on to the next shard and grant it one quantum */
+		group->merge_pos = (group->merge_pos + 1) & (group->n_shards - 1);
+		group->merge[group->merge_pos].deficit += group->quantum;
+	}
+
 	return count;
 }
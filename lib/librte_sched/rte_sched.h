@@ -85,22 +85,55 @@ extern "C" {
 #include "rte_red.h"
 #endif
 
-/** Number of traffic classes per pipe (as well as subport). Cannot be changed. */
+/** Maximum number of traffic classes per pipe (as well as subport). Compile-time
+configurable to 4, 8 or 16; the number actually used is a port parameter. */
+#ifndef RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE
 #define RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE    4
+#endif
 
-/** Number of queues per pipe traffic class. Cannot be changed. */
+/** Maximum number of queues per pipe traffic class. Compile-time configurable
+to 4 or 8; the number actually used is a port parameter. */
+#ifndef RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS
 #define RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS    4
+#endif
 
-/** Number of queues per pipe. */
+/** Maximum number of queues per pipe. */
 #define RTE_SCHED_QUEUES_PER_PIPE             \
 	(RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE *     \
 	RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)
 
+#if RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE == 4
+#define RTE_SCHED_TRAFFIC_CLASS_BITS          2
+#elif RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE == 8
+#define RTE_SCHED_TRAFFIC_CLASS_BITS          3
+#elif RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE == 16
+#define RTE_SCHED_TRAFFIC_CLASS_BITS          4
+#else
+#error Number of traffic classes per pipe must be 4, 8 or 16
+#endif
+
+#if RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS == 4
+#define RTE_SCHED_QUEUE_BITS                  2
+#elif RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS == 8
+#define RTE_SCHED_QUEUE_BITS                  3
+#else
+#error Number of queues per traffic class must be 4 or 8
+#endif
+
+#if RTE_SCHED_QUEUES_PER_PIPE > 64
+#error Number of queues per pipe must not exceed 64 (one bitmap slab)
+#endif
+
 /** Maximum number of pipe profiles that can be defined per port. Compile-time configurable.*/
 #ifndef RTE_SCHED_PIPE_PROFILES_PER_PORT
 #define RTE_SCHED_PIPE_PROFILES_PER_PORT      256
 #endif
 
+/** Maximum number of shards a port group can be split into. Compile-time configurable.*/
+#ifndef RTE_SCHED_PORT_GROUP_SHARDS_MAX
+#define RTE_SCHED_PORT_GROUP_SHARDS_MAX       16
+#endif
+
 /** Ethernet framing overhead. Overhead fields per Ethernet frame:
    1. Preamble:                             7 bytes;
    2. Start of Frame Delimiter (SFD):       1 byte;
@@ -156,11 +189,28 @@ struct rte_sched_pipe_params {
 	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Pipe traffic class rates (measured in bytes per second) */
 	uint32_t tc_period;              /**< Enforcement period for pipe traffic class rates (measured in milliseconds) */
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-	uint8_t tc_ov_weight;            /**< Weight for the current pipe in the event of subport traffic class 3 oversubscription */
+	uint8_t tc_ov_weight;            /**< Weight for the current pipe in the event of subport oversubscription of the
+	                                      last (lowest priority) traffic class */
 #endif
 
 	/* Pipe queues */
-	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE]; /**< WRR weights for the queues of the current pipe */
+	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE]; /**< WRR weights for the queues of the current pipe, queue q
+	                                      of traffic class tc stored at entry (tc * n_queues_per_traffic_class + q) */
+};
+
+/** Pipe statistics, aggregated over the queues of each pipe traffic class */
+struct rte_sched_pipe_stats {
+	/* Packets */
+	uint32_t n_pkts_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Number of packets successfully written to current
+	                                      pipe for each traffic class */
+	uint32_t n_pkts_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Number of packets dropped by the current
+	                                      pipe for each traffic class due to pipe queues being full or congested */
+
+	/* Bytes */
+	uint32_t n_bytes_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Number of bytes successfully written to current
+	                                      pipe for each traffic class */
+	uint32_t n_bytes_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Number of bytes dropped by the current
+	                                      pipe for each traffic class due to pipe queues being full or congested */
 };
 
 /** Queue statistics */
@@ -183,6 +233,12 @@ struct rte_sched_port_params {
 	uint32_t frame_overhead;         /**< Framing overhead per packet (measured in bytes) */
 	uint32_t n_subports_per_port;    /**< Number of subports for the current port scheduler instance*/
 	uint32_t n_pipes_per_subport;    /**< Number of pipes for each port scheduler subport */
+	uint32_t n_traffic_classes;      /**< Number of traffic classes per pipe: power of 2, up to
+	                                      RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; 0 selects the maximum */
+	uint32_t n_queues_per_traffic_class; /**< Number of queues per pipe traffic class: power of 2, up to
+	                                      RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; 0 selects the maximum */
+	uint32_t n_grinders;             /**< Number of pipes scheduled in parallel by dequeue: power of 2, up to
+	                                      RTE_SCHED_PORT_N_GRINDERS; 0 selects the maximum */
 	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Packet queue size for each traffic class. All queues
 	                                      within the same pipe traffic class have the same size. Queues from
 										  different pipes serving the same traffic class have the same size. */
@@ -200,9 +256,10 @@ identify the destination queue for the current packet. Stored in the field hash.
 of struct rte_mbuf of each packet, typically written by the classification stage and read by
 scheduler enqueue.*/
 struct rte_sched_port_hierarchy {
-	uint32_t queue:2;                /**< Queue ID (0 .. 3) */
-	uint32_t traffic_class:2;        /**< Traffic class ID (0 .. 3)*/
-	uint32_t pipe:20;                /**< Pipe ID */
+	uint32_t queue:RTE_SCHED_QUEUE_BITS; /**< Queue ID within traffic class */
+	uint32_t traffic_class:RTE_SCHED_TRAFFIC_CLASS_BITS; /**< Traffic class ID (0 is the highest priority) */
+	uint32_t pipe:(24 - RTE_SCHED_QUEUE_BITS - RTE_SCHED_TRAFFIC_CLASS_BITS); /**< Pipe ID (20 bits with
+	                                      the default 4 traffic classes of 4 queues) */
 	uint32_t subport:6;              /**< Subport ID */
 	uint32_t color:2;                /**< Color */
 };
@@ -269,6 +326,45 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	uint32_t pipe_id,
 	int32_t pipe_profile);
 
+/**
+ * Hierarchical scheduler pipe profile add. Must be called from the lcore running
+ * the enqueue and dequeue operations of the port, or while they are stopped.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param params
+ *   Pipe profile parameters
+ * @param pipe_profile_id
+ *   Pointer to pre-allocated variable where the ID of the new pipe profile
+ *   should be stored
+ * @return
+ *   0 upon success, error code otherwise
+ */
+int
+rte_sched_port_pipe_profile_add(struct rte_sched_port *port,
+	struct rte_sched_pipe_params *params,
+	uint32_t *pipe_profile_id);
+
+/**
+ * Hierarchical scheduler pipe profile modify. The pipes using the profile are
+ * not reset: the new rates and weights apply from their next credit refill.
+ * Must be called from the lcore running the enqueue and dequeue operations of
+ * the port, or while they are stopped.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param pipe_profile_id
+ *   ID of existing pipe profile
+ * @param params
+ *   New pipe profile parameters
+ * @return
+ *   0 upon success, error code otherwise
+ */
+int
+rte_sched_port_pipe_profile_modify(struct rte_sched_port *port,
+	uint32_t pipe_profile_id,
+	struct rte_sched_pipe_params *params);
+
 /**
  * Hierarchical scheduler memory footprint size per port
  *
@@ -280,6 +376,67 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 uint32_t
 rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params);
 
+/**
+ * Port group: one output port whose subports are sharded across several
+ * lcores. Each shard is a regular port scheduler instance owning a contiguous
+ * range of subports, so subport and pipe IDs keep their port-wide values. The
+ * shards share the output port token bucket and their output is merged by a
+ * deficit round robin stage feeding the single output port.
+ */
+struct rte_sched_port_group;
+
+/**
+ * Hierarchical scheduler port group configuration
+ *
+ * @param params
+ *   Port scheduler configuration parameter structure describing the whole
+ *   output port; the name is used to build the shard output ring names
+ * @param n_shards
+ *   Number of shards (power of 2, no bigger than the number of subports)
+ * @return
+ *   Handle to port group instance upon success or NULL otherwise.
+ */
+struct rte_sched_port_group *
+rte_sched_port_group_config(struct rte_sched_port_params *params, uint32_t n_shards);
+
+/**
+ * Hierarchical scheduler port group free
+ *
+ * @param group
+ *   Handle to port group instance
+ */
+void
+rte_sched_port_group_free(struct rte_sched_port_group *group);
+
+/**
+ * Port group shard handle. The shard handle is used with the regular subport
+ * and pipe configuration, statistics and enqueue functions, all of them taking
+ * port-wide subport IDs. It must not be freed with rte_sched_port_free().
+ *
+ * @param group
+ *   Handle to port group instance
+ * @param shard_id
+ *   Shard ID
+ * @return
+ *   Handle to the shard port scheduler instance upon success or NULL otherwise.
+ */
+struct rte_sched_port *
+rte_sched_port_group_shard(struct rte_sched_port_group *group, uint32_t shard_id);
+
+/**
+ * Port group shard lookup. Typically used by the classification stage to steer
+ * each packet to the lcore running the shard that owns its subport.
+ *
+ * @param group
+ *   Handle to port group instance
+ * @param subport_id
+ *   Subport ID
+ * @return
+ *   ID of the shard owning the subport upon success, negative value otherwise
+ */
+int
+rte_sched_port_group_shard_id(struct rte_sched_port_group *group, uint32_t subport_id);
+
 /*
  * Statistics
  *
@@ -328,6 +485,35 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 	struct rte_sched_queue_stats *stats,
 	uint16_t *qlen);
 
+/**
+ * Hierarchical scheduler pipe statistics snapshot for a range of pipes. Unlike
+ * the subport and queue statistics read functions, the counters are not
+ * cleared, so it can be called from any lcore without stopping the scheduler;
+ * the counters keep counting from the last rte_sched_queue_read_stats() call
+ * on each queue and wrap around at 32 bits.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_id
+ *   Subport ID
+ * @param pipe_id
+ *   ID of the first pipe within subport
+ * @param n_pipes
+ *   Number of consecutive pipes to read
+ * @param stats
+ *   Pointer to pre-allocated array of n_pipes pipe statistics structures where
+ *   the statistics counters should be stored
+ * @return
+ *   0 upon success, -ENOTSUP when the library is built without
+ *   RTE_SCHED_COLLECT_STATS, other error code otherwise
+ */
+int
+rte_sched_pipe_read_stats_bulk(struct rte_sched_port *port,
+	uint32_t subport_id,
+	uint32_t pipe_id,
+	uint32_t n_pipes,
+	struct rte_sched_pipe_stats *stats);
+
 /*
  * Run-time
  *
@@ -344,9 +530,9 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
  * @param pipe
  *   Pipe ID within subport
  * @param traffic_class
- *   Traffic class ID within pipe (0 .. 3)
+ *   Traffic class ID within pipe (0 .. n_traffic_classes - 1)
  * @param queue
- *   Queue ID within pipe traffic class (0 .. 3)
+ *   Queue ID within pipe traffic class (0 .. n_queues_per_traffic_class - 1)
  */
 static inline void
 rte_sched_port_pkt_write(struct rte_mbuf *pkt,
@@ -373,9 +559,9 @@ rte_sched_port_pkt_write(struct rte_mbuf *pkt,
  * @param pipe
  *   Pipe ID within subport
  * @param traffic_class
- *   Traffic class ID within pipe (0 .. 3)
+ *   Traffic class ID within pipe (0 .. n_traffic_classes - 1)
  * @param queue
- *   Queue ID within pipe traffic class (0 .. 3)
+ *   Queue ID within pipe traffic class (0 .. n_queues_per_traffic_class - 1)
  *
  */
 static inline void
@@ -435,6 +621,43 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 int
 rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts);
 
+/**
+ * Port group shard dequeue. Runs the shard scheduler and moves up to n_pkts
+ * packets into the shard output ring read by the merge stage. The shard only
+ * transmits while it holds credits from the output port token bucket shared by
+ * all shards, so the port rate is enforced across the group. Called by the
+ * lcore owning the shard; each shard must be handled by a single lcore.
+ *
+ * @param group
+ *   Handle to port group instance
+ * @param shard_id
+ *   Shard ID
+ * @param n_pkts
+ *   Maximum number of packets to move to the shard output ring
+ * @return
+ *   Number of packets moved to the shard output ring, or -1 on invalid
+ *   parameters
+ */
+int
+rte_sched_port_group_shard_dequeue(struct rte_sched_port_group *group, uint32_t shard_id, uint32_t n_pkts);
+
+/**
+ * Port group merge stage. Reads up to n_pkts from the shard output rings using
+ * byte-based deficit round robin, so that each shard gets a fair share of the
+ * output port. Called by the single lcore transmitting on the output port.
+ *
+ * @param group
+ *   Handle to port group instance
+ * @param pkts
+ *   Pre-allocated packet descriptor array where the merged packets should be stored
+ * @param n_pkts
+ *   Number of packets to read
+ * @return
+ *   Number of packets read and placed in the pkts array
+ */
+int
+rte_sched_port_group_dequeue(struct rte_sched_port_group *group, struct rte_mbuf **pkts, uint32_t n_pkts);
+
 #ifdef __cplusplus
 }
 #endif
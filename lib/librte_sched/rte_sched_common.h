@@ -78,6 +78,18 @@ rte_min_pos_4_u16(uint16_t *x)
 
 #endif
 
+static inline uint32_t
+rte_min_pos_n_u16(uint16_t *x, uint32_t n)
+{
+	uint32_t pos = 0;
+	uint32_t i;
+
+	for (i = 1; i < n; i ++)
+		if (x[i] <= x[pos]) pos = i;
+
+	return pos;
+}
+
 /*
  * Compute the Greatest Common Divisor (GCD) of two numbers.
  * This implementation uses Euclid's algorithm:
@@ -35,6 +35,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <errno.h>
 
 #include <rte_atomic.h>
 #include <rte_common.h>
@@ -55,6 +56,23 @@
 
 LIST_HEAD(rte_timer_list, rte_timer);
 
+/* timer wheel geometry: WHEEL_LEVELS levels of WHEEL_SLOTS slots */
+#define WHEEL_BITS	6
+#define WHEEL_SLOTS	(1 << WHEEL_BITS)
+#define WHEEL_MASK	(WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS	5
+
+/* max distance in ticks of a timer from the current tick */
+#define WHEEL_MAX_DELTA	((UINT64_C(1) << (WHEEL_BITS * WHEEL_LEVELS)) - 1)
+
+/* per-lcore hierarchical timer wheel */
+struct timer_wheel {
+	uint64_t cur_tick;   /**< next tick to process */
+	uint64_t next_time;  /**< time of cur_tick, in cycles */
+	uint32_t count;      /**< number of timers in the wheel */
+	struct rte_timer_list slots[WHEEL_LEVELS][WHEEL_SLOTS];
+};
+
 struct priv_timer {
 	struct rte_timer pending_head;  /**< dummy timer instance to head up list */
 	rte_spinlock_t list_lock;       /**< lock to protect list access */
@@ -68,6 +86,9 @@ struct priv_timer {
 
 	unsigned prev_lcore;              /**< used for lcore round robin */
 
+	/** timer wheel, when the wheel backend is used */
+	struct timer_wheel wheel;
+
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
@@ -77,6 +98,10 @@ struct priv_timer {
 /** per-lcore private info for timers */
 static struct priv_timer priv_timer[RTE_MAX_LCORE];
 
+/** timer list backend in use and wheel resolution in cycles */
+static enum rte_timer_backend timer_backend;
+static uint64_t wheel_tick;
+
 /* when debug is enabled, store some statistics */
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 #define __TIMER_STAT_ADD(name, n) do {				\
@@ -87,11 +112,24 @@ static struct priv_timer priv_timer[RTE_MAX_LCORE];
 #define __TIMER_STAT_ADD(name, n) do {} while(0)
 #endif
 
-/* Init the timer library. */
-void
-rte_timer_subsystem_init(void)
+/* Init the timer library with the given backend. */
+int
+rte_timer_subsystem_init_backend(enum rte_timer_backend backend,
+	uint64_t tick)
 {
-	unsigned lcore_id;
+	unsigned lcore_id, i, j;
+	uint64_t cur_tick;
+
+	if (backend != RTE_TIMER_BACKEND_SKIPLIST &&
+			backend != RTE_TIMER_BACKEND_WHEEL)
+		return -EINVAL;
+
+	if (tick == 0)
+		tick = rte_get_timer_hz() / 1000;
+
+	timer_backend = backend;
+	wheel_tick = tick;
+	cur_tick = rte_get_timer_cycles() / tick;
 
 	/* since priv_timer is static, it's zeroed by default, so only init some
 	 * fields.
@@ -99,7 +137,23 @@ rte_timer_subsystem_init(void)
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id ++) {
 		rte_spinlock_init(&priv_timer[lcore_id].list_lock);
 		priv_timer[lcore_id].prev_lcore = lcore_id;
+
+		priv_timer[lcore_id].wheel.cur_tick = cur_tick;
+		priv_timer[lcore_id].wheel.next_time = cur_tick * tick;
+		priv_timer[lcore_id].wheel.count = 0;
+		for (i = 0; i != WHEEL_LEVELS; i++)
+			for (j = 0; j != WHEEL_SLOTS; j++)
+				LIST_INIT(&priv_timer[lcore_id].wheel.slots[i][j]);
 	}
+
+	return 0;
+}
+
+/* Init the timer library. */
+void
+rte_timer_subsystem_init(void)
+{
+	rte_timer_subsystem_init_backend(RTE_TIMER_BACKEND_SKIPLIST, 0);
 }
 
 /* Initialize the timer handle tim for use */
@@ -264,23 +318,14 @@ timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 }
 
 /*
- * add in list, lock if needed
- * timer must be in config state
- * timer must not be in a list
+ * add in skiplist, list must be locked
  */
 static void
-timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
+skiplist_add(struct rte_timer *tim, unsigned tim_lcore)
 {
-	unsigned lcore_id = rte_lcore_id();
 	unsigned lvl;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs to be scheduled on another core, we need to
-	 * lock the list; if it is on local core, we need to lock if
-	 * we are not called from rte_timer_manage() */
-	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
-
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
 	timer_get_prev_entries(tim->expire, tim_lcore, prev);
@@ -304,31 +349,17 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 	 * NOTE: this is not atomic on 32-bit*/
 	priv_timer[tim_lcore].pending_head.expire = priv_timer[tim_lcore].\
 			pending_head.sl_next[0]->expire;
-
-	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
 }
 
 /*
- * del from list, lock if needed
- * timer must be in config state
- * timer must be in a list
+ * del from skiplist, list must be locked
  */
 static void
-timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
-		int local_is_locked)
+skiplist_del(struct rte_timer *tim, unsigned prev_owner)
 {
-	unsigned lcore_id = rte_lcore_id();
-	unsigned prev_owner = prev_status.owner;
 	int i;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs is pending another core, we need to lock the
-	 * list; if it is on local core, we need to lock if we are not
-	 * called from rte_timer_manage() */
-	if (prev_owner != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
-
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
 	if (tim == priv_timer[prev_owner].pending_head.sl_next[0])
@@ -348,6 +379,120 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 			priv_timer[prev_owner].curr_skiplist_depth --;
 		else
 			break;
+}
+
+/*
+ * add in the slot of the wheel matching the expire time,
+ * relative to the current tick of the wheel.
+ */
+static void
+wheel_insert(struct timer_wheel *wheel, struct rte_timer *tim)
+{
+	uint64_t delta, expire;
+	unsigned lvl;
+
+	/* round up, a timer must not expire early */
+	expire = (tim->expire + wheel_tick - 1) / wheel_tick;
+
+	/* already expired, run on the next tick */
+	if ((int64_t)(expire - wheel->cur_tick) < 0)
+		expire = wheel->cur_tick;
+
+	/* too far, park it on the last level, it is cascaded again */
+	delta = expire - wheel->cur_tick;
+	if (delta > WHEEL_MAX_DELTA) {
+		delta = WHEEL_MAX_DELTA;
+		expire = wheel->cur_tick + delta;
+	}
+
+	for (lvl = 0; lvl != WHEEL_LEVELS - 1; lvl++)
+		if (delta < UINT64_C(1) << (WHEEL_BITS * (lvl + 1)))
+			break;
+
+	LIST_INSERT_HEAD(&wheel->slots[lvl][(expire >> (WHEEL_BITS * lvl)) &
+		WHEEL_MASK], tim, wheel_next);
+}
+
+/*
+ * add in wheel, list must be locked
+ */
+static void
+wheel_add(struct rte_timer *tim, unsigned tim_lcore)
+{
+	struct timer_wheel *wheel = &priv_timer[tim_lcore].wheel;
+
+	/* the wheel is not turned while empty, catch up first */
+	if (wheel->count == 0) {
+		wheel->cur_tick = rte_get_timer_cycles() / wheel_tick;
+		wheel->next_time = wheel->cur_tick * wheel_tick;
+	}
+
+	wheel_insert(wheel, tim);
+	wheel->count++;
+}
+
+/*
+ * del from wheel, list must be locked
+ */
+static void
+wheel_del(struct rte_timer *tim, unsigned prev_owner)
+{
+	/* already taken out by rte_timer_manage() */
+	if (tim->wheel_next.le_prev == NULL)
+		return;
+
+	LIST_REMOVE(tim, wheel_next);
+	tim->wheel_next.le_prev = NULL;
+	priv_timer[prev_owner].wheel.count--;
+}
+
+/*
+ * add in list, lock if needed
+ * timer must be in config state
+ * timer must not be in a list
+ */
+static void
+timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	/* if timer needs to be scheduled on another core, we need to
+	 * lock the list; if it is on local core, we need to lock if
+	 * we are not called from rte_timer_manage() */
+	if (tim_lcore != lcore_id || !local_is_locked)
+		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
+
+	if (timer_backend == RTE_TIMER_BACKEND_WHEEL)
+		wheel_add(tim, tim_lcore);
+	else
+		skiplist_add(tim, tim_lcore);
+
+	if (tim_lcore != lcore_id || !local_is_locked)
+		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
+}
+
+/*
+ * del from list, lock if needed
+ * timer must be in config state
+ * timer must be in a list
+ */
+static void
+timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
+		int local_is_locked)
+{
+	unsigned lcore_id = rte_lcore_id();
+	unsigned prev_owner = prev_status.owner;
+
+	/* if timer needs is pending another core, we need to lock the
+	 * list; if it is on local core, we need to lock if we are not
+	 * called from rte_timer_manage() */
+	if (prev_owner != lcore_id || !local_is_locked)
+		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
+
+	if (timer_backend == RTE_TIMER_BACKEND_WHEEL)
+		wheel_del(tim, prev_owner);
+	else
+		skiplist_del(tim, prev_owner);
 
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
@@ -489,17 +634,61 @@ rte_timer_pending(struct rte_timer *tim)
 	return tim->status.state == RTE_TIMER_PENDING;
 }
 
-/* must be called periodically, run all timer that expired */
-void rte_timer_manage(void)
+/*
+ * run the callback of an expired timer, then stop or reload it
+ * list must be locked, it is unlocked while the callback runs
+ */
+static void
+timer_expire(struct rte_timer *tim, unsigned lcore_id, uint64_t cur_time)
 {
 	union rte_timer_status status;
+
+	/* this timer was not pending, continue */
+	if (timer_set_running_state(tim) < 0)
+		return;
+
+	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+
+	priv_timer[lcore_id].updated = 0;
+
+	/* execute callback function with list unlocked */
+	tim->f(tim, tim->arg);
+
+	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+	__TIMER_STAT_ADD(pending, -1);
+	/* the timer was stopped or reloaded by the callback
+	 * function, we have nothing to do here */
+	if (priv_timer[lcore_id].updated == 1)
+		return;
+
+	if (tim->period == 0) {
+		/* remove from done list and mark timer as stopped */
+		status.state = RTE_TIMER_STOP;
+		status.owner = RTE_TIMER_NO_OWNER;
+		rte_wmb();
+		tim->status.u32 = status.u32;
+	}
+	else {
+		/* keep it in list and mark timer as pending */
+		status.state = RTE_TIMER_PENDING;
+		__TIMER_STAT_ADD(pending, 1);
+		status.owner = (int16_t)lcore_id;
+		rte_wmb();
+		tim->status.u32 = status.u32;
+		__rte_timer_reset(tim, cur_time + tim->period,
+				tim->period, lcore_id, tim->f, tim->arg, 1);
+	}
+}
+
+/* run all expired timers of the skiplist */
+static void
+skiplist_manage(unsigned lcore_id)
+{
 	struct rte_timer *tim, *next_tim;
-	unsigned lcore_id = rte_lcore_id();
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
 	uint64_t cur_time;
-	int i, ret;
+	int i;
 
-	__TIMER_STAT_ADD(manage, 1);
 	/* optimize for the case where per-cpu list is empty */
 	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
 		return;
@@ -536,55 +725,108 @@ void rte_timer_manage(void)
 	/* now scan expired list and call callbacks */
 	for ( ; tim != NULL; tim = next_tim) {
 		next_tim = tim->sl_next[0];
+		timer_expire(tim, lcore_id, cur_time);
+	}
 
-		ret = timer_set_running_state(tim);
+	/* update the next to expire timer value */
+	priv_timer[lcore_id].pending_head.expire =
+			(priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
+					priv_timer[lcore_id].pending_head.sl_next[0]->expire;
+done:
+	/* job finished, unlock the list lock */
+	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+}
 
-		/* this timer was not pending, continue */
-		if (ret < 0)
-			continue;
+/*
+ * move the timers of the current slot of an upper level down the wheel
+ */
+static void
+wheel_cascade(struct timer_wheel *wheel, unsigned lvl)
+{
+	struct rte_timer *tim;
+	struct rte_timer_list *slot;
 
-		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	slot = &wheel->slots[lvl][(wheel->cur_tick >> (WHEEL_BITS * lvl)) &
+		WHEEL_MASK];
 
-		priv_timer[lcore_id].updated = 0;
+	while ((tim = LIST_FIRST(slot)) != NULL) {
+		LIST_REMOVE(tim, wheel_next);
+		wheel_insert(wheel, tim);
+	}
+}
 
-		/* execute callback function with list unlocked */
-		tim->f(tim, tim->arg);
+/* run all timers of the wheel up to the current tick */
+static void
+wheel_manage(unsigned lcore_id)
+{
+	struct timer_wheel *wheel = &priv_timer[lcore_id].wheel;
+	struct rte_timer_list expired;
+	struct rte_timer_list *slot;
+	struct rte_timer *tim;
+	uint64_t cur_time, cur_tick;
+	unsigned lvl;
 
-		rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
-		__TIMER_STAT_ADD(pending, -1);
-		/* the timer was stopped or reloaded by the callback
-		 * function, we have nothing to do here */
-		if (priv_timer[lcore_id].updated == 1)
-			continue;
-
-		if (tim->period == 0) {
-			/* remove from done list and mark timer as stopped */
-			status.state = RTE_TIMER_STOP;
-			status.owner = RTE_TIMER_NO_OWNER;
-			rte_wmb();
-			tim->status.u32 = status.u32;
+	/* optimize for the case where per-cpu wheel is empty */
+	if (wheel->count == 0)
+		return;
+	cur_time = rte_get_timer_cycles();
+
+	/* no tick to process yet, checked without the lock */
+	if (likely(cur_time < wheel->next_time))
+		return;
+
+	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+
+	cur_tick = cur_time / wheel_tick;
+
+	/* gather the timers of all elapsed ticks in a single batch */
+	LIST_INIT(&expired);
+	for (; wheel->cur_tick <= cur_tick; wheel->cur_tick++) {
+
+		/* at the start of a round, bring the next timers down */
+		for (lvl = 1; lvl != WHEEL_LEVELS; lvl++) {
+			if (((wheel->cur_tick >> (WHEEL_BITS * (lvl - 1))) &
+					WHEEL_MASK) != 0)
+				break;
+			wheel_cascade(wheel, lvl);
 		}
-		else {
-			/* keep it in list and mark timer as pending */
-			status.state = RTE_TIMER_PENDING;
-			__TIMER_STAT_ADD(pending, 1);
-			status.owner = (int16_t)lcore_id;
-			rte_wmb();
-			tim->status.u32 = status.u32;
-			__rte_timer_reset(tim, cur_time + tim->period,
-					tim->period, lcore_id, tim->f, tim->arg, 1);
+
+		slot = &wheel->slots[0][wheel->cur_tick & WHEEL_MASK];
+		while ((tim = LIST_FIRST(slot)) != NULL) {
+			LIST_REMOVE(tim, wheel_next);
+			LIST_INSERT_HEAD(&expired, tim, wheel_next);
 		}
 	}
 
-	/* update the next to expire timer value */
-	priv_timer[lcore_id].pending_head.expire =
-			(priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
-					priv_timer[lcore_id].pending_head.sl_next[0]->expire;
-done:
-	/* job finished, unlock the list lock */
+	wheel->next_time = wheel->cur_tick * wheel_tick;
+
+	/*
+	 * timers stopped by a callback are removed from the batch,
+	 * so always take the first one.
+	 */
+	while ((tim = LIST_FIRST(&expired)) != NULL) {
+		LIST_REMOVE(tim, wheel_next);
+		tim->wheel_next.le_prev = NULL;
+		wheel->count--;
+		timer_expire(tim, lcore_id, cur_time);
+	}
+
 	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
 }
 
+/* must be called periodically, run all timer that expired */
+void rte_timer_manage(void)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	__TIMER_STAT_ADD(manage, 1);
+
+	if (timer_backend == RTE_TIMER_BACKEND_WHEEL)
+		wheel_manage(lcore_id);
+	else
+		skiplist_manage(lcore_id);
+}
+
 /* dump statistics about timers */
 void rte_timer_dump_stats(FILE *f)
 {
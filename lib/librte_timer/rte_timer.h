@@ -66,6 +66,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <sys/queue.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -78,6 +79,14 @@ extern "C" {
 
 #define RTE_TIMER_NO_OWNER -1 /**< Timer has no owner. */
 
+/**
+ * Timer list implementation, selected at rte_timer_subsystem_init_backend().
+ */
+enum rte_timer_backend {
+	RTE_TIMER_BACKEND_SKIPLIST, /**< Ordered skiplist, O(log n) updates. */
+	RTE_TIMER_BACKEND_WHEEL,    /**< Hierarchical wheel, O(1) updates. */
+};
+
 /**
  * Timer type: Periodic or single (one-shot).
  */
@@ -125,7 +134,12 @@ typedef void (rte_timer_cb_t)(struct rte_timer *, void *);
 struct rte_timer
 {
 	uint64_t expire;       /**< Time when timer expire. */
-	struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+	union {
+		/** Next timers in the skiplist (skiplist backend). */
+		struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+		/** Link in a wheel slot (wheel backend). */
+		LIST_ENTRY(rte_timer) wheel_next;
+	};
 	volatile union rte_timer_status status; /**< Status of timer. */
 	uint64_t period;       /**< Period of timer (0 if not periodic). */
 	rte_timer_cb_t *f;     /**< Callback function. */
@@ -165,6 +179,32 @@ struct rte_timer
  */
 void rte_timer_subsystem_init(void);
 
+/**
+ * Initialize the timer library with the given timer list backend.
+ *
+ * rte_timer_subsystem_init() is the same as using the skiplist backend,
+ * which expires timers at their exact time.
+ *
+ * The wheel backend makes rte_timer_reset() and rte_timer_stop() O(1)
+ * and rte_timer_manage() expires all timers of a tick in one batch,
+ * which suits a large number of timers such as per-flow timeouts. Timers
+ * expire at the first tick boundary after their expiry time, so up to one
+ * tick late.
+ *
+ * The backend can't be changed while timers are pending.
+ *
+ * @param backend
+ *   The timer list backend.
+ * @param tick
+ *   The resolution of the wheel in cycles (see rte_get_timer_hz()),
+ *   0 for one millisecond. Ignored by the skiplist backend.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Unknown backend.
+ */
+int rte_timer_subsystem_init_backend(enum rte_timer_backend backend,
+	uint64_t tick);
+
 /**
  * Initialize a timer handle.
  *